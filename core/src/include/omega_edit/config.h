@@ -58,6 +58,100 @@
 #define OMEGA_SEARCH_PATTERN_LENGTH_LIMIT (OMEGA_VIEWPORT_CAPACITY_LIMIT / 2)
 #endif//OMEGA_SEARCH_PATTERN_LENGTH_LIMIT
 
+#ifndef OMEGA_SEARCH_PARALLEL_CHUNK_LENGTH
+/** Number of match positions each worker scans per chunk in a parallel find-all search */
+#define OMEGA_SEARCH_PARALLEL_CHUNK_LENGTH (4LL * 1024LL * 1024LL)
+#endif//OMEGA_SEARCH_PARALLEL_CHUNK_LENGTH
+
+#ifndef OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT
+/** Longest match reported by a regular expression or hex mask search, less than OMEGA_SEARCH_PATTERN_LENGTH_LIMIT */
+#define OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT (64LL * 1024LL)
+#endif//OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT
+
+#ifndef OMEGA_SEARCH_DFA_CACHE_LIMIT
+/** Memory budget in bytes for each lazily built DFA of a regular expression or hex mask search */
+#define OMEGA_SEARCH_DFA_CACHE_LIMIT (4LL * 1024LL * 1024LL)
+#endif//OMEGA_SEARCH_DFA_CACHE_LIMIT
+
+#ifndef OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT
+/** Most patterns one multi-pattern search may find */
+#define OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT (64LL * 1024LL)
+#endif//OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT
+
+#ifndef OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT
+/** Most bytes the patterns of one multi-pattern search may hold altogether */
+#define OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT (1024LL * 1024LL)
+#endif//OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT
+
+#ifndef OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT
+/** Most transition table entries (automaton states times byte classes) one multi-pattern search may build */
+#define OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT (32LL * 1024LL * 1024LL)
+#endif//OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT
+
+#ifndef OMEGA_SEARCH_INDEX_BLOCK_LENGTH
+/** Bytes of the original file covered by each trigram filter of a session's search index */
+#define OMEGA_SEARCH_INDEX_BLOCK_LENGTH (64LL * 1024LL)
+#endif//OMEGA_SEARCH_INDEX_BLOCK_LENGTH
+
+#ifndef OMEGA_SEARCH_INDEX_FILTER_BITS
+/** Size in bits of each trigram filter of a session's search index (a power of two) */
+#define OMEGA_SEARCH_INDEX_FILTER_BITS (8192LL)
+#endif//OMEGA_SEARCH_INDEX_FILTER_BITS
+
+#ifndef OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH
+/** Original files at least this long get a search index built when their session is created (0 disables this) */
+#define OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH (16LL * 1024LL * 1024LL)
+#endif//OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH
+
+#ifndef OMEGA_FILE_MAP_LENGTH_LIMIT
+/** Longest file a model reads through a memory mapping rather than regular reads (0 disables mapping) */
+#if INTPTR_MAX == INT64_MAX
+#define OMEGA_FILE_MAP_LENGTH_LIMIT INT64_MAX
+#else
+#define OMEGA_FILE_MAP_LENGTH_LIMIT (256LL * 1024LL * 1024LL)
+#endif
+#endif//OMEGA_FILE_MAP_LENGTH_LIMIT
+
+#ifndef OMEGA_FILE_MAP_SEQUENTIAL_LENGTH
+/** Reads of a memory mapped file at least this long are hinted to the operating system as sequential scans */
+#define OMEGA_FILE_MAP_SEQUENTIAL_LENGTH (256LL * 1024LL)
+#endif//OMEGA_FILE_MAP_SEQUENTIAL_LENGTH
+
+#ifndef OMEGA_COPY_OFFLOAD_MIN_LENGTH
+/** Unchanged file ranges at least this long are copied within the kernel when saving (0 disables offloading) */
+#define OMEGA_COPY_OFFLOAD_MIN_LENGTH (64LL * 1024LL)
+#endif//OMEGA_COPY_OFFLOAD_MIN_LENGTH
+
+#ifndef OMEGA_LAZY_SNAPSHOT_RECHECK_INTERVAL_MS
+/** Milliseconds a lazy snapshot session trusts its last check that the original file is unchanged before re-checking */
+#define OMEGA_LAZY_SNAPSHOT_RECHECK_INTERVAL_MS 100
+#endif//OMEGA_LAZY_SNAPSHOT_RECHECK_INTERVAL_MS
+
+#ifndef OMEGA_PAYLOAD_CACHE_LIMIT
+/** Default memory budget in bytes for each session's cache of decoded compressed change payload blocks */
+#define OMEGA_PAYLOAD_CACHE_LIMIT (16LL * 1024LL * 1024LL)
+#endif//OMEGA_PAYLOAD_CACHE_LIMIT
+
+#ifndef OMEGA_PAYLOAD_CACHE_FILE_LIMIT
+/** Most change payload files each session keeps open between reads */
+#define OMEGA_PAYLOAD_CACHE_FILE_LIMIT 16
+#endif//OMEGA_PAYLOAD_CACHE_FILE_LIMIT
+
+#ifndef OMEGA_PAYLOAD_COMPRESSION_THREADS
+/** Number of background workers compressing file-backed change payloads (0 uses one per hardware thread) */
+#define OMEGA_PAYLOAD_COMPRESSION_THREADS 0
+#endif//OMEGA_PAYLOAD_COMPRESSION_THREADS
+
+#ifndef OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT
+/** Idle plugin host processes each transform plugin registry keeps per plugin (0 starts a host for every request) */
+#define OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT 4
+#endif//OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT
+
+#ifndef OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH
+/** Shortest shard the range of a chunk-parallel transform plugin is split into when it is applied concurrently */
+#define OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH (4LL * 1024LL * 1024LL)
+#endif//OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH
+
 #ifndef OMEGA_MEMORY_BUFFER_LIMIT
 /** Maximum byte range that APIs may materialize into one in-memory buffer. */
 #define OMEGA_MEMORY_BUFFER_LIMIT (64LL * 1024LL * 1024LL)
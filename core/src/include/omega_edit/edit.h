@@ -53,6 +53,35 @@ extern "C" {
 omega_session_t *omega_edit_create_session(const char *file_path, omega_session_event_cbk_t cbk, void *user_data_ptr,
                                            int32_t event_interest, const char *checkpoint_directory);
 
+/**
+ * Options for creating a session with named fields.
+ */
+typedef struct {
+    omega_session_event_cbk_t cbk;
+    void *user_data_ptr;
+    int32_t event_interest;
+    const char *checkpoint_directory;
+    /**
+     * Rather than copying the file to the session's private snapshot before the session is created, read the file
+     * directly and copy the snapshot on a background thread, switching to it once it's copied.  This makes opening
+     * large files instant on filesystems that can't clone files.  Until the snapshot is copied (see
+     * omega_session_wait_for_original_snapshot), each read from the file checks it still has the size and modification
+     * time it had when the session was created.  If another process changes it, every read of the original content
+     * fails from then on, including the reads made to save or transform the session.
+     */
+    omega_edit_bool_t lazy_snapshot;
+} omega_edit_session_options_t;
+
+/**
+ * Create a file editing session from a file path, with named options
+ * @param file_path file path, will be opened for read, to create an editing session with, or nullptr if starting from
+ * scratch
+ * @param options session options, see omega_edit_create_session for the meaning of the fields they share
+ * @return pointer to the created session, or NULL on failure
+ */
+omega_session_t *omega_edit_create_session_with_options(const char *file_path,
+                                                        const omega_edit_session_options_t *options);
+
 /**
  * Create an editing session backed by an in-memory byte buffer.
  * @param data_ptr bytes to seed the session with, or nullptr if length is zero
@@ -177,6 +206,15 @@ typedef int (*omega_edit_overwrite_guard_cbk_t)(const char *file_path, void *use
 typedef struct {
     omega_edit_overwrite_guard_cbk_t overwrite_guard;
     void *overwrite_guard_user_data;
+    /**
+     * Overwrite the original file in place, writing only the byte ranges that changed rather than replacing the whole
+     * file.  The bytes being replaced are first saved to a journal next to the file, so an interrupted save can be
+     * rolled back by omega_edit_roll_back_in_place_save (see omega_session_has_in_place_save_journal).  This only
+     * applies when saving the whole session over its original file, the session length matches the file length, the
+     * session has no checkpoints, and the file is unmodified since the session was created or last saved in place;
+     * otherwise the save replaces the whole file as usual.  An in-place save fails while an earlier journal is pending.
+     */
+    omega_edit_bool_t in_place;
 } omega_edit_save_options_t;
 
 /**
@@ -223,6 +261,16 @@ int omega_edit_save(omega_session_t *session_ptr, const char *file_path, int io_
 int omega_edit_save_with_options(omega_session_t *session_ptr, const char *file_path, int io_flags,
                                  char *saved_file_path, const omega_edit_save_options_t *options_ptr);
 
+/**
+ * Roll back an interrupted in-place save of the given file (see omega_edit_save_options_t), restoring the bytes saved
+ * in its journal and then removing the journal.  Sessions created for the file never do this automatically, but
+ * report the journal through omega_session_has_in_place_save_journal.  The journal is refused unless it's owned by the
+ * current user, its checksum matches, and the file is the one it was written for and hasn't been rewritten since.
+ * @param file_path path of the file that may have been interrupted while being saved in place
+ * @return zero if the file had no journal or its save was rolled back, non-zero otherwise
+ */
+int omega_edit_roll_back_in_place_save(const char *file_path);
+
 /**
  * Write a session byte range to an already-open file without publishing a save event.
  *
@@ -471,6 +519,47 @@ int64_t omega_edit_replace_bytes_as_transform(omega_session_t *session_ptr, int6
                                               const omega_byte_t *bytes, int64_t insert_length,
                                               const char *transform_id, const char *options_json);
 
+/**
+ * Materialize a transform result held in a file through a checkpoint-backed model and record a lightweight transform
+ * change.
+ *
+ * Like omega_edit_replace_bytes_as_transform, but the replacement is the whole content of the given file, which is
+ * copied into the checkpoint without being read into memory. The file is not retained and may be removed afterwards.
+ *
+ * @param session_ptr session to make the change in
+ * @param offset location offset to make the change
+ * @param delete_length number of original bytes to remove
+ * @param file_path path to the file holding the replacement bytes
+ * @param transform_id stable transform identifier
+ * @param options_json optional transform options JSON
+ * @return positive transform change serial if successful, non-positive otherwise
+ */
+int64_t omega_edit_replace_file_as_transform(omega_session_t *session_ptr, int64_t offset, int64_t delete_length,
+                                             const char *file_path, const char *transform_id,
+                                             const char *options_json);
+
+/**
+ * Materialize a transform result held in several files through a checkpoint-backed model and record one lightweight
+ * transform change.
+ *
+ * Like omega_edit_replace_file_as_transform, but the range starting at the given offset is replaced in consecutive
+ * parts.  Each part replaces its length of bytes with the whole content of its file, or leaves them unchanged if its
+ * file path is null, so the result of a transform applied in pieces is never joined into one file first.  The files
+ * are not retained and may be removed afterwards.
+ *
+ * @param session_ptr session to make the change in
+ * @param offset location offset of the first part
+ * @param part_count number of parts
+ * @param part_lengths number of original bytes each part replaces
+ * @param file_paths path to the file holding each part's replacement bytes, or null to leave the part unchanged
+ * @param transform_id stable transform identifier
+ * @param options_json optional transform options JSON
+ * @return positive transform change serial if successful, zero if every part is unchanged, negative otherwise
+ */
+int64_t omega_edit_replace_files_as_transform(omega_session_t *session_ptr, int64_t offset, int64_t part_count,
+                                              const int64_t *part_lengths, const char *const *file_paths,
+                                              const char *transform_id, const char *options_json);
+
 /**
  * Replace a span of bytes at the given offset with a new C string.
  * @param session_ptr session to make the change in
@@ -720,6 +809,11 @@ int omega_edit_replace_all_cstring(omega_session_t *session_ptr, const char *pat
  * Operations are applied in the order given. The function does not roll back already-applied
  * operations if a later operation fails; it simply stops and returns non-zero.
  *
+ * Scripts whose operations all move forward (or all move backward) through the session without
+ * touching bytes an earlier operation inserted, such as the scripts built to replace matches, are
+ * applied in a single pass over the session's model. They record the same changes as applying the
+ * operations one at a time, and are applied entirely or not at all.
+ *
  * @param session_ptr session to edit
  * @param ops array of edit operations
  * @param op_count number of operations in the array
@@ -755,6 +849,19 @@ int omega_edit_apply_builtin_transform(omega_session_t *session_ptr, omega_edit_
 int omega_edit_apply_transform(omega_session_t *session_ptr, omega_util_byte_transform_t transform, void *user_data_ptr,
                                int64_t offset, int64_t length);
 
+/**
+ * Checkpoint and replace each byte starting at the given offset up to the given length with its entry in the given
+ * lookup table. Prefer this over omega_edit_apply_transform when the transform depends only on the byte value, since
+ * the table is applied without a function call per byte (see omega_util_fill_byte_table to tabulate a callback).
+ * @param session_ptr session to transform
+ * @param table table of 256 bytes, indexed by the input byte
+ * @param offset location offset to begin transforming bytes
+ * @param length number of bytes from the given offset to transform, or zero to transform through the end of session
+ * @return zero on success, non-zero otherwise
+ */
+int omega_edit_apply_table_transform(omega_session_t *session_ptr, const omega_byte_t *table, int64_t offset,
+                                     int64_t length);
+
 /**
  * Creates a session checkpoint.
  * @param session_ptr session to checkpoint
@@ -115,6 +115,9 @@ typedef struct omega_change_struct omega_change_t;
 /** Opaque search context */
 typedef struct omega_search_context_struct omega_search_context_t;
 
+/** Opaque multi-pattern search context */
+typedef struct omega_multi_search_context_struct omega_multi_search_context_t;
+
 /** Opaque segment */
 typedef struct omega_segment_struct omega_segment_t;
 
@@ -49,6 +49,20 @@ typedef enum {
     OMEGA_SEARCH_CASE_FOLDING_MAC_ROMAN = 5
 } omega_search_case_folding_t;
 
+/**
+ * Syntax of a pattern given to omega_search_create_pattern_context.
+ *
+ * OMEGA_SEARCH_PATTERN_SYNTAX_REGEX is a byte-oriented regular expression: '.' matches any byte, and patterns can use
+ * '\xHH' and the usual C escapes, the '\d', '\s', and '\w' ASCII classes (and their negations), bracketed classes
+ * and ranges, '|' alternation, '(' ')' groups, and the greedy '*', '+', '?', and '{n,m}' repetitions (counts up to
+ * 1000).  Anchors and backreferences are not supported.  OMEGA_SEARCH_PATTERN_SYNTAX_HEX_MASK is a sequence of hex
+ * byte pairs, optionally separated by whitespace, where '?' stands for any nibble (e.g. "4D 5A ?? ?? 5?").
+ */
+typedef enum {
+    OMEGA_SEARCH_PATTERN_SYNTAX_REGEX = 0,
+    OMEGA_SEARCH_PATTERN_SYNTAX_HEX_MASK = 1
+} omega_search_pattern_syntax_t;
+
 /**
  * Create a search context
  * @param session_ptr session to find patterns in
@@ -93,6 +107,29 @@ omega_search_context_t *omega_search_create_context(omega_session_t *session_ptr
                                                     int64_t session_length, omega_search_case_folding_t case_folding,
                                                     int is_reverse_search);
 
+/**
+ * Create a search context for a regular expression or hex mask pattern, found with lazily built DFAs that stream
+ * through the session in bounded memory.  Each match found is the leftmost one from the search position, and the
+ * longest one starting there.  Use omega_search_next_match to find matches (forward only), and
+ * omega_search_context_get_match_length for their lengths.
+ * @param session_ptr session to find the pattern in
+ * @param pattern pointer to the pattern text
+ * @param pattern_length explicit length of the pattern text in bytes
+ * @param pattern_syntax syntax of the pattern text
+ * @param session_offset start searching at this offset within the session
+ * @param session_length search from the starting offset within the session up to this many bytes, if set to zero, it
+ * will search to the end of the session
+ * @param case_folding case folding mode; use OMEGA_SEARCH_CASE_FOLDING_NONE for exact byte matching
+ * @return search context, or null if the pattern is malformed, too complex, or can match an empty sequence
+ * @warning Matches longer than OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT bytes are not found, so unbounded repetitions
+ * stop at that length.
+ */
+omega_search_context_t *omega_search_create_pattern_context(omega_session_t *session_ptr, const omega_byte_t *pattern,
+                                                            int64_t pattern_length,
+                                                            omega_search_pattern_syntax_t pattern_syntax,
+                                                            int64_t session_offset, int64_t session_length,
+                                                            omega_search_case_folding_t case_folding);
+
 /**
  * Given a search context, determine if the search is being done forwards or backwards
  * @param search_context_ptr search context to determine if the search is forwards or backwards
@@ -128,6 +165,25 @@ int64_t omega_search_context_get_match_offset(const omega_search_context_t *sear
  */
 int64_t omega_search_context_get_pattern_length(const omega_search_context_t *search_context_ptr);
 
+/**
+ * Given a search context, get the length of the most recent match
+ * @param search_context_ptr search context to get the match length from
+ * @return length of the most recent match, which is the pattern length for literal patterns, or zero if a regular
+ * expression or hex mask search has no current match
+ */
+int64_t omega_search_context_get_match_length(const omega_search_context_t *search_context_ptr);
+
+/**
+ * Pin the session content a search context searches, so later matches are found in the content as it is now, even if
+ * the session is edited between calls to omega_search_next_match.  Pinning is cheap (the content is shared with the
+ * session, not copied), and the pinned content is released when the search context is destroyed.
+ * @param search_context_ptr search context to pin the content of
+ * @return zero on success, non-zero on failure
+ * @warning Pinned content is lost if the checkpoint it belongs to is destroyed, after which omega_search_next_match
+ * fails.
+ */
+int omega_search_context_pin_content(omega_search_context_t *search_context_ptr);
+
 /**
  * Given a search context, find the next match
  * @param search_context_ptr search context to find the next match in
@@ -136,12 +192,128 @@ int64_t omega_search_context_get_pattern_length(const omega_search_context_t *se
  */
 int omega_search_next_match(omega_search_context_t *search_context_ptr, int64_t advance_context);
 
+/**
+ * Given a search context, find the next match, trying at most scan_length starting offsets.  When the limit is reached
+ * without a match, the next call (to this function or omega_search_next_match) continues from the first offset not yet
+ * tried, so a long search can be done in steps with other work, such as checking for cancellation, in between.
+ * @param search_context_ptr search context to find the next match in
+ * @param advance_context advance the internal search context offset by this many bytes, ignored when continuing a
+ * search that reached its scan limit
+ * @param scan_length maximum number of starting offsets to try, or zero to try them all
+ * @return 1 if a match is found, zero if no match remains, 2 if the scan limit was reached without a match, negative on
+ * search failure
+ * @note Only literal pattern searches are bounded, regular expression and hex mask searches scan to the next match.
+ */
+int omega_search_next_match_bounded(omega_search_context_t *search_context_ptr, int64_t advance_context,
+                                    int64_t scan_length);
+
 /**
  * Destroy the given search context
  * @param search_context_ptr search context to destroy
  */
 void omega_search_destroy_context(omega_search_context_t *search_context_ptr);
 
+/**
+ * Callback receiving the matches found by omega_search_find_all, one chunk of the searched range at a time
+ * @param match_offsets session offsets of the matches found in the chunk, in ascending order
+ * @param match_count number of matches in match_offsets, which may be zero
+ * @param user_data_ptr user data given to omega_search_find_all
+ * @return zero to continue searching, non-zero to cancel the search
+ */
+typedef int (*omega_search_matches_cbk_t)(const int64_t *match_offsets, int64_t match_count, void *user_data_ptr);
+
+/**
+ * Find every (possibly overlapping) forward match of a pattern, scanning chunks of the range on a pool of worker
+ * threads.  Each chunk overlaps the next by pattern_length - 1 bytes so matches spanning chunk boundaries are found
+ * once, and chunks are reported to the callback on the calling thread in ascending offset order.
+ * @param session_ptr session to find the pattern in
+ * @param pattern pointer to the pattern to find (as a sequence of bytes)
+ * @param pattern_length explicit length of the pattern in bytes
+ * @param session_offset start searching at this offset within the session
+ * @param session_length search from the starting offset within the session up to this many bytes, if set to zero, it
+ * will search to the end of the session
+ * @param case_folding case folding mode; use OMEGA_SEARCH_CASE_FOLDING_NONE for exact byte matching
+ * @param limit maximum number of matches to report (0 = unlimited)
+ * @param thread_count number of worker threads to use (0 = one per hardware thread)
+ * @param cbk callback receiving the matches, returning non-zero cancels the search
+ * @param user_data_ptr pointer to user data passed to the callback
+ * @return number of matches reported, or -1 on failure
+ * @warning The session must not be modified by any thread until this function returns.
+ */
+int64_t omega_search_find_all(omega_session_t *session_ptr, const omega_byte_t *pattern, int64_t pattern_length,
+                              int64_t session_offset, int64_t session_length, omega_search_case_folding_t case_folding,
+                              int64_t limit, int thread_count, omega_search_matches_cbk_t cbk, void *user_data_ptr);
+
+/**
+ * Create a multi-pattern search context, which finds every occurrence of any of the given patterns in a single forward
+ * pass over the session
+ * @param session_ptr session to find the patterns in
+ * @param patterns array of pointers to the patterns to find (as sequences of bytes), a pattern's identifier is its
+ * index in this array
+ * @param pattern_lengths array of explicit pattern lengths in bytes, each greater than zero and less than
+ * OMEGA_SEARCH_PATTERN_LENGTH_LIMIT
+ * @param pattern_count number of patterns, which must be greater than zero and at most
+ * OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT, with at most OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT bytes altogether
+ * @param session_offset start searching at this offset within the session
+ * @param session_length search from the starting offset within the session up to this many bytes, if set to zero, it
+ * will search to the end of the session
+ * @param case_folding case folding mode; use OMEGA_SEARCH_CASE_FOLDING_NONE for exact byte matching
+ * @return multi-pattern search context, or null if the arguments are invalid, the patterns need a transition table of
+ * more than OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT entries, or the context could not be allocated
+ * @warning Matches are read from the session as the search advances, so edit the session only between searches (a
+ * new context sees the edits).
+ */
+omega_multi_search_context_t *omega_search_create_multi_context(omega_session_t *session_ptr,
+                                                                const omega_byte_t *const *patterns,
+                                                                const int64_t *pattern_lengths, int64_t pattern_count,
+                                                                int64_t session_offset, int64_t session_length,
+                                                                omega_search_case_folding_t case_folding);
+
+/**
+ * Given a multi-pattern search context, find the next match.  Matches are reported in order of the offset where they
+ * end, and matches ending at the same offset are reported from the longest pattern to the shortest.  Overlapping
+ * matches are all reported.
+ * @param search_context_ptr multi-pattern search context to find the next match in
+ * @return positive if a match is found, zero if no match remains, negative on search failure
+ */
+int omega_search_next_multi_match(omega_multi_search_context_t *search_context_ptr);
+
+/**
+ * Given a multi-pattern search context, get the offset of the most recent match
+ * @param search_context_ptr multi-pattern search context to get the most recent match offset from
+ * @return most recent match offset, if it is equal to the end of the searched range, then no match was found
+ */
+int64_t omega_search_multi_context_get_match_offset(const omega_multi_search_context_t *search_context_ptr);
+
+/**
+ * Given a multi-pattern search context, get the identifier of the pattern of the most recent match
+ * @param search_context_ptr multi-pattern search context to get the most recent match pattern from
+ * @return index of the matched pattern in the array given at creation, or -1 if there is no current match
+ */
+int64_t omega_search_multi_context_get_match_pattern_id(const omega_multi_search_context_t *search_context_ptr);
+
+/**
+ * Given a multi-pattern search context, get the number of patterns
+ * @param search_context_ptr multi-pattern search context to get the number of patterns from
+ * @return number of patterns
+ */
+int64_t omega_search_multi_context_get_pattern_count(const omega_multi_search_context_t *search_context_ptr);
+
+/**
+ * Given a multi-pattern search context, get the length of a pattern
+ * @param search_context_ptr multi-pattern search context to get the pattern length from
+ * @param pattern_id pattern identifier
+ * @return pattern length, or zero if the pattern identifier is invalid
+ */
+int64_t omega_search_multi_context_get_pattern_length(const omega_multi_search_context_t *search_context_ptr,
+                                                      int64_t pattern_id);
+
+/**
+ * Destroy the given multi-pattern search context
+ * @param search_context_ptr multi-pattern search context to destroy
+ */
+void omega_search_destroy_multi_context(omega_multi_search_context_t *search_context_ptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -68,11 +68,21 @@ const char *omega_session_get_file_path(const omega_session_t *session_ptr);
 /**
  * Given a session, return the OmegaEdit-owned immutable snapshot file captured at session creation.
  * @param session_ptr session to inspect
- * @return borrowed snapshot file path pointer, or null if unavailable. The returned pointer is owned by the session and
- * remains valid only until the next session mutation or session destruction.
+ * @return borrowed snapshot file path pointer, or null if unavailable (including while a lazy snapshot is still being
+ * copied). The returned pointer is owned by the session and remains valid only until the next session mutation or
+ * session destruction.
  */
 const char *omega_session_get_original_snapshot_file_path(const omega_session_t *session_ptr);
 
+/**
+ * Given a session, determine if the journal of an interrupted in-place save of its file existed when it was created.
+ * Such a journal is never applied automatically; use omega_edit_roll_back_in_place_save to restore the file, then
+ * create a new session for it.
+ * @param session_ptr session to inspect
+ * @return non-zero if an in-place save journal was found and zero otherwise
+ */
+int omega_session_has_in_place_save_journal(const omega_session_t *session_ptr);
+
 /**
  * Given a session, return the session event callback
  * @param session_ptr session to return the event callback from
@@ -128,7 +138,7 @@ int omega_session_get_original_segment(const omega_session_t *session_ptr, omega
 int64_t omega_session_get_num_viewports(const omega_session_t *session_ptr);
 
 /**
- * Given a session, return the number of active search contexts
+ * Given a session, return the number of active search contexts, including multi-pattern search contexts
  * @param session_ptr session to get the number of active search contexts for
  * @return number of active search contexts
  */
@@ -397,6 +407,83 @@ int64_t omega_session_get_change_inline_payload_limit(const omega_session_t *ses
  */
 int64_t omega_session_set_change_inline_payload_limit(omega_session_t *session_ptr, int64_t limit);
 
+/**
+ * Given a session, return the memory budget of its payload cache. Reads of compressed file-backed change payloads keep
+ * the decoded blocks in this cache, least recently used blocks being evicted first, so reading the same bytes again
+ * doesn't decode them again. The budget defaults to OMEGA_PAYLOAD_CACHE_LIMIT.
+ * @param session_ptr session to get the payload cache budget for
+ * @return budget in bytes, or 0 for null sessions
+ */
+int64_t omega_session_get_payload_cache_limit(const omega_session_t *session_ptr);
+
+/**
+ * Set the memory budget of a session's payload cache, evicting cached blocks as needed. A value of 0 disables caching
+ * decoded blocks.
+ * @param session_ptr session to set the payload cache budget for
+ * @param limit budget in bytes
+ * @return the new budget, or 0 on error
+ */
+int64_t omega_session_set_payload_cache_limit(omega_session_t *session_ptr, int64_t limit);
+
+/**
+ * Given a session, return the number of compressed payload blocks read from its payload cache
+ * @param session_ptr session to get the payload cache hits for
+ * @return number of cache hits, or 0 for null sessions
+ */
+int64_t omega_session_get_payload_cache_hits(const omega_session_t *session_ptr);
+
+/**
+ * Given a session, return the number of compressed payload blocks its payload cache had to decode
+ * @param session_ptr session to get the payload cache misses for
+ * @return number of cache misses, or 0 for null sessions
+ */
+int64_t omega_session_get_payload_cache_misses(const omega_session_t *session_ptr);
+
+/**
+ * Given a session, return the number of decoded payload bytes held in its payload cache
+ * @param session_ptr session to get the payload cache size for
+ * @return number of cached bytes, or 0 for null sessions
+ */
+int64_t omega_session_get_payload_cache_bytes(const omega_session_t *session_ptr);
+
+/**
+ * Wait for the background compression of a session's file-backed change payloads to finish. Edits that store their
+ * payloads in files return before the files are compressed, and each payload is read from its raw file until its
+ * compressed file replaces it. Payloads that don't compress well are left raw.
+ * @param session_ptr session to wait for
+ * @return 0 once every payload of the session is either compressed or left raw, -1 for null sessions
+ */
+int omega_session_wait_for_payload_compression(const omega_session_t *session_ptr);
+
+/**
+ * Start building the search index of the session's original file on a background thread. The index records which
+ * trigrams occur in each block of the original file, letting forward literal searches skip the original bytes that
+ * can't contain the pattern (until the session creates a checkpoint). It's saved in the checkpoint directory and reused
+ * by later sessions on the same unmodified file. Sessions on original files of at least
+ * OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH bytes start building it when they're created.
+ * @param session_ptr session to build the search index for
+ * @return 0 if the index is being built (or already has been), -1 if the session has no original file or the build
+ * couldn't be started
+ */
+int omega_session_build_search_index(omega_session_t *session_ptr);
+
+/**
+ * Wait for the search index of the session's original file to finish building
+ * @param session_ptr session to wait for
+ * @return 0 if the search index is ready, -1 if it was never started or couldn't be built
+ */
+int omega_session_wait_for_search_index(omega_session_t *session_ptr);
+
+/**
+ * Wait for the lazy snapshot of the session's original file to be copied, then read the original content from the
+ * snapshot rather than the original file.  Sessions created with a lazy snapshot switch to the snapshot on their own
+ * once it's copied, at the next edit, viewport refresh, or checkpoint, and before saving over the original file.
+ * @param session_ptr session to wait for
+ * @return 0 if the session reads its original content from its private snapshot (always the case for sessions created
+ * without a lazy snapshot), -1 if the snapshot couldn't be copied, for example because the original file changed
+ */
+int omega_session_wait_for_original_snapshot(omega_session_t *session_ptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,7 +36,7 @@ extern "C" {
 
 #endif
 
-#define OMEGA_TRANSFORM_PLUGIN_ABI_VERSION 3
+#define OMEGA_TRANSFORM_PLUGIN_ABI_VERSION 5
 
 typedef enum {
     OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE = 1,
@@ -56,7 +56,13 @@ typedef enum {
     OMEGA_TRANSFORM_PLUGIN_FLAG_MAY_SHRINK = 1 << 2,
     OMEGA_TRANSFORM_PLUGIN_FLAG_TEXT_RESULT = 1 << 3,
     OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE = 1 << 4,
-    OMEGA_TRANSFORM_PLUGIN_FLAG_STREAMING = 1 << 5
+    OMEGA_TRANSFORM_PLUGIN_FLAG_STREAMING = 1 << 5,
+    /**
+     * Replace transform that maps each chunk of its input independently of the others, so the host may split a large
+     * range into shards at multiples of omega_transform_plugin_info_t::chunk_alignment, apply them concurrently, and
+     * join the replacements in order.  Its apply function must be safe to call from several threads at once.
+     */
+    OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL = 1 << 6
 } omega_transform_plugin_flags_t;
 
 typedef struct {
@@ -75,12 +81,15 @@ typedef struct {
     /** Optional JSON Schema used to validate options_json before apply. */
     const char *args_schema;
     omega_transform_plugin_support_t support;
+    /** Shard boundaries of OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL transforms fall on multiples of this (0 means 1). */
+    uint32_t chunk_alignment;
 } omega_transform_plugin_info_t;
 
 typedef void *(*omega_transform_plugin_alloc_t)(size_t size, void *user_data_ptr);
 typedef int64_t (*omega_transform_plugin_read_t)(int64_t relative_offset, omega_byte_t *buffer, int64_t length,
                                                  void *user_data_ptr);
 typedef int (*omega_transform_plugin_is_cancelled_t)(void *user_data_ptr);
+typedef int (*omega_transform_plugin_write_t)(const omega_byte_t *bytes, int64_t length, void *user_data_ptr);
 
 typedef enum {
     OMEGA_TRANSFORM_PROGRESS_HAS_PROCESSED_BYTES = 1,
@@ -89,7 +98,11 @@ typedef enum {
     OMEGA_TRANSFORM_PROGRESS_INDETERMINATE = 1 << 3
 } omega_transform_progress_flags_t;
 
-typedef enum { OMEGA_TRANSFORM_PLUGIN_RESPONSE_NO_CONTENT_CHANGE = 1 } omega_transform_plugin_response_flags_t;
+typedef enum {
+    OMEGA_TRANSFORM_PLUGIN_RESPONSE_NO_CONTENT_CHANGE = 1,
+    /** The replacement was passed to omega_transform_plugin_request_t::write; replacement_length is its total. */
+    OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT = 1 << 1
+} omega_transform_plugin_response_flags_t;
 
 typedef struct {
     int64_t processed_bytes;
@@ -132,6 +145,22 @@ typedef struct {
      */
     omega_transform_plugin_is_cancelled_t is_cancelled;
     void *cancel_user_data_ptr;
+    /**
+     * Optional callback replace operations may use to emit the replacement in chunks, in order, instead of returning
+     * it in one response buffer. The host appends each chunk to file-backed storage, so plugins that stream need only
+     * hold one chunk at a time. A non-zero return value means the chunk was not stored and the plugin should fail.
+     * Plugins that stream must set OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT and report the total length
+     * written in replacement_length. Null when the host can't accept a streamed replacement.
+     */
+    omega_transform_plugin_write_t write;
+    void *writer_user_data_ptr;
+    /**
+     * Offset of input_bytes within the range the caller asked to transform.  It is non-zero only when the host split
+     * the range of an OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL transform into shards, in which case session_offset
+     * and session_length describe the shard; position-dependent maps, such as a repeating mask, use it to stay in
+     * phase.
+     */
+    int64_t range_offset;
 } omega_transform_plugin_request_t;
 
 /**
@@ -168,6 +197,15 @@ int omega_transform_plugin_registry_register_directory(omega_transform_plugin_re
 int omega_transform_plugin_registry_set_host_path(omega_transform_plugin_registry_t *registry_ptr,
                                                   const char *host_path);
 
+int omega_transform_plugin_registry_set_host_pool_limit(omega_transform_plugin_registry_t *registry_ptr,
+                                                        int64_t limit);
+
+int omega_transform_plugin_registry_set_plugin_trusted(omega_transform_plugin_registry_t *registry_ptr,
+                                                       const char *plugin_path, int trusted);
+
+int omega_transform_plugin_registry_set_parallel_thread_count(omega_transform_plugin_registry_t *registry_ptr,
+                                                              int thread_count);
+
 int omega_transform_plugin_registry_set_allow_experimental(omega_transform_plugin_registry_t *registry_ptr, int allow);
 
 int omega_transform_plugin_registry_set_allow_test(omega_transform_plugin_registry_t *registry_ptr, int allow);
@@ -115,6 +115,23 @@ static inline int omega_transform_plugin_sdk_set_replacement(const omega_transfo
     return response_ptr->replacement_bytes ? 0 : -1;
 }
 
+static inline int
+omega_transform_plugin_sdk_can_stream_replacement(const omega_transform_plugin_request_t *request_ptr) {
+    return request_ptr && request_ptr->write ? 1 : 0;
+}
+
+static inline int omega_transform_plugin_sdk_write_replacement(const omega_transform_plugin_request_t *request_ptr,
+                                                               omega_transform_plugin_response_t *response_ptr,
+                                                               const omega_byte_t *bytes, int64_t length) {
+    if (!request_ptr || !request_ptr->write || !response_ptr || length < 0 || (length > 0 && !bytes)) { return -1; }
+    if (response_ptr->replacement_bytes || response_ptr->replacement_length > INT64_MAX - length) { return -1; }
+    response_ptr->flags |= OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT;
+    if (length == 0) { return 0; }
+    if (request_ptr->write(bytes, length, request_ptr->writer_user_data_ptr) != 0) { return -1; }
+    response_ptr->replacement_length += length;
+    return 0;
+}
+
 static inline int omega_transform_plugin_sdk_set_text_result(const omega_transform_plugin_request_t *request_ptr,
                                                              omega_transform_plugin_response_t *response_ptr,
                                                              const char *label, const char *value,
@@ -89,6 +89,46 @@ typedef omega_byte_t (*omega_util_byte_transform_t)(omega_byte_t, void *user_dat
 void omega_util_apply_byte_transform(omega_byte_t *buffer, int64_t len, omega_util_byte_transform_t transform,
                                      void *user_data_ptr);
 
+/**
+ * Fill a 256 entry lookup table with the result of the given transform for every byte value, so the transform can be
+ * applied with omega_util_apply_byte_table without a function call per byte
+ * @param table table of 256 bytes to fill, indexed by the input byte
+ * @param transform transform function to tabulate, which must not depend on the position of the byte
+ * @param user_data_ptr pointer to user-defined data to associate with the transformer
+ */
+void omega_util_fill_byte_table(omega_byte_t *table, omega_util_byte_transform_t transform, void *user_data_ptr);
+
+/**
+ * Replace each byte in the given buffer with its entry in the given lookup table
+ * @param buffer buffer of bytes to apply the table to
+ * @param len number of bytes in the buffer to apply the table to
+ * @param table table of 256 bytes, indexed by the input byte
+ */
+void omega_util_apply_byte_table(omega_byte_t *buffer, int64_t len, const omega_byte_t *table);
+
+/**
+ * Apply the given mask of the given mask kind to bytes in the given buffer
+ * @param buffer buffer of bytes to mask
+ * @param len number of bytes in the buffer to mask
+ * @param mask mask to apply
+ * @param mask_kind mask kind (e.g., MASK_AND, MASK_OR, MASK_XOR)
+ */
+void omega_util_apply_mask(omega_byte_t *buffer, int64_t len, omega_byte_t mask, omega_mask_kind_t mask_kind);
+
+/**
+ * Convert ASCII lower case letters in the given buffer to upper case, leaving all other bytes unchanged
+ * @param buffer buffer of bytes to convert
+ * @param len number of bytes in the buffer to convert
+ */
+void omega_util_ascii_to_upper(omega_byte_t *buffer, int64_t len);
+
+/**
+ * Convert ASCII upper case letters in the given buffer to lower case, leaving all other bytes unchanged
+ * @param buffer buffer of bytes to convert
+ * @param len number of bytes in the buffer to convert
+ */
+void omega_util_ascii_to_lower(omega_byte_t *buffer, int64_t len);
+
 /**
  * Apply the given transform to the input file and write the transformed data to the output file
  * @param in_path path of the file to apply the transform to
@@ -103,6 +143,18 @@ int omega_util_apply_byte_transform_to_file(char const *in_path, char const *out
                                             omega_util_byte_transform_t transform, void *user_data_ptr, int64_t offset,
                                             int64_t length);
 
+/**
+ * Apply the given lookup table to the input file and write the transformed data to the output file
+ * @param in_path path of the file to apply the table to
+ * @param out_path path of the file to write the transformed data to
+ * @param table table of 256 bytes, indexed by the input byte
+ * @param offset where to begin transforming bytes
+ * @param length number of bytes to transform from the given offset
+ * @return zero on success, non-zero on failure
+ */
+int omega_util_apply_byte_table_to_file(char const *in_path, char const *out_path, const omega_byte_t *table,
+                                        int64_t offset, int64_t length);
+
 /**
  * Apply the given mask of the given mask kind to the given byte
  * @param byte byte to mask
@@ -58,7 +58,10 @@ int64_t omega_viewport_get_length(const omega_viewport_t *viewport_ptr);
 /**
  * Given a viewport, return the viewport data
  * @param viewport_ptr viewport to get the viewport data from
- * @return viewport data
+ * @return viewport data, omega_viewport_get_length bytes long
+ * @warning When the viewport lies within a single unedited run of the file or a single insert, the data is borrowed
+ * from the session rather than copied, so it is not null-terminated.  The data remains valid until the viewport has
+ * changes, or is modified or destroyed.
  */
 const omega_byte_t *omega_viewport_get_data(const omega_viewport_t *viewport_ptr);
 
@@ -18,6 +18,7 @@
 #include "../include/omega_edit/filesystem.h"
 #include "../include/omega_edit/session.h"
 #include "impl_/change_def.hpp"
+#include "impl_/internal_fun.hpp"
 #include "impl_/model_def.hpp"
 #include "impl_/session_def.hpp"
 
@@ -34,6 +35,7 @@
 #include <vector>
 
 using omega_edit::internal::change_kind_t;
+using omega_edit::internal::model_file_is_unchanged_;
 using omega_edit::internal::omega_change_copy_payload_bytes_;
 using omega_edit::internal::omega_change_get_kind_;
 
@@ -598,9 +600,12 @@ namespace {
             if (!session || model_index >= session->models_.size()) { return false; }
             const auto *model = session->models_[model_index].get();
             rope_.reset();
-            const auto &backing_path = model_index == 0 && !session->checkpoint_file_name_.empty()
-                                               ? session->checkpoint_file_name_
-                                               : model->file_path;
+            // A pending lazy snapshot isn't complete yet, so the original model still reads the original file
+            const auto &backing_path =
+                    model_index == 0 && !session->checkpoint_file_name_.empty() && !session->original_snapshot_copier_
+                            ? session->checkpoint_file_name_
+                            : model->file_path;
+            if (!model_file_is_unchanged_(model)) { return false; }
             const auto file_size = omega_util_file_size(backing_path.c_str());
             if (file_size < 0) { return false; }
             if (file_size > 0) {
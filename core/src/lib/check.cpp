@@ -20,6 +20,7 @@
 #include "impl_/safe_math.hpp"
 #include "impl_/session_def.hpp"
 #include <cassert>
+#include <new>
 
 using omega_edit::internal::print_model_segments_;
 using omega_edit::internal::safe_add_int64_;
@@ -32,48 +33,63 @@ int omega_check_model(const omega_session_t *session_ptr) {
         const auto &model_ptr = session_ptr->models_[model_index];
         if (!model_ptr) { return -1; }
 
+        // Subtree aggregates in the piece tree must agree with the segments they summarize
+        if (!model_ptr->model_segments.validate()) {
+            print_model_segments_(model_ptr.get(), CLOG);
+            return -1;
+        }
+
         int64_t expected_offset = 0;
-        for (const auto &segment : model_ptr->model_segments) {
-            // Each segment must reference a valid change
-            if (!segment || !segment->change_ptr) { return -1; }
-
-            // Segment offsets must be non-negative
-            if (segment->computed_offset < 0 || segment->computed_length < 0 || segment->change_offset < 0) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
-            }
+        try {
+            const auto end = model_ptr->model_segments.end();
+            for (auto iter = model_ptr->model_segments.begin(); iter != end; ++iter) {
+                const auto &segment = *iter;
+                const auto *change_ptr = iter.change();
 
-            // Segments must have positive length (zero-length segments are not valid in the model)
-            if (segment->computed_length == 0) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
-            }
+                // Each segment must reference a valid change
+                if (!change_ptr) { return -1; }
 
-            // Segments must be contiguous (no gaps or overlaps)
-            if (expected_offset != segment->computed_offset) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
-            }
+                // Segment offsets must be non-negative
+                if (segment.computed_length < 0 || segment.change_offset < 0) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
 
-            // Segment must not extend beyond its parent change data
-            int64_t change_end = 0;
-            if (!safe_add_int64_(segment->change_offset, segment->computed_length, change_end) ||
-                change_end > segment->change_ptr->length) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
-            }
+                // Segments must have positive length (zero-length segments are not valid in the model)
+                if (segment.computed_length == 0) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
 
-            // change_offset must not exceed the change length
-            if (segment->change_offset >= segment->change_ptr->length) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
-            }
+                // Segments must be contiguous (no gaps or overlaps)
+                if (expected_offset != iter.computed_offset()) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
 
-            if (!safe_add_int64_(expected_offset, segment->computed_length, expected_offset)) {
-                print_model_segments_(model_ptr.get(), CLOG);
-                return -1;
+                // Segment must not extend beyond its parent change data
+                int64_t change_end = 0;
+                if (!safe_add_int64_(segment.change_offset, segment.computed_length, change_end) ||
+                    change_end > change_ptr->length) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
+
+                // change_offset must not exceed the change length
+                if (segment.change_offset >= change_ptr->length) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
+
+                if (!safe_add_int64_(expected_offset, segment.computed_length, expected_offset)) {
+                    print_model_segments_(model_ptr.get(), CLOG);
+                    return -1;
+                }
             }
-        }
+        } catch (const std::bad_alloc &) { return -1; }
+
+        // The segments must cover exactly the length recorded at the root of the piece tree
+        if (expected_offset != model_ptr->model_segments.computed_length()) { return -1; }
 
         // Checkpoint models (index > 0) must have a backing file
         if (model_index > 0 && !model_ptr->file_ptr) { return -1; }
@@ -84,11 +100,11 @@ int omega_check_model(const omega_session_t *session_ptr) {
     if (computed_file_size < 0) { return -1; }
     const auto &back_model = session_ptr->models_.back();
     int64_t model_total_length = 0;
-    if (!back_model->model_segments.empty() &&
-        !safe_add_int64_(back_model->model_segments.back()->computed_offset,
-                         back_model->model_segments.back()->computed_length, model_total_length)) {
-        return -1;
-    }
+    try {
+        for (const auto &segment : back_model->model_segments) {
+            if (!safe_add_int64_(model_total_length, segment.computed_length, model_total_length)) { return -1; }
+        }
+    } catch (const std::bad_alloc &) { return -1; }
     if (model_total_length != computed_file_size) { return -1; }
 
     return 0;
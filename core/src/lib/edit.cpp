@@ -18,6 +18,7 @@
 #include "../include/omega_edit/segment.h"
 #include "../include/omega_edit/session.h"
 #include "../include/omega_edit/viewport.h"
+#include "impl_/byte_transform_def.h"
 #include "impl_/change_def.hpp"
 #include "impl_/edit_private_helpers.hpp"
 #include "impl_/internal_fun.hpp"
@@ -35,6 +36,7 @@
 #include <limits>
 #include <memory>
 #include <new>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -46,6 +48,7 @@ using omega_edit::internal::change_kind_t;
 using omega_edit::internal::del_;
 using omega_edit::internal::ins_;
 using omega_edit::internal::is_builtin_transform_kind_;
+using omega_edit::internal::model_file_is_unchanged_;
 using omega_edit::internal::model_segment_kind_t;
 using omega_edit::internal::next_change_serial_;
 using omega_edit::internal::omega_change_copy_payload_bytes_;
@@ -53,11 +56,14 @@ using omega_edit::internal::omega_change_get_kind_;
 using omega_edit::internal::omega_change_get_payload_length_;
 using omega_edit::internal::omega_change_get_transaction_bit_;
 using omega_edit::internal::omega_change_write_payload_bytes_;
+using omega_edit::internal::omega_data_borrow_;
 using omega_edit::internal::omega_data_create_;
 using omega_edit::internal::omega_data_destroy_;
 using omega_edit::internal::omega_model_segment_get_kind_;
+using omega_edit::internal::omega_session_adopt_original_snapshot_;
 using omega_edit::internal::omega_session_get_transaction_bit_;
 using omega_edit::internal::ovr_;
+using omega_edit::internal::payload_block_cache_t;
 using omega_edit::internal::populate_data_segment_;
 using omega_edit::internal::print_model_segments_;
 using omega_edit::internal::restore_viewport_callbacks_;
@@ -72,6 +78,8 @@ using omega_edit::internal::valid_nonnegative_range_;
 #ifdef OMEGA_BUILD_WINDOWS
 
 #include <io.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 #include <windows.h>
 
 #define close _close
@@ -84,14 +92,26 @@ using omega_edit::internal::valid_nonnegative_range_;
 #else
 
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <atomic>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#ifndef FICLONERANGE
+#define FICLONERANGE _IOW(0x94, 13, struct file_clone_range)
+#endif
+#endif
+
 #endif
 
 namespace {
     constexpr int64_t OMEGA_IO_BUFFER_SIZE = 65536;
     constexpr int OMEGA_OUTPUT_PATH_SUFFIX_ATTEMPTS = 1000000;
     constexpr int64_t OMEGA_REPLACE_MATCH_SCRIPT_OPS_PER_MATCH = 1;
+    // Scripts are applied in one pass over the model when they make at least one change per this many model segments
+    constexpr size_t OMEGA_EDIT_SCRIPT_BATCH_SEGMENTS_PER_CHANGE = 32;
     constexpr int64_t OMEGA_REPLACE_MATCH_SCRIPT_MATCH_LIMIT =
             (std::min)(static_cast<int64_t>(OMEGA_REPLACE_MATCHES_LIMIT),
                        static_cast<int64_t>(OMEGA_MEMORY_BUFFER_LIMIT /
@@ -269,7 +289,8 @@ namespace {
                                            const std::string &checkpoint_directory,
                                            int64_t original_file_modification_time,
                                            bool original_file_modification_time_valid, omega_session_event_cbk_t cbk,
-                                           void *user_data_ptr, int32_t event_interest) -> omega_session_t * {
+                                           void *user_data_ptr, int32_t event_interest,
+                                           bool is_file_private = true) -> omega_session_t * {
         int64_t file_size = 0;
         if (file_ptr != nullptr) {
             if (0 != FSEEK(file_ptr, 0L, SEEK_END)) {
@@ -285,11 +306,14 @@ namespace {
             session_ptr->event_handler = cbk;
             session_ptr->user_data_ptr = user_data_ptr;
             session_ptr->event_interest_ = event_interest;
+            session_ptr->payload_block_cache_ = std::make_shared<payload_block_cache_t>(OMEGA_PAYLOAD_CACHE_LIMIT);
             session_ptr->original_file_modification_time_ = original_file_modification_time;
             session_ptr->original_file_modification_time_valid_ = original_file_modification_time_valid;
             session_ptr->models_.push_back(std::make_unique<omega_model_t>());
             if (file_ptr != nullptr) {
                 session_ptr->models_.back()->file_ptr = file_ptr;
+                // Only files private to the session are mapped, as another process could truncate any other file
+                if (is_file_private) { session_ptr->models_.back()->file_map.map(file_ptr); }
                 if (file_path != nullptr) { session_ptr->models_.back()->file_path.assign(file_path); }
                 if (checkpoint_file_name != nullptr) {
                     session_ptr->checkpoint_file_name_.assign(checkpoint_file_name);
@@ -406,7 +430,8 @@ namespace {
 
     auto initialize_model_segments_(omega_model_segments_t &model_segments, int64_t length) -> bool {
         try {
-            omega_model_segments_t replacement_segments;
+            // The replacement allocates from the same pool, so it can be moved into place
+            omega_model_segments_t replacement_segments(model_segments.pool());
             if (0 >= length) {
                 model_segments = std::move(replacement_segments);
                 return true;
@@ -416,12 +441,9 @@ namespace {
             change_ptr->kind = (uint8_t) (change_kind_t::CHANGE_INSERT);
             change_ptr->offset = 0;
             change_ptr->length = length;
-            auto read_segment_ptr = std::make_unique<omega_model_segment_t>();
-            read_segment_ptr->change_ptr = change_ptr;
-            read_segment_ptr->computed_offset = 0;
-            read_segment_ptr->change_offset = read_segment_ptr->change_ptr->offset;
-            read_segment_ptr->computed_length = read_segment_ptr->change_ptr->length;
-            replacement_segments.push_back(std::move(read_segment_ptr));
+            if (0 != replacement_segments.insert(0, change_ptr, change_ptr->offset, change_ptr->length)) {
+                return false;
+            }
             model_segments = std::move(replacement_segments);
             return true;
         } catch (const std::bad_alloc &) { return false; }
@@ -844,37 +866,22 @@ namespace {
         return 0;
     }
 
-    inline auto clone_model_segment_(const omega_model_segment_ptr_t &segment_ptr) -> omega_model_segment_ptr_t {
-        auto result = std::make_unique<omega_model_segment_t>();
-        result->computed_offset = segment_ptr->computed_offset;
-        result->computed_length = segment_ptr->computed_length;
-        result->change_offset = segment_ptr->change_offset;
-        result->change_ptr = segment_ptr->change_ptr;
-        result->payload_role = segment_ptr->payload_role;
-        return result;
-    }
-
-    inline auto clone_model_segments_(const omega_model_segments_t &segments) -> omega_model_segments_t {
-        omega_model_segments_t result;
-        result.reserve(segments.size());
-        for (const auto &seg : segments) { result.push_back(clone_model_segment_(seg)); }
-        return result;
-    }
-
     template<typename UpdateFn>
     auto update_model_transactionally_(omega_model_t *model_ptr, const UpdateFn &update_fn) -> int {
         if (!model_ptr) { return -1; }
 
+        // The candidate shares every segment node with the live model and edits copy only the nodes they touch, so
+        // rolling back is just discarding the candidate
         omega_model_t candidate_model{};
         try {
-            candidate_model.model_segments = clone_model_segments_(model_ptr->model_segments);
+            candidate_model.model_segments = model_ptr->model_segments.clone();
             const auto rc = update_fn(&candidate_model);
             if (rc != 0) { return rc; }
         } catch (const std::bad_alloc &) { return -1; } catch (...) {
             return -1;
         }
 
-        model_ptr->model_segments.swap(candidate_model.model_segments);
+        model_ptr->model_segments = std::move(candidate_model.model_segments);
         return 0;
     }
 
@@ -910,6 +917,7 @@ namespace {
     }
 
     void discard_model_(omega_model_ptr_t &model_ptr) {
+        model_ptr->file_map.unmap();
         if (model_ptr->file_ptr) {
             FCLOSE(model_ptr->file_ptr);
             model_ptr->file_ptr = nullptr;
@@ -932,99 +940,15 @@ namespace {
     auto update_model_helper_in_place_(omega_model_t *model_ptr, const const_omega_change_ptr_t &change_ptr) -> int {
         if (!change_ptr) { return -1; }
         assert(change_ptr->length > 0);
-        try {
-            model_ptr->model_segments.reserve(model_ptr->model_segments.size() + 2);
-        } catch (const std::bad_alloc &) { return -1; }
-        int64_t read_offset = 0;
-
-        if (model_ptr->model_segments.empty()) {
-            if (omega_change_get_kind_(change_ptr.get()) != change_kind_t::CHANGE_DELETE) {
-                auto insert_segment_ptr = std::make_unique<omega_model_segment_t>();
-                insert_segment_ptr->computed_offset = change_ptr->offset;
-                insert_segment_ptr->computed_length = change_ptr->length;
-                insert_segment_ptr->change_offset = 0;
-                insert_segment_ptr->change_ptr = change_ptr;
-                model_ptr->model_segments.push_back(std::move(insert_segment_ptr));
-            }
-            return 0;
-        }
-        for (auto iter = model_ptr->model_segments.begin(); iter != model_ptr->model_segments.end(); ++iter) {
-            int64_t segment_end = 0;
-            if (!safe_add_int64_((*iter)->computed_offset, (*iter)->computed_length, segment_end)) { return -1; }
-            if (read_offset != (*iter)->computed_offset) {
-                ABORT(print_model_segments_(model_ptr, CLOG);
-                      LOG_ERROR("break in model continuity, expected: " << read_offset
-                                                                        << ", got: " << (*iter)->computed_offset););
-            }
-            if (change_ptr->offset >= read_offset && change_ptr->offset <= segment_end) {
-                if (change_ptr->offset != read_offset) {
-                    const auto delta = change_ptr->offset - (*iter)->computed_offset;
-                    if (delta == (*iter)->computed_length) {
-                        ++iter;
-                    } else {
-                        auto split_segment_ptr = clone_model_segment_(*iter);
-                        if (!safe_add_int64_(split_segment_ptr->computed_offset, delta,
-                                             split_segment_ptr->computed_offset) ||
-                            !safe_add_int64_(split_segment_ptr->change_offset, delta,
-                                             split_segment_ptr->change_offset)) {
-                            return -1;
-                        }
-                        split_segment_ptr->computed_length -= delta;
-                        (*iter)->computed_length = delta;
-                        iter = model_ptr->model_segments.insert(iter + 1, std::move(split_segment_ptr));
-                    }
-                }
-                switch (omega_change_get_kind_(change_ptr.get())) {
-                    case change_kind_t::CHANGE_DELETE: {
-                        auto delete_length = change_ptr->length;
-                        while (delete_length && iter != model_ptr->model_segments.end()) {
-                            if ((*iter)->computed_length <= delete_length) {
-                                delete_length -= (*iter)->computed_length;
-                                iter = model_ptr->model_segments.erase(iter);
-                            } else {
-                                (*iter)->computed_length -= delete_length;
-                                if (!safe_add_int64_((*iter)->computed_offset, delete_length - change_ptr->length,
-                                                     (*iter)->computed_offset) ||
-                                    !safe_add_int64_((*iter)->change_offset, delete_length, (*iter)->change_offset)) {
-                                    return -1;
-                                }
-                                assert((*iter)->change_offset < (*iter)->change_ptr->length);
-                                delete_length = 0;
-                                ++iter;// move to the next segment for adjusting
-                            }
-                        }
-                        for (; iter != model_ptr->model_segments.end(); ++iter) {
-                            if (!safe_add_int64_((*iter)->computed_offset, -change_ptr->length,
-                                                 (*iter)->computed_offset)) {
-                                return -1;
-                            }
-                        }
-                        break;
-                    }
-                    case change_kind_t::CHANGE_OVERWRITE:// deliberate fall-through
-                    case change_kind_t::CHANGE_INSERT: {
-                        auto insert_segment_ptr = std::make_unique<omega_model_segment_t>();
-                        insert_segment_ptr->computed_offset = change_ptr->offset;
-                        insert_segment_ptr->computed_length = change_ptr->length;
-                        insert_segment_ptr->change_offset = 0;
-                        insert_segment_ptr->change_ptr = change_ptr;
-                        iter = model_ptr->model_segments.insert(iter, std::move(insert_segment_ptr));
-                        for (++iter; iter != model_ptr->model_segments.end(); ++iter) {
-                            if (!safe_add_int64_((*iter)->computed_offset, change_ptr->length,
-                                                 (*iter)->computed_offset)) {
-                                return -1;
-                            }
-                        }
-                        break;
-                    }
-                    default:
-                        ABORT(LOG_ERROR("Unhandled change kind"););
-                }
-                return 0;
-            }
-            if (!safe_add_int64_(read_offset, (*iter)->computed_length, read_offset)) { return -1; }
+        switch (omega_change_get_kind_(change_ptr.get())) {
+            case change_kind_t::CHANGE_DELETE:
+                return model_ptr->model_segments.erase(change_ptr->offset, change_ptr->length);
+            case change_kind_t::CHANGE_OVERWRITE:// deliberate fall-through
+            case change_kind_t::CHANGE_INSERT:
+                return model_ptr->model_segments.insert(change_ptr->offset, change_ptr, 0, change_ptr->length);
+            default:
+                ABORT(print_model_segments_(model_ptr, CLOG); LOG_ERROR("Unhandled change kind"););
         }
-        return -1;
     }
 
     auto update_model_helper_(omega_model_t *model_ptr, const const_omega_change_ptr_t &change_ptr) -> int {
@@ -1039,64 +963,8 @@ namespace {
         if (!model_ptr || !change_ptr || !valid_nonnegative_range_(offset, length)) { return -1; }
         if (length == 0) { return 0; }
         try {
-            model_ptr->model_segments.reserve(model_ptr->model_segments.size() + 2);
-        } catch (const std::bad_alloc &) { return -1; }
-
-        auto make_insert_segment = [&]() {
-            auto insert_segment_ptr = std::make_unique<omega_model_segment_t>();
-            insert_segment_ptr->computed_offset = offset;
-            insert_segment_ptr->computed_length = length;
-            insert_segment_ptr->change_offset = 0;
-            insert_segment_ptr->change_ptr = change_ptr;
-            insert_segment_ptr->payload_role = payload_role;
-            return insert_segment_ptr;
-        };
-
-        if (model_ptr->model_segments.empty()) {
-            if (offset != 0) { return -1; }
-            try {
-                model_ptr->model_segments.push_back(make_insert_segment());
-            } catch (const std::bad_alloc &) { return -1; }
-            return 0;
-        }
-
-        int64_t read_offset = 0;
-        for (auto iter = model_ptr->model_segments.begin(); iter != model_ptr->model_segments.end(); ++iter) {
-            int64_t segment_end = 0;
-            if (!safe_add_int64_((*iter)->computed_offset, (*iter)->computed_length, segment_end)) { return -1; }
-            if (read_offset != (*iter)->computed_offset) {
-                ABORT(print_model_segments_(model_ptr, CLOG);
-                      LOG_ERROR("break in model continuity, expected: " << read_offset
-                                                                        << ", got: " << (*iter)->computed_offset););
-            }
-            if (offset >= read_offset && offset <= segment_end) {
-                if (offset != read_offset) {
-                    const auto delta = offset - (*iter)->computed_offset;
-                    if (delta == (*iter)->computed_length) {
-                        ++iter;
-                    } else {
-                        auto split_segment_ptr = clone_model_segment_(*iter);
-                        if (!safe_add_int64_(split_segment_ptr->computed_offset, delta,
-                                             split_segment_ptr->computed_offset) ||
-                            !safe_add_int64_(split_segment_ptr->change_offset, delta,
-                                             split_segment_ptr->change_offset)) {
-                            return -1;
-                        }
-                        split_segment_ptr->computed_length -= delta;
-                        (*iter)->computed_length = delta;
-                        iter = model_ptr->model_segments.insert(iter + 1, std::move(split_segment_ptr));
-                    }
-                }
-
-                iter = model_ptr->model_segments.insert(iter, make_insert_segment());
-                for (++iter; iter != model_ptr->model_segments.end(); ++iter) {
-                    if (!safe_add_int64_((*iter)->computed_offset, length, (*iter)->computed_offset)) { return -1; }
-                }
-                return 0;
-            }
-            if (!safe_add_int64_(read_offset, (*iter)->computed_length, read_offset)) { return -1; }
-        }
-        return -1;
+            return model_ptr->model_segments.insert(offset, change_ptr, 0, length, payload_role);
+        } catch (const std::bad_alloc &) { return -1; } catch (const std::overflow_error &) { return -1; }
     }
 
     auto undo_change_in_model_(omega_model_t *model_ptr, const const_omega_change_ptr_t &change_ptr) -> int {
@@ -1171,7 +1039,7 @@ namespace {
             if (snap_it != snapshots.begin()) {
                 --snap_it;
                 try {
-                    model_ptr->model_segments = clone_model_segments_(snap_it->second);
+                    model_ptr->model_segments = snap_it->second.clone();
                 } catch (const std::bad_alloc &) { return -1; }
                 replay_from = snap_it->first;
             } else {
@@ -1214,6 +1082,7 @@ namespace {
 
     auto update_(omega_session_t *session_ptr, const const_omega_change_ptr_t &change_ptr) -> int64_t {
         if (!change_ptr) { return -1; }
+        omega_session_adopt_original_snapshot_(session_ptr, false);
         if (change_ptr->offset <= omega_session_get_computed_file_size(session_ptr)) {
             const auto change_serial = omega_change_get_serial(change_ptr.get());
             if (change_serial == 0 || change_serial == (std::numeric_limits<int64_t>::min)()) { return -1; }
@@ -1244,7 +1113,7 @@ namespace {
                 const auto count = static_cast<int64_t>(model_ptr->changes.size());
                 if (count % session_ptr->undo_snapshot_interval_ == 0) {
                     try {
-                        model_ptr->model_snapshots[count] = clone_model_segments_(model_ptr->model_segments);
+                        model_ptr->model_snapshots[count] = model_ptr->model_segments.clone();
                     } catch (const std::bad_alloc &) {
                         model_ptr->model_snapshots.erase(count);
                         LOG_ERROR("warning: unable to capture undo snapshot at change "
@@ -1481,6 +1350,7 @@ namespace {
         }
 
         checkpoint_model_ptr->file_ptr = checkpoint_file_ptr;
+        checkpoint_model_ptr->file_map.map(checkpoint_file_ptr);
         try {
             session_ptr->models_.push_back(std::move(checkpoint_model_ptr));
         } catch (const std::bad_alloc &) {
@@ -1515,22 +1385,12 @@ namespace {
         if (!session_ptr || offset < 0) { return false; }
         const auto &segments = session_ptr->models_.back()->model_segments;
         cursor.session_ptr = session_ptr;
-        cursor.segment_end = segments.cend();
+        cursor.segment_end = segments.end();
         cursor.offset = offset;
-        cursor.segment_iter = std::upper_bound(segments.cbegin(), segments.cend(), offset,
-                                               [](int64_t logical_offset, const omega_model_segment_ptr_t &segment) {
-                                                   return logical_offset < segment->computed_offset;
-                                               });
-        if (cursor.segment_iter != segments.cbegin()) { --cursor.segment_iter; }
-        while (cursor.segment_iter != cursor.segment_end) {
-            int64_t segment_end = 0;
-            if (!safe_add_int64_((*cursor.segment_iter)->computed_offset, (*cursor.segment_iter)->computed_length,
-                                 segment_end)) {
-                return false;
-            }
-            if (segment_end > offset) { break; }
-            ++cursor.segment_iter;
-        }
+        try {
+            // An offset at or beyond the end of the model leaves the cursor at the end
+            cursor.segment_iter = segments.find(offset);
+        } catch (const std::bad_alloc &) { return false; }
         return true;
     }
 
@@ -1540,23 +1400,19 @@ namespace {
         int64_t processed = 0;
         while (cursor.offset < end_offset) {
             if (cursor.segment_iter == cursor.segment_end) { return -1; }
-            const auto &segment = *cursor.segment_iter;
-            int64_t segment_end = 0;
-            if (!safe_add_int64_(segment->computed_offset, segment->computed_length, segment_end)) { return -1; }
-            if (segment_end <= cursor.offset) {
-                ++cursor.segment_iter;
-                continue;
-            }
-            if (segment->computed_offset > cursor.offset) {
-                ABORT(LOG_ERROR("break in model continuity, expected at most: " << cursor.offset << ", got: "
-                                                                                << segment->computed_offset););
+            const auto *segment = &*cursor.segment_iter;
+            const auto *segment_change_ptr = cursor.segment_iter.change();
+            const auto segment_offset = cursor.segment_iter.computed_offset();
+            if (segment_offset > cursor.offset) {
+                ABORT(LOG_ERROR("break in model continuity, expected at most: " << cursor.offset
+                                                                                << ", got: " << segment_offset););
                 return -1;
             }
 
-            const auto segment_start = std::max(cursor.offset - segment->computed_offset, int64_t(0));
+            const auto segment_start = cursor.offset - segment_offset;
             const auto segment_length = std::min(end_offset - cursor.offset, segment->computed_length - segment_start);
             if (to_file_ptr != nullptr) {
-                switch (omega_model_segment_get_kind_(segment.get())) {
+                switch (omega_model_segment_get_kind_(segment_change_ptr)) {
                     case model_segment_kind_t::SEGMENT_READ: {
                         if (cursor.session_ptr->models_.back()->file_ptr == nullptr) {
                             ABORT(LOG_ERROR("attempt to read segment from null file pointer"););
@@ -1565,7 +1421,8 @@ namespace {
                         int64_t source_offset = 0;
                         if (!safe_add_int64_(segment->change_offset, segment_start, source_offset)) { return -1; }
                         if (write_file_segment_(cursor.session_ptr->models_.back()->file_ptr, source_offset,
-                                                segment_length, to_file_ptr, io_buf) != segment_length) {
+                                                segment_length, to_file_ptr, io_buf) != segment_length ||
+                            !model_file_is_unchanged_(cursor.session_ptr->models_.back().get())) {
                             LOG_ERROR("write_file_segment_ failed");
                             return -1;
                         }
@@ -1574,7 +1431,7 @@ namespace {
                     case model_segment_kind_t::SEGMENT_INSERT: {
                         int64_t source_offset = 0;
                         if (!safe_add_int64_(segment->change_offset, segment_start, source_offset)) { return -1; }
-                        if (omega_change_write_payload_bytes_(segment->change_ptr.get(), segment->payload_role,
+                        if (omega_change_write_payload_bytes_(segment_change_ptr, segment->payload_role,
                                                               source_offset, segment_length, to_file_ptr, io_buf,
                                                               OMEGA_IO_BUFFER_SIZE) != segment_length) {
                             LOG_ERROR("fwrite failed");
@@ -1594,7 +1451,11 @@ namespace {
             }
             int64_t segment_consumed = 0;
             if (!safe_add_int64_(segment_start, segment_length, segment_consumed)) { return -1; }
-            if (segment_consumed >= segment->computed_length) { ++cursor.segment_iter; }
+            if (segment_consumed >= segment->computed_length) {
+                try {
+                    ++cursor.segment_iter;
+                } catch (const std::bad_alloc &) { return -1; }
+            }
         }
         return processed;
     }
@@ -1662,6 +1523,217 @@ namespace {
         return true;
     }
 
+    // Edit of a script applied in one pass, with its deleted range in the coordinates of the model before the script
+    struct script_edit_t {
+        int64_t offset{};       ///< Offset of the edit when its op is applied
+        int64_t source_offset{};///< Offset of the edit in the model before the script
+        int64_t delete_length{};
+        const omega_byte_t *bytes{};
+        int64_t insert_length{};
+        const_omega_change_ptr_t data_change_ptr{};///< Insert or overwrite change holding the inserted bytes
+    };
+
+    // Gets the bytes a script op deletes and inserts, or returns false if the op isn't a plain edit that can be applied
+    // in one pass (edits past the end of the model, invalid ops, and no-ops are left to be applied one at a time)
+    auto script_op_edit_(const omega_edit_script_op_t &op, script_edit_t &edit) -> bool {
+        if (op.offset < 0) { return false; }
+        edit.offset = op.offset;
+        switch (op.kind) {
+            case OMEGA_EDIT_SCRIPT_DELETE:
+                edit.delete_length = op.length;
+                edit.bytes = nullptr;
+                edit.insert_length = 0;
+                return op.length > 0;
+            case OMEGA_EDIT_SCRIPT_INSERT:
+                edit.delete_length = 0;
+                edit.bytes = op.bytes;
+                edit.insert_length = op.bytes_length;
+                return op.bytes && op.bytes_length > 0;
+            case OMEGA_EDIT_SCRIPT_OVERWRITE:
+                edit.delete_length = op.bytes_length;
+                edit.bytes = op.bytes;
+                edit.insert_length = op.bytes_length;
+                return op.bytes && op.bytes_length > 0 && (op.length == 0 || op.length == op.bytes_length);
+            case OMEGA_EDIT_SCRIPT_REPLACE:
+                edit.delete_length = op.length;
+                edit.bytes = op.bytes;
+                edit.insert_length = op.bytes_length;
+                return op.length >= 0 && op.bytes_length >= 0 && (op.length > 0 || op.bytes_length > 0) &&
+                       (op.bytes || op.bytes_length == 0);
+            default:
+                return false;
+        }
+    }
+
+    // Maps the ops of a script to edits of the model before the script, which only works when the ops move through the
+    // model in one direction without touching bytes an earlier op inserted. The edits are returned in document order.
+    auto plan_script_edits_(const omega_edit_script_op_t *ops, size_t op_count, int64_t model_length, bool is_reverse,
+                            std::vector<script_edit_t> &edits) -> bool {
+        edits.clear();
+        int64_t bound = is_reverse ? model_length : 0;// Reverse ops end before it, forward ops start at or after it
+        int64_t shift = 0;                            // Bytes inserted less bytes deleted by the ops so far
+        int64_t length = model_length;
+        for (size_t i = 0; i < op_count; ++i) {
+            script_edit_t edit;
+            if (!script_op_edit_(ops[i], edit)) { return false; }
+            int64_t edit_end = 0;
+            if (is_reverse) {
+                if (!safe_add_int64_(edit.offset, edit.delete_length, edit_end) || edit_end > bound) { return false; }
+                edit.source_offset = edit.offset;
+                bound = edit.offset;
+            } else {
+                if (edit.offset < bound) { return false; }
+                edit.source_offset = edit.offset - shift;
+                if (!safe_add_int64_(edit.source_offset, edit.delete_length, edit_end) || edit_end > model_length ||
+                    !safe_add_int64_(edit.offset, edit.insert_length, bound) ||
+                    !safe_add_int64_(shift, edit.insert_length - edit.delete_length, shift)) {
+                    return false;
+                }
+            }
+            if (!safe_add_int64_(length, edit.insert_length - edit.delete_length, length)) { return false; }
+            edits.push_back(edit);
+        }
+        if (is_reverse) { std::reverse(edits.begin(), edits.end()); }
+        return true;
+    }
+
+    // Builds the segments of the model with the edits applied, copying the unedited ranges of the current segments
+    void rebuild_model_segments_(const omega_model_segments_t &model_segments, const std::vector<script_edit_t> &edits,
+                                 omega_model_segments_t &rebuilt_segments) {
+        omega_model_segments_t::builder_t builder(rebuilt_segments);
+        auto iter = model_segments.begin();
+        int64_t offset = 0;
+        const auto copy_to = [&](int64_t end_offset) {
+            while (offset < end_offset) {
+                while (iter.computed_offset() + iter->computed_length <= offset) { ++iter; }
+                auto segment = *iter;
+                const auto skipped = offset - iter.computed_offset();
+                segment.change_offset += skipped;
+                segment.computed_length = (std::min)(segment.computed_length - skipped, end_offset - offset);
+                builder.append(segment);
+                offset += segment.computed_length;
+            }
+        };
+        for (const auto &edit : edits) {
+            copy_to(edit.source_offset);
+            offset += edit.delete_length;
+            if (edit.data_change_ptr) { builder.append(edit.data_change_ptr, 0, edit.insert_length); }
+        }
+        copy_to(model_segments.computed_length());
+        builder.finish();
+    }
+
+    // Applies a script in one pass over the model instead of one edit at a time. The changes recorded are the same as
+    // applying the ops in order would record, and nothing is changed unless the whole script is applied. Returns 1 if
+    // the script was applied, 0 if it has to be applied one op at a time, or -1 on failure.
+    auto apply_script_in_one_pass_(omega_session_t *session_ptr, const omega_edit_script_op_t *ops,
+                                   size_t op_count) -> int {
+        if (op_count < 2 || omega_session_changes_paused(session_ptr) != 0) { return 0; }
+        auto *const model_ptr = session_ptr->models_.back().get();
+        const auto model_length = omega_session_get_computed_file_size(session_ptr);
+        if (model_length < 0) { return 0; }
+        try {
+            std::vector<script_edit_t> edits;
+            edits.reserve(op_count);
+            auto is_reverse = false;
+            if (!plan_script_edits_(ops, op_count, model_length, is_reverse, edits)) {
+                is_reverse = true;
+                if (!plan_script_edits_(ops, op_count, model_length, is_reverse, edits)) { return 0; }
+            }
+            size_t change_count = 0;
+            for (const auto &edit : edits) {
+                change_count += (edit.delete_length > 0 && edit.insert_length > 0 &&
+                                 edit.delete_length != edit.insert_length)
+                                        ? 2
+                                        : 1;
+            }
+            // A pass visits every segment, so short scripts on fragmented models are cheaper applied op by op
+            if (model_ptr->model_segments.size() / OMEGA_EDIT_SCRIPT_BATCH_SEGMENTS_PER_CHANGE > change_count) {
+                return 0;
+            }
+            auto serial = next_change_serial_(session_ptr);
+            if (serial <= 0) { return 0; }
+
+            // Create the changes in op order, so they get the serials and offsets applying the ops in turn would give
+            // them, but capture the bytes they remove from the model as it is before the script
+            std::vector<const_omega_change_ptr_t> changes;
+            changes.reserve(change_count);
+            std::vector<size_t> op_order(edits.size());
+            for (size_t i = 0; i < edits.size(); ++i) { op_order[i] = i; }
+            if (is_reverse) { std::reverse(op_order.begin(), op_order.end()); }
+            const auto transaction_bit = determine_change_transaction_bit_(session_ptr);
+            for (const auto index : op_order) {
+                auto &edit = edits[index];
+                captured_change_payload_t deleted_payload;
+                if (!capture_session_range_payload_(session_ptr, edit.source_offset, edit.delete_length,
+                                                    deleted_payload)) {
+                    return -1;
+                }
+                const auto is_file_backed = deleted_payload.storage == OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED;
+                if (edit.delete_length == edit.insert_length) {
+                    edit.data_change_ptr =
+                            is_file_backed ? ovr_(serial++, edit.offset, edit.bytes, edit.insert_length,
+                                                  deleted_payload.release_file_path(), edit.delete_length,
+                                                  transaction_bit, session_ptr->payload_block_cache_)
+                                           : ovr_(serial++, edit.offset, edit.bytes, edit.insert_length,
+                                                  deleted_payload.bytes, deleted_payload.length, transaction_bit);
+                    if (!edit.data_change_ptr) { return -1; }
+                    changes.push_back(edit.data_change_ptr);
+                    continue;
+                }
+                if (edit.delete_length > 0) {
+                    auto change_ptr = is_file_backed
+                                              ? del_(serial++, edit.offset, edit.delete_length,
+                                                     deleted_payload.release_file_path(), edit.delete_length,
+                                                     transaction_bit, session_ptr->payload_block_cache_)
+                                              : del_(serial++, edit.offset, edit.delete_length, deleted_payload.bytes,
+                                                     deleted_payload.length, transaction_bit);
+                    if (!change_ptr) { return -1; }
+                    changes.push_back(std::move(change_ptr));
+                }
+                if (edit.insert_length > 0) {
+                    edit.data_change_ptr = ins_(serial++, edit.offset, edit.bytes, edit.insert_length, transaction_bit);
+                    if (!edit.data_change_ptr) { return -1; }
+                    changes.push_back(edit.data_change_ptr);
+                }
+            }
+
+            omega_model_segments_t rebuilt_segments(model_ptr->model_segments.pool());
+            rebuild_model_segments_(model_ptr->model_segments, edits, rebuilt_segments);
+            model_ptr->changes.reserve(model_ptr->changes.size() + changes.size());
+
+            // Nothing below can fail, so the bookkeeping of each change matches what update_ does for it
+            omega_session_adopt_original_snapshot_(session_ptr, false);
+            if (!model_ptr->changes_undone.empty()) { free_session_changes_undone_(session_ptr); }
+            const auto count_before = static_cast<int64_t>(model_ptr->changes.size());
+            for (const auto &change_ptr : changes) {
+                assign_transaction_start_serial_(session_ptr, change_ptr);
+                model_ptr->changes.push_back(change_ptr);
+            }
+            model_ptr->model_segments = std::move(rebuilt_segments);
+            discard_checkpoint_future_(session_ptr);
+            const auto interval = session_ptr->undo_snapshot_interval_;
+            const auto count = static_cast<int64_t>(model_ptr->changes.size());
+            if (interval > 0 && count / interval != count_before / interval) {
+                // Only the model after the whole script exists, so it stands in for the snapshots the script passed
+                try {
+                    model_ptr->model_snapshots[count] = model_ptr->model_segments.clone();
+                } catch (const std::bad_alloc &) {
+                    model_ptr->model_snapshots.erase(count);
+                    LOG_ERROR("warning: unable to capture undo snapshot at change "
+                              << count << "; undo replay may be slower");
+                }
+            }
+            for (const auto &change_ptr : changes) {
+                update_viewports_(session_ptr, change_ptr.get());
+                omega_session_notify(session_ptr, SESSION_EVT_EDIT, change_ptr.get());
+            }
+            return 1;
+        } catch (const std::bad_alloc &) { return -1; } catch (const std::overflow_error &) {
+            return -1;
+        }
+    }
+
     auto write_bytes_to_file_(FILE *file_ptr, const omega_byte_t *bytes, int64_t length) -> int64_t {
         if (!file_ptr || length < 0 || (!bytes && length > 0)) { return -1; }
         if (length == 0) { return 0; }
@@ -1676,22 +1748,46 @@ namespace {
         return written == length ? written : -1;
     }
 
-    auto replace_bytes_checkpointed_(omega_session_t *session_ptr, int64_t offset, int64_t delete_length,
-                                     const omega_byte_t *bytes, int64_t insert_length,
-                                     const char *transform_id = nullptr,
-                                     const char *options_json = nullptr) -> int64_t {
-        if (!session_ptr || !valid_nonnegative_range_(offset, delete_length) || insert_length < 0) { return -1; }
-        if (!bytes && insert_length > 0) { return -1; }
+    /**
+     * One part of a range replaced through a checkpoint: the session bytes it deletes, and the bytes or file that
+     * replace them, unless the part leaves its session bytes unchanged.
+     */
+    struct replacement_part_t {
+        int64_t delete_length{};
+        const omega_byte_t *bytes{};
+        FILE *file_ptr{};
+        int64_t insert_length{};
+        bool is_unchanged{};
+    };
+
+    auto replace_parts_checkpointed_(omega_session_t *session_ptr, int64_t offset, const replacement_part_t *parts,
+                                     size_t part_count, const char *transform_id, const char *options_json)
+            -> int64_t {
+        if (!session_ptr || offset < 0 || (!parts && part_count > 0)) { return -1; }
         if (omega_session_changes_paused(session_ptr) != 0) { return -1; }
 
         const auto computed_file_size = omega_session_get_computed_file_size(session_ptr);
         if (computed_file_size < 0 || offset > computed_file_size) { return -1; }
-        const auto adjusted_delete_length = std::min(delete_length, computed_file_size - offset);
-        if (adjusted_delete_length == 0 && insert_length == 0) { return 0; }
+        int64_t delete_length = 0;
+        int64_t insert_length = 0;
+        auto is_unchanged = true;
+        for (size_t i = 0; i < part_count; ++i) {
+            const auto &part = parts[i];
+            if (part.delete_length < 0 || part.insert_length < 0) { return -1; }
+            if (!part.is_unchanged && !part.bytes && !part.file_ptr && part.insert_length > 0) { return -1; }
+            const auto part_insert_length = part.is_unchanged ? part.delete_length : part.insert_length;
+            if (!safe_add_int64_(delete_length, part.delete_length, delete_length) ||
+                !safe_add_int64_(insert_length, part_insert_length, insert_length)) {
+                return -1;
+            }
+            is_unchanged = is_unchanged && (part.is_unchanged || (part.delete_length == 0 && part.insert_length == 0));
+        }
+        if (delete_length > computed_file_size - offset) { return -1; }
+        if (is_unchanged) { return 0; }
 
         int64_t size_after_delete = 0;
         int64_t checkpoint_file_size = 0;
-        if (!safe_add_int64_(computed_file_size, -adjusted_delete_length, size_after_delete) ||
+        if (!safe_add_int64_(computed_file_size, -delete_length, size_after_delete) ||
             !safe_add_int64_(size_after_delete, insert_length, checkpoint_file_size)) {
             return -1;
         }
@@ -1706,25 +1802,32 @@ namespace {
                 create_checkpoint_file_for_write_(session_ptr, checkpoint_filename, sizeof(checkpoint_filename));
         if (checkpoint_fptr == nullptr) { return -1; }
 
+        // Unchanged parts are copied from the session as it is streamed, so they never need to be read separately
         session_stream_cursor_t cursor;
         auto rc = 0;
-        if (!initialize_session_stream_cursor_(session_ptr, 0, cursor)) {
+        if (!initialize_session_stream_cursor_(session_ptr, 0, cursor) ||
+            stream_session_range_(cursor, offset, checkpoint_fptr, io_buf.get()) != offset) {
             rc = -1;
-        } else if (stream_session_range_(cursor, offset, checkpoint_fptr, io_buf.get()) != offset) {
-            rc = -1;
-        } else if (write_bytes_to_file_(checkpoint_fptr, bytes, insert_length) != insert_length) {
-            rc = -1;
-        } else {
-            int64_t delete_end = 0;
-            if (!safe_add_int64_(offset, adjusted_delete_length, delete_end) ||
-                stream_session_range_(cursor, delete_end, nullptr, io_buf.get()) != adjusted_delete_length) {
-                rc = -1;
-            } else {
-                const auto remaining_suffix = computed_file_size - cursor.offset;
-                if (stream_session_range_(cursor, computed_file_size, checkpoint_fptr, io_buf.get()) !=
-                    remaining_suffix) {
+        }
+        for (size_t i = 0; rc == 0 && i < part_count; ++i) {
+            const auto &part = parts[i];
+            const auto part_end = cursor.offset + part.delete_length;
+            if (part.is_unchanged) {
+                if (stream_session_range_(cursor, part_end, checkpoint_fptr, io_buf.get()) != part.delete_length) {
                     rc = -1;
                 }
+            } else if ((part.file_ptr ? write_file_segment_(part.file_ptr, 0, part.insert_length, checkpoint_fptr,
+                                                            io_buf.get())
+                                      : write_bytes_to_file_(checkpoint_fptr, part.bytes, part.insert_length)) !=
+                               part.insert_length ||
+                       stream_session_range_(cursor, part_end, nullptr, io_buf.get()) != part.delete_length) {
+                rc = -1;
+            }
+        }
+        if (rc == 0) {
+            const auto remaining_suffix = computed_file_size - cursor.offset;
+            if (stream_session_range_(cursor, computed_file_size, checkpoint_fptr, io_buf.get()) != remaining_suffix) {
+                rc = -1;
             }
         }
 
@@ -1737,9 +1840,9 @@ namespace {
         const_omega_change_ptr_t transform_change_ptr;
         if (is_transform) {
             transform_change_ptr =
-                    transform_(next_change_serial_(session_ptr), offset, adjusted_delete_length, transform_id,
-                               options_json, insert_length, computed_file_size, checkpoint_file_size,
-                               checkpoint_filename, determine_change_transaction_bit_(session_ptr));
+                    transform_(next_change_serial_(session_ptr), offset, delete_length, transform_id, options_json,
+                               insert_length, computed_file_size, checkpoint_file_size, checkpoint_filename,
+                               determine_change_transaction_bit_(session_ptr));
             if (!transform_change_ptr) {
                 omega_util_remove_file(checkpoint_filename);
                 return -1;
@@ -1752,9 +1855,94 @@ namespace {
         return is_transform ? serial : 0;
     }
 
+    auto replace_bytes_checkpointed_(omega_session_t *session_ptr, int64_t offset, int64_t delete_length,
+                                     const omega_byte_t *bytes, int64_t insert_length,
+                                     const char *transform_id = nullptr, const char *options_json = nullptr,
+                                     FILE *insert_file_ptr = nullptr) -> int64_t {
+        if (!session_ptr || !valid_nonnegative_range_(offset, delete_length) || insert_length < 0) { return -1; }
+        if (!bytes && !insert_file_ptr && insert_length > 0) { return -1; }
+        const auto computed_file_size = omega_session_get_computed_file_size(session_ptr);
+        if (computed_file_size < 0 || offset > computed_file_size) { return -1; }
+        const replacement_part_t part{std::min(delete_length, computed_file_size - offset), bytes, insert_file_ptr,
+                                      insert_length, false};
+        return replace_parts_checkpointed_(session_ptr, offset, &part, 1, transform_id, options_json);
+    }
+
+#if defined(__linux__) && defined(HAVE_COPY_FILE_RANGE)
+    std::atomic<bool> copy_file_range_unsupported_{false};
+#endif
+
+    /**
+     * Copies a range of one file to the current position of another within the kernel, sharing the blocks (a reflink)
+     * where the filesystem supports it, so the bytes never pass through a userspace buffer
+     * @param from_file_ptr file to copy from
+     * @param offset offset in the file to copy from
+     * @param byte_count number of bytes to copy
+     * @param to_file_ptr file to copy to, at its current position, which is advanced past the bytes copied
+     * @return number of bytes copied, which is short (or zero) where the kernel can't copy the rest of the range, so
+     * the caller must copy the remaining bytes itself
+     */
+    int64_t offload_file_segment_(FILE *from_file_ptr, int64_t offset, int64_t byte_count, FILE *to_file_ptr) {
+#if defined(__linux__) && defined(HAVE_COPY_FILE_RANGE)
+        if (byte_count < OMEGA_COPY_OFFLOAD_MIN_LENGTH || OMEGA_COPY_OFFLOAD_MIN_LENGTH <= 0 ||
+            copy_file_range_unsupported_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        const auto from_fd = fileno(from_file_ptr);
+        const auto to_fd = fileno(to_file_ptr);
+        if (from_fd < 0 || to_fd < 0 || fflush(to_file_ptr) != 0) { return 0; }
+        const auto to_offset = FTELL(to_file_ptr);
+        if (to_offset < 0) { return 0; }
+        int64_t copied = 0;
+
+        // Share whole blocks when both ranges start on a block boundary
+        struct stat to_stat {};
+        if (0 == fstat(to_fd, &to_stat) && 0 < to_stat.st_blksize) {
+            const auto block_size = static_cast<int64_t>(to_stat.st_blksize);
+            const auto clone_length = byte_count - byte_count % block_size;
+            if (0 < clone_length && 0 == offset % block_size && 0 == to_offset % block_size) {
+                file_clone_range clone_range{};
+                clone_range.src_fd = from_fd;
+                clone_range.src_offset = static_cast<uint64_t>(offset);
+                clone_range.src_length = static_cast<uint64_t>(clone_length);
+                clone_range.dest_offset = static_cast<uint64_t>(to_offset);
+                if (0 == ioctl(to_fd, FICLONERANGE, &clone_range)) { copied = clone_length; }
+            }
+        }
+
+        // Copy the rest in the kernel, which may still share blocks or copy them server-side on network filesystems
+        while (copied < byte_count) {
+            auto from_offset = static_cast<off_t>(offset + copied);
+            auto copy_to_offset = static_cast<off_t>(to_offset + copied);
+            const auto count = copy_file_range(from_fd, &from_offset, to_fd, &copy_to_offset,
+                                               static_cast<size_t>(byte_count - copied), 0);
+            if (count < 0) {
+                if (errno == EINTR) { continue; }
+                if (errno == ENOSYS) { copy_file_range_unsupported_.store(true, std::memory_order_relaxed); }
+                break;
+            }
+            if (count == 0) { break; }
+            copied += count;
+        }
+        if (copied && 0 != FSEEK(to_file_ptr, to_offset + copied, SEEK_SET)) { return -1; }
+        return copied;
+#else
+        (void) from_file_ptr;
+        (void) offset;
+        (void) byte_count;
+        (void) to_file_ptr;
+        return 0;
+#endif
+    }
+
     int64_t write_file_segment_(FILE *from_file_ptr, int64_t offset, int64_t byte_count, FILE *to_file_ptr,
                                 omega_byte_t *io_buf) {
         if (!from_file_ptr || !to_file_ptr) { return -1; }
+        const auto offloaded = offload_file_segment_(from_file_ptr, offset, byte_count, to_file_ptr);
+        if (offloaded < 0) { return -1; }
+        if (offloaded == byte_count) { return byte_count; }
+        offset += offloaded;
+        byte_count -= offloaded;
         if (0 != FSEEK(from_file_ptr, offset, SEEK_SET)) { return -1; }
         int64_t remaining = byte_count;
         while (remaining) {
@@ -1765,12 +1953,12 @@ namespace {
             }
             remaining -= count;
         }
-        return byte_count - remaining;
+        return offloaded + byte_count - remaining;
     }
 
     int64_t write_segment_to_file_transformed_(FILE *from_file_ptr, int64_t offset, int64_t byte_count,
                                                FILE *to_file_ptr, int64_t file_write_pos,
-                                               omega_util_byte_transform_t transform, void *user_data_ptr,
+                                               omega_util_buffer_transform_t transform, const void *context_ptr,
                                                int64_t transform_file_begin, int64_t transform_file_end,
                                                omega_byte_t *io_buf) {
         if (!from_file_ptr || !to_file_ptr) { return -1; }
@@ -1786,7 +1974,7 @@ namespace {
                 if (buf_begin < transform_file_end && buf_end > transform_file_begin) {
                     const auto t_start = std::max(transform_file_begin - buf_begin, int64_t(0));
                     const auto t_end = std::min(transform_file_end - buf_begin, count);
-                    omega_util_apply_byte_transform(io_buf + t_start, t_end - t_start, transform, user_data_ptr);
+                    transform(io_buf + t_start, t_end - t_start, context_ptr);
                 }
             }
             if (count != static_cast<int64_t>(fwrite(io_buf, sizeof(omega_byte_t), count, to_file_ptr))) { break; }
@@ -1796,8 +1984,9 @@ namespace {
         return byte_count - remaining;
     }
 
-    int save_segment_transformed_(omega_session_t *session_ptr, FILE *temp_fptr, omega_util_byte_transform_t transform,
-                                  void *user_data_ptr, int64_t transform_offset, int64_t transform_length) {
+    int save_segment_transformed_(omega_session_t *session_ptr, FILE *temp_fptr,
+                                  omega_util_buffer_transform_t transform, const void *context_ptr,
+                                  int64_t transform_offset, int64_t transform_length) {
         if (!session_ptr || !temp_fptr || !transform) { return -1; }
         if (transform_offset < 0) { return -1; }
         const auto computed_file_size = omega_session_get_computed_file_size(session_ptr);
@@ -1816,66 +2005,72 @@ namespace {
 
         int64_t write_offset = 0;
         int64_t file_write_pos = 0;
-        for (const auto &segment : session_ptr->models_.back()->model_segments) {
-            if (write_offset != segment->computed_offset) {
-                ABORT(LOG_ERROR("break in model continuity, expected: " << write_offset
-                                                                        << ", got: " << segment->computed_offset););
-            }
-            switch (omega_model_segment_get_kind_(segment.get())) {
-                case model_segment_kind_t::SEGMENT_READ: {
-                    if (session_ptr->models_.back()->file_ptr == nullptr) {
-                        ABORT(LOG_ERROR("attempt to read segment from null file pointer"););
-                    }
-                    if (write_segment_to_file_transformed_(
-                                session_ptr->models_.back()->file_ptr, segment->change_offset, segment->computed_length,
-                                temp_fptr, file_write_pos, transform, user_data_ptr, transform_file_begin,
-                                transform_file_end, io_buf.get()) != segment->computed_length) {
-                        LOG_ERROR("write_segment_to_file_transformed_ failed");
-                        return -1;
-                    }
-                    break;
+        try {
+            const auto &segments = session_ptr->models_.back()->model_segments;
+            for (auto iter = segments.begin(); iter != segments.end(); ++iter) {
+                const auto *segment = &*iter;
+                const auto *segment_change_ptr = iter.change();
+                if (write_offset != iter.computed_offset()) {
+                    ABORT(LOG_ERROR("break in model continuity, expected: " << write_offset
+                                                                            << ", got: " << iter.computed_offset()););
                 }
-                case model_segment_kind_t::SEGMENT_INSERT: {
-                    const auto len = segment->computed_length;
-                    int64_t segment_file_end = 0;
-                    if (!safe_add_int64_(file_write_pos, len, segment_file_end)) { return -1; }
-                    int64_t seg_remaining = len;
-                    int64_t seg_offset = 0;
-                    while (seg_remaining > 0) {
-                        const auto chunk = std::min(seg_remaining, OMEGA_IO_BUFFER_SIZE);
-                        int64_t payload_offset = 0;
-                        if (!safe_add_int64_(segment->change_offset, seg_offset, payload_offset) ||
-                            omega_change_copy_payload_bytes_(segment->change_ptr.get(), segment->payload_role,
-                                                             payload_offset, io_buf.get(), chunk) != 0) {
-                            return -1;
-                        }
-                        int64_t buf_begin = 0;
-                        if (!safe_add_int64_(file_write_pos, seg_offset, buf_begin)) { return -1; }
-                        int64_t buf_end = 0;
-                        if (!safe_add_int64_(buf_begin, chunk, buf_end)) { return -1; }
-                        if (buf_begin < transform_file_end && buf_end > transform_file_begin) {
-                            const auto t_start = std::max(transform_file_begin - buf_begin, int64_t(0));
-                            const auto t_end = std::min(transform_file_end - buf_begin, chunk);
-                            omega_util_apply_byte_transform(io_buf.get() + t_start, t_end - t_start, transform,
-                                                            user_data_ptr);
+                switch (omega_model_segment_get_kind_(segment_change_ptr)) {
+                    case model_segment_kind_t::SEGMENT_READ: {
+                        if (session_ptr->models_.back()->file_ptr == nullptr) {
+                            ABORT(LOG_ERROR("attempt to read segment from null file pointer"););
                         }
-                        if (static_cast<int64_t>(fwrite(io_buf.get(), 1, chunk, temp_fptr)) != chunk) {
-                            LOG_ERROR("fwrite failed");
+                        if (write_segment_to_file_transformed_(session_ptr->models_.back()->file_ptr,
+                                                               segment->change_offset, segment->computed_length,
+                                                               temp_fptr, file_write_pos, transform, context_ptr,
+                                                               transform_file_begin, transform_file_end,
+                                                               io_buf.get()) != segment->computed_length ||
+                            !model_file_is_unchanged_(session_ptr->models_.back().get())) {
+                            LOG_ERROR("write_segment_to_file_transformed_ failed");
                             return -1;
                         }
-                        seg_remaining -= chunk;
-                        if (!safe_add_int64_(seg_offset, chunk, seg_offset)) { return -1; }
+                        break;
                     }
-                    break;
+                    case model_segment_kind_t::SEGMENT_INSERT: {
+                        const auto len = segment->computed_length;
+                        int64_t segment_file_end = 0;
+                        if (!safe_add_int64_(file_write_pos, len, segment_file_end)) { return -1; }
+                        int64_t seg_remaining = len;
+                        int64_t seg_offset = 0;
+                        while (seg_remaining > 0) {
+                            const auto chunk = std::min(seg_remaining, OMEGA_IO_BUFFER_SIZE);
+                            int64_t payload_offset = 0;
+                            if (!safe_add_int64_(segment->change_offset, seg_offset, payload_offset) ||
+                                omega_change_copy_payload_bytes_(segment_change_ptr, segment->payload_role,
+                                                                 payload_offset, io_buf.get(), chunk) != 0) {
+                                return -1;
+                            }
+                            int64_t buf_begin = 0;
+                            if (!safe_add_int64_(file_write_pos, seg_offset, buf_begin)) { return -1; }
+                            int64_t buf_end = 0;
+                            if (!safe_add_int64_(buf_begin, chunk, buf_end)) { return -1; }
+                            if (buf_begin < transform_file_end && buf_end > transform_file_begin) {
+                                const auto t_start = std::max(transform_file_begin - buf_begin, int64_t(0));
+                                const auto t_end = std::min(transform_file_end - buf_begin, chunk);
+                                transform(io_buf.get() + t_start, t_end - t_start, context_ptr);
+                            }
+                            if (static_cast<int64_t>(fwrite(io_buf.get(), 1, chunk, temp_fptr)) != chunk) {
+                                LOG_ERROR("fwrite failed");
+                                return -1;
+                            }
+                            seg_remaining -= chunk;
+                            if (!safe_add_int64_(seg_offset, chunk, seg_offset)) { return -1; }
+                        }
+                        break;
+                    }
+                    default:
+                        ABORT(LOG_ERROR("Unhandled segment kind"););
+                }
+                if (!safe_add_int64_(file_write_pos, segment->computed_length, file_write_pos) ||
+                    !safe_add_int64_(write_offset, segment->computed_length, write_offset)) {
+                    return -1;
                 }
-                default:
-                    ABORT(LOG_ERROR("Unhandled segment kind"););
-            }
-            if (!safe_add_int64_(file_write_pos, segment->computed_length, file_write_pos) ||
-                !safe_add_int64_(write_offset, segment->computed_length, write_offset)) {
-                return -1;
             }
-        }
+        } catch (const std::bad_alloc &) { return -1; }
         if (file_write_pos != computed_file_size) {
             LOG_ERROR("failed to write all bytes, expected: " << computed_file_size << ", got: " << file_write_pos);
             return -1;
@@ -1883,10 +2078,11 @@ namespace {
         return 0;
     }
 
-    int64_t apply_transform_checkpointed_(omega_session_t *session_ptr, omega_util_byte_transform_t byte_transform,
-                                          void *user_data_ptr, int64_t offset, int64_t length, const char *transform_id,
+    int64_t apply_transform_checkpointed_(omega_session_t *session_ptr,
+                                          omega_util_buffer_transform_t buffer_transform, const void *context_ptr,
+                                          int64_t offset, int64_t length, const char *transform_id,
                                           const char *options_json) {
-        if (!session_ptr || !byte_transform || offset < 0) { return -1; }
+        if (!session_ptr || !buffer_transform || offset < 0) { return -1; }
         if (omega_session_changes_paused(session_ptr) != 0) { return -1; }
 
         const auto file_size_before = omega_session_get_computed_file_size(session_ptr);
@@ -1900,8 +2096,8 @@ namespace {
                 create_checkpoint_file_for_write_(session_ptr, checkpoint_filename, sizeof(checkpoint_filename));
         if (!checkpoint_fptr) { return -1; }
 
-        const auto transform_write_ok = 0 == save_segment_transformed_(session_ptr, checkpoint_fptr, byte_transform,
-                                                                       user_data_ptr, offset, effective_length);
+        const auto transform_write_ok = 0 == save_segment_transformed_(session_ptr, checkpoint_fptr, buffer_transform,
+                                                                       context_ptr, offset, effective_length);
         const auto transform_flush_ok = transform_write_ok && flush_file_to_disk_(checkpoint_fptr);
         const auto transform_close_ok = FCLOSE(checkpoint_fptr) == 0;
         if (!transform_write_ok || !transform_flush_ok || !transform_close_ok) {
@@ -1949,6 +2145,7 @@ namespace {
 
         transform_model_ptr->changes.pop_back();
         change_ptr->transform_data->preserved_changes_undone.swap(transform_model_ptr->changes_undone);
+        transform_model_ptr->file_map.unmap();
         FCLOSE(transform_model_ptr->file_ptr);
         session_ptr->models_.pop_back();
         auto *const undone_change_ptr = change_ptr.get();
@@ -2009,6 +2206,352 @@ namespace {
         discard_model_(session_ptr->models_.back());
         session_ptr->models_.pop_back();
     }
+
+    using byte_ranges_t = std::vector<std::pair<int64_t, int64_t>>;
+
+    // An in-place save journal starts with this tag, the number of ranges, the length of the target file, and the
+    // device, inode, owner, and pre-save modification time of the target, followed by the offset, length, and original
+    // bytes of each range, and ends with a checksum of everything before it
+    constexpr char OMEGA_IN_PLACE_JOURNAL_TAG[8] = {'O', 'M', 'E', 'G', 'A', 'J', 'N', '2'};
+    constexpr auto OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS = 6;
+
+    auto in_place_journal_path_(const char *file_path, std::string &journal_path) -> bool {
+        try {
+            journal_path = file_path;
+            journal_path += ".OmegaEdit-journal";
+            return true;
+        } catch (const std::bad_alloc &) { return false; }
+    }
+
+    /**
+     * Gets the sorted and coalesced ranges where the session content may differ from its original file, which are the
+     * ranges that aren't read from the same offset of the original, along with any ranges earlier in-place saves wrote
+     * @param session_ptr session without checkpoints
+     * @param ranges set to the (offset, length) ranges
+     * @return true on success, false on allocation failure
+     */
+    auto in_place_dirty_ranges_(const omega_session_t *session_ptr, byte_ranges_t &ranges) -> bool {
+        try {
+            ranges = session_ptr->in_place_saved_ranges_;
+            const auto &segments = session_ptr->models_.back()->model_segments;
+            for (auto iter = segments.begin(); iter != segments.end(); ++iter) {
+                if (iter->computed_length == 0 ||
+                    (omega_model_segment_get_kind_(iter.change()) == model_segment_kind_t::SEGMENT_READ &&
+                     iter->change_offset == iter.computed_offset())) {
+                    continue;
+                }
+                ranges.emplace_back(iter.computed_offset(), iter->computed_length);
+            }
+            std::sort(ranges.begin(), ranges.end());
+            size_t merged_count = 0;
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                auto *merged = merged_count ? &ranges[merged_count - 1] : nullptr;
+                if (merged && ranges[i].first <= merged->first + merged->second) {
+                    merged->second = std::max(merged->second, ranges[i].first + ranges[i].second - merged->first);
+                } else {
+                    ranges[merged_count++] = ranges[i];
+                }
+            }
+            ranges.resize(merged_count);
+            return true;
+        } catch (const std::bad_alloc &) { return false; }
+    }
+
+    auto write_journal_header_(FILE *journal_fptr, int64_t first, int64_t second) -> bool {
+        const int64_t fields[] = {first, second};
+        return 2 == fwrite(fields, sizeof(int64_t), 2, journal_fptr);
+    }
+
+    auto read_journal_header_(FILE *journal_fptr, int64_t &first, int64_t &second) -> bool {
+        int64_t fields[2];
+        if (2 != fread(fields, sizeof(int64_t), 2, journal_fptr)) { return false; }
+        first = fields[0];
+        second = fields[1];
+        return true;
+    }
+
+    /**
+     * Identifies the file an in-place save journal belongs to, so the journal is never applied to a different file, or
+     * to the same file after it was rewritten by something other than the interrupted save
+     */
+    struct in_place_target_identity_t {
+        int64_t device{};
+        int64_t inode{};
+        int64_t owner{};
+        int64_t modification_time{};
+    };
+
+    auto get_in_place_target_identity_(const char *file_path, FILE *target_fptr, in_place_target_identity_t &identity)
+            -> bool {
+#ifdef OMEGA_BUILD_WINDOWS
+        struct _stat64 file_stat {};
+        if (0 != _fstat64(_fileno(target_fptr), &file_stat)) { return false; }
+#else
+        struct stat file_stat {};
+        if (0 != fstat(fileno(target_fptr), &file_stat)) { return false; }
+#endif
+        identity.device = static_cast<int64_t>(file_stat.st_dev);
+        identity.inode = static_cast<int64_t>(file_stat.st_ino);
+        identity.owner = static_cast<int64_t>(file_stat.st_uid);
+        return 0 == omega_util_get_modification_time(file_path, &identity.modification_time);
+    }
+
+    /**
+     * Opens an in-place save journal for reading, provided it's a regular file, not a link, owned by the current user
+     * @param journal_path journal path
+     * @return journal file, or nullptr if it can't be opened or isn't trusted
+     */
+    auto open_in_place_journal_(const char *journal_path) -> FILE * {
+#ifdef OMEGA_BUILD_WINDOWS
+        return FOPEN(journal_path, "rb");
+#else
+        struct stat path_stat {};
+        if (0 != lstat(journal_path, &path_stat) || !S_ISREG(path_stat.st_mode) || path_stat.st_uid != geteuid()) {
+            return nullptr;
+        }
+        auto *journal_fptr = FOPEN(journal_path, "rb");
+        struct stat file_stat {};
+        if (journal_fptr && (0 != fstat(fileno(journal_fptr), &file_stat) || file_stat.st_dev != path_stat.st_dev ||
+                             file_stat.st_ino != path_stat.st_ino)) {
+            FCLOSE(journal_fptr);
+            return nullptr;
+        }
+        return journal_fptr;
+#endif
+    }
+
+    /**
+     * Computes the FNV-1a checksum of the start of a journal
+     * @param journal_fptr journal, open for reading
+     * @param length number of bytes from the start of the journal to include
+     * @param io_buf buffer of OMEGA_IO_BUFFER_SIZE bytes
+     * @param checksum set to the checksum
+     * @return true on success, false on failure
+     */
+    auto in_place_journal_checksum_(FILE *journal_fptr, int64_t length, omega_byte_t *io_buf, uint64_t &checksum)
+            -> bool {
+        if (0 != FSEEK(journal_fptr, 0, SEEK_SET)) { return false; }
+        checksum = 0xcbf29ce484222325ULL;
+        while (length > 0) {
+            const auto count = static_cast<size_t>(std::min<int64_t>(length, OMEGA_IO_BUFFER_SIZE));
+            if (count != fread(io_buf, 1, count, journal_fptr)) { return false; }
+            for (size_t i = 0; i < count; ++i) {
+                checksum ^= io_buf[i];
+                checksum *= 0x100000001b3ULL;
+            }
+            length -= static_cast<int64_t>(count);
+        }
+        return true;
+    }
+
+    /**
+     * Writes the journal of an in-place save, holding the bytes of the target file that the save is about to replace.
+     * The journal is completed in a temporary file then renamed into place, so a journal never exists half-written.
+     * @param file_path target file path
+     * @param target_fptr target file, open for reading
+     * @param target_length length of the target file
+     * @param ranges ranges of the target to be replaced
+     * @param io_buf buffer of OMEGA_IO_BUFFER_SIZE bytes
+     * @return true on success, false on failure
+     */
+    auto write_in_place_journal_(const char *file_path, FILE *target_fptr, int64_t target_length,
+                                 const byte_ranges_t &ranges, omega_byte_t *io_buf) -> bool {
+        std::string journal_path;
+        in_place_target_identity_t identity{};
+        if (!in_place_journal_path_(file_path, journal_path) ||
+            !get_in_place_target_identity_(file_path, target_fptr, identity)) {
+            return false;
+        }
+        char temp_filename[FILENAME_MAX + 1];
+        char directory[FILENAME_MAX + 1];
+        omega_util_dirname(file_path, directory);
+        const auto count = directory[0] ? snprintf(temp_filename, FILENAME_MAX, "%s%c.OmegaEdit_XXXXXX", directory,
+                                                   omega_util_directory_separator())
+                                         : snprintf(temp_filename, FILENAME_MAX, ".OmegaEdit_XXXXXX");
+        if (count < 0 || FILENAME_MAX <= count) { return false; }
+        const auto journal_fd = omega_util_mkstemp(temp_filename, 0600);// S_IRUSR | S_IWUSR
+        if (journal_fd < 0) { return false; }
+        auto *journal_fptr = open_owned_fd_as_file_(journal_fd, "w+b");
+        if (!journal_fptr) {
+            omega_util_remove_file(temp_filename);
+            return false;
+        }
+        const int64_t header[OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS] = {static_cast<int64_t>(ranges.size()),
+                                                                      target_length,
+                                                                      identity.device,
+                                                                      identity.inode,
+                                                                      identity.owner,
+                                                                      identity.modification_time};
+        auto written = 1 == fwrite(OMEGA_IN_PLACE_JOURNAL_TAG, sizeof(OMEGA_IN_PLACE_JOURNAL_TAG), 1, journal_fptr) &&
+                       OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS ==
+                               fwrite(header, sizeof(int64_t), OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS, journal_fptr);
+        for (const auto &range : ranges) {
+            if (!written) { break; }
+            written = write_journal_header_(journal_fptr, range.first, range.second) &&
+                      write_file_segment_(target_fptr, range.first, range.second, journal_fptr, io_buf) ==
+                              range.second;
+        }
+        int64_t journal_length = 0;
+        uint64_t checksum = 0;
+        written = written && 0 == fflush(journal_fptr) && 0 == FSEEK(journal_fptr, 0, SEEK_END) &&
+                  0 <= (journal_length = FTELL(journal_fptr)) &&
+                  in_place_journal_checksum_(journal_fptr, journal_length, io_buf, checksum) &&
+                  0 == FSEEK(journal_fptr, journal_length, SEEK_SET) &&
+                  1 == fwrite(&checksum, sizeof(checksum), 1, journal_fptr);
+        written = written && flush_file_to_disk_(journal_fptr);
+        written = FCLOSE(journal_fptr) == 0 && written;
+        if (!written || !atomic_replace_file_(temp_filename, journal_path.c_str())) {
+            omega_util_remove_file(temp_filename);
+            return false;
+        }
+        return sync_parent_directory_(journal_path.c_str());
+    }
+
+    /**
+     * Rolls back an interrupted in-place save of the given file, restoring the bytes saved in its journal, then removes
+     * the journal.  The journal is refused unless it's owned by the current user, its checksum matches, and it was
+     * written for this same file, which hasn't been replaced or rewritten since the save began.
+     * @param file_path path of the file that may have been saved in place
+     * @return zero if there was no journal or the save was rolled back, non-zero otherwise
+     */
+    auto roll_back_in_place_save_(const char *file_path) -> int {
+        std::string journal_path;
+        if (!in_place_journal_path_(file_path, journal_path)) { return -1; }
+        if (!omega_util_file_exists(journal_path.c_str())) { return 0; }
+        auto *journal_fptr = open_in_place_journal_(journal_path.c_str());
+        if (!journal_fptr) {
+            LOG_ERROR("refusing to roll back from untrusted in-place save journal '" << journal_path << "'");
+            return -1;
+        }
+        auto *target_fptr = FOPEN(file_path, "r+b");
+        if (!target_fptr) {
+            FCLOSE(journal_fptr);
+            return -1;
+        }
+        std::unique_ptr<omega_byte_t[]> io_buf;
+        try {
+            io_buf = std::make_unique<omega_byte_t[]>(OMEGA_IO_BUFFER_SIZE);
+        } catch (const std::bad_alloc &) {}
+        char tag[sizeof(OMEGA_IN_PLACE_JOURNAL_TAG)];
+        int64_t header[OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS] = {};
+        int64_t journal_length = 0;
+        uint64_t checksum = 0;
+        uint64_t expected_checksum = 0;
+        in_place_target_identity_t identity{};
+        constexpr auto range_header_length = static_cast<int64_t>(2 * sizeof(int64_t));
+        constexpr auto header_length = static_cast<int64_t>(sizeof(tag) + sizeof(header));
+        auto valid = io_buf && 0 == FSEEK(journal_fptr, 0, SEEK_END) &&
+                     static_cast<int64_t>(sizeof(checksum)) <= (journal_length = FTELL(journal_fptr)) &&
+                     0 == FSEEK(journal_fptr, journal_length - static_cast<int64_t>(sizeof(checksum)), SEEK_SET) &&
+                     1 == fread(&expected_checksum, sizeof(expected_checksum), 1, journal_fptr);
+        journal_length -= static_cast<int64_t>(sizeof(checksum));
+        valid = valid && in_place_journal_checksum_(journal_fptr, journal_length, io_buf.get(), checksum) &&
+                checksum == expected_checksum && 0 == FSEEK(journal_fptr, 0, SEEK_SET) &&
+                1 == fread(tag, sizeof(tag), 1, journal_fptr) &&
+                0 == memcmp(tag, OMEGA_IN_PLACE_JOURNAL_TAG, sizeof(tag)) &&
+                OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS ==
+                        fread(header, sizeof(int64_t), OMEGA_IN_PLACE_JOURNAL_HEADER_FIELDS, journal_fptr);
+        const auto range_count = header[0];
+        const auto target_length = header[1];
+
+        // The target must be the same file, still the length it was, and not modified before the save began
+        valid = valid && 0 <= range_count && target_length == omega_util_file_size(file_path) &&
+                get_in_place_target_identity_(file_path, target_fptr, identity) && identity.device == header[2] &&
+                identity.inode == header[3] && identity.owner == header[4] && header[5] <= identity.modification_time;
+
+        // Check that the ranges lie within the target and account for the whole journal before restoring any of them
+        int64_t position = header_length;
+        for (int64_t i = 0; valid && i < range_count; ++i) {
+            int64_t offset = 0;
+            int64_t length = 0;
+            valid = read_journal_header_(journal_fptr, offset, length) && 0 <= offset && 0 <= length &&
+                    length <= target_length - offset &&
+                    safe_add_int64_(position, range_header_length + length, position) &&
+                    position <= journal_length && 0 == FSEEK(journal_fptr, position, SEEK_SET);
+        }
+        valid = valid && position == journal_length;
+        position = header_length;
+        for (int64_t i = 0; valid && i < range_count; ++i) {
+            int64_t offset = 0;
+            int64_t length = 0;
+            valid = 0 == FSEEK(journal_fptr, position, SEEK_SET) &&
+                    read_journal_header_(journal_fptr, offset, length) && 0 == FSEEK(target_fptr, offset, SEEK_SET) &&
+                    write_file_segment_(journal_fptr, position + range_header_length, length, target_fptr,
+                                        io_buf.get()) == length;
+            position += range_header_length + length;
+        }
+        valid = valid && flush_file_to_disk_(target_fptr);
+        valid = FCLOSE(target_fptr) == 0 && valid;
+        FCLOSE(journal_fptr);
+        if (!valid) {
+            LOG_ERROR("failed to roll back the in-place save of '" << file_path << "' from '" << journal_path << "'");
+            return -1;
+        }
+        if (0 != omega_util_remove_file(journal_path.c_str()) || !sync_parent_directory_(file_path)) { return -1; }
+        return 0;
+    }
+
+    /**
+     * Saves a session over its original file by writing only the ranges that differ, after journaling the bytes they
+     * replace so an interrupted save can be rolled back
+     * @param session_ptr session without checkpoints, whose original file still matches its snapshot
+     * @param file_path path of the original file
+     * @param io_buf buffer of OMEGA_IO_BUFFER_SIZE bytes
+     * @return zero on success and non-zero otherwise
+     */
+    auto save_in_place_(omega_session_t *session_ptr, const char *file_path, omega_byte_t *io_buf) -> int {
+        byte_ranges_t ranges;
+        std::string journal_path;
+        if (!in_place_dirty_ranges_(session_ptr, ranges) || !in_place_journal_path_(file_path, journal_path)) {
+            return -6;
+        }
+        if (ranges.empty()) { return 0; }
+        // A journal left by an interrupted save must be rolled back explicitly before it's replaced by a new one
+        if (omega_util_file_exists(journal_path.c_str())) {
+            LOG_ERROR("the in-place save journal '" << journal_path << "' from an interrupted save is pending");
+            return -5;
+        }
+        auto *target_fptr = FOPEN(file_path, "r+b");
+        if (!target_fptr) {
+            LOG_ERRNO();
+            return -4;
+        }
+        if (!write_in_place_journal_(file_path, target_fptr, omega_session_get_computed_file_size(session_ptr), ranges,
+                                     io_buf)) {
+            LOG_ERROR("failed to write the in-place save journal '" << journal_path << "'");
+            FCLOSE(target_fptr);
+            return -5;
+        }
+        auto written = true;
+        for (const auto &range : ranges) {
+            session_stream_cursor_t cursor{};
+            if (!initialize_session_stream_cursor_(session_ptr, range.first, cursor) ||
+                0 != FSEEK(target_fptr, range.first, SEEK_SET) ||
+                stream_session_range_(cursor, range.first + range.second, target_fptr, io_buf) != range.second) {
+                written = false;
+                break;
+            }
+        }
+        written = written && flush_file_to_disk_(target_fptr);
+        written = FCLOSE(target_fptr) == 0 && written;
+        if (!written) {
+            LOG_ERRNO();
+            roll_back_in_place_save_(file_path);
+            return -8;
+        }
+        // The save is committed once its journal is gone
+        if (0 != omega_util_remove_file(journal_path.c_str())) {
+            LOG_ERROR("failed to remove the in-place save journal '" << journal_path << "'");
+            roll_back_in_place_save_(file_path);
+            return -12;
+        }
+        session_ptr->in_place_saved_ranges_.swap(ranges);
+        if (!sync_parent_directory_(file_path)) {
+            LOG_ERRNO();
+            return OMEGA_EDIT_SAVE_DIRECTORY_SYNC_FAILED;
+        }
+        return 0;
+    }
 }// namespace
 
 int omega_edit_serial_result_is_success(int64_t result) { return result > 0 ? 1 : 0; }
@@ -2017,12 +2560,27 @@ int omega_edit_status_result_is_success(int result) { return result == 0 ? 1 : 0
 
 omega_session_t *omega_edit_create_session(const char *file_path, omega_session_event_cbk_t cbk, void *user_data_ptr,
                                            int32_t event_interest, const char *checkpoint_directory) {
+    omega_edit_session_options_t options{};
+    options.cbk = cbk;
+    options.user_data_ptr = user_data_ptr;
+    options.event_interest = event_interest;
+    options.checkpoint_directory = checkpoint_directory;
+    return omega_edit_create_session_with_options(file_path, &options);
+}
+
+omega_session_t *omega_edit_create_session_with_options(const char *file_path,
+                                                        const omega_edit_session_options_t *options) {
+    if (!options) { return nullptr; }
     std::string checkpoint_directory_str;
-    if (!resolve_checkpoint_directory_(file_path, checkpoint_directory, checkpoint_directory_str)) { return nullptr; }
+    if (!resolve_checkpoint_directory_(file_path, options->checkpoint_directory, checkpoint_directory_str)) {
+        return nullptr;
+    }
+    const auto is_lazy_snapshot = options->lazy_snapshot != OMEGA_EDIT_FALSE;
     FILE *file_ptr = nullptr;
     char checkpoint_filename[FILENAME_MAX + 1];
     int64_t original_file_modification_time = 0;
     bool original_file_modification_time_valid = false;
+    int64_t original_file_length = 0;
     if ((file_path != nullptr) && file_path[0] != '\0') {
         if (FILENAME_MAX <= snprintf(static_cast<char *>(checkpoint_filename), FILENAME_MAX,
                                      "%s%c.OmegaEdit-orig.XXXXXX", checkpoint_directory_str.c_str(),
@@ -2038,7 +2596,8 @@ omega_session_t *omega_edit_create_session(const char *file_path, omega_session_
             return nullptr;
         }
         CLOSE(checkpoint_fd);
-        if (0 != omega_util_file_copy(file_path, static_cast<char *>(checkpoint_filename), mode)) {
+        // A lazy snapshot is copied in the background once the session exists, reading the original file until then
+        if (!is_lazy_snapshot && 0 != omega_util_file_copy(file_path, static_cast<char *>(checkpoint_filename), mode)) {
             LOG_ERROR("failed to copy original file '" << file_path << "' to checkpoint file '"
                                                        << static_cast<char *>(checkpoint_filename) << "'");
             omega_util_remove_file(checkpoint_filename);
@@ -2050,16 +2609,53 @@ omega_session_t *omega_edit_create_session(const char *file_path, omega_session_
             return nullptr;
         }
         original_file_modification_time_valid = true;
-        file_ptr = FOPEN(checkpoint_filename, "rb");
+        file_ptr = FOPEN(is_lazy_snapshot ? file_path : checkpoint_filename, "rb");
         if (file_ptr == nullptr) {
             omega_util_remove_file(checkpoint_filename);
             return nullptr;
         }
+        if (is_lazy_snapshot) {
+            if (0 != FSEEK(file_ptr, 0L, SEEK_END) || (original_file_length = FTELL(file_ptr)) < 0) {
+                FCLOSE(file_ptr);
+                omega_util_remove_file(checkpoint_filename);
+                return nullptr;
+            }
+        }
     }
-    auto *const session_ptr = create_session_with_backing_file_(
+    auto *session_ptr = create_session_with_backing_file_(
             file_ptr, file_path, checkpoint_filename, checkpoint_directory_str, original_file_modification_time,
-            original_file_modification_time_valid, cbk, user_data_ptr, event_interest);
+            original_file_modification_time_valid, options->cbk, options->user_data_ptr, options->event_interest,
+            !is_lazy_snapshot);
     if (session_ptr == nullptr && file_ptr != nullptr) { omega_util_remove_file(checkpoint_filename); }
+    if (session_ptr != nullptr && file_ptr != nullptr) {
+        // An interrupted in-place save is reported rather than rolled back, which is left to the caller
+        std::string journal_path;
+        session_ptr->in_place_journal_found_ =
+                in_place_journal_path_(file_path, journal_path) && omega_util_file_exists(journal_path.c_str());
+        if (session_ptr->in_place_journal_found_) {
+            LOG_ERROR("found the journal of an interrupted in-place save of '" << file_path << "'");
+        }
+    }
+    if (session_ptr != nullptr && file_ptr != nullptr && is_lazy_snapshot) {
+        try {
+            session_ptr->original_file_length_ = original_file_length;
+            session_ptr->original_snapshot_copier_ = std::make_unique<omega_edit::internal::snapshot_copier_t>();
+            session_ptr->models_.front()->original_snapshot_copier_ptr = session_ptr->original_snapshot_copier_.get();
+            if (0 != session_ptr->original_snapshot_copier_->start(file_path, checkpoint_filename, original_file_length,
+                                                                    original_file_modification_time)) {
+                omega_edit_destroy_session(session_ptr);
+                return nullptr;
+            }
+        } catch (const std::bad_alloc &) {
+            omega_edit_destroy_session(session_ptr);
+            return nullptr;
+        }
+    }
+    if (session_ptr != nullptr && 0 < OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH &&
+        OMEGA_SEARCH_INDEX_MIN_FILE_LENGTH <= omega_session_get_original_file_size(session_ptr)) {
+        // Searches work without the index, so failing to start building it isn't an error
+        omega_session_build_search_index(session_ptr);
+    }
     return session_ptr;
 }
 
@@ -2112,12 +2708,19 @@ omega_session_t *omega_edit_create_session_from_bytes(const omega_byte_t *data_p
 
 void omega_edit_destroy_session(omega_session_t *session_ptr) {
     if (!session_ptr) { return; }
+    // Stop building the search index and copying the original snapshot before removing the snapshot
+    session_ptr->search_index_builder_.reset();
+    session_ptr->original_snapshot_copier_.reset();
     for (const auto &model_ptr : session_ptr->models_) {
+        model_ptr->file_map.unmap();
         if (model_ptr->file_ptr) { FCLOSE(model_ptr->file_ptr); }
     }
     while (!session_ptr->search_contexts_.empty()) {
         omega_search_destroy_context(session_ptr->search_contexts_.back().get());
     }
+    while (!session_ptr->multi_search_contexts_.empty()) {
+        omega_search_destroy_multi_context(session_ptr->multi_search_contexts_.back().get());
+    }
     while (!session_ptr->viewports_.empty()) { omega_edit_destroy_viewport(session_ptr->viewports_.back().get()); }
     free_session_changes_(session_ptr);
     free_session_changes_undone_(session_ptr);
@@ -2147,7 +2750,8 @@ omega_viewport_t *omega_edit_create_viewport(omega_session_t *session_ptr, int64
             viewport_ptr->data_segment.is_floating = (bool) is_floating;
             viewport_ptr->data_segment.capacity = -1 * capacity;// Negative capacity indicates dirty read
             viewport_ptr->data_segment.length = 0;
-            omega_data_create_(&viewport_ptr->data_segment.data, capacity);
+            omega_data_create_(&viewport_ptr->buffer, capacity);
+            omega_data_borrow_(&viewport_ptr->data_segment.data, viewport_ptr->buffer.data(), capacity);
             viewport_ptr->event_handler = cbk;
             viewport_ptr->user_data_ptr = user_data_ptr;
             viewport_ptr->event_interest_ = event_interest;
@@ -2199,7 +2803,7 @@ int64_t omega_edit_delete(omega_session_t *session_ptr, int64_t offset, int64_t
     const auto transaction_bit = determine_change_transaction_bit_(session_ptr);
     const auto change_ptr = deleted_payload.storage == OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED
                                     ? del_(serial, offset, effective_length, deleted_payload.release_file_path(),
-                                           effective_length, transaction_bit)
+                                           effective_length, transaction_bit, session_ptr->payload_block_cache_)
                                     : del_(serial, offset, effective_length, deleted_payload.bytes,
                                            deleted_payload.length, transaction_bit);
     return update_(session_ptr, change_ptr);
@@ -2255,7 +2859,7 @@ int64_t omega_edit_overwrite_bytes(omega_session_t *session_ptr, int64_t offset,
     const auto transaction_bit = determine_change_transaction_bit_(session_ptr);
     const auto change_ptr = replaced_payload.storage == OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED
                                     ? ovr_(serial, offset, bytes, length, replaced_payload.release_file_path(),
-                                           replaced_length, transaction_bit)
+                                           replaced_length, transaction_bit, session_ptr->payload_block_cache_)
                                     : ovr_(serial, offset, bytes, length, replaced_payload.bytes,
                                            replaced_payload.length, transaction_bit);
     return update_(session_ptr, change_ptr);
@@ -2290,6 +2894,55 @@ int64_t omega_edit_replace_bytes_as_transform(omega_session_t *session_ptr, int6
                                        options_json);
 }
 
+int64_t omega_edit_replace_file_as_transform(omega_session_t *session_ptr, int64_t offset, int64_t delete_length,
+                                             const char *file_path, const char *transform_id,
+                                             const char *options_json) {
+    if (!file_path || !transform_id || !*transform_id) { return -1; }
+    auto *insert_fptr = FOPEN(file_path, "rb");
+    if (!insert_fptr) { return -1; }
+    int64_t serial = -1;
+    if (0 == FSEEK(insert_fptr, 0, SEEK_END)) {
+        const auto insert_length = FTELL(insert_fptr);
+        if (0 <= insert_length) {
+            serial = replace_bytes_checkpointed_(session_ptr, offset, delete_length, nullptr, insert_length,
+                                                 transform_id, options_json, insert_fptr);
+        }
+    }
+    FCLOSE(insert_fptr);
+    return serial;
+}
+
+int64_t omega_edit_replace_files_as_transform(omega_session_t *session_ptr, int64_t offset, int64_t part_count,
+                                              const int64_t *part_lengths, const char *const *file_paths,
+                                              const char *transform_id, const char *options_json) {
+    if (part_count <= 0 || !part_lengths || !file_paths || !transform_id || !*transform_id) { return -1; }
+    std::vector<replacement_part_t> parts;
+    std::vector<FILE *> files;
+    int64_t serial = -1;
+    try {
+        parts.resize(static_cast<size_t>(part_count));
+        files.reserve(static_cast<size_t>(part_count));
+        auto is_open = true;
+        for (size_t i = 0; is_open && i < parts.size(); ++i) {
+            auto &part = parts[i];
+            part.delete_length = part_lengths[i];
+            part.is_unchanged = !file_paths[i];
+            if (part.is_unchanged) { continue; }
+            part.file_ptr = FOPEN(file_paths[i], "rb");
+            is_open = part.file_ptr && 0 == FSEEK(part.file_ptr, 0, SEEK_END);
+            if (part.file_ptr) { files.push_back(part.file_ptr); }
+            part.insert_length = is_open ? FTELL(part.file_ptr) : -1;
+            is_open = is_open && 0 <= part.insert_length;
+        }
+        if (is_open) {
+            serial = replace_parts_checkpointed_(session_ptr, offset, parts.data(), parts.size(), transform_id,
+                                                 options_json);
+        }
+    } catch (const std::bad_alloc &) { serial = -1; }
+    for (auto *file_ptr : files) { FCLOSE(file_ptr); }
+    return serial;
+}
+
 int64_t omega_edit_replace(omega_session_t *session_ptr, int64_t offset, int64_t delete_length, const char *cstr,
                            int64_t insert_length) {
     if (offset < 0 || delete_length < 0 || insert_length < 0) { return -1; }
@@ -2699,6 +3352,12 @@ int omega_edit_apply_script(omega_session_t *session_ptr, const omega_edit_scrip
         return -1;
     }
 
+    const auto one_pass_rc = apply_script_in_one_pass_(session_ptr, ops, op_count);
+    if (one_pass_rc != 0) {
+        restore_viewport_callbacks_(session_ptr, callbacks_were_paused, one_pass_rc > 0);
+        return one_pass_rc > 0 ? 0 : -1;
+    }
+
     bool changed = false;
     int rc = 0;
     try {
@@ -2738,7 +3397,19 @@ int omega_edit_apply_builtin_transform(omega_session_t *session_ptr, omega_edit_
 
 int omega_edit_apply_transform(omega_session_t *session_ptr, omega_util_byte_transform_t transform, void *user_data_ptr,
                                int64_t offset, int64_t length) {
-    return apply_transform_checkpointed_(session_ptr, transform, user_data_ptr, offset, length, "callback", nullptr) > 0
+    if (!transform) { return -1; }
+    const omega_util_byte_transform_context_t context{transform, user_data_ptr};
+    return apply_transform_checkpointed_(session_ptr, omega_util_apply_byte_transform_context_, &context, offset,
+                                         length, "callback", nullptr) > 0
+                   ? 0
+                   : -1;
+}
+
+int omega_edit_apply_table_transform(omega_session_t *session_ptr, const omega_byte_t *table, int64_t offset,
+                                     int64_t length) {
+    if (!table) { return -1; }
+    return apply_transform_checkpointed_(session_ptr, omega_util_apply_byte_table_context_, table, offset, length,
+                                         "table", nullptr) > 0
                    ? 0
                    : -1;
 }
@@ -2780,6 +3451,28 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
                                        "IO_FLG_FORCE_OVERWRITE to override)");
         return ORIGINAL_MODIFIED;// indicate that the original file has been modified since the session was created
     }
+    // The session must stop reading the original file before it's replaced
+    if (overwrite_original && 0 != omega_session_adopt_original_snapshot_(session_ptr, true)) {
+        LOG_ERROR("the snapshot of original file '" << session_file_path << "' couldn't be copied, save failed");
+        return -1;
+    }
+    // An in-place save writes only the changed ranges, so the original file must still match its snapshot, and the
+    // session must save all of its content, without checkpoints, at the original length
+    if (overwrite_original && options_ptr != nullptr && options_ptr->in_place != OMEGA_EDIT_FALSE && offset == 0 &&
+        adjusted_length == computed_file_size && session_ptr->models_.size() == 1 &&
+        !session_ptr->original_file_replaced_ && computed_file_size == omega_util_file_size(file_path) &&
+        !original_file_modified_since_last_sync_(session_ptr, session_file_path)) {
+        if (const auto result = save_in_place_(session_ptr, file_path, io_buf.get()); result != 0) { return result; }
+        if (0 != refresh_original_file_modification_time_(session_ptr, file_path)) {
+            LOG_ERROR("failed to refresh original file modification time: " << file_path);
+#ifndef OMEGA_BUILD_WINDOWS// Windows files may not have their modified times updated without elevated privileges
+            return -13;
+#endif
+        }
+        if (saved_file_path != nullptr) { omega_util_normalize_path(file_path, saved_file_path); }
+        omega_session_notify(session_ptr, SESSION_EVT_SAVE, saved_file_path);
+        return 0;
+    }
 
     omega_util_dirname(file_path, temp_filename);
     if (!temp_filename[0]) { omega_util_get_current_dir(temp_filename); }
@@ -2838,25 +3531,27 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
     };
 
     const auto &segments = session_ptr->models_.back()->model_segments;
-    auto seg_iter = std::upper_bound(
-            segments.cbegin(), segments.cend(), offset,
-            [](int64_t off, const omega_model_segment_ptr_t &seg) { return off < seg->computed_offset; });
-    if (seg_iter != segments.cbegin()) { --seg_iter; }
-
-    for (; seg_iter != segments.cend() && bytes_written < adjusted_length; ++seg_iter) {
-        const auto &segment = *seg_iter;
-        int64_t segment_end = 0;
-        if (!safe_add_int64_(segment->computed_offset, segment->computed_length, segment_end)) {
-            close_and_cleanup_output();
-            LOG_ERROR("segment offset overflow");
-            return -6;
-        }
-        if (segment_end <= offset) { continue; }
+    const auto advance_segment = [](omega_model_segments_t::const_iterator &iter) -> bool {
+        try {
+            ++iter;
+            return true;
+        } catch (const std::bad_alloc &) { return false; }
+    };
+    omega_model_segments_t::const_iterator seg_iter;
+    try {
+        seg_iter = segments.find(offset);
+    } catch (const std::bad_alloc &) {
+        close_and_cleanup_output();
+        return -6;
+    }
 
-        const auto segment_start = std::max(offset - segment->computed_offset, int64_t(0));
+    while (seg_iter != segments.end() && bytes_written < adjusted_length) {
+        const auto *segment = &*seg_iter;
+        const auto *segment_change_ptr = seg_iter.change();
+        const auto segment_start = std::max(offset - seg_iter.computed_offset(), int64_t(0));
         const auto segment_length = std::min(adjusted_length - bytes_written, segment->computed_length - segment_start);
 
-        switch (omega_model_segment_get_kind_(segment.get())) {
+        switch (omega_model_segment_get_kind_(segment_change_ptr)) {
             case model_segment_kind_t::SEGMENT_READ: {
                 if (session_ptr->models_.back()->file_ptr == nullptr) {
                     ABORT(LOG_ERROR("attempt to read segment from null file pointer"););
@@ -2867,7 +3562,8 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
                     return -6;
                 }
                 if (write_file_segment_(session_ptr->models_.back()->file_ptr, source_offset, segment_length, temp_fptr,
-                                        io_buf.get()) != segment_length) {
+                                        io_buf.get()) != segment_length ||
+                    !model_file_is_unchanged_(session_ptr->models_.back().get())) {
                     close_and_cleanup_output();
                     LOG_ERROR("write_file_segment_ failed");
                     return -6;
@@ -2880,7 +3576,7 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
                     close_and_cleanup_output();
                     return -7;
                 }
-                if (omega_change_write_payload_bytes_(segment->change_ptr.get(), segment->payload_role, source_offset,
+                if (omega_change_write_payload_bytes_(segment_change_ptr, segment->payload_role, source_offset,
                                                       segment_length, temp_fptr, io_buf.get(),
                                                       OMEGA_IO_BUFFER_SIZE) != segment_length) {
                     close_and_cleanup_output();
@@ -2896,6 +3592,10 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
             close_and_cleanup_output();
             return -8;
         }
+        if (!advance_segment(seg_iter)) {
+            close_and_cleanup_output();
+            return -6;
+        }
     }
     if (!flush_file_to_disk_(temp_fptr)) {
         LOG_ERRNO();
@@ -2935,6 +3635,7 @@ int omega_edit_save_segment_with_options(omega_session_t *session_ptr, const cha
         }
         cleanup_output = false;
         output_path = file_path;
+        if (overwrite_original) { session_ptr->original_file_replaced_ = true; }
         if (!sync_parent_directory_(file_path)) {
             LOG_ERRNO();
             return OMEGA_EDIT_SAVE_DIRECTORY_SYNC_FAILED;
@@ -2975,6 +3676,11 @@ int omega_edit_save_with_options(omega_session_t *session_ptr, const char *file_
     return omega_edit_save_segment_with_options(session_ptr, file_path, io_flags, saved_file_path, 0, 0, options_ptr);
 }
 
+int omega_edit_roll_back_in_place_save(const char *file_path) {
+    if (!file_path || !*file_path) { return -1; }
+    return roll_back_in_place_save_(file_path);
+}
+
 int omega_edit_save_segment_to_file_with_options(const omega_session_t *session_ptr, FILE *file_ptr, int64_t offset,
                                                  int64_t length,
                                                  const omega_edit_save_segment_to_file_options_t *options_ptr) {
@@ -3086,7 +3792,7 @@ int omega_edit_clear_changes(omega_session_t *session_ptr) {
         if (length < 0) { return -1; }
     }
 
-    omega_model_segments_t reset_segments;
+    omega_model_segments_t reset_segments(&session_ptr->models_.front()->segment_pool);
     if (!initialize_model_segments_(reset_segments, length)) { return -1; }
     discard_checkpoint_future_(session_ptr);
     while (session_ptr->models_.size() > 1) { discard_top_model_(session_ptr); }
@@ -3246,6 +3952,7 @@ int64_t omega_edit_redo_last_undo(omega_session_t *session_ptr) {
 
 int omega_edit_create_checkpoint(omega_session_t *session_ptr) {
     if (!session_ptr) { return -1; }
+    omega_session_adopt_original_snapshot_(session_ptr, false);
     char checkpoint_filename[FILENAME_MAX + 1];
     auto *checkpoint_file_ptr =
             create_checkpoint_file_for_write_(session_ptr, checkpoint_filename, sizeof(checkpoint_filename));
@@ -3289,7 +3996,7 @@ int omega_edit_checkout_checkpoint(omega_session_t *session_ptr, int64_t checkpo
     if (checkpoint_count > active_count + future_count) { return -1; }
     if (checkpoint_count == active_count) { return 0; }
 
-    omega_model_segments_t original_segments;
+    omega_model_segments_t original_segments(&session_ptr->models_.front()->segment_pool);
     if (checkpoint_count == 0) {
         const auto original_length = omega_session_get_original_file_size(session_ptr);
         if (original_length < 0 || !initialize_model_segments_(original_segments, original_length)) { return -1; }
@@ -0,0 +1,635 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "byte_regex.hpp"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace omega_edit::internal {
+
+    namespace {
+        using byte_set_t = std::bitset<UCHAR_MAX + 1>;
+
+        constexpr int64_t unbounded = -1;
+        constexpr int64_t repeat_limit = 1000;
+        constexpr int nesting_limit = 1000;
+        constexpr size_t nfa_state_limit = size_t{1} << 18;
+
+        // Node of a parsed pattern
+        struct node_t {
+            enum class kind_t { bytes, concat, alternate, repeat };
+
+            kind_t kind{kind_t::concat};
+            byte_set_t bytes{};           ///< Bytes matched by a bytes node
+            std::vector<size_t> children{};///< Children of a concat, alternate, or repeat node
+            int64_t min{};                 ///< Minimum repeat count
+            int64_t max{};                 ///< Maximum repeat count, or unbounded
+        };
+
+        [[noreturn]] void fail_(const char *what) { throw std::invalid_argument(what); }
+
+        bool is_hex_digit_(omega_byte_t byte) {
+            return ('0' <= byte && byte <= '9') || ('a' <= byte && byte <= 'f') || ('A' <= byte && byte <= 'F');
+        }
+
+        int hex_value_(omega_byte_t byte) {
+            if ('0' <= byte && byte <= '9') { return byte - '0'; }
+            return (byte | 0x20) - 'a' + 10;
+        }
+
+        byte_set_t byte_range_(int first, int last) {
+            byte_set_t bytes;
+            for (auto byte = first; byte <= last; ++byte) { bytes.set(static_cast<size_t>(byte)); }
+            return bytes;
+        }
+
+        // Recursive descent parser producing a tree of nodes, with case folding applied to the byte sets
+        class parser_t {
+        public:
+            parser_t(const omega_byte_t *pattern, int64_t pattern_length, const omega_byte_t *fold_table,
+                     std::vector<node_t> &nodes)
+                : pattern_(pattern), end_(pattern + pattern_length), fold_table_(fold_table), nodes_(nodes) {}
+
+            size_t parse_regex() {
+                const auto root = alternation_(0);
+                if (!at_end_()) { fail_("unbalanced parenthesis"); }
+                return root;
+            }
+
+            size_t parse_hex_mask() {
+                node_t concat;
+                for (;;) {
+                    while (!at_end_() && is_space_(peek_())) { take_(); }
+                    if (at_end_()) { break; }
+                    const auto high = take_();
+                    if (at_end_()) { fail_("hex mask has an odd number of digits"); }
+                    const auto low = take_();
+                    if ((high != '?' && !is_hex_digit_(high)) || (low != '?' && !is_hex_digit_(low))) {
+                        fail_("hex mask digits must be hex digits or '?'");
+                    }
+                    byte_set_t bytes;
+                    for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+                        if ((high == '?' || hex_value_(high) == byte >> 4) &&
+                            (low == '?' || hex_value_(low) == (byte & 0xF))) {
+                            bytes.set(static_cast<size_t>(byte));
+                        }
+                    }
+                    concat.children.push_back(add_bytes_(bytes));
+                }
+                return add_(std::move(concat));
+            }
+
+        private:
+            static bool is_space_(omega_byte_t byte) {
+                return byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r' || byte == '\f' || byte == '\v';
+            }
+
+            bool at_end_() const { return pattern_ == end_; }
+
+            omega_byte_t peek_() const { return *pattern_; }
+
+            omega_byte_t take_() {
+                if (at_end_()) { fail_("pattern ends unexpectedly"); }
+                return *pattern_++;
+            }
+
+            size_t add_(node_t &&node) {
+                nodes_.push_back(std::move(node));
+                return nodes_.size() - 1;
+            }
+
+            // Adds a bytes node matching every byte that folds to the same byte as one of the given bytes
+            size_t add_bytes_(const byte_set_t &bytes) {
+                node_t node;
+                node.kind = node_t::kind_t::bytes;
+                if (fold_table_) {
+                    byte_set_t folded;
+                    for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+                        if (bytes.test(static_cast<size_t>(byte))) { folded.set(fold_table_[byte]); }
+                    }
+                    for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+                        if (folded.test(fold_table_[byte])) { node.bytes.set(static_cast<size_t>(byte)); }
+                    }
+                } else {
+                    node.bytes = bytes;
+                }
+                return add_(std::move(node));
+            }
+
+            size_t alternation_(int depth) {
+                if (nesting_limit < depth) { throw std::length_error("pattern nests too deeply"); }
+                node_t alternate;
+                alternate.kind = node_t::kind_t::alternate;
+                alternate.children.push_back(concatenation_(depth));
+                while (!at_end_() && peek_() == '|') {
+                    take_();
+                    alternate.children.push_back(concatenation_(depth));
+                }
+                return alternate.children.size() == 1 ? alternate.children.front() : add_(std::move(alternate));
+            }
+
+            size_t concatenation_(int depth) {
+                node_t concat;
+                while (!at_end_() && peek_() != '|' && peek_() != ')') {
+                    concat.children.push_back(repetition_(depth));
+                }
+                return concat.children.size() == 1 ? concat.children.front() : add_(std::move(concat));
+            }
+
+            size_t repetition_(int depth) {
+                auto child = atom_(depth);
+                while (!at_end_()) {
+                    node_t repeat;
+                    repeat.kind = node_t::kind_t::repeat;
+                    switch (peek_()) {
+                        case '*':
+                            repeat.min = 0;
+                            repeat.max = unbounded;
+                            break;
+                        case '+':
+                            repeat.min = 1;
+                            repeat.max = unbounded;
+                            break;
+                        case '?':
+                            repeat.min = 0;
+                            repeat.max = 1;
+                            break;
+                        case '{':
+                            break;
+                        default:
+                            return child;
+                    }
+                    if (take_() == '{') {
+                        repeat.min = count_();
+                        repeat.max = repeat.min;
+                        if (!at_end_() && peek_() == ',') {
+                            take_();
+                            repeat.max = !at_end_() && peek_() == '}' ? unbounded : count_();
+                        }
+                        if (take_() != '}') { fail_("malformed repetition"); }
+                        if (repeat.max != unbounded && repeat.max < repeat.min) {
+                            fail_("repetition range is invalid");
+                        }
+                    }
+                    if (nesting_limit < ++depth) { throw std::length_error("pattern nests too deeply"); }
+                    repeat.children.push_back(child);
+                    child = add_(std::move(repeat));
+                }
+                return child;
+            }
+
+            int64_t count_() {
+                if (at_end_() || peek_() < '0' || '9' < peek_()) { fail_("malformed repetition"); }
+                int64_t count = 0;
+                while (!at_end_() && '0' <= peek_() && peek_() <= '9') {
+                    count = count * 10 + (take_() - '0');
+                    if (repeat_limit < count) { fail_("repetition count is too large"); }
+                }
+                return count;
+            }
+
+            size_t atom_(int depth) {
+                const auto byte = take_();
+                switch (byte) {
+                    case '(': {
+                        if (!at_end_() && peek_() == '?') {
+                            take_();
+                            if (take_() != ':') { fail_("unsupported group"); }
+                        }
+                        const auto group = alternation_(depth + 1);
+                        if (at_end_() || take_() != ')') { fail_("unbalanced parenthesis"); }
+                        return group;
+                    }
+                    case '[':
+                        return add_bytes_(bracket_());
+                    case '.':
+                        return add_bytes_(byte_set_t().set());
+                    case '\\': {
+                        omega_byte_t escaped_byte = 0;
+                        return add_bytes_(escape_(escaped_byte));
+                    }
+                    case '*':
+                    case '+':
+                    case '?':
+                    case '{':
+                        fail_("nothing to repeat");
+                    case '^':
+                    case '$':
+                        fail_("anchors are not supported");
+                    default:
+                        return add_bytes_(byte_set_t().set(byte));
+                }
+            }
+
+            // Parses the escape following a backslash, setting the escaped byte if it stands for a single byte
+            byte_set_t escape_(omega_byte_t &escaped_byte) {
+                const auto byte = take_();
+                switch (byte) {
+                    case 'd':
+                    case 'D':
+                    case 's':
+                    case 'S':
+                    case 'w':
+                    case 'W': {
+                        byte_set_t bytes;
+                        switch (byte | 0x20) {
+                            case 'd':
+                                bytes = byte_range_('0', '9');
+                                break;
+                            case 's':
+                                for (const auto space : {' ', '\t', '\n', '\v', '\f', '\r'}) { bytes.set(space); }
+                                break;
+                            default:
+                                bytes = byte_range_('0', '9') | byte_range_('A', 'Z') | byte_range_('a', 'z');
+                                bytes.set('_');
+                                break;
+                        }
+                        return byte == (byte | 0x20) ? bytes : ~bytes;
+                    }
+                    case 'x': {
+                        const auto high = take_();
+                        const auto low = take_();
+                        if (!is_hex_digit_(high) || !is_hex_digit_(low)) {
+                            fail_("\\x must be followed by two hex digits");
+                        }
+                        escaped_byte = static_cast<omega_byte_t>(hex_value_(high) << 4 | hex_value_(low));
+                        break;
+                    }
+                    case '0':
+                        escaped_byte = '\0';
+                        break;
+                    case 'a':
+                        escaped_byte = '\a';
+                        break;
+                    case 'e':
+                        escaped_byte = 0x1B;
+                        break;
+                    case 'f':
+                        escaped_byte = '\f';
+                        break;
+                    case 'n':
+                        escaped_byte = '\n';
+                        break;
+                    case 'r':
+                        escaped_byte = '\r';
+                        break;
+                    case 't':
+                        escaped_byte = '\t';
+                        break;
+                    case 'v':
+                        escaped_byte = '\v';
+                        break;
+                    default:
+                        // Other letters and digits are reserved, anything else stands for itself
+                        if (byte_range_('0', '9').test(byte) || byte_range_('A', 'Z').test(byte) ||
+                            byte_range_('a', 'z').test(byte)) {
+                            fail_("unsupported escape");
+                        }
+                        escaped_byte = byte;
+                        break;
+                }
+                return byte_set_t().set(escaped_byte);
+            }
+
+            // Parses a bracketed class following the opening bracket
+            byte_set_t bracket_() {
+                const auto is_negated = !at_end_() && peek_() == '^';
+                if (is_negated) { take_(); }
+                byte_set_t bytes;
+                for (auto is_first = true;; is_first = false) {
+                    if (at_end_()) { fail_("unterminated class"); }
+                    auto byte = take_();
+                    if (byte == ']' && !is_first) { break; }
+                    if (byte == '\\') {
+                        const auto escaped = escape_(byte);
+                        if (escaped.count() != 1 || !escaped.test(byte)) {
+                            // A class escape like \d can't bound a range
+                            bytes |= escaped;
+                            continue;
+                        }
+                    }
+                    // A '-' first, last, or after a range is literal
+                    if (end_ - pattern_ >= 2 && peek_() == '-' && pattern_[1] != ']') {
+                        take_();
+                        auto last = take_();
+                        if (last == '\\') {
+                            const auto escaped = escape_(last);
+                            if (escaped.count() != 1 || !escaped.test(last)) { fail_("class range is invalid"); }
+                        }
+                        if (last < byte) { fail_("class range is invalid"); }
+                        bytes |= byte_range_(byte, last);
+                    } else {
+                        bytes.set(byte);
+                    }
+                }
+                return is_negated ? ~bytes : bytes;
+            }
+
+            const omega_byte_t *pattern_;
+            const omega_byte_t *end_;
+            const omega_byte_t *fold_table_;
+            std::vector<node_t> &nodes_;
+        };
+
+        // Computes the minimum and maximum match lengths of a node, saturating at the given cap
+        std::pair<int64_t, int64_t> lengths_(const std::vector<node_t> &nodes, size_t index, int64_t cap) {
+            const auto &node = nodes[index];
+            const auto saturate = [cap](int64_t length) { return std::min(length, cap); };
+            switch (node.kind) {
+                case node_t::kind_t::bytes:
+                    return {1, 1};
+                case node_t::kind_t::concat: {
+                    int64_t min = 0;
+                    int64_t max = 0;
+                    for (const auto child : node.children) {
+                        const auto [child_min, child_max] = lengths_(nodes, child, cap);
+                        min = saturate(min + child_min);
+                        max = saturate(max + child_max);
+                    }
+                    return {min, max};
+                }
+                case node_t::kind_t::alternate: {
+                    int64_t min = cap;
+                    int64_t max = 0;
+                    for (const auto child : node.children) {
+                        const auto [child_min, child_max] = lengths_(nodes, child, cap);
+                        min = std::min(min, child_min);
+                        max = std::max(max, child_max);
+                    }
+                    return {min, max};
+                }
+                default: {
+                    const auto [child_min, child_max] = lengths_(nodes, node.children.front(), cap);
+                    const auto max = node.max == unbounded ? (child_max ? cap : 0) : saturate(child_max * node.max);
+                    return {saturate(child_min * node.min), max};
+                }
+            }
+        }
+
+        // Thompson construction, compiling each node in front of the state that follows it
+        class nfa_builder_t {
+        public:
+            nfa_builder_t(const std::vector<node_t> &nodes, bool is_reverse, byte_nfa_t &nfa)
+                : nodes_(nodes), is_reverse_(is_reverse), nfa_(nfa) {}
+
+            void build(size_t root) {
+                nfa_.states.clear();
+                const auto match = add_({});
+                nfa_.start = compile_(root, match);
+            }
+
+        private:
+            uint32_t add_(byte_nfa_t::state_t &&state) {
+                if (nfa_state_limit <= nfa_.states.size()) { throw std::length_error("pattern is too complex"); }
+                nfa_.states.push_back(std::move(state));
+                return static_cast<uint32_t>(nfa_.states.size() - 1);
+            }
+
+            uint32_t add_split_(uint32_t out, uint32_t out1) {
+                byte_nfa_t::state_t split;
+                split.kind = byte_nfa_t::kind_t::split;
+                split.out = out;
+                split.out1 = out1;
+                return add_(std::move(split));
+            }
+
+            uint32_t compile_(size_t index, uint32_t next) {
+                const auto &node = nodes_[index];
+                switch (node.kind) {
+                    case node_t::kind_t::bytes: {
+                        byte_nfa_t::state_t state;
+                        state.kind = byte_nfa_t::kind_t::byte;
+                        state.out = next;
+                        state.bytes = node.bytes;
+                        return add_(std::move(state));
+                    }
+                    case node_t::kind_t::concat:
+                        // Compiled back to front, unless the automaton runs backwards
+                        if (is_reverse_) {
+                            for (const auto child : node.children) { next = compile_(child, next); }
+                        } else {
+                            for (auto iter = node.children.rbegin(); iter != node.children.rend(); ++iter) {
+                                next = compile_(*iter, next);
+                            }
+                        }
+                        return next;
+                    case node_t::kind_t::alternate: {
+                        auto entry = compile_(node.children.back(), next);
+                        for (auto i = node.children.size() - 1; i-- > 0;) {
+                            entry = add_split_(compile_(node.children[i], next), entry);
+                        }
+                        return entry;
+                    }
+                    default: {
+                        const auto child = node.children.front();
+                        auto entry = next;
+                        if (node.max == unbounded) {
+                            // The loop state is patched once its body exists
+                            const auto loop = add_split_(next, next);
+                            nfa_.states[loop].out = compile_(child, loop);
+                            entry = loop;
+                        } else {
+                            for (auto i = node.min; i < node.max; ++i) {
+                                entry = add_split_(compile_(child, entry), next);
+                            }
+                        }
+                        for (int64_t i = 0; i < node.min; ++i) { entry = compile_(child, entry); }
+                        return entry;
+                    }
+                }
+            }
+
+            const std::vector<node_t> &nodes_;
+            bool is_reverse_;
+            byte_nfa_t &nfa_;
+        };
+    }// namespace
+
+    lazy_dfa_t::lazy_dfa_t(const byte_nfa_t &nfa, const uint16_t *byte_classes, size_t class_count,
+                           bool is_unanchored, size_t cache_limit)
+        : nfa_(nfa), byte_classes_(byte_classes), class_count_(class_count), is_unanchored_(is_unanchored),
+          cache_limit_(cache_limit), visited_(nfa.states.size()) {
+        assert(byte_classes);
+        assert(0 < class_count);
+        reset_();
+    }
+
+    lazy_dfa_t::state_t lazy_dfa_t::start() { return start_; }
+
+    void lazy_dfa_t::reset_() {
+        transitions_.clear();
+        state_sets_.clear();
+        state_ids_.clear();
+        cache_size_ = 0;
+        // The dead state has no NFA states and never leaves
+        add_state_({});
+        std::fill(transitions_.begin(), transitions_.end(), dead);
+        std::vector<uint32_t> start_states;
+        begin_visit_();
+        add_closure_(nfa_.start, start_states);
+        std::sort(start_states.begin(), start_states.end());
+        start_ = add_state_(std::move(start_states)) & ~match_flag;
+    }
+
+    void lazy_dfa_t::begin_visit_() {
+        if (visit_mark_ == UINT32_MAX) {
+            std::fill(visited_.begin(), visited_.end(), 0);
+            visit_mark_ = 0;
+        }
+        ++visit_mark_;
+    }
+
+    void lazy_dfa_t::add_closure_(uint32_t nfa_state, std::vector<uint32_t> &nfa_states) {
+        stack_.push_back(nfa_state);
+        while (!stack_.empty()) {
+            const auto state = stack_.back();
+            stack_.pop_back();
+            if (visited_[state] == visit_mark_) { continue; }
+            visited_[state] = visit_mark_;
+            const auto &nfa_state_ref = nfa_.states[state];
+            if (nfa_state_ref.kind == byte_nfa_t::kind_t::split) {
+                stack_.push_back(nfa_state_ref.out1);
+                stack_.push_back(nfa_state_ref.out);
+            } else {
+                nfa_states.push_back(state);
+            }
+        }
+    }
+
+    lazy_dfa_t::state_t lazy_dfa_t::add_state_(std::vector<uint32_t> &&nfa_states) {
+        const auto iter = state_ids_.find(nfa_states);
+        if (iter != state_ids_.end()) { return iter->second; }
+        auto state = static_cast<state_t>(state_sets_.size());
+        const auto is_match = [this](uint32_t nfa_state) {
+            return nfa_.states[nfa_state].kind == byte_nfa_t::kind_t::match;
+        };
+        if (std::any_of(nfa_states.begin(), nfa_states.end(), is_match)) { state |= match_flag; }
+        cache_size_ += (class_count_ + 2 * nfa_states.size()) * sizeof(state_t) + 128;
+        transitions_.resize(transitions_.size() + class_count_, unknown);
+        state_ids_.emplace(nfa_states, state);
+        state_sets_.push_back(std::move(nfa_states));
+        return state;
+    }
+
+    lazy_dfa_t::state_t lazy_dfa_t::compute_next_(state_t state, omega_byte_t byte) {
+        if (cache_limit_ < cache_size_) {
+            // Start over, keeping only the state being left
+            auto nfa_states = state_sets_[state];
+            reset_();
+            state = add_state_(std::move(nfa_states)) & ~match_flag;
+        }
+        begin_visit_();
+        std::vector<uint32_t> next_states;
+        for (const auto nfa_state : state_sets_[state]) {
+            const auto &nfa_state_ref = nfa_.states[nfa_state];
+            if (nfa_state_ref.kind == byte_nfa_t::kind_t::byte && nfa_state_ref.bytes.test(byte)) {
+                add_closure_(nfa_state_ref.out, next_states);
+            }
+        }
+        if (is_unanchored_) { add_closure_(nfa_.start, next_states); }
+        std::sort(next_states.begin(), next_states.end());
+        const auto target = add_state_(std::move(next_states));
+        transitions_[static_cast<size_t>(state) * class_count_ + byte_classes_[byte]] = target;
+        return target;
+    }
+
+    byte_regex_t::program_t byte_regex_t::compile_(const omega_byte_t *pattern, int64_t pattern_length,
+                                                   syntax_t syntax, const omega_byte_t *fold_table,
+                                                   int64_t match_length_limit) {
+        assert(pattern || pattern_length == 0);
+        assert(0 < match_length_limit);
+        std::vector<node_t> nodes;
+        parser_t parser(pattern, pattern_length, fold_table, nodes);
+        const auto root = syntax == syntax_t::regex ? parser.parse_regex() : parser.parse_hex_mask();
+
+        program_t program;
+        const auto [min_length, max_length] = lengths_(nodes, root, match_length_limit + 1);
+        if (min_length == 0) { fail_("pattern matches an empty sequence"); }
+        if (match_length_limit < min_length) { fail_("pattern can't match within the match length limit"); }
+        program.min_length = min_length;
+        program.max_length = std::min(max_length, match_length_limit);
+        nfa_builder_t(nodes, false, program.forward_nfa).build(root);
+        nfa_builder_t(nodes, true, program.reverse_nfa).build(root);
+
+        // Refine the byte classes with each distinct byte set, so bytes in one class are interchangeable
+        std::unordered_set<byte_set_t> byte_sets;
+        for (const auto &node : nodes) {
+            if (node.kind == node_t::kind_t::bytes) { byte_sets.insert(node.bytes); }
+        }
+        program.class_count = 1;
+        for (const auto &bytes : byte_sets) {
+            std::vector<int> refined(program.class_count * 2, -1);
+            size_t class_count = 0;
+            for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+                auto &refined_class = refined[program.byte_classes[byte] * 2 + bytes.test(static_cast<size_t>(byte))];
+                if (refined_class < 0) { refined_class = static_cast<int>(class_count++); }
+                program.byte_classes[byte] = static_cast<uint16_t>(refined_class);
+            }
+            program.class_count = class_count;
+        }
+        return program;
+    }
+
+    byte_regex_t::byte_regex_t(const omega_byte_t *pattern, int64_t pattern_length, syntax_t syntax,
+                               const omega_byte_t *fold_table, int64_t match_length_limit, size_t cache_limit)
+        : program_(compile_(pattern, pattern_length, syntax, fold_table, match_length_limit)),
+          forward_dfa_(program_.forward_nfa, program_.byte_classes, program_.class_count, true, cache_limit),
+          reverse_dfa_(program_.reverse_nfa, program_.byte_classes, program_.class_count, true, cache_limit),
+          anchored_dfa_(program_.forward_nfa, program_.byte_classes, program_.class_count, false, cache_limit) {}
+
+    int64_t byte_regex_t::find_end(const omega_byte_t *data, int64_t length, lazy_dfa_t::state_t &state) {
+        auto current = state;
+        for (int64_t i = 0; i < length; ++i) {
+            current = forward_dfa_.next(current, data[i]);
+            if (current & lazy_dfa_t::match_flag) {
+                state = current & ~lazy_dfa_t::match_flag;
+                return i + 1;
+            }
+        }
+        state = current;
+        return -1;
+    }
+
+    void byte_regex_t::find_starts(const omega_byte_t *data, int64_t length, std::vector<int64_t> &starts) {
+        starts.clear();
+        auto state = reverse_dfa_.start();
+        for (auto i = length; i-- > 0;) {
+            state = reverse_dfa_.next(state, data[i]);
+            if (state & lazy_dfa_t::match_flag) {
+                state &= ~lazy_dfa_t::match_flag;
+                starts.push_back(i);
+            }
+        }
+    }
+
+    int64_t byte_regex_t::longest_match(const omega_byte_t *data, int64_t length, int64_t &scanned) {
+        auto state = anchored_dfa_.start();
+        int64_t longest = 0;
+        int64_t i = 0;
+        while (i < length) {
+            state = anchored_dfa_.next(state, data[i++]);
+            if (state == lazy_dfa_t::dead) { break; }
+            if (state & lazy_dfa_t::match_flag) {
+                state &= ~lazy_dfa_t::match_flag;
+                longest = i;
+            }
+        }
+        scanned = i;
+        return longest;
+    }
+
+}// namespace omega_edit::internal
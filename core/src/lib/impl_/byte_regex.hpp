@@ -0,0 +1,215 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_BYTE_REGEX_HPP
+#define OMEGA_EDIT_BYTE_REGEX_HPP
+
+#include "../../include/omega_edit/byte.h"
+#include <bitset>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    /**
+     * Nondeterministic automaton compiled from a byte pattern (Thompson construction).  Byte states consume one byte
+     * from their set, split states branch without consuming anything, and reaching the match state completes a match.
+     */
+    struct byte_nfa_t {
+        enum class kind_t : uint8_t { byte, split, match };
+
+        struct state_t {
+            kind_t kind{kind_t::match};
+            uint32_t out{};
+            uint32_t out1{};
+            std::bitset<UCHAR_MAX + 1> bytes{};
+        };
+
+        std::vector<state_t> states{};
+        uint32_t start{};
+    };
+
+    /**
+     * Deterministic automaton built lazily, one transition at a time, from a byte NFA.  The states built so far are
+     * cached, and the cache is flushed (keeping only the state being left) once it outgrows its memory budget, so
+     * memory stays bounded however many subsets of NFA states the input visits.
+     */
+    class lazy_dfa_t {
+    public:
+        using state_t = uint32_t;
+
+        static constexpr state_t dead = 0;
+        static constexpr state_t match_flag = 1U << 31;
+
+        /**
+         * Prepares the automaton
+         * @param nfa NFA to determinize, which must outlive this automaton
+         * @param byte_classes byte classes that no byte set in the NFA splits
+         * @param class_count number of byte classes
+         * @param is_unanchored true to restart the NFA at every byte (find matches starting anywhere), false to only
+         * start it at the first byte
+         * @param cache_limit memory budget for the cached states in bytes
+         */
+        lazy_dfa_t(const byte_nfa_t &nfa, const uint16_t *byte_classes, size_t class_count, bool is_unanchored,
+                   size_t cache_limit);
+
+        /**
+         * Gets the start state, which may change whenever the cache is flushed
+         * @return start state
+         */
+        state_t start();
+
+        /**
+         * Transition function
+         * @param state current state (without the match flag)
+         * @param byte next byte
+         * @return next state, with match_flag set if a match ends with this byte
+         * @warning Only the returned state remains valid, any other state held by the caller may have been flushed.
+         */
+        state_t next(state_t state, omega_byte_t byte) {
+            const auto target = transitions_[static_cast<size_t>(state) * class_count_ + byte_classes_[byte]];
+            return target != unknown ? target : compute_next_(state, byte);
+        }
+
+    private:
+        static constexpr state_t unknown = match_flag - 1;
+
+        state_t compute_next_(state_t state, omega_byte_t byte);
+        state_t add_state_(std::vector<uint32_t> &&nfa_states);
+        void add_closure_(uint32_t nfa_state, std::vector<uint32_t> &nfa_states);
+        void begin_visit_();
+        void reset_();
+
+        const byte_nfa_t &nfa_;
+        const uint16_t *byte_classes_;
+        size_t class_count_;
+        bool is_unanchored_;
+        size_t cache_limit_;
+        size_t cache_size_{};
+        state_t start_{};
+        std::vector<state_t> transitions_{};
+        std::vector<std::vector<uint32_t>> state_sets_{};
+        std::map<std::vector<uint32_t>, state_t> state_ids_{};
+        std::vector<uint32_t> visited_{};
+        std::vector<uint32_t> stack_{};
+        uint32_t visit_mark_{};
+    };
+
+    /**
+     * Byte pattern (a regular expression or a hex byte mask) searched for with lazily built DFAs.
+     *
+     * Regular expressions work on bytes: '.' matches any byte, and a pattern can use literal bytes, '\xHH' escapes,
+     * the '\0', '\a', '\e', '\f', '\n', '\r', '\t', and '\v' escapes, the '\d', '\D', '\s', '\S', '\w', and '\W' ASCII
+     * classes, bracketed classes and ranges, '|' alternation, '(' ')' or '(?:' ')' groups, and the greedy '*', '+',
+     * '?', '{n}', '{n,}', and '{n,m}' repetitions (up to 1000).  Anchors and backreferences aren't supported.
+     *
+     * Hex masks are pairs of hex digits, optionally separated by whitespace, where '?' stands for any nibble, so "4D 5A
+     * ?? ?? 5?" matches 'M', 'Z', any two bytes, then a byte from 0x50 through 0x5F.
+     *
+     * A search finds the leftmost match, and then the longest match starting there (POSIX semantics).  Matches are at
+     * most match_length_limit bytes long, which bounds the bytes a search needs to look at around any match.
+     */
+    class byte_regex_t {
+    public:
+        enum class syntax_t { regex, hex_mask };
+
+        /**
+         * Compiles the pattern
+         * @param pattern pattern text
+         * @param pattern_length length of the pattern text in bytes
+         * @param syntax pattern syntax
+         * @param fold_table table of UCHAR_MAX + 1 entries mapping each byte to its folded form, or nullptr to match
+         * bytes exactly
+         * @param match_length_limit longest match to report, unbounded repetitions stop matching at this length
+         * @param cache_limit memory budget for each lazily built DFA in bytes
+         * @throws std::invalid_argument if the pattern is malformed, can match an empty sequence, or can't match within
+         * the length limit, std::length_error if the pattern is too complex, std::bad_alloc if it can't be allocated
+         */
+        byte_regex_t(const omega_byte_t *pattern, int64_t pattern_length, syntax_t syntax,
+                     const omega_byte_t *fold_table, int64_t match_length_limit, size_t cache_limit);
+
+        byte_regex_t(const byte_regex_t &) = delete;
+        auto operator=(const byte_regex_t &) -> byte_regex_t & = delete;
+
+        /**
+         * Gets the length of the shortest possible match
+         * @return minimum match length
+         */
+        int64_t min_length() const { return program_.min_length; }
+
+        /**
+         * Gets the length of the longest possible match, capped at the match length limit
+         * @return maximum match length
+         */
+        int64_t max_length() const { return program_.max_length; }
+
+        /**
+         * Gets the start state of a forward scan for the earliest match end
+         * @return scan state to pass to find_end
+         */
+        lazy_dfa_t::state_t find_end_start() { return forward_dfa_.start(); }
+
+        /**
+         * Continues a forward scan for the end of the earliest-ending match, which may start anywhere in the scan
+         * @param data bytes to scan, following the bytes already scanned with this state
+         * @param length number of bytes to scan
+         * @param state scan state, updated to the state after the bytes scanned
+         * @return number of bytes scanned up to and including the last byte of the earliest match, or -1 if no match
+         * ends in the given bytes
+         */
+        int64_t find_end(const omega_byte_t *data, int64_t length, lazy_dfa_t::state_t &state);
+
+        /**
+         * Finds every position in the data where a match that ends within the data starts
+         * @param data bytes to scan (backwards, from the end)
+         * @param length number of bytes
+         * @param starts set to the start positions found, in descending order
+         */
+        void find_starts(const omega_byte_t *data, int64_t length, std::vector<int64_t> &starts);
+
+        /**
+         * Gets the longest match starting at the first byte of the data
+         * @param data bytes to match
+         * @param length number of bytes available
+         * @param scanned set to the number of bytes scanned
+         * @return length of the longest match, or zero if there is no match
+         */
+        int64_t longest_match(const omega_byte_t *data, int64_t length, int64_t &scanned);
+
+    private:
+        // Automata and byte classes compiled from the pattern, shared by the DFAs
+        struct program_t {
+            byte_nfa_t forward_nfa{};
+            byte_nfa_t reverse_nfa{};
+            uint16_t byte_classes[UCHAR_MAX + 1]{};
+            size_t class_count{};
+            int64_t min_length{};
+            int64_t max_length{};
+        };
+
+        static program_t compile_(const omega_byte_t *pattern, int64_t pattern_length, syntax_t syntax,
+                                  const omega_byte_t *fold_table, int64_t match_length_limit);
+
+        const program_t program_;
+        lazy_dfa_t forward_dfa_; ///< Finds where the earliest match ends
+        lazy_dfa_t reverse_dfa_; ///< Finds where matches start, scanning backwards
+        lazy_dfa_t anchored_dfa_;///< Finds the longest match at a given start
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_BYTE_REGEX_HPP
@@ -0,0 +1,57 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_BYTE_TRANSFORM_DEF_H
+#define OMEGA_EDIT_BYTE_TRANSFORM_DEF_H
+
+#include "../../include/omega_edit/utility.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Transform that rewrites a buffer of bytes in place, applied a chunk at a time when a file or session is transformed
+ */
+typedef void (*omega_util_buffer_transform_t)(omega_byte_t *buffer, int64_t len, const void *context_ptr);
+
+/**
+ * Context of omega_util_apply_byte_transform_context_, which adapts a per-byte transform to a buffer transform
+ */
+typedef struct {
+    omega_util_byte_transform_t transform;
+    void *user_data_ptr;
+} omega_util_byte_transform_context_t;
+
+/**
+ * Buffer transform applying the per-byte transform of its omega_util_byte_transform_context_t context
+ * @param buffer bytes to transform in place
+ * @param len number of bytes to transform
+ * @param context_ptr pointer to an omega_util_byte_transform_context_t
+ */
+void omega_util_apply_byte_transform_context_(omega_byte_t *buffer, int64_t len, const void *context_ptr);
+
+/**
+ * Buffer transform mapping each byte through the 256-entry byte table that is its context
+ * @param buffer bytes to transform in place
+ * @param len number of bytes to transform
+ * @param context_ptr pointer to a 256-entry omega_byte_t table
+ */
+void omega_util_apply_byte_table_context_(omega_byte_t *buffer, int64_t len, const void *context_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif//OMEGA_EDIT_BYTE_TRANSFORM_DEF_H
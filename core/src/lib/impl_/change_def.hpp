@@ -39,9 +39,15 @@ namespace omega_edit::internal {
         int64_t uncompressed_length{};
     };
 
-    int omega_payload_compress_file_(omega_byte_payload_struct *payload);
+    class payload_block_cache_t;
+    struct payload_compression_job_t;
+
+    int omega_payload_compress_file_(omega_byte_payload_struct *payload,
+                                     const std::shared_ptr<payload_block_cache_t> &block_cache);
     int omega_payload_read_file_(const omega_byte_payload_struct *payload, int64_t offset, omega_byte_t *buffer,
                                  int64_t byte_count);
+    void omega_payload_wait_for_compression_(const omega_byte_payload_struct *payload);
+    void omega_payload_release_(omega_byte_payload_struct *payload);
 
 }// namespace omega_edit::internal
 
@@ -52,6 +58,7 @@ struct omega_byte_payload_struct {
     ~omega_byte_payload_struct() { reset(); }
 
     void reset() {
+        omega_edit::internal::omega_payload_release_(this);
         if (storage == OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED && !file_path.empty()) {
             omega_util_remove_file(file_path.c_str());
         }
@@ -60,7 +67,6 @@ struct omega_byte_payload_struct {
         length = 0;
         storage = OMEGA_CHANGE_DATA_STORAGE_NONE;
         file_path.clear();
-        compressed_blocks.clear();
     }
 
     omega_byte_payload_struct() = default;
@@ -82,7 +88,9 @@ struct omega_byte_payload_struct {
     int64_t length{};
     omega_change_data_storage_t storage{OMEGA_CHANGE_DATA_STORAGE_NONE};
     std::string file_path{};
-    std::vector<omega_edit::internal::compressed_payload_block_t> compressed_blocks{};
+    std::shared_ptr<omega_edit::internal::payload_compression_job_t> compression{};///< Compresses the file
+    std::shared_ptr<omega_edit::internal::payload_block_cache_t> block_cache{};    ///< Cache the file is read through
+    uint64_t block_cache_id{};                                                     ///< Payload identifier in the cache
 
 private:
     void move_from_(omega_byte_payload_struct &&other) noexcept {
@@ -91,7 +99,10 @@ private:
         length = other.length;
         storage = other.storage;
         file_path.swap(other.file_path);
-        compressed_blocks = std::move(other.compressed_blocks);
+        compression = std::move(other.compression);
+        block_cache = std::move(other.block_cache);
+        block_cache_id = other.block_cache_id;
+        other.block_cache_id = 0;
         other.length = 0;
         other.storage = OMEGA_CHANGE_DATA_STORAGE_NONE;
         other.file_path.clear();
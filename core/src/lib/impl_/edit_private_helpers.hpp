@@ -98,7 +98,8 @@ namespace omega_edit::internal {
     }
 
     inline auto del_(int64_t serial, int64_t offset, int64_t length, std::string deleted_bytes_file_path,
-                     int64_t deleted_byte_count, bool transaction_bit) -> const_omega_change_ptr_t {
+                     int64_t deleted_byte_count, bool transaction_bit,
+                     const std::shared_ptr<payload_block_cache_t> &block_cache) -> const_omega_change_ptr_t {
         auto change_ptr = del_(serial, offset, length, transaction_bit);
         if (!change_ptr) {
             if (!deleted_bytes_file_path.empty()) { omega_util_remove_file(deleted_bytes_file_path.c_str()); }
@@ -110,7 +111,7 @@ namespace omega_edit::internal {
             if (!deleted_bytes_file_path.empty()) { omega_util_remove_file(deleted_bytes_file_path.c_str()); }
             return nullptr;
         }
-        if (omega_payload_compress_file_(&change_ptr->data) != 0) { return nullptr; }
+        if (omega_payload_compress_file_(&change_ptr->data, block_cache) != 0) { return nullptr; }
         return change_ptr;
     }
 
@@ -203,8 +204,8 @@ namespace omega_edit::internal {
     }
 
     inline auto ovr_(int64_t serial, int64_t offset, const omega_byte_t *bytes, int64_t length,
-                     std::string replaced_bytes_file_path, int64_t replaced_length,
-                     bool transaction_bit) -> const_omega_change_ptr_t {
+                     std::string replaced_bytes_file_path, int64_t replaced_length, bool transaction_bit,
+                     const std::shared_ptr<payload_block_cache_t> &block_cache) -> const_omega_change_ptr_t {
         auto change_ptr = ovr_(serial, offset, bytes, length, nullptr, 0, transaction_bit);
         if (!change_ptr) {
             if (!replaced_bytes_file_path.empty()) { omega_util_remove_file(replaced_bytes_file_path.c_str()); }
@@ -216,7 +217,9 @@ namespace omega_edit::internal {
             if (!replaced_bytes_file_path.empty()) { omega_util_remove_file(replaced_bytes_file_path.c_str()); }
             return nullptr;
         }
-        if (replaced_length > 0 && omega_payload_compress_file_(&change_ptr->inverse_data) != 0) { return nullptr; }
+        if (replaced_length > 0 && omega_payload_compress_file_(&change_ptr->inverse_data, block_cache) != 0) {
+            return nullptr;
+        }
         return change_ptr;
     }
 
@@ -367,21 +370,26 @@ namespace omega_edit::internal {
         }
     }
 
-    inline omega_byte_t apply_builtin_transform_(omega_byte_t byte, void *user_data_ptr) {
-        const auto *const transform_ptr = reinterpret_cast<const omega_edit_transform_t *>(user_data_ptr);
+    inline void apply_builtin_transform_(omega_byte_t *buffer, int64_t len, const void *context_ptr) {
+        const auto *const transform_ptr = static_cast<const omega_edit_transform_t *>(context_ptr);
         switch (transform_ptr->kind) {
             case OMEGA_EDIT_TRANSFORM_ASCII_TO_UPPER:
-                return (byte >= 'a' && byte <= 'z') ? static_cast<omega_byte_t>(byte - ('a' - 'A')) : byte;
+                omega_util_ascii_to_upper(buffer, len);
+                break;
             case OMEGA_EDIT_TRANSFORM_ASCII_TO_LOWER:
-                return (byte >= 'A' && byte <= 'Z') ? static_cast<omega_byte_t>(byte + ('a' - 'A')) : byte;
+                omega_util_ascii_to_lower(buffer, len);
+                break;
             case OMEGA_EDIT_TRANSFORM_BITWISE_AND:
-                return omega_util_mask_byte(byte, transform_ptr->operand, MASK_AND);
+                omega_util_apply_mask(buffer, len, transform_ptr->operand, MASK_AND);
+                break;
             case OMEGA_EDIT_TRANSFORM_BITWISE_OR:
-                return omega_util_mask_byte(byte, transform_ptr->operand, MASK_OR);
+                omega_util_apply_mask(buffer, len, transform_ptr->operand, MASK_OR);
+                break;
             case OMEGA_EDIT_TRANSFORM_BITWISE_XOR:
-                return omega_util_mask_byte(byte, transform_ptr->operand, MASK_XOR);
+                omega_util_apply_mask(buffer, len, transform_ptr->operand, MASK_XOR);
+                break;
             default:
-                return byte;
+                break;
         }
     }
 
@@ -0,0 +1,96 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "file_map.hpp"
+#include "../../include/omega_edit/config.h"
+
+#ifdef OMEGA_BUILD_WINDOWS
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace omega_edit::internal {
+
+    bool file_map_t::map(FILE *file_ptr) noexcept {
+        unmap();
+        if (!file_ptr || OMEGA_FILE_MAP_LENGTH_LIMIT <= 0) { return false; }
+#ifdef OMEGA_BUILD_WINDOWS
+        const auto file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file_ptr)));
+        if (file_handle == INVALID_HANDLE_VALUE) { return false; }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart <= 0 ||
+            OMEGA_FILE_MAP_LENGTH_LIMIT < file_size.QuadPart ||
+            static_cast<uint64_t>(file_size.QuadPart) > static_cast<uint64_t>(SIZE_MAX)) {
+            return false;
+        }
+        const auto mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_handle) { return false; }
+        // The view keeps the mapping alive after its handle is closed
+        auto *const view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping_handle);
+        if (!view) { return false; }
+        data_ = static_cast<omega_byte_t *>(view);
+        length_ = file_size.QuadPart;
+#else
+        const auto fd = fileno(file_ptr);
+        struct stat file_stat {};
+        if (fd < 0 || fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0 ||
+            OMEGA_FILE_MAP_LENGTH_LIMIT < file_stat.st_size ||
+            static_cast<uint64_t>(file_stat.st_size) > static_cast<uint64_t>(SIZE_MAX)) {
+            return false;
+        }
+        auto *const view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) { return false; }
+        data_ = static_cast<omega_byte_t *>(view);
+        length_ = static_cast<int64_t>(file_stat.st_size);
+#endif
+        return true;
+    }
+
+    void file_map_t::unmap() noexcept {
+        if (!data_) { return; }
+#ifdef OMEGA_BUILD_WINDOWS
+        UnmapViewOfFile(data_);
+#else
+        munmap(data_, static_cast<size_t>(length_));
+#endif
+        data_ = nullptr;
+        length_ = 0;
+    }
+
+    const omega_byte_t *file_map_t::data(int64_t offset, int64_t length) const noexcept {
+        if (!data_ || offset < 0 || length < 0 || length_ - offset < length) { return nullptr; }
+        if (OMEGA_FILE_MAP_SEQUENTIAL_LENGTH <= length) { advise_sequential_(offset, length); }
+        return data_ + offset;
+    }
+
+    void file_map_t::advise_sequential_(int64_t offset, int64_t length) const noexcept {
+#ifdef OMEGA_BUILD_WINDOWS
+        (void) offset;
+        (void) length;
+#else
+        // Long reads are scans (searches, saves, counts, and profiles), so read ahead aggressively in the range and
+        // let the pages go early once they're read.  Hints are best-effort, so failures are ignored.
+        static const auto page_size = static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+        if (page_size <= 0) { return; }
+        const auto begin = offset - offset % page_size;
+        madvise(data_ + begin, static_cast<size_t>(offset + length - begin), MADV_SEQUENTIAL);
+#endif
+    }
+
+}// namespace omega_edit::internal
@@ -0,0 +1,76 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_FILE_MAP_HPP
+#define OMEGA_EDIT_FILE_MAP_HPP
+
+#include "../../include/omega_edit/byte.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace omega_edit::internal {
+
+    /**
+     * Read-only memory mapping of a whole file that a model reads from.  Reads from a mapped file are plain memory
+     * copies, or no copies at all for callers that can borrow the mapped bytes, rather than a seek and an fread through
+     * stdio.  A file that can't be mapped (empty, over OMEGA_FILE_MAP_LENGTH_LIMIT, or on a file system without mmap
+     * support) leaves the map empty, and callers fall back to regular reads.
+     *
+     * The mapped file must not be truncated while it's mapped, so only files private to the session are mapped.
+     */
+    class file_map_t {
+    public:
+        file_map_t() = default;
+        ~file_map_t() { unmap(); }
+
+        file_map_t(const file_map_t &) = delete;
+        auto operator=(const file_map_t &) -> file_map_t & = delete;
+
+        /**
+         * Maps the whole file, replacing any previous mapping
+         * @param file_ptr file open for reading
+         * @return true if the file is mapped, false if it's to be read with regular reads instead
+         */
+        bool map(FILE *file_ptr) noexcept;
+
+        /**
+         * Removes the mapping, if any
+         */
+        void unmap() noexcept;
+
+        /**
+         * Determines if a file is mapped
+         * @return true if a file is mapped
+         */
+        bool is_mapped() const { return data_ != nullptr; }
+
+        /**
+         * Gets the mapped bytes [offset, offset + length) of the file, hinting that they are about to be read in order
+         * when the range is long enough to be part of a scan
+         * @param offset offset in the file
+         * @param length number of bytes
+         * @return pointer to the mapped bytes, or nullptr if no file is mapped or the range isn't within the file
+         */
+        const omega_byte_t *data(int64_t offset, int64_t length) const noexcept;
+
+    private:
+        void advise_sequential_(int64_t offset, int64_t length) const noexcept;
+
+        omega_byte_t *data_{};
+        int64_t length_{};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_FILE_MAP_HPP
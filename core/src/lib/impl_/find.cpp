@@ -14,13 +14,38 @@
 
 #include "find.h"
 #include "omega_edit/utility.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <climits>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define OMEGA_FIND_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define OMEGA_FIND_TARGET_AVX2
+#define OMEGA_FIND_FLATTEN_AVX2
+#else
+#define OMEGA_FIND_TARGET_AVX2 __attribute__((target("avx2")))
+#define OMEGA_FIND_FLATTEN_AVX2 __attribute__((target("avx2"), flatten))
+#endif
+#endif
+
 struct omega_find_skip_table_t : public std::vector<std::ptrdiff_t> {
     int is_reverse_search;
+    int is_folded{};
+    // Non-zero if the candidate filter can be done with vector compares
+    int is_vectorizable{};
+    // Haystack bytes that match the first and last needle bytes (the same byte twice unless folding pairs them)
+    unsigned char first_bytes[2]{};
+    unsigned char last_bytes[2]{};
+    // Folded form of each haystack byte, used when is_folded is set
+    std::array<unsigned char, UCHAR_MAX + 1> fold_table{};
 
     omega_find_skip_table_t(std::ptrdiff_t vec_size, std::ptrdiff_t fill, int isReverse)
         : std::vector<std::ptrdiff_t>(vec_size, fill), is_reverse_search(isReverse) {}
@@ -31,20 +56,39 @@ int omega_find_is_reversed(const omega_find_skip_table_t *skip_table_ptr) {
     return skip_table_ptr->is_reverse_search;
 }
 
+/*
+ * Collects up to two haystack bytes that fold to the given needle byte, returning false if there are none or more than
+ * two, which the vector filter can't express.
+ */
+static bool collect_folded_bytes_(const omega_find_skip_table_t *skip_table_ptr, unsigned char needle_byte,
+                                  unsigned char (&bytes)[2]) {
+    auto count = 0;
+    for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+        if (skip_table_ptr->fold_table[byte] == needle_byte) {
+            if (count == 2) { return false; }
+            bytes[count++] = static_cast<unsigned char>(byte);
+        }
+    }
+    if (count == 1) { bytes[1] = bytes[0]; }
+    return count != 0;
+}
+
 /*
  * Function to create the skip table for Boyer-Moore searching algorithm. Depending on the direction of the search,
- * it creates a forward skip table or a reverse skip table.
+ * it creates a forward skip table or a reverse skip table.  When a fold table is given, the skip for each haystack
+ * byte is the skip of its folded form, so the search never has to rewrite the haystack.
  */
-const omega_find_skip_table_t *omega_find_create_skip_table(const unsigned char *needle, size_t needle_length,
-                                                            int is_reverse_search) {
+const omega_find_skip_table_t *omega_find_create_folded_skip_table(const unsigned char *needle, size_t needle_length,
+                                                                   int is_reverse_search,
+                                                                   const unsigned char *fold_table) {
     assert(needle);
     assert(needle_length > 0);
 
     // Ensure that is_reverse_search is 0 or 1.
     is_reverse_search = is_reverse_search != 0 ? 1 : 0;
 
-    // Create a new skip table with size based on the needle length.
-    auto *skip_table_ptr = new omega_find_skip_table_t(needle_length == 1 ? 0 : UCHAR_MAX + 1,
+    // Create a new skip table with size based on the needle length, folded single byte needles still need the table.
+    auto *skip_table_ptr = new omega_find_skip_table_t(needle_length == 1 && !fold_table ? 0 : UCHAR_MAX + 1,
                                                        static_cast<std::ptrdiff_t>(needle_length), is_reverse_search);
     assert(skip_table_ptr);
 
@@ -66,13 +110,255 @@ const omega_find_skip_table_t *omega_find_create_skip_table(const unsigned char
         }
     }
 
+    const auto first_byte = needle[0];
+    const auto last_byte = needle[needle_length - 1];
+    if (fold_table) {
+        skip_table_ptr->is_folded = 1;
+        std::memcpy(skip_table_ptr->fold_table.data(), fold_table, skip_table_ptr->fold_table.size());
+        // Index the skips by haystack byte rather than folded byte
+        std::array<std::ptrdiff_t, UCHAR_MAX + 1> folded_skips{};
+        std::copy(skip_table_ptr->begin(), skip_table_ptr->end(), folded_skips.begin());
+        for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+            (*skip_table_ptr)[byte] = folded_skips[skip_table_ptr->fold_table[byte]];
+        }
+        skip_table_ptr->is_vectorizable =
+                collect_folded_bytes_(skip_table_ptr, first_byte, skip_table_ptr->first_bytes) &&
+                collect_folded_bytes_(skip_table_ptr, last_byte, skip_table_ptr->last_bytes);
+    } else {
+        skip_table_ptr->is_vectorizable = 1;
+        skip_table_ptr->first_bytes[0] = skip_table_ptr->first_bytes[1] = first_byte;
+        skip_table_ptr->last_bytes[0] = skip_table_ptr->last_bytes[1] = last_byte;
+    }
+
     return skip_table_ptr;
 }
 
+const omega_find_skip_table_t *omega_find_create_skip_table(const unsigned char *needle, size_t needle_length,
+                                                            int is_reverse_search) {
+    return omega_find_create_folded_skip_table(needle, needle_length, is_reverse_search, nullptr);
+}
+
+namespace {
+    // Compares needle bytes [begin, end) against the probe, folding the probe bytes if the table is folded
+    template<bool is_folded>
+    inline bool matches_(const omega_find_skip_table_t *skip_table_ptr, const unsigned char *probe,
+                         const unsigned char *needle, size_t begin, size_t end) {
+        if (!is_folded) { return std::memcmp(probe + begin, needle + begin, end - begin) == 0; }
+        for (auto i = begin; i < end; ++i) {
+            if (skip_table_ptr->fold_table[probe[i]] != needle[i]) { return false; }
+        }
+        return true;
+    }
+
+    /*
+     * Boyer-Moore-Horspool with additional tuning (https://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.14.7176)
+     * It can handle both forward and reverse searches.  The needle fits in the haystack, and is at least 2 bytes
+     * unless the table is folded.
+     */
+    template<bool is_folded>
+    const unsigned char *find_scalar_(const unsigned char *haystack, size_t haystack_length,
+                                      const omega_find_skip_table_t *skip_table_ptr, const unsigned char *needle,
+                                      size_t needle_length) {
+        const auto needle_length_minus_1 = needle_length - 1;
+        const auto last_needle_char = skip_table_ptr->is_reverse_search ? needle[0] : needle[needle_length_minus_1];
+        std::ptrdiff_t haystack_position =
+                skip_table_ptr->is_reverse_search ? static_cast<std::ptrdiff_t>(haystack_length - needle_length) : 0;
+
+        while (skip_table_ptr->is_reverse_search ? haystack_position >= 0
+                                                 : haystack_position <= haystack_length - needle_length) {
+            const auto skip =
+                    haystack[haystack_position + (skip_table_ptr->is_reverse_search ? 0 : needle_length_minus_1)];
+
+            if (const auto probe = haystack + haystack_position;
+                last_needle_char == (is_folded ? skip_table_ptr->fold_table[skip] : skip) &&
+                matches_<is_folded>(skip_table_ptr, probe, needle, 0, needle_length)) {
+                return probe;
+            }
+
+            haystack_position +=
+                    skip_table_ptr->is_reverse_search ? -(*skip_table_ptr)[skip] : (*skip_table_ptr)[skip];
+        }
+
+        return nullptr;
+    }
+
+#ifdef OMEGA_FIND_X86
+    inline unsigned lowest_bit_(uint32_t mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    inline unsigned highest_bit_(uint32_t mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return 31U - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+    }
+
+    /*
+     * Vector search (http://0x80.pl/articles/simd-strfind.html): compare a block of candidate positions against the
+     * first and last needle bytes at once, and only verify the interior of the needle at positions where both match.
+     * Whatever positions don't fill a whole block are handed to the scalar search.
+     */
+    template<typename vector_ops_t, bool is_folded>
+    inline const unsigned char *find_vector_(const unsigned char *haystack, size_t haystack_length,
+                                             const omega_find_skip_table_t *skip_table_ptr,
+                                             const unsigned char *needle, size_t needle_length) {
+        constexpr auto block_size = vector_ops_t::block_size;
+        const auto needle_length_minus_1 = needle_length - 1;
+        const vector_ops_t ops(skip_table_ptr->first_bytes, skip_table_ptr->last_bytes);
+        const auto candidate_mask = [&](const unsigned char *block) {
+            return ops.template match_mask<is_folded>(block, block + needle_length_minus_1);
+        };
+        const auto is_match = [&](const unsigned char *probe) {
+            return needle_length < 3 ||
+                   matches_<is_folded>(skip_table_ptr, probe, needle, 1, needle_length_minus_1);
+        };
+
+        // Number of positions where the needle could start
+        const auto position_count = haystack_length - needle_length_minus_1;
+        if (skip_table_ptr->is_reverse_search) {
+            auto remaining = position_count;
+            for (; remaining >= block_size; remaining -= block_size) {
+                const auto *block = haystack + remaining - block_size;
+                for (auto mask = candidate_mask(block); mask != 0;) {
+                    const auto bit = highest_bit_(mask);
+                    if (is_match(block + bit)) { return block + bit; }
+                    mask &= ~(1U << bit);
+                }
+            }
+            return remaining == 0 ? nullptr
+                                  : find_scalar_<is_folded>(haystack, remaining + needle_length_minus_1,
+                                                            skip_table_ptr, needle, needle_length);
+        }
+        size_t position = 0;
+        for (; position + block_size <= position_count; position += block_size) {
+            const auto *block = haystack + position;
+            for (auto mask = candidate_mask(block); mask != 0; mask &= mask - 1) {
+                if (const auto *probe = block + lowest_bit_(mask); is_match(probe)) { return probe; }
+            }
+        }
+        return position == position_count ? nullptr
+                                          : find_scalar_<is_folded>(haystack + position, haystack_length - position,
+                                                                    skip_table_ptr, needle, needle_length);
+    }
+
+    // Case folded tables compare each position against both haystack bytes that fold to the needle byte
+    struct sse2_ops_t {
+        static constexpr size_t block_size = 16;
+        __m128i first[2];
+        __m128i last[2];
+
+        sse2_ops_t(const unsigned char (&first_bytes)[2], const unsigned char (&last_bytes)[2])
+            : first{_mm_set1_epi8(static_cast<char>(first_bytes[0])), _mm_set1_epi8(static_cast<char>(first_bytes[1]))},
+              last{_mm_set1_epi8(static_cast<char>(last_bytes[0])), _mm_set1_epi8(static_cast<char>(last_bytes[1]))} {}
+
+        template<bool is_folded>
+        uint32_t match_mask(const unsigned char *first_block, const unsigned char *last_block) const {
+            const auto first_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first_block));
+            const auto last_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(last_block));
+            auto first_eq = _mm_cmpeq_epi8(first[0], first_data);
+            auto last_eq = _mm_cmpeq_epi8(last[0], last_data);
+            if (is_folded) {
+                first_eq = _mm_or_si128(first_eq, _mm_cmpeq_epi8(first[1], first_data));
+                last_eq = _mm_or_si128(last_eq, _mm_cmpeq_epi8(last[1], last_data));
+            }
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(first_eq, last_eq)));
+        }
+    };
+
+    struct avx2_ops_t {
+        static constexpr size_t block_size = 32;
+        __m256i first[2];
+        __m256i last[2];
+
+        OMEGA_FIND_TARGET_AVX2 avx2_ops_t(const unsigned char (&first_bytes)[2], const unsigned char (&last_bytes)[2])
+            : first{_mm256_set1_epi8(static_cast<char>(first_bytes[0])),
+                    _mm256_set1_epi8(static_cast<char>(first_bytes[1]))},
+              last{_mm256_set1_epi8(static_cast<char>(last_bytes[0])),
+                   _mm256_set1_epi8(static_cast<char>(last_bytes[1]))} {}
+
+        template<bool is_folded>
+        OMEGA_FIND_TARGET_AVX2 uint32_t match_mask(const unsigned char *first_block,
+                                                   const unsigned char *last_block) const {
+            const auto first_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first_block));
+            const auto last_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(last_block));
+            auto first_eq = _mm256_cmpeq_epi8(first[0], first_data);
+            auto last_eq = _mm256_cmpeq_epi8(last[0], last_data);
+            if (is_folded) {
+                first_eq = _mm256_or_si256(first_eq, _mm256_cmpeq_epi8(first[1], first_data));
+                last_eq = _mm256_or_si256(last_eq, _mm256_cmpeq_epi8(last[1], last_data));
+            }
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(first_eq, last_eq)));
+        }
+    };
+
+    template<bool is_folded>
+    const unsigned char *find_sse2_(const unsigned char *haystack, size_t haystack_length,
+                                    const omega_find_skip_table_t *skip_table_ptr, const unsigned char *needle,
+                                    size_t needle_length) {
+        return find_vector_<sse2_ops_t, is_folded>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+    }
+
+    // Flattened so the generic vector search is compiled for AVX2 along with the operations it calls
+    template<bool is_folded>
+    OMEGA_FIND_FLATTEN_AVX2 const unsigned char *find_avx2_(const unsigned char *haystack, size_t haystack_length,
+                                                            const omega_find_skip_table_t *skip_table_ptr,
+                                                            const unsigned char *needle, size_t needle_length) {
+        return find_vector_<avx2_ops_t, is_folded>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+    }
+
+    bool cpu_supports_avx2_() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) { return false; }
+        __cpuid(info, 1);
+        // The OS must save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2)
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) { return false; }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+
+    omega_find_isa_t best_supported_isa_() {
+#ifdef OMEGA_FIND_X86
+        static const auto best_isa = cpu_supports_avx2_() ? OMEGA_FIND_ISA_AVX2 : OMEGA_FIND_ISA_SSE2;
+        return best_isa;
+#else
+        return OMEGA_FIND_ISA_SCALAR;
+#endif
+    }
+
+    std::atomic<int> selected_isa_{-1};
+}// namespace
+
+omega_find_isa_t omega_find_get_isa() {
+    const auto isa = selected_isa_.load(std::memory_order_relaxed);
+    return isa < 0 ? best_supported_isa_() : static_cast<omega_find_isa_t>(isa);
+}
+
+omega_find_isa_t omega_find_set_isa(omega_find_isa_t isa) {
+    const auto best_isa = best_supported_isa_();
+    if (isa < OMEGA_FIND_ISA_SCALAR || isa > best_isa) { isa = best_isa; }
+    selected_isa_.store(isa, std::memory_order_relaxed);
+    return isa;
+}
 
 /*
- * Boyer-Moore-Horspool with additional tuning (https://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.14.7176)
- * It can handle both forward and reverse searches.
+ * Finds the needle in the haystack.  Single byte needles use memchr/memrchr, and longer or case folded needles use the
+ * vector search selected for the running CPU, falling back to the Boyer-Moore-Horspool search.
  */
 const unsigned char *omega_find(const unsigned char *haystack, size_t haystack_length,
                                 const omega_find_skip_table_t *skip_table_ptr, const unsigned char *needle,
@@ -85,36 +371,41 @@ const unsigned char *omega_find(const unsigned char *haystack, size_t haystack_l
     // If the pattern is longer than the text, it can't be found
     if (needle_length > haystack_length) { return nullptr; }
 
-    // If the needle is a single character, use memchr/memrchr instead of the skip table.
-    if (needle_length == 1) {
+    // If the needle is a single character that only one haystack byte matches, use memchr/memrchr instead of the
+    // skip table.
+    if (needle_length == 1 && skip_table_ptr->first_bytes[0] == skip_table_ptr->first_bytes[1] &&
+        skip_table_ptr->is_vectorizable) {
+        const auto byte = skip_table_ptr->first_bytes[0];
         return skip_table_ptr->is_reverse_search
-                       ? (const unsigned char *) omega_util_memrchr(haystack, *needle, haystack_length)
-                       : (const unsigned char *) std::memchr(haystack, *needle, haystack_length);
+                       ? (const unsigned char *) omega_util_memrchr(haystack, byte, haystack_length)
+                       : (const unsigned char *) std::memchr(haystack, byte, haystack_length);
     }
 
-    assert(skip_table_ptr);
-
-    const auto needle_length_minus_1 = needle_length - 1;
-    const auto last_needle_char = skip_table_ptr->is_reverse_search ? needle[0] : needle[needle_length_minus_1];
-    std::ptrdiff_t haystack_position =
-            skip_table_ptr->is_reverse_search ? static_cast<std::ptrdiff_t>(haystack_length - needle_length) : 0;
-
-    while (skip_table_ptr->is_reverse_search ? haystack_position >= 0
-                                             : haystack_position <= haystack_length - needle_length) {
-        const auto skip = haystack[haystack_position + (skip_table_ptr->is_reverse_search ? 0 : needle_length_minus_1)];
-
-        if (const auto probe = haystack + haystack_position;
-            last_needle_char == skip && std::memcmp(needle, probe, needle_length) == 0) {
-            return probe;
+    const auto isa = skip_table_ptr->is_vectorizable ? omega_find_get_isa() : OMEGA_FIND_ISA_SCALAR;
+    if (skip_table_ptr->is_folded) {
+        switch (isa) {
+#ifdef OMEGA_FIND_X86
+            case OMEGA_FIND_ISA_AVX2:
+                return find_avx2_<true>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+            case OMEGA_FIND_ISA_SSE2:
+                return find_sse2_<true>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+#endif
+            default:
+                return find_scalar_<true>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
         }
-
-        haystack_position += skip_table_ptr->is_reverse_search ? -(*skip_table_ptr)[skip] : (*skip_table_ptr)[skip];
     }
-
-    return nullptr;
+    switch (isa) {
+#ifdef OMEGA_FIND_X86
+        case OMEGA_FIND_ISA_AVX2:
+            return find_avx2_<false>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+        case OMEGA_FIND_ISA_SSE2:
+            return find_sse2_<false>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+#endif
+        default:
+            return find_scalar_<false>(haystack, haystack_length, skip_table_ptr, needle, needle_length);
+    }
 }
 
-
 void omega_find_destroy_skip_table(const omega_find_skip_table_t *skip_table_ptr) {
     assert(skip_table_ptr);
     delete skip_table_ptr;
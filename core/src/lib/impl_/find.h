@@ -28,6 +28,29 @@ extern "C" {
 
 struct omega_find_skip_table_t;
 
+/**
+ * Instruction set used by omega_find to filter candidate positions for needles longer than one byte
+ */
+typedef enum {
+    OMEGA_FIND_ISA_SCALAR = 0,///< portable Boyer-Moore-Horspool
+    OMEGA_FIND_ISA_SSE2,      ///< 16-byte first and last byte filtering with verification
+    OMEGA_FIND_ISA_AVX2       ///< 32-byte first and last byte filtering with verification
+} omega_find_isa_t;
+
+/**
+ * Gets the instruction set omega_find is currently using, which defaults to the best one the running CPU supports
+ * @return instruction set omega_find is currently using
+ */
+omega_find_isa_t omega_find_get_isa(void);
+
+/**
+ * Selects the instruction set omega_find uses, clamped to what the running CPU supports (used for testing and
+ * benchmarking, this setting is process-wide)
+ * @param isa desired instruction set
+ * @return instruction set omega_find will use
+ */
+omega_find_isa_t omega_find_set_isa(omega_find_isa_t isa);
+
 /**
  * Preprocess the needle to create a skip table for use in the omega_find function
  * @param needle needle to process
@@ -38,6 +61,19 @@ struct omega_find_skip_table_t;
 const struct omega_find_skip_table_t *omega_find_create_skip_table(const unsigned char *needle, size_t needle_length,
                                                                    int is_reverse_search);
 
+/**
+ * Preprocess an already folded needle to create a skip table for case-insensitive use in the omega_find function
+ * @param needle folded needle to process
+ * @param needle_length length of the needle to process
+ * @param is_reverse_search non-zero if the search is to be done in reverse, zero otherwise
+ * @param fold_table table of UCHAR_MAX + 1 entries mapping each haystack byte to its folded form, or NULL to match
+ * bytes exactly
+ * @return skip table for use in the omega_find function
+ */
+const struct omega_find_skip_table_t *omega_find_create_folded_skip_table(const unsigned char *needle,
+                                                                          size_t needle_length, int is_reverse_search,
+                                                                          const unsigned char *fold_table);
+
 /**
  * Determines if the skip table is for a reverse search
  * @param skip_table_ptr skip table to check
@@ -50,7 +86,7 @@ int omega_find_is_reversed(const struct omega_find_skip_table_t *skip_table_ptr)
  * @param haystack haystack to search in
  * @param haystack_length length of haystack
  * @param skip_table_ptr skip table for this needle, created using the omega_find_create_skip_table function
- * @param needle needle to find
+ * @param needle needle to find, folded if the skip table was created with a fold table
  * @param needle_length length of needle to find
  * @return first offset in the haystack where the needle was found, or haystack length
  */
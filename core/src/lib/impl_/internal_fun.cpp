@@ -24,6 +24,8 @@
 #include "viewport_def.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <new>
 
 namespace omega_edit::internal {
 
@@ -41,13 +43,24 @@ namespace omega_edit::internal {
         return static_cast<int64_t>(fread(buffer, sizeof(omega_byte_t), capacity, from_file_ptr));
     }
 
+    bool model_file_is_unchanged_(const omega_model_t *model_ptr) noexcept {
+        const auto *copier_ptr = model_ptr->original_snapshot_copier_ptr;
+        return !copier_ptr || copier_ptr->source_is_unchanged();
+    }
+
     int populate_data_segment_(const omega_session_t *session_ptr, omega_segment_t *data_segment_ptr) noexcept {
         assert(session_ptr);
         assert(session_ptr->models_.back());
-        assert(data_segment_ptr);
         const auto &model_ptr = session_ptr->models_.back();
+        return populate_data_segment_(model_ptr.get(), model_ptr->model_segments, data_segment_ptr);
+    }
+
+    int populate_data_segment_(const omega_model_t *model_ptr, const model_segment_tree_t &model_segments,
+                               omega_segment_t *data_segment_ptr) noexcept {
+        assert(model_ptr);
+        assert(data_segment_ptr);
         data_segment_ptr->length = 0;
-        if (model_ptr->model_segments.empty()) { return 0; }
+        if (model_segments.empty()) { return 0; }
         assert(0 <= data_segment_ptr->capacity);
         const auto data_segment_capacity = data_segment_ptr->capacity;
         int64_t data_segment_offset = 0;
@@ -55,86 +68,128 @@ namespace omega_edit::internal {
             return -1;
         }
         if (data_segment_offset < 0) { return -1; }
-        // Binary search for the first segment that could contain data_segment_offset.
-        // Segments are contiguous and sorted by computed_offset, so upper_bound finds the first segment
-        // with computed_offset > data_segment_offset, and we step back one to get the containing segment.
-        auto iter = std::upper_bound(
-                model_ptr->model_segments.cbegin(), model_ptr->model_segments.cend(), data_segment_offset,
-                [](int64_t offset, const omega_model_segment_ptr_t &seg) { return offset < seg->computed_offset; });
-        if (iter != model_ptr->model_segments.cbegin()) { --iter; }
-
-        // Verify the found segment contains the target offset
-        int64_t segment_end = 0;
-        if (!safe_add_int64_((*iter)->computed_offset, (*iter)->computed_length, segment_end) ||
-            data_segment_offset < (*iter)->computed_offset || data_segment_offset > segment_end) {
-            return -1;
-        }
-
-        auto delta = data_segment_offset - (*iter)->computed_offset;
         const auto data_segment_buffer = omega_segment_get_data(data_segment_ptr);
-        do {
-            // This is how much data remains to be filled
-            const auto remaining_capacity = data_segment_capacity - data_segment_ptr->length;
-            auto amount = (*iter)->computed_length - delta;
-            amount = (amount > remaining_capacity) ? remaining_capacity : amount;
-            switch (omega_model_segment_get_kind_(iter->get())) {
-                case model_segment_kind_t::SEGMENT_READ: {
-                    // For read segments, we're reading a segment, or portion thereof, from the input file and
-                    // writing it into the data segment.
-                    // Coalesce with consecutive READ segments that are contiguous in the source file to reduce
-                    // the number of fread system calls.
-                    int64_t file_offset = 0;
-                    if (!safe_add_int64_((*iter)->change_offset, delta, file_offset)) { return -1; }
-                    auto coalesced = amount;
-                    auto peek = iter;
-                    while (coalesced < remaining_capacity && ++peek != model_ptr->model_segments.end() &&
-                           omega_model_segment_get_kind_(peek->get()) == model_segment_kind_t::SEGMENT_READ &&
-                           !add_overflows_int64_(file_offset, coalesced) &&
-                           (*peek)->change_offset == file_offset + coalesced) {
-                        const auto peek_amount = (std::min)(remaining_capacity - coalesced, (*peek)->computed_length);
-                        coalesced += peek_amount;
-                        // Only advance iter if we consumed the entire peek segment
-                        if (peek_amount == (*peek)->computed_length) {
-                            iter = peek;
-                        } else {
-                            break;
+        const auto computed_length = model_segments.computed_length();
+        if (data_segment_offset >= computed_length) {
+            // Reading at the very end of the model yields an empty segment, reading beyond it is an error
+            if (data_segment_offset > computed_length) { return -1; }
+            data_segment_buffer[0] = '\0';
+            return 0;
+        }
+        try {
+            // Descend the piece tree to the segment containing data_segment_offset, then walk forward in order
+            const auto end = model_segments.end();
+            auto iter = model_segments.find(data_segment_offset);
+            if (iter == end) { return -1; }
+            auto delta = data_segment_offset - iter.computed_offset();
+            while (data_segment_ptr->length < data_segment_capacity && iter != end) {
+                // This is how much data remains to be filled
+                const auto remaining_capacity = data_segment_capacity - data_segment_ptr->length;
+                auto amount = iter->computed_length - delta;
+                amount = (amount > remaining_capacity) ? remaining_capacity : amount;
+                switch (omega_model_segment_get_kind_(iter.change())) {
+                    case model_segment_kind_t::SEGMENT_READ: {
+                        // For read segments, we're reading a segment, or portion thereof, from the input file and
+                        // writing it into the data segment.
+                        // Coalesce with consecutive READ segments that are contiguous in the source file to reduce
+                        // the number of fread system calls.
+                        int64_t file_offset = 0;
+                        if (!safe_add_int64_(iter->change_offset, delta, file_offset)) { return -1; }
+                        auto coalesced = amount;
+                        ++iter;
+                        while (coalesced < remaining_capacity && iter != end &&
+                               omega_model_segment_get_kind_(iter.change()) == model_segment_kind_t::SEGMENT_READ &&
+                               !add_overflows_int64_(file_offset, coalesced) &&
+                               iter->change_offset == file_offset + coalesced) {
+                            // A partially consumed segment fills the data segment, which ends the walk
+                            coalesced += (std::min)(remaining_capacity - coalesced, iter->computed_length);
+                            ++iter;
                         }
+                        if (const auto *mapped = model_ptr->file_map.data(file_offset, coalesced)) {
+                            memcpy(data_segment_buffer + data_segment_ptr->length, mapped, coalesced);
+                        } else if (read_segment_from_file_(model_ptr->file_ptr, file_offset,
+                                                           data_segment_buffer + data_segment_ptr->length,
+                                                           coalesced) != coalesced ||
+                                   !model_file_is_unchanged_(model_ptr)) {
+                            return -1;
+                        }
+                        amount = coalesced;
+                        break;
                     }
-                    if (read_segment_from_file_(session_ptr->models_.back()->file_ptr, file_offset,
-                                                data_segment_buffer + data_segment_ptr->length,
-                                                coalesced) != coalesced) {
-                        return -1;
-                    }
-                    amount = coalesced;
-                    break;
-                }
-                case model_segment_kind_t::SEGMENT_INSERT: {
-                    // For insert segments, we're writing the change byte buffer, or portion thereof, into the data
-                    // segment
-                    int64_t change_offset = 0;
-                    if (!safe_add_int64_((*iter)->change_offset, delta, change_offset)) { return -1; }
-                    if (omega_change_copy_payload_bytes_((*iter)->change_ptr.get(), (*iter)->payload_role,
-                                                         change_offset, data_segment_buffer + data_segment_ptr->length,
-                                                         amount) != 0) {
-                        return -1;
+                    case model_segment_kind_t::SEGMENT_INSERT: {
+                        // For insert segments, we're writing the change byte buffer, or portion thereof, into the data
+                        // segment
+                        int64_t change_offset = 0;
+                        if (!safe_add_int64_(iter->change_offset, delta, change_offset)) { return -1; }
+                        if (omega_change_copy_payload_bytes_(iter.change(), iter->payload_role, change_offset,
+                                                             data_segment_buffer + data_segment_ptr->length,
+                                                             amount) != 0) {
+                            return -1;
+                        }
+                        ++iter;
+                        break;
                     }
-                    break;
+                    default:
+                        ABORT(LOG_ERROR("Unhandled model segment kind"););
                 }
-                default:
-                    ABORT(LOG_ERROR("Unhandled model segment kind"););
+                // Add the amount written to the data segment length
+                if (!safe_add_int64_(data_segment_ptr->length, amount, data_segment_ptr->length)) { return -1; }
+                // After the first segment is written, the delta should be zero from that point on
+                delta = 0;
+                // Keep writing segments until we run out of viewport capacity or run out of segments
             }
-            // Add the amount written to the data segment length
-            if (!safe_add_int64_(data_segment_ptr->length, amount, data_segment_ptr->length)) { return -1; }
-            // After the first segment is written, the delta should be zero from that point on
-            delta = 0;
-            // Keep writing segments until we run out of viewport capacity or run out of segments
-        } while (data_segment_ptr->length < data_segment_capacity && ++iter != model_ptr->model_segments.end());
+        } catch (const std::bad_alloc &) { return -1; }
         assert(data_segment_ptr->length <= data_segment_capacity);
         // data segment buffer allocation is its capacity plus one, so we can null-terminate it
         data_segment_buffer[data_segment_ptr->length] = '\0';
         return 0;
     }
 
+    const omega_byte_t *borrow_data_segment_(const omega_model_t *model_ptr, const model_segment_tree_t &model_segments,
+                                             omega_segment_t *data_segment_ptr) noexcept {
+        assert(model_ptr);
+        assert(data_segment_ptr);
+        int64_t data_segment_offset = 0;
+        if (0 < data_segment_ptr->capacity &&
+            safe_add_int64_(data_segment_ptr->offset, data_segment_ptr->offset_adjustment, data_segment_offset) &&
+            0 <= data_segment_offset && data_segment_offset < model_segments.computed_length()) {
+            const auto length =
+                    (std::min)(data_segment_ptr->capacity, model_segments.computed_length() - data_segment_offset);
+            try {
+                const auto end = model_segments.end();
+                auto iter = model_segments.find(data_segment_offset);
+                if (iter == end) { return nullptr; }
+                const auto delta = data_segment_offset - iter.computed_offset();
+                const omega_byte_t *borrowed = nullptr;
+                if (omega_model_segment_get_kind_(iter.change()) == model_segment_kind_t::SEGMENT_READ) {
+                    if (model_ptr->file_map.is_mapped()) {
+                        // Extend the run through the following read segments that are contiguous in the file
+                        const auto file_offset = iter->change_offset + delta;
+                        auto run_length = iter->computed_length - delta;
+                        for (++iter;
+                             run_length < length && iter != end &&
+                             omega_model_segment_get_kind_(iter.change()) == model_segment_kind_t::SEGMENT_READ &&
+                             iter->change_offset == file_offset + run_length;
+                             ++iter) {
+                            run_length += iter->computed_length;
+                        }
+                        if (length <= run_length) { borrowed = model_ptr->file_map.data(file_offset, length); }
+                    }
+                } else if (length <= iter->computed_length - delta) {
+                    // Inserted bytes kept inline in the change can be borrowed too, file backed ones can't
+                    const auto *bytes = omega_change_get_inline_payload_bytes_(iter.change(), iter->payload_role);
+                    if (bytes) { borrowed = bytes + iter->change_offset + delta; }
+                }
+                if (borrowed) {
+                    data_segment_ptr->length = length;
+                    return borrowed;
+                }
+            } catch (const std::bad_alloc &) { return nullptr; }
+        }
+        if (populate_data_segment_(model_ptr, model_segments, data_segment_ptr) != 0) { return nullptr; }
+        return omega_segment_get_data(data_segment_ptr);
+    }
+
     /**********************************************************************************************************************
  * Model segment functions
  **********************************************************************************************************************/
@@ -151,20 +206,24 @@ namespace omega_edit::internal {
         out_stream << "}";
     }
 
-    static inline void print_model_segment_(const omega_model_segment_ptr_t &segment_ptr,
-                                            std::ostream &out_stream) noexcept {
-        out_stream << R"({"kind": ")"
-                   << omega_model_segment_kind_as_char_(omega_model_segment_get_kind_(segment_ptr.get()))
-                   << R"(", "computed_offset": )" << segment_ptr->computed_offset << R"(, "computed_length": )"
-                   << segment_ptr->computed_length << R"(, "change_offset": )" << segment_ptr->change_offset
+    static inline void print_model_segment_(const omega_model_segment_t &segment, const omega_change_t *change_ptr,
+                                            int64_t computed_offset, std::ostream &out_stream) noexcept {
+        out_stream << R"({"kind": ")" << omega_model_segment_kind_as_char_(omega_model_segment_get_kind_(change_ptr))
+                   << R"(", "computed_offset": )" << computed_offset << R"(, "computed_length": )"
+                   << segment.computed_length << R"(, "change_offset": )" << segment.change_offset
                    << R"(, "change": )";
-        print_change_(segment_ptr->change_ptr.get(), out_stream);
+        print_change_(change_ptr, out_stream);
         out_stream << "}" << std::endl;
     }
 
     void print_model_segments_(const omega_model_t *model_ptr, std::ostream &out_stream) noexcept {
         assert(model_ptr);
-        for (const auto &segment : model_ptr->model_segments) { print_model_segment_(segment, out_stream); }
+        try {
+            const auto end = model_ptr->model_segments.end();
+            for (auto iter = model_ptr->model_segments.begin(); iter != end; ++iter) {
+                print_model_segment_(*iter, iter.change(), iter.computed_offset(), out_stream);
+            }
+        } catch (const std::bad_alloc &) { out_stream << "<out of memory>" << std::endl; }
     }
 
 }// namespace omega_edit::internal
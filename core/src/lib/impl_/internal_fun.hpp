@@ -22,11 +22,27 @@
 
 namespace omega_edit::internal {
 
+    class model_segment_tree_t;
+
     // Data segment functions
     int populate_data_segment_(const omega_session_t *session_ptr, omega_segment_t *data_segment_ptr)
 
             noexcept;
 
+    // Populates the data segment from the given segments of the model, rather than the session's current content
+    int populate_data_segment_(const omega_model_t *model_ptr, const model_segment_tree_t &model_segments,
+                               omega_segment_t *data_segment_ptr) noexcept;
+
+    // Gets the data segment's bytes, borrowed from the model's mapped file if they all lie in one run of it, or from a
+    // change's inline payload if they all lie in one inserted segment, else read into the data segment.  Sets the data
+    // segment length, and returns nullptr on failure.
+    const omega_byte_t *borrow_data_segment_(const omega_model_t *model_ptr, const model_segment_tree_t &model_segments,
+                                             omega_segment_t *data_segment_ptr) noexcept;
+
+    // Determines if bytes read from the model's file can be trusted, which is false once another process has changed a
+    // file the model reads in place (the original file of a session whose lazy snapshot is pending)
+    bool model_file_is_unchanged_(const omega_model_t *model_ptr) noexcept;
+
     // Model segment functions
     void print_model_segments_(const omega_model_t *model_ptr, std::ostream &out_stream)
 
@@ -15,26 +15,34 @@
 #ifndef OMEGA_EDIT_MODEL_DEF_HPP
 #define OMEGA_EDIT_MODEL_DEF_HPP
 
+#include "file_map.hpp"
 #include "internal_fwd_defs.hpp"
 #include "model_segment_def.hpp"
+#include "model_segment_tree.hpp"
+#include "original_snapshot.hpp"
 #include <cstdio>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
-using omega_model_segment_ptr_t = std::unique_ptr<omega_model_segment_t>;
-using omega_model_segments_t = std::vector<omega_model_segment_ptr_t>;
+using omega_model_segment_pool_t = omega_edit::internal::model_segment_pool_t;
+using omega_model_segments_t = omega_edit::internal::model_segment_tree_t;
 using omega_changes_t = std::vector<const_omega_change_ptr_t>;
 
 struct omega_model_struct {
     FILE *file_ptr{};                       ///< File being edited (open for read)
+    omega_edit::internal::file_map_t file_map{};///< Memory mapping of the file being edited, if it could be mapped
     std::string file_path{};                ///< File path being edited
     int64_t change_serial_base{};           ///< Number of active changes before this model
     omega_changes_t changes{};              ///< Collection of changes for this session, ordered by time
     omega_changes_t changes_undone{};       ///< Undone changes that are eligible for being redone
-    omega_model_segments_t model_segments{};///< Model segment vector
+    omega_model_segment_pool_t segment_pool{};///< Node and change storage shared by the trees below (declared first)
+    omega_model_segments_t model_segments{&segment_pool};///< Model segment piece tree
     std::map<int64_t, omega_model_segments_t> model_snapshots{};///< Periodic model snapshots for fast undo
+    std::map<uint64_t, omega_model_segments_t> pinned_segments{};///< Content pinned by search contexts, by pin id
+    /// Copier of the session's pending lazy snapshot, while this model reads the original file it's copying
+    const omega_edit::internal::snapshot_copier_t *original_snapshot_copier_ptr{};
 };
 
 #endif//OMEGA_EDIT_MODEL_DEF_HPP
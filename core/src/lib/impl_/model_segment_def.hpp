@@ -17,6 +17,7 @@
 
 #include "../../include/omega_edit/change.h"
 #include "internal_fwd_defs.hpp"
+#include <cstdint>
 
 namespace omega_edit::internal {
 
@@ -26,17 +27,21 @@ namespace omega_edit::internal {
 
 // NOTE: omega_model_segment_struct is used in internal_fwd_defs.hpp despite what sonarlint says
 struct omega_model_segment_struct {
-    int64_t computed_offset{};            ///< Computed offset can differ from the change as segments move and split
-    int64_t computed_length{};            ///< Computed length can differ from the change as segments split
-    int64_t change_offset{};              ///< Change offset is the offset in the change due to a split
-    const_omega_change_ptr_t change_ptr{};///< Reference to parent change
+    int64_t computed_length{};///< Computed length can differ from the change as segments split
+    int64_t change_offset{};  ///< Change offset is the offset in the change due to a split
+    uint32_t change_index{};  ///< Index of the parent change in the model segment pool's change table
     omega_change_payload_role_t payload_role{OMEGA_CHANGE_PAYLOAD_DATA};
 };
 
 namespace omega_edit::internal {
 
-    inline model_segment_kind_t omega_model_segment_get_kind_(const omega_model_segment_t *model_segment_ptr) {
-        return (0 == omega_change_get_serial(model_segment_ptr->change_ptr.get()))
+    /**
+     * Kind of a model segment, which depends on the change it refers to
+     * @param change_ptr change referenced by the segment
+     * @return SEGMENT_READ for segments of the original file, SEGMENT_INSERT otherwise
+     */
+    inline model_segment_kind_t omega_model_segment_get_kind_(const omega_change_t *change_ptr) {
+        return (0 == omega_change_get_serial(change_ptr))
                        ? model_segment_kind_t::SEGMENT_READ
                        : model_segment_kind_t::SEGMENT_INSERT;
     }
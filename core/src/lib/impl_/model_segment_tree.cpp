@@ -0,0 +1,400 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "model_segment_tree.hpp"
+#include "safe_math.hpp"
+#include <new>
+#include <stdexcept>
+
+namespace omega_edit::internal {
+
+    auto model_segment_pool_t::allocate_node_() -> uint32_t {
+        uint32_t index = free_node_head_;
+        if (index != npos) {
+            free_node_head_ = nodes_[index].left;
+            --free_node_count_;
+        } else {
+            // Indexes are 32 bits wide and npos is reserved to mean "no node"
+            if (nodes_.size() >= npos) { throw std::bad_alloc(); }
+            nodes_.emplace_back();
+            index = static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        nodes_[index] = node_t{};
+        nodes_[index].ref_count = 1;
+        return index;
+    }
+
+    void model_segment_pool_t::release_node_(uint32_t index) noexcept {
+        // Freeing a node releases its children, so loop down the right spine and recurse only to the left
+        while (index != npos) {
+            auto &node = nodes_[index];
+            if (--node.ref_count != 0) { return; }
+            const auto left = node.left;
+            const auto right = node.right;
+            release_change_(node.segment.change_index);
+            node.right = npos;
+            node.left = free_node_head_;
+            free_node_head_ = index;
+            ++free_node_count_;
+            release_node_(left);
+            index = right;
+        }
+    }
+
+    auto model_segment_pool_t::acquire_change_(const const_omega_change_ptr_t &change_ptr) -> uint32_t {
+        const auto emplaced = change_indices_.emplace(change_ptr.get(), npos);
+        if (!emplaced.second) {
+            retain_change_(emplaced.first->second);
+            return emplaced.first->second;
+        }
+        uint32_t index = free_change_head_;
+        if (index != npos) {
+            free_change_head_ = changes_[index].next_free;
+        } else {
+            try {
+                if (changes_.size() >= npos) { throw std::bad_alloc(); }
+                changes_.emplace_back();
+            } catch (...) {
+                change_indices_.erase(emplaced.first);
+                throw;
+            }
+            index = static_cast<uint32_t>(changes_.size() - 1);
+        }
+        emplaced.first->second = index;
+        changes_[index].change_ptr = change_ptr;
+        changes_[index].ref_count = 1;
+        changes_[index].next_free = npos;
+        return index;
+    }
+
+    void model_segment_pool_t::release_change_(uint32_t index) noexcept {
+        auto &entry = changes_[index];
+        if (--entry.ref_count != 0) { return; }
+        // Drop the change as soon as no segment refers to it, so payload files are removed as promptly as before
+        change_indices_.erase(entry.change_ptr.get());
+        entry.change_ptr.reset();
+        entry.next_free = free_change_head_;
+        free_change_head_ = index;
+    }
+
+    void model_segment_tree_t::const_iterator::descend_left_(uint32_t index, int64_t base_offset) {
+        while (index != npos) {
+            const auto &node = pool_ptr_->node_(index);
+            pending_.push_back({index, base_offset + pool_ptr_->subtree_length_(node.left)});
+            index = node.left;
+        }
+    }
+
+    void model_segment_tree_t::const_iterator::pop_() {
+        if (pending_.empty()) {
+            index_ = npos;
+            offset_ = 0;
+            return;
+        }
+        index_ = pending_.back().index;
+        offset_ = pending_.back().offset;
+        pending_.pop_back();
+    }
+
+    auto model_segment_tree_t::const_iterator::operator++() -> const_iterator & {
+        if (index_ != npos) {
+            const auto &node = pool_ptr_->node_(index_);
+            // Only derive the next offset when there is a right subtree to descend into
+            if (node.right != npos) { descend_left_(node.right, offset_ + node.segment.computed_length); }
+            pop_();
+        }
+        return *this;
+    }
+
+    auto model_segment_tree_t::clone() const noexcept -> model_segment_tree_t {
+        model_segment_tree_t result(pool_ptr_);
+        result.root_ = root_;
+        result.priority_state_ = priority_state_;
+        return result;
+    }
+
+    auto model_segment_tree_t::begin() const -> const_iterator {
+        const_iterator iter;
+        if (!root_) { return iter; }
+        iter.pool_ptr_ = pool_ptr_;
+        iter.descend_left_(root_.index(), 0);
+        iter.pop_();
+        return iter;
+    }
+
+    auto model_segment_tree_t::find(int64_t offset) const -> const_iterator {
+        const_iterator iter;
+        if (offset < 0 || !root_) { return iter; }
+        iter.pool_ptr_ = pool_ptr_;
+        auto index = root_.index();
+        int64_t base_offset = 0;
+        while (index != npos) {
+            const auto &node = pool_ptr_->node_(index);
+            const auto segment_offset = base_offset + pool_ptr_->subtree_length_(node.left);
+            if (offset < segment_offset) {
+                iter.pending_.push_back({index, segment_offset});
+                index = node.left;
+            } else if (offset - segment_offset < node.segment.computed_length) {
+                iter.index_ = index;
+                iter.offset_ = segment_offset;
+                return iter;
+            } else {
+                base_offset = segment_offset + node.segment.computed_length;
+                index = node.right;
+            }
+        }
+        return {};
+    }
+
+    auto model_segment_tree_t::insert(int64_t offset, const const_omega_change_ptr_t &change_ptr,
+                                      int64_t change_offset, int64_t length,
+                                      omega_change_payload_role_t payload_role) -> int {
+        const auto total_length = computed_length();
+        int64_t new_length = 0;
+        if (!pool_ptr_ || offset < 0 || offset > total_length || length <= 0 || change_offset < 0 || !change_ptr ||
+            !safe_add_int64_(total_length, length, new_length)) {
+            return -1;
+        }
+        // Hold the change table entry until the new node takes its own reference
+        struct change_hold_t {
+            pool_t *pool_ptr;
+            uint32_t index;
+            ~change_hold_t() { pool_ptr->release_change_(index); }
+        } const change_hold{pool_ptr_, pool_ptr_->acquire_change_(change_ptr)};
+
+        omega_model_segment_t segment{};
+        segment.computed_length = length;
+        segment.change_offset = change_offset;
+        segment.change_index = change_hold.index;
+        segment.payload_role = payload_role;
+        node_ref_t left_ref;
+        node_ref_t right_ref;
+        split_(root_.index(), offset, left_ref, right_ref);
+        auto root_ref = merge_(merge_(left_ref, make_node_(segment, next_priority_(), {}, {})), right_ref);
+        root_ = std::move(root_ref);
+        return 0;
+    }
+
+    auto model_segment_tree_t::erase(int64_t offset, int64_t length) -> int {
+        const auto total_length = computed_length();
+        if (offset < 0 || length < 0 || offset > total_length) { return -1; }
+        if (length > total_length - offset) { length = total_length - offset; }
+        if (length == 0) { return 0; }
+        node_ref_t left_ref;
+        node_ref_t right_ref;
+        node_ref_t middle_ref;
+        node_ref_t tail_ref;
+        split_(root_.index(), offset, left_ref, right_ref);
+        split_(right_ref.index(), length, middle_ref, tail_ref);
+        auto root_ref = merge_(left_ref, tail_ref);
+        root_ = std::move(root_ref);
+        return 0;
+    }
+
+    model_segment_tree_t::builder_t::~builder_t() {
+        if (root_ != npos) { tree_.pool_ptr_->release_node_(root_); }
+    }
+
+    void model_segment_tree_t::builder_t::append(const omega_model_segment_t &segment) {
+        if (!tree_.pool_ptr_ || segment.computed_length <= 0) { throw std::invalid_argument("invalid model segment"); }
+        // Every subtree length is bounded by the total, so checking it here keeps the aggregates from overflowing
+        int64_t length = 0;
+        if (!safe_add_int64_(length_, segment.computed_length, length)) {
+            throw std::overflow_error("model segment length overflow");
+        }
+        spine_.reserve(spine_.size() + 1);
+        const auto segment_copy = segment;
+        auto *const pool_ptr = tree_.pool_ptr_;
+        const auto priority = tree_.next_priority_();
+        const auto index = pool_ptr->allocate_node_();
+        pool_ptr->retain_change_(segment_copy.change_index);
+        auto &node = pool_ptr->nodes_[index];
+        node.segment = segment_copy;
+        node.priority = priority;
+
+        // Spine nodes with lower priorities become the left subtree of the new node, which ends the spine
+        auto left = npos;
+        while (!spine_.empty() && pool_ptr->nodes_[spine_.back()].priority < priority) {
+            left = spine_.back();
+            spine_.pop_back();
+            close_(left);
+        }
+        pool_ptr->nodes_[index].left = left;
+        if (spine_.empty()) {
+            root_ = index;
+        } else {
+            pool_ptr->nodes_[spine_.back()].right = index;
+        }
+        spine_.push_back(index);
+        length_ = length;
+    }
+
+    void model_segment_tree_t::builder_t::append(const const_omega_change_ptr_t &change_ptr, int64_t change_offset,
+                                                 int64_t length, omega_change_payload_role_t payload_role) {
+        if (!tree_.pool_ptr_ || !change_ptr || change_offset < 0) {
+            throw std::invalid_argument("invalid model segment");
+        }
+        // Hold the change table entry until the new node takes its own reference
+        struct change_hold_t {
+            pool_t *pool_ptr;
+            uint32_t index;
+            ~change_hold_t() { pool_ptr->release_change_(index); }
+        } const change_hold{tree_.pool_ptr_, tree_.pool_ptr_->acquire_change_(change_ptr)};
+
+        omega_model_segment_t segment{};
+        segment.computed_length = length;
+        segment.change_offset = change_offset;
+        segment.change_index = change_hold.index;
+        segment.payload_role = payload_role;
+        append(segment);
+    }
+
+    void model_segment_tree_t::builder_t::finish() {
+        while (!spine_.empty()) {
+            close_(spine_.back());
+            spine_.pop_back();
+        }
+        tree_.root_ = node_ref_t(tree_.pool_ptr_, std::exchange(root_, npos));
+    }
+
+    void model_segment_tree_t::builder_t::close_(uint32_t index) noexcept {
+        // Both subtrees are complete once a node leaves the spine, so its aggregates can be computed
+        auto *const pool_ptr = tree_.pool_ptr_;
+        auto &node = pool_ptr->nodes_[index];
+        node.subtree_length = node.segment.computed_length + pool_ptr->subtree_length_(node.left) +
+                              pool_ptr->subtree_length_(node.right);
+        node.subtree_count = 1 + pool_ptr->subtree_count_(node.left) + pool_ptr->subtree_count_(node.right);
+    }
+
+    auto model_segment_tree_t::validate() const noexcept -> bool {
+        int64_t length = 0;
+        uint64_t count = 0;
+        return validate_(root_.index(), length, count);
+    }
+
+    auto model_segment_tree_t::make_node_(const omega_model_segment_t &segment, uint32_t priority, node_ref_t left_ref,
+                                          node_ref_t right_ref) -> node_ref_t {
+        auto length = segment.computed_length;
+        uint64_t count = 1;
+        if (left_ref) {
+            if (!safe_add_int64_(length, pool_ptr_->subtree_length_(left_ref.index()), length)) {
+                throw std::overflow_error("model segment length overflow");
+            }
+            count += pool_ptr_->subtree_count_(left_ref.index());
+        }
+        if (right_ref) {
+            if (!safe_add_int64_(length, pool_ptr_->subtree_length_(right_ref.index()), length)) {
+                throw std::overflow_error("model segment length overflow");
+            }
+            count += pool_ptr_->subtree_count_(right_ref.index());
+        }
+        // The segment is taken by reference, so copy it before allocating can move the node storage
+        const auto segment_copy = segment;
+        const auto index = pool_ptr_->allocate_node_();
+        pool_ptr_->retain_change_(segment_copy.change_index);
+        auto &node = pool_ptr_->nodes_[index];
+        node.segment = segment_copy;
+        node.subtree_length = length;
+        node.subtree_count = count;
+        node.priority = priority;
+        node.left = left_ref.release();
+        node.right = right_ref.release();
+        return {pool_ptr_, index};
+    }
+
+    void model_segment_tree_t::split_(uint32_t index, int64_t offset, node_ref_t &left_ref, node_ref_t &right_ref) {
+        if (index == npos) {
+            left_ref.reset();
+            right_ref.reset();
+            return;
+        }
+        // Copy the node, since allocating new nodes can move the node storage
+        const auto node = pool_ptr_->node_(index);
+        const auto left_length = pool_ptr_->subtree_length_(node.left);
+        const auto segment_length = node.segment.computed_length;
+        node_ref_t lower_ref;
+        node_ref_t upper_ref;
+        if (offset <= left_length) {
+            split_(node.left, offset, lower_ref, upper_ref);
+            right_ref = make_node_(node.segment, node.priority, std::move(upper_ref), pool_ptr_->ref_(node.right));
+            left_ref = std::move(lower_ref);
+        } else if (offset - left_length >= segment_length) {
+            split_(node.right, offset - left_length - segment_length, lower_ref, upper_ref);
+            left_ref = make_node_(node.segment, node.priority, pool_ptr_->ref_(node.left), std::move(lower_ref));
+            right_ref = std::move(upper_ref);
+        } else {
+            // The offset falls inside this node's segment, so it becomes a head and a tail that both keep the node's
+            // priority, which keeps the heap order valid for the subtrees they adopt
+            const auto delta = offset - left_length;
+            auto head = node.segment;
+            auto tail = node.segment;
+            head.computed_length = delta;
+            tail.computed_length = segment_length - delta;
+            if (!safe_add_int64_(tail.change_offset, delta, tail.change_offset)) {
+                throw std::overflow_error("model segment change offset overflow");
+            }
+            auto head_ref = make_node_(head, node.priority, pool_ptr_->ref_(node.left), {});
+            right_ref = make_node_(tail, node.priority, {}, pool_ptr_->ref_(node.right));
+            left_ref = std::move(head_ref);
+        }
+    }
+
+    auto model_segment_tree_t::merge_(const node_ref_t &left_ref, const node_ref_t &right_ref) -> node_ref_t {
+        if (!left_ref) { return right_ref; }
+        if (!right_ref) { return left_ref; }
+        const auto left = pool_ptr_->node_(left_ref.index());
+        const auto right = pool_ptr_->node_(right_ref.index());
+        if (left.priority >= right.priority) {
+            return make_node_(left.segment, left.priority, pool_ptr_->ref_(left.left),
+                              merge_(pool_ptr_->ref_(left.right), right_ref));
+        }
+        return make_node_(right.segment, right.priority, merge_(left_ref, pool_ptr_->ref_(right.left)),
+                          pool_ptr_->ref_(right.right));
+    }
+
+    auto model_segment_tree_t::validate_(uint32_t index, int64_t &length, uint64_t &count) const noexcept -> bool {
+        length = 0;
+        count = 0;
+        if (index == npos) { return true; }
+        const auto &node = pool_ptr_->node_(index);
+        int64_t left_length = 0;
+        int64_t right_length = 0;
+        uint64_t left_count = 0;
+        uint64_t right_count = 0;
+        if (!validate_(node.left, left_length, left_count) || !validate_(node.right, right_length, right_count)) {
+            return false;
+        }
+        if ((node.left != npos && pool_ptr_->node_(node.left).priority > node.priority) ||
+            (node.right != npos && pool_ptr_->node_(node.right).priority > node.priority) ||
+            node.ref_count == 0 || node.segment.change_index >= pool_ptr_->changes_.size() ||
+            !pool_ptr_->changes_[node.segment.change_index].change_ptr) {
+            return false;
+        }
+        if (!safe_add_int64_(left_length, node.segment.computed_length, length) ||
+            !safe_add_int64_(length, right_length, length)) {
+            return false;
+        }
+        count = left_count + right_count + 1;
+        return length == node.subtree_length && count == node.subtree_count;
+    }
+
+    auto model_segment_tree_t::next_priority_() noexcept -> uint32_t {
+        // xorshift32 keeps priorities well mixed and reproducible from run to run
+        priority_state_ ^= priority_state_ << 13;
+        priority_state_ ^= priority_state_ >> 17;
+        priority_state_ ^= priority_state_ << 5;
+        return priority_state_;
+    }
+
+}// namespace omega_edit::internal
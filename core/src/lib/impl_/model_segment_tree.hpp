@@ -0,0 +1,332 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_MODEL_SEGMENT_TREE_HPP
+#define OMEGA_EDIT_MODEL_SEGMENT_TREE_HPP
+
+#include "internal_fwd_defs.hpp"
+#include "model_segment_def.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    class model_segment_tree_t;
+
+    /**
+     * Storage for the piece tree nodes and the change table of one edit model.
+     *
+     * Nodes are held by value in a single vector and refer to their children and to their change by 32-bit index. Every
+     * tree of the model (the live segments, rollback candidates, and undo snapshots) allocates from the same pool, so
+     * they can share nodes using plain reference counts. The pool must outlive every tree that uses it, and like the
+     * rest of the model it is not safe to modify from more than one thread at a time.
+     */
+    class model_segment_pool_t {
+    public:
+        model_segment_pool_t() = default;
+        ~model_segment_pool_t() = default;
+        model_segment_pool_t(const model_segment_pool_t &) = delete;
+        auto operator=(const model_segment_pool_t &) -> model_segment_pool_t & = delete;
+        model_segment_pool_t(model_segment_pool_t &&) = delete;
+        auto operator=(model_segment_pool_t &&) -> model_segment_pool_t & = delete;
+
+        /** Number of nodes referenced by at least one tree */
+        auto live_node_count() const noexcept -> size_t { return nodes_.size() - free_node_count_; }
+
+        /** Number of changes referenced by at least one segment */
+        auto live_change_count() const noexcept -> size_t { return change_indices_.size(); }
+
+        /**
+         * Look up the change a segment refers to
+         * @param segment segment held by a tree of this pool
+         * @return the change the segment refers to
+         */
+        auto change(const omega_model_segment_t &segment) const noexcept -> const omega_change_t * {
+            return changes_[segment.change_index].change_ptr.get();
+        }
+
+    private:
+        friend class model_segment_tree_t;
+
+        static constexpr uint32_t npos = (std::numeric_limits<uint32_t>::max)();
+
+        struct node_t {
+            omega_model_segment_t segment{};
+            int64_t subtree_length{};///< Bytes covered by this node and its descendants
+            uint64_t subtree_count{};///< Segments held by this node and its descendants
+            uint32_t priority{};     ///< Treap heap priority (parents have priorities >= their children)
+            uint32_t left{npos}; ///< Left child, or the next free node while the node is on the free list
+            uint32_t right{npos};
+            uint32_t ref_count{};///< Number of parents and trees referring to this node
+        };
+
+        struct change_entry_t {
+            const_omega_change_ptr_t change_ptr{};
+            uint32_t ref_count{};    ///< Number of nodes referring to this change
+            uint32_t next_free{npos};///< Next free entry while the entry is on the free list
+        };
+
+        /** Counted reference to a node, released back to the pool when the last reference goes away */
+        class node_ref_t {
+        public:
+            node_ref_t() = default;
+
+            /** Adopt a reference that has already been counted */
+            node_ref_t(model_segment_pool_t *pool_ptr, uint32_t index) noexcept : pool_ptr_(pool_ptr), index_(index) {}
+
+            node_ref_t(const node_ref_t &other) noexcept : pool_ptr_(other.pool_ptr_), index_(other.index_) {
+                if (index_ != npos && pool_ptr_) { pool_ptr_->retain_node_(index_); }
+            }
+
+            node_ref_t(node_ref_t &&other) noexcept
+                : pool_ptr_(other.pool_ptr_), index_(std::exchange(other.index_, npos)) {}
+
+            auto operator=(node_ref_t other) noexcept -> node_ref_t & {
+                std::swap(pool_ptr_, other.pool_ptr_);
+                std::swap(index_, other.index_);
+                return *this;
+            }
+
+            ~node_ref_t() { reset(); }
+
+            void reset() noexcept {
+                // A reference only holds a node while it has a pool, so an empty reference never touches the pool
+                if (index_ != npos && pool_ptr_) { pool_ptr_->release_node_(std::exchange(index_, npos)); }
+            }
+
+            /** Give up the reference without releasing it */
+            auto release() noexcept -> uint32_t { return std::exchange(index_, npos); }
+
+            auto index() const noexcept -> uint32_t { return index_; }
+
+            explicit operator bool() const noexcept { return index_ != npos; }
+
+        private:
+            model_segment_pool_t *pool_ptr_{};
+            uint32_t index_{npos};
+        };
+
+        auto node_(uint32_t index) const noexcept -> const node_t & { return nodes_[index]; }
+
+        auto subtree_length_(uint32_t index) const noexcept -> int64_t {
+            return index == npos ? 0 : nodes_[index].subtree_length;
+        }
+
+        auto subtree_count_(uint32_t index) const noexcept -> uint64_t {
+            return index == npos ? 0 : nodes_[index].subtree_count;
+        }
+
+        auto ref_(uint32_t index) noexcept -> node_ref_t {
+            if (index != npos) { retain_node_(index); }
+            return {this, index};
+        }
+
+        auto allocate_node_() -> uint32_t;
+        void retain_node_(uint32_t index) noexcept { ++nodes_[index].ref_count; }
+        void release_node_(uint32_t index) noexcept;
+        auto acquire_change_(const const_omega_change_ptr_t &change_ptr) -> uint32_t;
+        void retain_change_(uint32_t index) noexcept { ++changes_[index].ref_count; }
+        void release_change_(uint32_t index) noexcept;
+
+        std::vector<node_t> nodes_{};
+        std::vector<change_entry_t> changes_{};
+        std::unordered_map<const omega_change_t *, uint32_t> change_indices_{};
+        uint32_t free_node_head_{npos};
+        uint32_t free_change_head_{npos};
+        size_t free_node_count_{};
+    };
+
+    /**
+     * Piece tree holding the model segments of an edit model in document order.
+     *
+     * Segments live in a treap whose nodes also carry the byte length and segment count of their subtree, so locating
+     * the segment that holds a computed offset, inserting a segment, and erasing a byte range all take logarithmic time
+     * regardless of how fragmented the model is. Segment offsets are not stored; they are derived during descent and
+     * reported by the iterator.
+     *
+     * Nodes are immutable once built and shared between trees of the same pool. Edits copy only the nodes on the path
+     * they touch and publish the new root when they succeed, so copying a tree is constant time, a failed edit leaves
+     * the tree as it was, and undo snapshots share every segment they have in common with the live model.
+     */
+    class model_segment_tree_t {
+        using pool_t = model_segment_pool_t;
+        using node_t = pool_t::node_t;
+        using node_ref_t = pool_t::node_ref_t;
+        static constexpr uint32_t npos = pool_t::npos;
+
+    public:
+        /** Forward iterator over the segments in document order */
+        class const_iterator {
+        public:
+            const_iterator() = default;
+
+            auto operator*() const -> const omega_model_segment_t & { return pool_ptr_->node_(index_).segment; }
+
+            auto operator->() const -> const omega_model_segment_t * { return &pool_ptr_->node_(index_).segment; }
+
+            /** Change referenced by the current segment */
+            auto change() const noexcept -> const omega_change_t * { return pool_ptr_->change(**this); }
+
+            /** Computed offset of the current segment */
+            auto computed_offset() const noexcept -> int64_t { return offset_; }
+
+            auto operator++() -> const_iterator &;
+
+            auto operator==(const const_iterator &other) const noexcept -> bool { return index_ == other.index_; }
+
+            auto operator!=(const const_iterator &other) const noexcept -> bool { return !(*this == other); }
+
+        private:
+            friend class model_segment_tree_t;
+
+            struct frame_t {
+                uint32_t index;
+                int64_t offset;
+            };
+
+            void descend_left_(uint32_t index, int64_t base_offset);
+            void pop_();
+
+            const pool_t *pool_ptr_{};
+            std::vector<frame_t> pending_{};///< Ancestors still to be visited, nearest last
+            uint32_t index_{npos};
+            int64_t offset_{};
+        };
+
+        explicit model_segment_tree_t(model_segment_pool_t *pool_ptr = nullptr) noexcept : pool_ptr_(pool_ptr) {}
+        ~model_segment_tree_t() = default;
+        model_segment_tree_t(model_segment_tree_t &&) noexcept = default;
+        auto operator=(model_segment_tree_t &&) noexcept -> model_segment_tree_t & = default;
+        model_segment_tree_t(const model_segment_tree_t &) = delete;
+        auto operator=(const model_segment_tree_t &) -> model_segment_tree_t & = delete;
+
+        /** Copy of the tree that shares all of its nodes with this one (constant time) */
+        auto clone() const noexcept -> model_segment_tree_t;
+
+        /** Pool the tree allocates its nodes from */
+        auto pool() const noexcept -> model_segment_pool_t * { return pool_ptr_; }
+
+        auto empty() const noexcept -> bool { return !root_; }
+
+        /** Number of segments in the tree */
+        auto size() const noexcept -> size_t {
+            return root_ ? static_cast<size_t>(pool_ptr_->subtree_count_(root_.index())) : 0;
+        }
+
+        /** Total number of bytes covered by the segments, which is the computed file size of the model */
+        auto computed_length() const noexcept -> int64_t {
+            return root_ ? pool_ptr_->subtree_length_(root_.index()) : 0;
+        }
+
+        auto begin() const -> const_iterator;
+
+        auto end() const noexcept -> const_iterator { return {}; }
+
+        /**
+         * Find the segment containing the given computed offset
+         * @param offset computed offset to find
+         * @return iterator to the segment containing the offset, or end() if the offset is not less than
+         * computed_length()
+         */
+        auto find(int64_t offset) const -> const_iterator;
+
+        void clear() noexcept { root_.reset(); }
+
+        /**
+         * Insert a segment so that it begins at the given computed offset, splitting the segment that spans the offset
+         * @param offset computed offset where the segment will begin, which must not exceed computed_length()
+         * @param change_ptr change the segment refers to
+         * @param change_offset offset of the segment within the change payload
+         * @param length segment length (must be positive)
+         * @param payload_role which payload of the change the segment reads
+         * @return 0 on success, non-zero on failure (the tree is unchanged on failure, including when this throws)
+         */
+        auto insert(int64_t offset, const const_omega_change_ptr_t &change_ptr, int64_t change_offset, int64_t length,
+                    omega_change_payload_role_t payload_role = OMEGA_CHANGE_PAYLOAD_DATA) -> int;
+
+        /**
+         * Erase a range of bytes from the model, trimming or splitting segments at the range boundaries
+         * @param offset computed offset where the range begins, which must not exceed computed_length()
+         * @param length number of bytes to erase (clipped to the end of the model)
+         * @return 0 on success, non-zero on failure (the tree is unchanged on failure, including when this throws)
+         */
+        auto erase(int64_t offset, int64_t length) -> int;
+
+        /**
+         * Builds the contents of a tree from segments appended in document order. The treap is built in linear time by
+         * keeping its right spine on a stack rather than paying a logarithmic insert for every segment, so rebuilding a
+         * whole model in one pass is cheaper than applying a long run of edits to it one at a time. The tree is left as
+         * it was unless finish() is called, including when appending throws.
+         */
+        class builder_t {
+        public:
+            explicit builder_t(model_segment_tree_t &tree) noexcept : tree_(tree) {}
+            ~builder_t();
+            builder_t(const builder_t &) = delete;
+            auto operator=(const builder_t &) -> builder_t & = delete;
+
+            /**
+             * Append a segment held by a tree of the same pool
+             * @param segment segment to append (its length must be positive)
+             */
+            void append(const omega_model_segment_t &segment);
+
+            /**
+             * Append a segment referring to the given change
+             * @param change_ptr change the segment refers to
+             * @param change_offset offset of the segment within the change payload
+             * @param length segment length (must be positive)
+             * @param payload_role which payload of the change the segment reads
+             */
+            void append(const const_omega_change_ptr_t &change_ptr, int64_t change_offset, int64_t length,
+                        omega_change_payload_role_t payload_role = OMEGA_CHANGE_PAYLOAD_DATA);
+
+            /** Replace the contents of the tree with the appended segments */
+            void finish();
+
+        private:
+            void close_(uint32_t index) noexcept;
+
+            model_segment_tree_t &tree_;
+            std::vector<uint32_t> spine_{};///< Right spine of the tree built so far, root first
+            uint32_t root_{npos};
+            int64_t length_{};
+        };
+
+        /**
+         * Verify that the subtree aggregates agree with the segments they summarize
+         * @return true if the tree is consistent, false otherwise
+         */
+        auto validate() const noexcept -> bool;
+
+    private:
+        auto make_node_(const omega_model_segment_t &segment, uint32_t priority, node_ref_t left_ref,
+                        node_ref_t right_ref) -> node_ref_t;
+        void split_(uint32_t index, int64_t offset, node_ref_t &left_ref, node_ref_t &right_ref);
+        auto merge_(const node_ref_t &left_ref, const node_ref_t &right_ref) -> node_ref_t;
+        auto validate_(uint32_t index, int64_t &length, uint64_t &count) const noexcept -> bool;
+        auto next_priority_() noexcept -> uint32_t;
+
+        model_segment_pool_t *pool_ptr_{};
+        node_ref_t root_{};
+        uint32_t priority_state_{0x9E3779B9U};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_MODEL_SEGMENT_TREE_HPP
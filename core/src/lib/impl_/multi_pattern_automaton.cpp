@@ -0,0 +1,128 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "multi_pattern_automaton.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace omega_edit::internal {
+
+    multi_pattern_automaton_t::multi_pattern_automaton_t(const omega_byte_t *const *patterns,
+                                                         const int64_t *pattern_lengths, int64_t pattern_count,
+                                                         const omega_byte_t *fold_table) {
+        assert(patterns);
+        assert(pattern_lengths);
+        assert(pattern_count > 0);
+        const auto fold = [fold_table](omega_byte_t byte) { return fold_table ? fold_table[byte] : byte; };
+
+        // Give each (folded) byte used by a pattern its own class, and lump every other byte into class 0
+        if (pattern_count > OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT) {
+            throw std::length_error("multi-pattern automaton has too many patterns");
+        }
+        bool is_used[UCHAR_MAX + 1]{};
+        int64_t total_length = 0;
+        for (int64_t i = 0; i < pattern_count; ++i) {
+            assert(patterns[i]);
+            assert(pattern_lengths[i] > 0);
+            if (pattern_lengths[i] > OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT - total_length) {
+                throw std::length_error("multi-pattern automaton patterns are too long");
+            }
+            for (int64_t j = 0; j < pattern_lengths[i]; ++j) { is_used[fold(patterns[i][j])] = true; }
+            total_length += pattern_lengths[i];
+        }
+        if (static_cast<uint64_t>(total_length) >= output_flag - 1) {
+            throw std::length_error("multi-pattern automaton has too many states");
+        }
+        uint16_t folded_classes[UCHAR_MAX + 1]{};
+        class_count_ = 1;
+        for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+            if (is_used[byte]) { folded_classes[byte] = static_cast<uint16_t>(class_count_++); }
+        }
+        for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+            byte_classes_[byte] = folded_classes[fold(static_cast<omega_byte_t>(byte))];
+        }
+
+        // Build the trie, remembering which state completes each pattern
+        std::vector<std::pair<state_t, int64_t>> completions;
+        completions.reserve(static_cast<size_t>(pattern_count));
+        pattern_lengths_.assign(pattern_lengths, pattern_lengths + pattern_count);
+        transitions_.assign(class_count_, npos);
+        state_t state_count = 1;
+        constexpr auto table_limit = static_cast<size_t>(OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT);
+        for (int64_t i = 0; i < pattern_count; ++i) {
+            state_t state = root;
+            for (int64_t j = 0; j < pattern_lengths[i]; ++j) {
+                const auto index = static_cast<size_t>(state) * class_count_ + byte_classes_[patterns[i][j]];
+                if (transitions_[index] == npos) {
+                    if (transitions_.size() + class_count_ > table_limit) {
+                        throw std::length_error("multi-pattern automaton transition table is too large");
+                    }
+                    transitions_[index] = state_count++;
+                    transitions_.resize(transitions_.size() + class_count_, npos);
+                }
+                state = transitions_[index];
+            }
+            completions.emplace_back(state, i);
+        }
+
+        // Group the pattern identifiers by the state that completes them
+        output_begins_.assign(static_cast<size_t>(state_count) + 1, 0);
+        for (const auto &completion : completions) { ++output_begins_[completion.first + 1]; }
+        for (size_t i = 1; i < output_begins_.size(); ++i) { output_begins_[i] += output_begins_[i - 1]; }
+        output_ids_.resize(completions.size());
+        auto fill = output_begins_;
+        for (const auto &completion : completions) { output_ids_[fill[completion.first]++] = completion.second; }
+        const auto completes_pattern = [this](state_t state) {
+            return output_begins_[state + 1] != output_begins_[state] || output_links_[state] != npos;
+        };
+
+        // Breadth first, resolve the failure function into the transition table and link each state to the longest
+        // proper suffix state that completes a pattern
+        std::vector<state_t> failures(state_count, root);
+        std::vector<state_t> queue;
+        queue.reserve(state_count);
+        output_links_.assign(state_count, npos);
+        for (size_t c = 0; c < class_count_; ++c) {
+            auto &child = transitions_[c];
+            if (child == npos) {
+                child = root;
+            } else {
+                queue.push_back(child);
+            }
+        }
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const auto state = queue[head];
+            const auto failure = failures[state];
+            for (size_t c = 0; c < class_count_; ++c) {
+                auto &child = transitions_[static_cast<size_t>(state) * class_count_ + c];
+                const auto failure_child = transitions_[static_cast<size_t>(failure) * class_count_ + c];
+                if (child == npos) {
+                    child = failure_child;
+                } else {
+                    failures[child] = failure_child;
+                    output_links_[child] = output_begins_[failure_child + 1] != output_begins_[failure_child]
+                                                   ? failure_child
+                                                   : output_links_[failure_child];
+                    queue.push_back(child);
+                }
+            }
+        }
+
+        for (auto &transition : transitions_) {
+            if (completes_pattern(transition)) { transition |= output_flag; }
+        }
+    }
+
+}// namespace omega_edit::internal
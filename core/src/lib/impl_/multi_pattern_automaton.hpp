@@ -0,0 +1,101 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_MULTI_PATTERN_AUTOMATON_HPP
+#define OMEGA_EDIT_MULTI_PATTERN_AUTOMATON_HPP
+
+#include "../../include/omega_edit/byte.h"
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    /**
+     * Aho-Corasick automaton that finds every occurrence of a set of byte patterns in one pass.
+     *
+     * The goto and failure functions are resolved into a dense transition table over byte classes (bytes that no
+     * pattern uses all share one class), so each haystack byte costs one table lookup.  Transitions into states that
+     * complete at least one pattern carry a flag bit, which keeps the scan loop free of a separate output check.
+     */
+    class multi_pattern_automaton_t {
+    public:
+        using state_t = uint32_t;
+
+        static constexpr state_t root = 0;
+        static constexpr state_t npos = UINT32_MAX;
+        static constexpr state_t output_flag = 1U << 31;
+
+        /**
+         * Builds the automaton
+         * @param patterns patterns to find, identified by their index
+         * @param pattern_lengths length of each pattern, each greater than zero
+         * @param pattern_count number of patterns
+         * @param fold_table table of UCHAR_MAX + 1 entries mapping each byte to its folded form, or nullptr to match
+         * bytes exactly (patterns are folded here)
+         * @throws std::bad_alloc if the automaton can't be allocated, std::length_error if the patterns exceed
+         * OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT or OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT, or the automaton
+         * needs more than OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT transitions or 2^31 states
+         */
+        multi_pattern_automaton_t(const omega_byte_t *const *patterns, const int64_t *pattern_lengths,
+                                  int64_t pattern_count, const omega_byte_t *fold_table);
+
+        /**
+         * Transition function
+         * @param state current state (without the output flag)
+         * @param byte next haystack byte
+         * @return next state, with output_flag set if it completes at least one pattern
+         */
+        state_t next(state_t state, omega_byte_t byte) const {
+            return transitions_[static_cast<size_t>(state) * class_count_ + byte_classes_[byte]];
+        }
+
+        /**
+         * Gets the next state in the chain of states whose patterns end at the same position as the given state's
+         * @param state state to follow
+         * @return longest proper suffix state that completes a pattern, or npos
+         */
+        state_t output_link(state_t state) const { return output_links_[state]; }
+
+        /**
+         * Gets the patterns completed by the given state itself (not by its output links)
+         * @param state state to query
+         * @param count set to the number of patterns
+         * @return pointer to the pattern identifiers
+         */
+        const int64_t *outputs(state_t state, size_t &count) const {
+            count = output_begins_[state + 1] - output_begins_[state];
+            return output_ids_.data() + output_begins_[state];
+        }
+
+        int64_t pattern_count() const { return static_cast<int64_t>(pattern_lengths_.size()); }
+
+        int64_t pattern_length(int64_t pattern_id) const { return pattern_lengths_[static_cast<size_t>(pattern_id)]; }
+
+        size_t state_count() const { return output_links_.size(); }
+
+    private:
+        size_t class_count_{};
+        uint16_t byte_classes_[UCHAR_MAX + 1]{};
+        std::vector<state_t> transitions_{};
+        std::vector<state_t> output_links_{};
+        std::vector<uint32_t> output_begins_{};
+        std::vector<int64_t> output_ids_{};
+        std::vector<int64_t> pattern_lengths_{};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_MULTI_PATTERN_AUTOMATON_HPP
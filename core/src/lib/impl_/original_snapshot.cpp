@@ -0,0 +1,112 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "original_snapshot.hpp"
+#include "../../include/omega_edit/config.h"
+#include "../../include/omega_edit/filesystem.h"
+#include "macros.h"
+#include <chrono>
+#include <new>
+#include <system_error>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    namespace {
+        constexpr size_t copy_buffer_length = 1024 * 1024;
+
+        int64_t steady_clock_ms() {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+        }
+    }// namespace
+
+    int snapshot_copier_t::start(const std::string &source_path, const std::string &snapshot_path,
+                                 int64_t source_length, int64_t source_modification_time) {
+        if (thread_.joinable() || is_finished_) { return 0; }
+        is_cancelled_ = false;
+        try {
+            source_path_ = source_path;
+            source_length_ = source_length;
+            source_modification_time_ = source_modification_time;
+            thread_ = std::thread(&snapshot_copier_t::copy_, this, snapshot_path);
+        } catch (const std::system_error &) { return -1; } catch (const std::bad_alloc &) {
+            return -1;
+        }
+        return 0;
+    }
+
+    bool snapshot_copier_t::source_is_unchanged() const {
+        if (is_source_changed_) { return false; }
+        if (steady_clock_ms() < source_checked_at_ms_ + OMEGA_LAZY_SNAPSHOT_RECHECK_INTERVAL_MS) { return true; }
+        return verify_source_is_unchanged();
+    }
+
+    bool snapshot_copier_t::verify_source_is_unchanged() const {
+        if (is_source_changed_) { return false; }
+        const auto checked_at_ms = steady_clock_ms();
+        int64_t modification_time = 0;
+        if (omega_util_file_size(source_path_.c_str()) == source_length_ &&
+            0 == omega_util_get_modification_time(source_path_.c_str(), &modification_time) &&
+            modification_time == source_modification_time_) {
+            source_checked_at_ms_ = checked_at_ms;
+            return true;
+        }
+        is_source_changed_ = true;
+        return false;
+    }
+
+    void snapshot_copier_t::cancel() {
+        is_cancelled_ = true;
+        if (thread_.joinable()) { thread_.join(); }
+    }
+
+    bool snapshot_copier_t::wait() {
+        if (thread_.joinable()) { thread_.join(); }
+        return is_copied_;
+    }
+
+    void snapshot_copier_t::copy_(std::string snapshot_path) {
+        auto is_copied = false;
+        try {
+            std::vector<unsigned char> buffer(copy_buffer_length);
+            if (verify_source_is_unchanged()) {
+                auto *source_file_ptr = FOPEN(source_path_.c_str(), "rb");
+                auto *snapshot_file_ptr = source_file_ptr ? FOPEN(snapshot_path.c_str(), "wb") : nullptr;
+                if (snapshot_file_ptr) {
+                    int64_t copied = 0;
+                    while (!is_cancelled_) {
+                        const auto count = fread(buffer.data(), 1, buffer.size(), source_file_ptr);
+                        if (count == 0 || fwrite(buffer.data(), 1, count, snapshot_file_ptr) != count) { break; }
+                        copied += static_cast<int64_t>(count);
+                    }
+                    is_copied = !is_cancelled_ && !ferror(source_file_ptr) && copied == source_length_;
+                    if (FCLOSE(snapshot_file_ptr) != 0) { is_copied = false; }
+                }
+                if (source_file_ptr) { FCLOSE(source_file_ptr); }
+                // A copy made while the original was being changed may mix old and new bytes
+                if (is_copied && !verify_source_is_unchanged()) {
+                    LOG_ERROR("original file '" << source_path_ << "' changed while its snapshot was being copied");
+                    is_copied = false;
+                }
+            } else {
+                LOG_ERROR("original file '" << source_path_ << "' changed before its snapshot could be copied");
+            }
+        } catch (const std::bad_alloc &) { is_copied = false; }
+        is_copied_ = is_copied;
+        is_finished_ = true;
+    }
+
+}// namespace omega_edit::internal
@@ -0,0 +1,97 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_ORIGINAL_SNAPSHOT_HPP
+#define OMEGA_EDIT_ORIGINAL_SNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace omega_edit::internal {
+
+    /**
+     * Copies a session's original file to its private snapshot on a background thread, for sessions that read the
+     * original directly until the snapshot is ready (lazy snapshots).  The snapshot only counts as copied if the
+     * original still has the size and modification time it had when the session was created, both before and after
+     * the copy, so it holds the same bytes the session has been reading.
+     */
+    class snapshot_copier_t {
+    public:
+        snapshot_copier_t() = default;
+        ~snapshot_copier_t() { cancel(); }
+
+        snapshot_copier_t(const snapshot_copier_t &) = delete;
+        auto operator=(const snapshot_copier_t &) -> snapshot_copier_t & = delete;
+
+        /**
+         * Starts copying
+         * @param source_path original file to copy
+         * @param snapshot_path snapshot file to copy it to, which is overwritten
+         * @param source_length length the original file must have
+         * @param source_modification_time modification time the original file must have
+         * @return 0 if the copy was started, -1 if the thread couldn't be started
+         */
+        int start(const std::string &source_path, const std::string &snapshot_path, int64_t source_length,
+                  int64_t source_modification_time);
+
+        /**
+         * Determines if the original file still has the size and modification time it had when the session was
+         * created, so bytes read from it are the bytes the session has been reading.  Reads call this after every
+         * unmapped read, so the original is only examined again once OMEGA_LAZY_SNAPSHOT_RECHECK_INTERVAL_MS has
+         * passed since it was last found unchanged.  Once the original is found changed, it's never considered
+         * unchanged again.
+         * @return true if the original file is unchanged
+         */
+        bool source_is_unchanged() const;
+
+        /**
+         * Examines the original file now, like source_is_unchanged but without trusting an earlier check
+         * @return true if the original file is unchanged
+         */
+        bool verify_source_is_unchanged() const;
+
+        /** Stops the copy (if running) and waits for the thread to finish */
+        void cancel();
+
+        /**
+         * Waits for the copy to finish
+         * @return true if the snapshot was copied, false if the copy failed or was cancelled
+         */
+        bool wait();
+
+        /**
+         * Determines if the copy has finished, whether it succeeded or not
+         * @return true if wait won't block
+         */
+        bool is_finished() const { return is_finished_; }
+
+    private:
+        void copy_(std::string snapshot_path);
+
+        std::string source_path_{};
+        int64_t source_length_{};
+        int64_t source_modification_time_{};
+        std::thread thread_{};
+        std::atomic<bool> is_cancelled_{false};
+        std::atomic<bool> is_finished_{false};
+        std::atomic<bool> is_copied_{false};
+        mutable std::atomic<bool> is_source_changed_{false};
+        mutable std::atomic<int64_t> source_checked_at_ms_{INT64_MIN};///< Steady clock time of the last check
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_ORIGINAL_SNAPSHOT_HPP
@@ -0,0 +1,127 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_PAYLOAD_BLOCK_CACHE_HPP
+#define OMEGA_EDIT_PAYLOAD_BLOCK_CACHE_HPP
+
+#include "../../include/omega_edit/byte.h"
+#include "change_def.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+struct omega_byte_payload_struct;
+struct ZSTD_DCtx_s;
+
+namespace omega_edit::internal {
+
+    /**
+     * Session-wide cache for reading file-backed change payloads.  Decoded blocks of compressed payloads are kept in
+     * least recently used order within a memory budget, so reading the same region of a payload again (a viewport
+     * scrolling across a large compressed insert, for example) copies decoded bytes instead of decoding the block
+     * again.  Payload files are kept open between reads, up to OMEGA_PAYLOAD_CACHE_FILE_LIMIT of them, and one
+     * decompression context is reused for every block.  A cache may be shared by concurrent readers.
+     */
+    class payload_block_cache_t {
+    public:
+        /**
+         * Creates an empty cache
+         * @param limit memory budget for decoded blocks in bytes (0 caches no blocks)
+         */
+        explicit payload_block_cache_t(int64_t limit);
+        ~payload_block_cache_t();
+
+        payload_block_cache_t(const payload_block_cache_t &) = delete;
+        auto operator=(const payload_block_cache_t &) -> payload_block_cache_t & = delete;
+
+        /**
+         * Gets a new identifier for a payload to read through a cache
+         * @return payload identifier, unique within the process
+         */
+        static uint64_t next_payload_id();
+
+        /**
+         * Reads bytes of a file-backed payload
+         * @param payload payload to read, whose cache identifier is set
+         * @param blocks blocks of the compressed payload file, or nullptr if the file holds the raw payload
+         * @param offset offset in the payload
+         * @param buffer buffer to read into
+         * @param byte_count number of bytes to read
+         * @return zero on success, non-zero otherwise
+         */
+        int read(const omega_byte_payload_struct *payload, const std::vector<compressed_payload_block_t> *blocks,
+                 int64_t offset, omega_byte_t *buffer, int64_t byte_count);
+
+        /**
+         * Drops the cached blocks and closes the file of a payload, which must happen before its file is removed
+         * @param payload_id cache identifier of the payload
+         */
+        void forget(uint64_t payload_id);
+
+        /**
+         * Sets the memory budget, evicting blocks as needed
+         * @param limit memory budget for decoded blocks in bytes (0 caches no blocks)
+         */
+        void set_limit(int64_t limit);
+
+        /**
+         * Gets the cache statistics
+         * @param hits set to the number of block reads served from the cache
+         * @param misses set to the number of block reads that decoded a block
+         * @param cached_bytes set to the number of decoded bytes cached
+         * @param limit set to the memory budget in bytes
+         */
+        void get_stats(int64_t &hits, int64_t &misses, int64_t &cached_bytes, int64_t &limit) const;
+
+    private:
+        using block_key_t = std::pair<uint64_t, int64_t>;///< Payload identifier and block index
+
+        struct block_t {
+            block_key_t key{};
+            std::vector<omega_byte_t> bytes{};
+        };
+
+        struct open_file_t {
+            uint64_t payload_id{};
+            FILE *file_ptr{};
+            uint64_t last_use{};
+        };
+
+        FILE *file_(const omega_byte_payload_struct *payload);
+        const std::vector<omega_byte_t> *block_(const omega_byte_payload_struct *payload,
+                                                const std::vector<compressed_payload_block_t> &blocks,
+                                                int64_t block_index);
+        void evict_(int64_t limit);
+
+        mutable std::mutex mutex_{};
+        std::list<block_t> blocks_{};///< Cached blocks, most recently used first
+        std::map<block_key_t, std::list<block_t>::iterator> block_index_{};
+        std::vector<open_file_t> files_{};
+        ZSTD_DCtx_s *decompression_context_{};
+        std::vector<omega_byte_t> compressed_{};///< Compressed bytes of the block being decoded
+        std::vector<omega_byte_t> decoded_{};   ///< Decoded block when the budget can't hold it
+        int64_t limit_{};
+        int64_t cached_bytes_{};
+        int64_t hits_{};
+        int64_t misses_{};
+        uint64_t file_uses_{};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_PAYLOAD_BLOCK_CACHE_HPP
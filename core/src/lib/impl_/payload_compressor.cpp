@@ -0,0 +1,293 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "payload_compressor.hpp"
+#include "../../include/omega_edit/config.h"
+#include "../../include/omega_edit/filesystem.h"
+#include "payload_block_cache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <zstd.h>
+
+namespace omega_edit::internal {
+
+    namespace {
+        // A payload is sampled by compressing up to SAMPLE_COUNT regions of SAMPLE_LENGTH bytes spread across it
+        constexpr int64_t SAMPLE_LENGTH = 64 * 1024;
+        constexpr int64_t SAMPLE_COUNT = 8;
+
+        int level_for_backlog_(int64_t blocks_per_worker) {
+            if (blocks_per_worker <= 4) { return 3; }
+            if (blocks_per_worker <= 64) { return 1; }
+            return -4;
+        }
+
+        int64_t block_length_(const payload_compression_job_t &job, int64_t block_index) {
+            return (std::min)(PAYLOAD_BLOCK_SIZE, job.length - block_index * PAYLOAD_BLOCK_SIZE);
+        }
+
+        // Returns 1 if the sample shrinks by at least 5%, 0 if it doesn't, and -1 on errors
+        int sample_(const payload_compression_job_t &job, ZSTD_CCtx *context, std::vector<omega_byte_t> &source,
+                    std::vector<omega_byte_t> &compressed) {
+            const auto sample_count = (std::min)(SAMPLE_COUNT, (job.length + SAMPLE_LENGTH - 1) / SAMPLE_LENGTH);
+            const auto sample_length = (std::min)(SAMPLE_LENGTH, job.length);
+            try {
+                source.resize(static_cast<size_t>(sample_length));
+                compressed.resize(ZSTD_compressBound(source.size()));
+            } catch (const std::bad_alloc &) { return -1; }
+            int64_t compressed_total = 0;
+            for (int64_t sample = 0; sample < sample_count; ++sample) {
+                const auto offset =
+                        sample_count > 1 ? (job.length - sample_length) / (sample_count - 1) * sample : int64_t{0};
+                if (omega_util_read_file_segment(job.path.c_str(), offset, source.data(), sample_length) !=
+                    sample_length) {
+                    return -1;
+                }
+                const auto compressed_length = ZSTD_compressCCtx(context, compressed.data(), compressed.size(),
+                                                                 source.data(), source.size(), 1);
+                if (ZSTD_isError(compressed_length)) { return -1; }
+                compressed_total += static_cast<int64_t>(compressed_length);
+            }
+            return compressed_total * 20 <= sample_length * sample_count * 19 ? 1 : 0;
+        }
+
+        bool compress_block_(const payload_compression_job_t &job, int64_t block_index, int level, ZSTD_CCtx *context,
+                             std::vector<omega_byte_t> &source, std::vector<omega_byte_t> &compressed) {
+            const auto source_length = block_length_(job, block_index);
+            try {
+                source.resize(static_cast<size_t>(source_length));
+                compressed.resize(ZSTD_compressBound(source.size()));
+            } catch (const std::bad_alloc &) { return false; }
+            if (omega_util_read_file_segment(job.path.c_str(), block_index * PAYLOAD_BLOCK_SIZE, source.data(),
+                                             source_length) != source_length) {
+                return false;
+            }
+            const auto compressed_length = ZSTD_compressCCtx(context, compressed.data(), compressed.size(),
+                                                             source.data(), source.size(), level);
+            if (ZSTD_isError(compressed_length)) { return false; }
+            compressed.resize(compressed_length);
+            return true;
+        }
+    }// namespace
+
+    payload_compression_job_t::payload_compression_job_t(std::string path, int64_t length,
+                                                         std::shared_ptr<payload_block_cache_t> block_cache,
+                                                         uint64_t payload_id)
+        : path(std::move(path)), length(length), block_cache(std::move(block_cache)), payload_id(payload_id),
+          block_count_(length / PAYLOAD_BLOCK_SIZE + (length % PAYLOAD_BLOCK_SIZE == 0 ? 0 : 1)),
+          output_path_(this->path + ".zst.tmp") {}
+
+    payload_compressor_t &payload_compressor_t::instance() {
+        static payload_compressor_t compressor;
+        return compressor;
+    }
+
+    payload_compressor_t::~payload_compressor_t() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_available_.notify_all();
+        for (auto &worker : workers_) { worker.join(); }
+    }
+
+    bool payload_compressor_t::start_workers_() {
+        if (!workers_.empty()) { return true; }
+        const auto worker_count =
+                OMEGA_PAYLOAD_COMPRESSION_THREADS > 0
+                        ? static_cast<unsigned>(OMEGA_PAYLOAD_COMPRESSION_THREADS)
+                        : (std::max)(std::thread::hardware_concurrency(), 1U);
+        try {
+            while (workers_.size() < worker_count) { workers_.emplace_back(&payload_compressor_t::work_, this); }
+        } catch (const std::system_error &) {} catch (const std::bad_alloc &) {}
+        return !workers_.empty();
+    }
+
+    bool payload_compressor_t::submit(const std::shared_ptr<payload_compression_job_t> &job) {
+        if (!job || job->length <= 0) { return false; }
+        {
+            const std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || !start_workers_()) { return false; }
+            try {
+                queue_.push_back(job);
+            } catch (const std::bad_alloc &) { return false; }
+        }
+        work_available_.notify_all();
+        return true;
+    }
+
+    void payload_compressor_t::cancel(payload_compression_job_t &job) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job.cancelled_ = true;
+        job_finished_.wait(lock, [&job] { return job.active_ == 0; });
+        if (!job.finished_) { retire_(job); }
+    }
+
+    void payload_compressor_t::wait(payload_compression_job_t &job) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_finished_.wait(lock, [&job] { return job.finished_; });
+    }
+
+    bool payload_compressor_t::claim_(task_t &task) {
+        int64_t backlog = 0;
+        for (const auto &job : queue_) {
+            if (!job->abandoned_ && !job->cancelled_) { backlog += job->block_count_ - job->next_block_; }
+        }
+        // Workers run at most a couple of blocks ahead of the writer, bounding the compressed blocks held in memory
+        const auto window = 2 * static_cast<int64_t>(workers_.size());
+        for (const auto &job : queue_) {
+            if (job->abandoned_ || job->cancelled_) { continue; }
+            if (!job->sampled_) {
+                if (job->sampling_) { continue; }
+                job->sampling_ = true;
+                task = {job, -1, 1};
+            } else if (job->next_block_ < job->block_count_ && job->next_block_ - job->written_blocks_ < window) {
+                task = {job, job->next_block_++,
+                        level_for_backlog_(backlog / static_cast<int64_t>(workers_.size()))};
+            } else {
+                continue;
+            }
+            ++job->active_;
+            return true;
+        }
+        return false;
+    }
+
+    void payload_compressor_t::work_() {
+        auto *const context = ZSTD_createCCtx();
+        std::vector<omega_byte_t> source;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            task_t task;
+            work_available_.wait(lock, [&] { return stopping_ || claim_(task); });
+            if (stopping_) { break; }
+            auto &job = *task.job;
+            lock.unlock();
+            std::vector<omega_byte_t> compressed;
+            if (task.block_index < 0) {
+                auto sampled = context ? sample_(job, context, source, compressed) : -1;
+                if (sampled > 0) {
+                    job.output_ptr_ = fopen(job.output_path_.c_str(), "wb");
+                    if (!job.output_ptr_) { sampled = -1; }
+                }
+                lock.lock();
+                job.sampling_ = false;
+                // Payloads that wouldn't shrink enough stay raw
+                if (sampled > 0) {
+                    job.sampled_ = true;
+                } else {
+                    job.abandoned_ = true;
+                }
+            } else {
+                const auto compressed_block = context && compress_block_(job, task.block_index, task.level, context,
+                                                                         source, compressed);
+                lock.lock();
+                if (!compressed_block) {
+                    job.abandoned_ = true;
+                } else {
+                    try {
+                        job.results_.emplace(task.block_index, std::move(compressed));
+                    } catch (const std::bad_alloc &) { job.abandoned_ = true; }
+                    if (!job.writing_) { write_(job, lock); }
+                }
+            }
+            if (--job.active_ == 0 && (job.abandoned_ || job.cancelled_) && !job.finished_) { retire_(job); }
+            job_finished_.notify_all();
+            work_available_.notify_all();
+        }
+        ZSTD_freeCCtx(context);
+    }
+
+    void payload_compressor_t::write_(payload_compression_job_t &job, std::unique_lock<std::mutex> &lock) {
+        job.writing_ = true;
+        while (!job.abandoned_ && !job.cancelled_) {
+            const auto next = job.results_.find(job.written_blocks_);
+            if (next == job.results_.end()) { break; }
+            const auto block_index = next->first;
+            const auto compressed = std::move(next->second);
+            job.results_.erase(next);
+            lock.unlock();
+            auto written = compressed.size() <=
+                                   static_cast<size_t>((std::numeric_limits<int64_t>::max)() - job.output_length_) &&
+                           fwrite(compressed.data(), 1, compressed.size(), job.output_ptr_) == compressed.size();
+            if (written) {
+                try {
+                    job.output_blocks_.push_back({job.output_length_, static_cast<int64_t>(compressed.size()),
+                                                  block_length_(job, block_index)});
+                    job.output_length_ += static_cast<int64_t>(compressed.size());
+                } catch (const std::bad_alloc &) { written = false; }
+            }
+            lock.lock();
+            if (!written) {
+                job.abandoned_ = true;
+                break;
+            }
+            ++job.written_blocks_;
+            work_available_.notify_all();
+        }
+        if (!job.abandoned_ && !job.cancelled_ && job.written_blocks_ == job.block_count_) {
+            lock.unlock();
+            auto success = fflush(job.output_ptr_) == 0;
+            if (fclose(job.output_ptr_) != 0) { success = false; }
+            job.output_ptr_ = nullptr;
+
+            // Keep the raw payload unless compression saves enough to justify block metadata and decode cost
+            const auto metadata_bytes =
+                    static_cast<int64_t>(job.output_blocks_.size() * sizeof(compressed_payload_block_t));
+            const auto minimum_savings = (std::max)(int64_t{4096}, job.length / 20);
+            success = success && job.output_length_ <= job.length - (std::min)(job.length, metadata_bytes) &&
+                      job.output_length_ + metadata_bytes <= job.length - (std::min)(job.length, minimum_savings);
+            if (success) {
+                const std::lock_guard<std::mutex> payload_lock(job.mutex);
+                // The cache may hold the raw file open, which would keep it from being replaced on Windows
+                if (job.block_cache) { job.block_cache->forget(job.payload_id); }
+                const auto raw_path = job.path + ".raw.tmp";
+                if (rename(job.path.c_str(), raw_path.c_str()) != 0) {
+                    success = false;
+                } else if (rename(job.output_path_.c_str(), job.path.c_str()) != 0) {
+                    rename(raw_path.c_str(), job.path.c_str());
+                    success = false;
+                } else {
+                    omega_util_remove_file(raw_path.c_str());
+                    job.blocks = std::move(job.output_blocks_);
+                    job.published = true;
+                }
+            }
+            if (!success) { omega_util_remove_file(job.output_path_.c_str()); }
+            lock.lock();
+            job.finished_ = true;
+            queue_.erase(std::find_if(queue_.begin(), queue_.end(),
+                                      [&job](const auto &queued) { return queued.get() == &job; }));
+        }
+        job.writing_ = false;
+    }
+
+    void payload_compressor_t::retire_(payload_compression_job_t &job) {
+        if (job.output_ptr_) {
+            fclose(job.output_ptr_);
+            job.output_ptr_ = nullptr;
+            omega_util_remove_file(job.output_path_.c_str());
+        }
+        job.results_.clear();
+        job.finished_ = true;
+        const auto queued = std::find_if(queue_.begin(), queue_.end(),
+                                         [&job](const auto &queued_job) { return queued_job.get() == &job; });
+        if (queued != queue_.end()) { queue_.erase(queued); }
+        job_finished_.notify_all();
+    }
+
+}// namespace omega_edit::internal
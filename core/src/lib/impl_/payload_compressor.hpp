@@ -0,0 +1,152 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_PAYLOAD_COMPRESSOR_HPP
+#define OMEGA_EDIT_PAYLOAD_COMPRESSOR_HPP
+
+#include "change_def.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    /** Uncompressed length of every compressed payload block but the last */
+    constexpr int64_t PAYLOAD_BLOCK_SIZE = 1024 * 1024;
+
+    class payload_block_cache_t;
+
+    /**
+     * Background compression of one file-backed change payload.  The payload file keeps its raw bytes until every block
+     * has been compressed to a temporary file, which then replaces it while the mutex is held.  Readers of the payload
+     * hold the same mutex, so they see either the raw file or the published compressed file and its blocks.
+     */
+    struct payload_compression_job_t {
+        /**
+         * Describes the payload to compress
+         * @param path payload file
+         * @param length payload length in bytes
+         * @param block_cache cache the payload is read through (may be null), whose handles are dropped on publishing
+         * @param payload_id identifier of the payload in its cache
+         */
+        payload_compression_job_t(std::string path, int64_t length, std::shared_ptr<payload_block_cache_t> block_cache,
+                                  uint64_t payload_id);
+
+        payload_compression_job_t(const payload_compression_job_t &) = delete;
+        auto operator=(const payload_compression_job_t &) -> payload_compression_job_t & = delete;
+
+        const std::string path;
+        const int64_t length;
+        const std::shared_ptr<payload_block_cache_t> block_cache;
+        const uint64_t payload_id;
+
+        std::mutex mutex{};                              ///< Held while reading the payload file and while publishing
+        bool published{};                                ///< True once the payload file holds the compressed blocks
+        std::vector<compressed_payload_block_t> blocks{};///< Blocks of the published payload file
+
+    private:
+        friend class payload_compressor_t;
+
+        // Guarded by the compressor's mutex
+        int64_t block_count_{};
+        int64_t next_block_{};     ///< Next block for a worker to compress
+        int64_t written_blocks_{}; ///< Blocks written to the output file, in order
+        int64_t active_{};         ///< Workers busy with this job
+        bool sampling_{};
+        bool sampled_{};           ///< The sample showed the payload is worth compressing
+        bool abandoned_{};         ///< The payload stays raw (incompressible or failed)
+        bool cancelled_{};
+        bool writing_{};           ///< A worker is writing compressed blocks to the output file
+        bool finished_{};
+        std::map<int64_t, std::vector<omega_byte_t>> results_{};///< Compressed blocks waiting to be written
+
+        // Only used by the writing worker, or once no worker is active
+        std::string output_path_{};
+        FILE *output_ptr_{};
+        int64_t output_length_{};
+        std::vector<compressed_payload_block_t> output_blocks_{};
+    };
+
+    /**
+     * Process-wide worker pool compressing file-backed change payloads in the background, so the edit creating a
+     * payload doesn't wait for it.  The blocks of a payload are compressed in parallel, then written in order.  A
+     * sample of each payload is compressed first, and payloads that wouldn't shrink enough are left raw without paying
+     * for a full pass.  The compression level follows the backlog: spare workers buy better ratios, while a deep queue
+     * drops to zstd's fast levels so compression keeps up with editing.
+     */
+    class payload_compressor_t {
+    public:
+        /**
+         * Gets the process-wide compressor, whose workers start with the first job
+         * @return compressor
+         */
+        static payload_compressor_t &instance();
+
+        ~payload_compressor_t();
+
+        payload_compressor_t(const payload_compressor_t &) = delete;
+        auto operator=(const payload_compressor_t &) -> payload_compressor_t & = delete;
+
+        /**
+         * Queues a payload for compression
+         * @param job job describing the payload
+         * @return true if the job was queued, false if no worker could be started
+         */
+        bool submit(const std::shared_ptr<payload_compression_job_t> &job);
+
+        /**
+         * Stops a job, waiting for any worker busy with it and removing its temporary file, which must happen before
+         * the payload file is removed.  The payload file then holds either the raw or the compressed payload.
+         * @param job job to stop
+         */
+        void cancel(payload_compression_job_t &job);
+
+        /**
+         * Waits for a job to finish, whether the payload was compressed or left raw
+         * @param job job to wait for
+         */
+        void wait(payload_compression_job_t &job);
+
+    private:
+        struct task_t {
+            std::shared_ptr<payload_compression_job_t> job{};
+            int64_t block_index{};///< Block to compress, or -1 to sample the payload
+            int level{};
+        };
+
+        payload_compressor_t() = default;
+
+        bool start_workers_();
+        bool claim_(task_t &task);
+        void work_();
+        void write_(payload_compression_job_t &job, std::unique_lock<std::mutex> &lock);
+        void retire_(payload_compression_job_t &job);
+
+        std::mutex mutex_{};
+        std::condition_variable work_available_{};
+        std::condition_variable job_finished_{};
+        std::vector<std::shared_ptr<payload_compression_job_t>> queue_{};
+        std::vector<std::thread> workers_{};
+        bool stopping_{};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_PAYLOAD_COMPRESSOR_HPP
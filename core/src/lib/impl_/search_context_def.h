@@ -16,8 +16,12 @@
 #define OMEGA_EDIT_SEARCH_CONTEXT_DEF_H
 
 #include "../../include/omega_edit/fwd_defs.h"
+#include "byte_regex.hpp"
 #include "data_def.hpp"
 #include "find.h"
+#include "multi_pattern_automaton.hpp"
+#include "search_index.hpp"
+#include <memory>
 
 struct omega_search_context_struct {
     ~omega_search_context_struct() {
@@ -34,10 +38,36 @@ struct omega_search_context_struct {
     int64_t session_offset{};
     int64_t session_length{};
     int64_t match_offset{};
-    omega_util_byte_transform_t byte_transform{};
     omega_data_t pattern{};
     omega_data_t scratch_buffer{};
     int64_t scratch_capacity{};
+    std::unique_ptr<omega_edit::internal::byte_regex_t> regex_ptr{};///< Regex or hex mask, if not a literal pattern
+    int64_t match_length{};                                         ///< Length of the most recent match
+    int64_t scratch_offset{};///< Session offset of the first byte in the scratch buffer (regex searches only)
+    int64_t scratch_length{};///< Number of bytes in the scratch buffer (regex searches only)
+    const omega_byte_t *scratch_data{};///< Scratch bytes, in the buffer or borrowed from a mapped file (regex only)
+    omega_edit::internal::search_index_t::query_t index_query{};///< Search index query, empty if it can't be used
+    uint64_t content_pin_id{};///< Identifier of the content pinned by omega_search_context_pin_content, or 0
+    int64_t scan_offset{-1};  ///< Next start omega_search_next_match_bounded scans from after its limit, or -1
+};
+
+struct omega_multi_search_context_struct {
+    using automaton_t = omega_edit::internal::multi_pattern_automaton_t;
+
+    omega_session_t *session_ptr{};
+    std::unique_ptr<const automaton_t> automaton_ptr{};
+    int64_t session_offset{};
+    int64_t session_length{};
+    int64_t match_offset{};
+    int64_t match_pattern_id{-1};
+    automaton_t::state_t state{automaton_t::root};       ///< Automaton state after the bytes fed so far
+    automaton_t::state_t output_state{automaton_t::npos};///< State whose completed patterns are being reported
+    size_t output_index{};                               ///< Next pattern to report from output_state
+    omega_data_t window{};                               ///< Session bytes being fed to the automaton
+    int64_t window_capacity{};
+    int64_t window_offset{};  ///< Session offset of the first byte in the window
+    int64_t window_length{};  ///< Number of bytes in the window
+    int64_t window_position{};///< Number of window bytes fed to the automaton
 };
 
 #endif//OMEGA_EDIT_SEARCH_CONTEXT_DEF_H
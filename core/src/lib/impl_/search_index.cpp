@@ -0,0 +1,253 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "search_index.hpp"
+#include "../../include/omega_edit/filesystem.h"
+#include "macros.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#ifdef OMEGA_BUILD_WINDOWS
+
+#include <io.h>
+
+#define close _close
+#else
+
+#include <unistd.h>
+
+#endif
+
+namespace omega_edit::internal {
+
+    namespace {
+        constexpr int64_t index_magic = 0x0158444945474d4fLL;// "OMGEIDX\1" read as a little-endian integer
+
+        inline omega_byte_t ascii_lower_(omega_byte_t byte) {
+            return static_cast<omega_byte_t>(static_cast<unsigned>(byte - 'A') < 26U ? byte | 0x20U : byte);
+        }
+    }// namespace
+
+    static_assert(64 <= search_index_t::filter_bits && search_index_t::filter_bits <= (1LL << 24) &&
+                          (search_index_t::filter_bits & (search_index_t::filter_bits - 1)) == 0,
+                  "OMEGA_SEARCH_INDEX_FILTER_BITS must be a power of two between 64 and 2^24");
+    static_assert(3 <= search_index_t::block_length, "OMEGA_SEARCH_INDEX_BLOCK_LENGTH must be at least 3");
+
+    search_index_t::search_index_t(int64_t file_length)
+        : file_length_(file_length), block_count_((file_length + block_length - 1) / block_length),
+          filters_(static_cast<size_t>(block_count_) * filter_words) {}
+
+    uint32_t search_index_t::trigram_bit_(omega_byte_t byte0, omega_byte_t byte1, omega_byte_t byte2) {
+        return filter_bit_(static_cast<uint32_t>(byte0) | static_cast<uint32_t>(byte1) << 8 |
+                           static_cast<uint32_t>(byte2) << 16);
+    }
+
+    void search_index_t::add_block(int64_t block_index, const omega_byte_t *data, int64_t length) {
+        assert(0 <= block_index && block_index < block_count_);
+        auto *filter = filters_.data() + static_cast<size_t>(block_index) * filter_words;
+        const auto trigram_count = std::min(length - 2, block_length);
+        if (trigram_count <= 0) { return; }
+        // Roll the trigram along the block so each byte is lowercased once
+        auto trigram = static_cast<uint32_t>(ascii_lower_(data[0])) | static_cast<uint32_t>(ascii_lower_(data[1])) << 8;
+        for (int64_t i = 0; i < trigram_count; ++i) {
+            trigram |= static_cast<uint32_t>(ascii_lower_(data[i + 2])) << 16;
+            const auto bit = filter_bit_(trigram);
+            filter[bit / 64] |= uint64_t{1} << (bit % 64);
+            trigram >>= 8;
+        }
+    }
+
+    bool search_index_t::load(FILE *file_ptr, int64_t modification_time) {
+        assert(file_ptr);
+        int64_t header[5]{};
+        if (fread(header, sizeof(header), 1, file_ptr) != 1) { return false; }
+        if (header[0] != index_magic || header[1] != block_length || header[2] != filter_bits ||
+            header[3] != file_length_ || header[4] != modification_time) {
+            return false;
+        }
+        if (fread(filters_.data(), sizeof(uint64_t), filters_.size(), file_ptr) != filters_.size()) { return false; }
+        return fgetc(file_ptr) == EOF;
+    }
+
+    bool search_index_t::save(FILE *file_ptr, int64_t modification_time) const {
+        assert(file_ptr);
+        const int64_t header[5] = {index_magic, block_length, filter_bits, file_length_, modification_time};
+        return fwrite(header, sizeof(header), 1, file_ptr) == 1 &&
+               fwrite(filters_.data(), sizeof(uint64_t), filters_.size(), file_ptr) == filters_.size();
+    }
+
+    bool search_index_t::make_query(const omega_byte_t *pattern, int64_t pattern_length, query_t &query) {
+        assert(pattern);
+        query.clear();
+        // Longer patterns could touch more than two blocks
+        if (pattern_length < 3 || block_length < pattern_length) { return false; }
+        query.reserve(static_cast<size_t>(pattern_length - 2));
+        for (int64_t i = 0; i + 2 < pattern_length; ++i) {
+            query.push_back(trigram_bit_(ascii_lower_(pattern[i]), ascii_lower_(pattern[i + 1]),
+                                         ascii_lower_(pattern[i + 2])));
+        }
+        return true;
+    }
+
+    void search_index_t::block_candidates_(const query_t &query, int64_t block_index, int64_t &begin,
+                                           int64_t &end) const {
+        const auto trigram_count = static_cast<int64_t>(query.size());
+        const auto block_begin = block_index * block_length;
+        const auto block_end = block_begin + block_length;
+        begin = end = block_begin;
+
+        // Leading trigrams of the pattern in this block's filter
+        int64_t prefix_length = 0;
+        while (prefix_length < trigram_count && has_bit_(block_index, query[prefix_length])) { ++prefix_length; }
+        if (prefix_length == trigram_count) {
+            begin = block_begin;
+            end = block_end - trigram_count + 1;
+        }
+
+        // A match starting at block_end - j has its first j trigrams in this block and the rest in the next one
+        const auto split_high = std::min(prefix_length, trigram_count - 1);
+        if (split_high < 1 || block_index + 1 == block_count_) { return; }
+        auto suffix_begin = trigram_count;
+        while (suffix_begin > 0 && has_bit_(block_index + 1, query[suffix_begin - 1])) { --suffix_begin; }
+        const auto split_low = std::max(suffix_begin, int64_t{1});
+        if (split_low <= split_high) {
+            if (begin == end) { begin = block_end - split_high; }
+            end = block_end - split_low + 1;
+        }
+    }
+
+    bool search_index_t::next_candidates(const query_t &query, int64_t from, int64_t to, int64_t limit,
+                                         int64_t &run_begin, int64_t &run_end) const {
+        assert(!query.empty());
+        bool is_found = false;
+        for (auto block_index = std::max(from, int64_t{0}) / block_length;
+             block_index < block_count_ && block_index * block_length < to; ++block_index) {
+            int64_t begin = 0;
+            int64_t end = 0;
+            block_candidates_(query, block_index, begin, end);
+            begin = std::max(begin, from);
+            end = std::min(end, to);
+            if (begin >= end || (is_found && begin != run_end)) {
+                if (is_found) { break; }
+                continue;
+            }
+            if (!is_found) {
+                is_found = true;
+                run_begin = begin;
+            }
+            run_end = end;
+            // The run continues into the next block only if it reaches the end of this one
+            if (run_end < (block_index + 1) * block_length || limit <= run_end - run_begin) { break; }
+        }
+        return is_found;
+    }
+
+    int search_index_builder_t::start(const std::string &source_path, const std::string &index_path,
+                                      int64_t modification_time) {
+        if (is_started()) { return 0; }
+        is_cancelled_ = false;
+        try {
+            thread_ = std::thread(&search_index_builder_t::build_, this, source_path, index_path, modification_time);
+        } catch (const std::system_error &) { return -1; } catch (const std::bad_alloc &) {
+            return -1;
+        }
+        return 0;
+    }
+
+    void search_index_builder_t::cancel() {
+        is_cancelled_ = true;
+        if (thread_.joinable()) { thread_.join(); }
+    }
+
+    bool search_index_builder_t::wait() {
+        if (thread_.joinable()) { thread_.join(); }
+        return index() != nullptr;
+    }
+
+    std::shared_ptr<const search_index_t> search_index_builder_t::index() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_;
+    }
+
+    void search_index_builder_t::build_(std::string source_path, std::string index_path,
+                                        int64_t modification_time) {
+        try {
+            const auto file_length = omega_util_file_size(source_path.c_str());
+            if (file_length < 0) { return; }
+            auto index_ptr = std::make_shared<search_index_t>(file_length);
+
+            // Reuse the index saved by an earlier session on the same original file, if it's still valid
+            bool is_loaded = false;
+            if (!index_path.empty()) {
+                if (auto *index_file_ptr = FOPEN(index_path.c_str(), "rb")) {
+                    is_loaded = index_ptr->load(index_file_ptr, modification_time);
+                    FCLOSE(index_file_ptr);
+                }
+            }
+            if (!is_loaded) {
+                auto *source_file_ptr = FOPEN(source_path.c_str(), "rb");
+                if (!source_file_ptr) { return; }
+                // Read the file in order, carrying the two bytes that follow each block over to the next
+                std::vector<omega_byte_t> buffer(static_cast<size_t>(search_index_t::block_length + 2));
+                auto buffered = static_cast<int64_t>(fread(buffer.data(), 1, buffer.size(), source_file_ptr));
+                for (int64_t block_index = 0; block_index < index_ptr->block_count(); ++block_index) {
+                    if (is_cancelled_ || buffered <= 0) { break; }
+                    index_ptr->add_block(block_index, buffer.data(), buffered);
+                    if (buffered <= search_index_t::block_length) { break; }
+                    const auto carried = buffered - search_index_t::block_length;
+                    memmove(buffer.data(), buffer.data() + search_index_t::block_length, static_cast<size_t>(carried));
+                    buffered = carried + static_cast<int64_t>(fread(buffer.data() + carried, 1,
+                                                                   buffer.size() - static_cast<size_t>(carried),
+                                                                   source_file_ptr));
+                }
+                const auto is_read = !is_cancelled_ && !ferror(source_file_ptr);
+                FCLOSE(source_file_ptr);
+                if (!is_read) { return; }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                index_ = index_ptr;
+            }
+            if (is_loaded || index_path.empty()) { return; }
+
+            // Write to a temporary file and rename it into place, so concurrent sessions never load a partial index
+            std::string temp_path = index_path + ".XXXXXX";
+            const auto temp_fd = omega_util_mkstemp(&temp_path[0], 0600);// S_IRUSR | S_IWUSR
+            if (temp_fd < 0) {
+                LOG_ERROR("failed to create search index file for '" << index_path << "'");
+                return;
+            }
+            CLOSE(temp_fd);
+            bool is_saved = false;
+            if (auto *temp_file_ptr = FOPEN(temp_path.c_str(), "wb")) {
+                is_saved = index_ptr->save(temp_file_ptr, modification_time);
+                is_saved = (0 == FCLOSE(temp_file_ptr)) && is_saved;
+            }
+            if (is_saved && 0 != std::rename(temp_path.c_str(), index_path.c_str())) {
+                // Renaming over an existing file fails on Windows
+                omega_util_remove_file(index_path.c_str());
+                is_saved = 0 == std::rename(temp_path.c_str(), index_path.c_str());
+            }
+            if (!is_saved) {
+                LOG_ERROR("failed to save search index file '" << index_path << "'");
+                omega_util_remove_file(temp_path.c_str());
+            }
+        } catch (const std::bad_alloc &) {}
+    }
+
+}// namespace omega_edit::internal
@@ -0,0 +1,172 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_SEARCH_INDEX_HPP
+#define OMEGA_EDIT_SEARCH_INDEX_HPP
+
+#include "../../include/omega_edit/byte.h"
+#include "../../include/omega_edit/config.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace omega_edit::internal {
+
+    constexpr uint32_t search_index_log2_(int64_t value) { return value <= 1 ? 0 : 1 + search_index_log2_(value / 2); }
+
+    /**
+     * Block-level trigram index of an original file.
+     *
+     * Each block of OMEGA_SEARCH_INDEX_BLOCK_LENGTH bytes gets a one-hash Bloom filter of the (ASCII lowercased)
+     * trigrams that start in it.  A literal pattern can only match at an offset when every one of its trigrams is in
+     * the filters of the one or two blocks the match touches, so a search can skip the blocks that rule it out.
+     */
+    class search_index_t {
+    public:
+        static constexpr int64_t block_length = OMEGA_SEARCH_INDEX_BLOCK_LENGTH;
+        static constexpr int64_t filter_bits = OMEGA_SEARCH_INDEX_FILTER_BITS;
+
+        /** Filter bits of a pattern's trigrams, in pattern order */
+        using query_t = std::vector<uint32_t>;
+
+        /**
+         * Creates an empty index
+         * @param file_length length of the indexed file
+         * @throws std::bad_alloc if the filters can't be allocated
+         */
+        explicit search_index_t(int64_t file_length);
+
+        int64_t file_length() const { return file_length_; }
+
+        int64_t block_count() const { return block_count_; }
+
+        /**
+         * Adds the trigrams starting in a block to its filter
+         * @param block_index block to add to
+         * @param data block bytes, followed by up to two bytes of the next block
+         * @param length number of bytes in data
+         */
+        void add_block(int64_t block_index, const omega_byte_t *data, int64_t length);
+
+        /**
+         * Reads the filters from an index file written by save
+         * @param file_ptr index file, positioned at its beginning
+         * @param modification_time modification time of the original file the index must have been built from
+         * @return true if the index file is valid for this index, false otherwise
+         */
+        bool load(FILE *file_ptr, int64_t modification_time);
+
+        /**
+         * Writes the index to a file
+         * @param file_ptr file to write to
+         * @param modification_time modification time of the original file the index was built from
+         * @return true on success, false on failure
+         */
+        bool save(FILE *file_ptr, int64_t modification_time) const;
+
+        /**
+         * Builds the query for a pattern
+         * @param pattern pattern bytes
+         * @param pattern_length pattern length in bytes
+         * @param query receives the query
+         * @return true if the index can be used for the pattern, false if it's too short or too long to use
+         * @throws std::bad_alloc if the query can't be allocated
+         */
+        static bool make_query(const omega_byte_t *pattern, int64_t pattern_length, query_t &query);
+
+        /**
+         * Finds the first run of file offsets at which a match could start
+         * @param query pattern query from make_query
+         * @param from first file offset to consider
+         * @param to file offset to stop at
+         * @param limit stop extending the run once it's at least this long
+         * @param run_begin receives the first offset of the run
+         * @param run_end receives the offset after the run
+         * @return true if a run was found in [from, to), false if no match can start there
+         */
+        bool next_candidates(const query_t &query, int64_t from, int64_t to, int64_t limit, int64_t &run_begin,
+                             int64_t &run_end) const;
+
+    private:
+        static constexpr size_t filter_words = filter_bits / 64;
+        static constexpr uint32_t filter_shift = 32 - search_index_log2_(filter_bits);
+
+        static uint32_t filter_bit_(uint32_t trigram) { return (trigram * 0x9E3779B1U) >> filter_shift; }
+
+        static uint32_t trigram_bit_(omega_byte_t byte0, omega_byte_t byte1, omega_byte_t byte2);
+
+        bool has_bit_(int64_t block_index, uint32_t bit) const {
+            return 0 != (filters_[static_cast<size_t>(block_index) * filter_words + bit / 64] >> (bit % 64) & 1U);
+        }
+
+        void block_candidates_(const query_t &query, int64_t block_index, int64_t &begin, int64_t &end) const;
+
+        int64_t file_length_;
+        int64_t block_count_;
+        std::vector<uint64_t> filters_;
+    };
+
+    /**
+     * Builds (or loads) the search index of a session's original file on a background thread
+     */
+    class search_index_builder_t {
+    public:
+        search_index_builder_t() = default;
+        ~search_index_builder_t() { cancel(); }
+        search_index_builder_t(const search_index_builder_t &) = delete;
+        auto operator=(const search_index_builder_t &) -> search_index_builder_t & = delete;
+
+        /**
+         * Starts building the index
+         * @param source_path file to index
+         * @param index_path file to load the index from, or to save it to once it's built (empty to not persist it)
+         * @param modification_time modification time of the original file, which validates a saved index
+         * @return 0 if the build was started, -1 if the thread couldn't be started
+         */
+        int start(const std::string &source_path, const std::string &index_path, int64_t modification_time);
+
+        /** Stops the build (if running) and waits for the thread to finish */
+        void cancel();
+
+        /**
+         * Waits for the build to finish
+         * @return true if the index is ready, false if it failed or was cancelled
+         */
+        bool wait();
+
+        bool is_started() const { return thread_.joinable() || index(); }
+
+        /**
+         * Gets the index
+         * @return index, or nullptr if it isn't ready
+         */
+        std::shared_ptr<const search_index_t> index() const;
+
+    private:
+        void build_(std::string source_path, std::string index_path, int64_t modification_time);
+
+        mutable std::mutex mutex_;
+        std::shared_ptr<const search_index_t> index_;
+        std::atomic<bool> is_cancelled_{};
+        std::thread thread_;
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_SEARCH_INDEX_HPP
@@ -19,12 +19,18 @@
 #include "../../include/omega_edit/fwd_defs.h"
 #include "internal_fwd_defs.hpp"
 #include "model_def.hpp"
+#include "original_snapshot.hpp"
+#include "payload_block_cache.hpp"
+#include "search_index.hpp"
+#include <utility>
 #include <vector>
 
 using omega_model_ptr_t = std::unique_ptr<omega_model_t>;
 using omega_models_t = std::vector<omega_model_ptr_t>;
 using omega_search_context_ptr_t = std::shared_ptr<omega_search_context_t>;
 using omega_search_contexts_t = std::vector<omega_search_context_ptr_t>;
+using omega_multi_search_context_ptr_t = std::shared_ptr<omega_multi_search_context_t>;
+using omega_multi_search_contexts_t = std::vector<omega_multi_search_context_ptr_t>;
 using omega_viewport_ptr_t = std::shared_ptr<omega_viewport_t>;
 using omega_viewports_t = std::vector<omega_viewport_ptr_t>;
 
@@ -40,6 +46,7 @@ struct omega_session_struct {
     int32_t event_interest_;                   ///< Events of interest
     omega_viewports_t viewports_{};            ///< Collection of viewports in this session
     omega_search_contexts_t search_contexts_{};///< Collection of active search contexts
+    omega_multi_search_contexts_t multi_search_contexts_{};///< Collection of active multi-pattern search contexts
     omega_models_t models_{};                  ///< Edit models (internal)
     omega_models_t checkpoint_future_models_{};///< Checkpoint models preserved by non-destructive timeline rewind
     int64_t undo_snapshot_interval_{100};      ///< Undo model snapshot interval (0 = disabled, default 100)
@@ -52,6 +59,14 @@ struct omega_session_struct {
     std::string checkpoint_file_name_{};          ///< Name of session checkpoint file
     int64_t original_file_modification_time_{};   ///< Last synchronized modification time for the original file
     bool original_file_modification_time_valid_{};///< True when original_file_modification_time_ can be compared
+    std::unique_ptr<omega_edit::internal::search_index_builder_t> search_index_builder_{};///< Original file's index
+    uint64_t last_content_pin_id_{};///< Last identifier given to content pinned by a search context
+    std::unique_ptr<omega_edit::internal::snapshot_copier_t> original_snapshot_copier_{};///< Pending lazy snapshot
+    int64_t original_file_length_{};///< Length of the original file when the session was created (lazy snapshots)
+    bool original_file_replaced_{};///< True once a save replaced the original file, so its snapshot is stale
+    std::vector<std::pair<int64_t, int64_t>> in_place_saved_ranges_{};///< Original file ranges rewritten in place
+    bool in_place_journal_found_{};///< True if an interrupted in-place save journal existed at session creation
+    std::shared_ptr<omega_edit::internal::payload_block_cache_t> payload_block_cache_{};///< File-backed payload reads
 };
 
 namespace omega_edit::internal {
@@ -60,6 +75,25 @@ namespace omega_edit::internal {
     void omega_session_begin_event_batch_(omega_session_t *session_ptr, omega_session_event_t session_event);
     void omega_session_end_event_batch_(omega_session_t *session_ptr);
 
+    /**
+     * Gets the search index of the session's original file, if it's ready and the given model reads from that file
+     * @param session_ptr session to get the search index of
+     * @param model_ptr model of the session whose content is to be searched
+     * @return search index, or nullptr if there isn't a usable one
+     */
+    std::shared_ptr<const search_index_t> omega_session_get_search_index_(const omega_session_t *session_ptr,
+                                                                          const omega_model_t *model_ptr);
+
+    /**
+     * Switches the original model of a lazy snapshot session from the original file to the session's private snapshot
+     * once the snapshot is copied
+     * @param session_ptr session whose snapshot to adopt
+     * @param wait true to wait for the copy to finish, false to only adopt a snapshot that's already copied
+     * @return 0 if the original model reads the private snapshot (or will once the copy finishes, when not waiting),
+     * -1 if the snapshot couldn't be copied or opened, so the original model keeps reading the original file
+     */
+    int omega_session_adopt_original_snapshot_(omega_session_t *session_ptr, bool wait) noexcept;
+
 }// namespace omega_edit::internal
 
 #endif//OMEGA_EDIT_SESSION_DEF_HPP
@@ -0,0 +1,117 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "sha256.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace omega_edit::internal {
+
+    namespace {
+        constexpr uint32_t round_constants[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+        constexpr uint32_t rotate_right(uint32_t value, int count) {
+            return (value >> count) | (value << (32 - count));
+        }
+    }// namespace
+
+    sha256_t::sha256_t()
+        : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+    void sha256_t::update(const void *bytes, size_t length) {
+        const auto *input = static_cast<const uint8_t *>(bytes);
+        message_length_ += length;
+        while (length > 0) {
+            const auto count = std::min(length, block_.size() - block_length_);
+            std::memcpy(block_.data() + block_length_, input, count);
+            block_length_ += count;
+            input += count;
+            length -= count;
+            if (block_length_ == block_.size()) {
+                transform_(block_.data());
+                block_length_ = 0;
+            }
+        }
+    }
+
+    sha256_digest_t sha256_t::finish() {
+        const auto message_bits = message_length_ * 8;
+        const uint8_t padding = 0x80;
+        update(&padding, 1);
+        const uint8_t zero = 0;
+        while (block_length_ != block_.size() - 8) { update(&zero, 1); }
+        uint8_t length_bytes[8];
+        for (int i = 0; i < 8; ++i) { length_bytes[i] = static_cast<uint8_t>(message_bits >> (56 - 8 * i)); }
+        update(length_bytes, sizeof(length_bytes));
+        sha256_digest_t digest{};
+        for (size_t i = 0; i < digest.size(); ++i) {
+            digest[i] = static_cast<uint8_t>(state_[i / 4] >> (24 - 8 * (i % 4)));
+        }
+        return digest;
+    }
+
+    void sha256_t::transform_(const uint8_t *block) {
+        uint32_t schedule[64];
+        for (int i = 0; i < 16; ++i) {
+            schedule[i] = static_cast<uint32_t>(block[4 * i]) << 24 | static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+                          static_cast<uint32_t>(block[4 * i + 2]) << 8 | static_cast<uint32_t>(block[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const auto s0 = rotate_right(schedule[i - 15], 7) ^ rotate_right(schedule[i - 15], 18) ^
+                            (schedule[i - 15] >> 3);
+            const auto s1 = rotate_right(schedule[i - 2], 17) ^ rotate_right(schedule[i - 2], 19) ^
+                            (schedule[i - 2] >> 10);
+            schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+        }
+        auto a = state_[0];
+        auto b = state_[1];
+        auto c = state_[2];
+        auto d = state_[3];
+        auto e = state_[4];
+        auto f = state_[5];
+        auto g = state_[6];
+        auto h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            const auto t1 = h + (rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25)) +
+                            ((e & f) ^ (~e & g)) + round_constants[i] + schedule[i];
+            const auto t2 = (rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22)) +
+                            ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+        state_[4] += e;
+        state_[5] += f;
+        state_[6] += g;
+        state_[7] += h;
+    }
+
+}// namespace omega_edit::internal
@@ -0,0 +1,58 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef OMEGA_EDIT_SHA256_HPP
+#define OMEGA_EDIT_SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace omega_edit::internal {
+
+    /** SHA-256 digest */
+    using sha256_digest_t = std::array<uint8_t, 32>;
+
+    /**
+     * Incremental SHA-256 (FIPS 180-4) hasher
+     */
+    class sha256_t {
+    public:
+        sha256_t();
+
+        /**
+         * Adds bytes to the message
+         * @param bytes bytes to add
+         * @param length number of bytes
+         */
+        void update(const void *bytes, size_t length);
+
+        /**
+         * Completes the message, after which the hasher must not be updated again
+         * @return digest of the message
+         */
+        sha256_digest_t finish();
+
+    private:
+        void transform_(const uint8_t *block);
+
+        std::array<uint32_t, 8> state_{};
+        std::array<uint8_t, 64> block_{};
+        size_t block_length_{};
+        uint64_t message_length_{};
+    };
+
+}// namespace omega_edit::internal
+
+#endif//OMEGA_EDIT_SHA256_HPP
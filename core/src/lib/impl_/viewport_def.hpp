@@ -21,7 +21,8 @@
 
 struct omega_viewport_struct {
     omega_session_t *session_ptr{};            ///< Session that owns this viewport instance
-    omega_segment_t data_segment{};            ///< Viewport data
+    omega_segment_t data_segment{};            ///< Viewport data, borrowing either the buffer or session memory
+    omega_data_t buffer{};                     ///< Viewport buffer, used when the data can't be borrowed
     omega_viewport_event_cbk_t event_handler{};///< User callback when the viewport changes
     void *user_data_ptr{};                     ///< Pointer to associated user-provided data
     int32_t event_interest_{};                 ///< Events of interest
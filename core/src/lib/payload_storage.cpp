@@ -12,17 +12,19 @@
 
 #include "../include/omega_edit/config.h"
 #include "impl_/change_def.hpp"
+#include "impl_/payload_block_cache.hpp"
+#include "impl_/payload_compressor.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <zstd.h>
 
 namespace omega_edit::internal {
     namespace {
-        constexpr int64_t PAYLOAD_BLOCK_SIZE = 1024 * 1024;
-
         bool seek_(FILE *file, int64_t offset) {
 #if !defined(OMEGA_BUILD_WINDOWS) && !defined(HAVE_FSEEKO)
             return offset <= (std::numeric_limits<long>::max)() &&
@@ -31,79 +33,192 @@ namespace omega_edit::internal {
             return FSEEK(file, offset, SEEK_SET) == 0;
 #endif
         }
+
+        bool read_block_(FILE *file, const compressed_payload_block_t &block, std::vector<omega_byte_t> &compressed,
+                         omega_byte_t *decoded, ZSTD_DCtx *decompression_context) {
+            try {
+                if (compressed.size() < static_cast<size_t>(block.compressed_length)) {
+                    compressed.resize(static_cast<size_t>(block.compressed_length));
+                }
+            } catch (const std::bad_alloc &) { return false; }
+            if (!seek_(file, block.file_offset) ||
+                fread(compressed.data(), 1, static_cast<size_t>(block.compressed_length), file) !=
+                        static_cast<size_t>(block.compressed_length)) {
+                return false;
+            }
+            const auto decoded_length =
+                    decompression_context
+                            ? ZSTD_decompressDCtx(decompression_context, decoded,
+                                                  static_cast<size_t>(block.uncompressed_length), compressed.data(),
+                                                  static_cast<size_t>(block.compressed_length))
+                            : ZSTD_decompress(decoded, static_cast<size_t>(block.uncompressed_length),
+                                              compressed.data(), static_cast<size_t>(block.compressed_length));
+            return decoded_length == static_cast<size_t>(block.uncompressed_length);
+        }
     }// namespace
 
-    int omega_payload_compress_file_(omega_byte_payload_struct *payload) {
-        if (!payload || payload->storage != OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED || payload->length <= 0 ||
-            payload->file_path.empty()) {
-            return -1;
+    payload_block_cache_t::payload_block_cache_t(int64_t limit)
+        : decompression_context_(ZSTD_createDCtx()), limit_((std::max)(limit, int64_t{0})) {}
+
+    payload_block_cache_t::~payload_block_cache_t() {
+        for (const auto &file : files_) { fclose(file.file_ptr); }
+        ZSTD_freeDCtx(decompression_context_);
+    }
+
+    uint64_t payload_block_cache_t::next_payload_id() {
+        static std::atomic<uint64_t> last_payload_id{0};
+        return ++last_payload_id;
+    }
+
+    FILE *payload_block_cache_t::file_(const omega_byte_payload_struct *payload) {
+        ++file_uses_;
+        for (auto &file : files_) {
+            if (file.payload_id == payload->block_cache_id) {
+                file.last_use = file_uses_;
+                return file.file_ptr;
+            }
+        }
+        auto *file_ptr = fopen(payload->file_path.c_str(), "rb");
+        if (!file_ptr) { return nullptr; }
+        if (static_cast<int64_t>(files_.size()) >= (std::max)(OMEGA_PAYLOAD_CACHE_FILE_LIMIT, 1)) {
+            auto least_recent = std::min_element(files_.begin(), files_.end(), [](const auto &left, const auto &right) {
+                return left.last_use < right.last_use;
+            });
+            fclose(least_recent->file_ptr);
+            *least_recent = {payload->block_cache_id, file_ptr, file_uses_};
+            return file_ptr;
         }
-        std::string compressed_path;
-        std::string raw_path;
-        std::vector<omega_byte_t> source;
-        std::vector<omega_byte_t> compressed;
-        std::vector<compressed_payload_block_t> blocks;
         try {
-            compressed_path = payload->file_path + ".zst.tmp";
-            raw_path = payload->file_path + ".raw.tmp";
-            source.resize(static_cast<size_t>(PAYLOAD_BLOCK_SIZE));
-            compressed.resize(ZSTD_compressBound(source.size()));
-            const auto block_count = payload->length / PAYLOAD_BLOCK_SIZE +
-                                     (payload->length % PAYLOAD_BLOCK_SIZE == 0 ? int64_t{0} : int64_t{1});
-            blocks.reserve(static_cast<size_t>(block_count));
-        } catch (const std::bad_alloc &) { return -1; }
-        auto *input = fopen(payload->file_path.c_str(), "rb");
-        if (!input) { return -1; }
-        auto *output = fopen(compressed_path.c_str(), "wb");
-        if (!output) {
-            fclose(input);
-            return -1;
+            files_.push_back({payload->block_cache_id, file_ptr, file_uses_});
+        } catch (const std::bad_alloc &) {
+            fclose(file_ptr);
+            return nullptr;
         }
-        int64_t file_offset = 0;
-        int64_t remaining = payload->length;
-        bool success = true;
-        while (remaining > 0 && success) {
-            const auto source_length = (std::min)(remaining, PAYLOAD_BLOCK_SIZE);
-            if (fread(source.data(), 1, static_cast<size_t>(source_length), input) !=
-                static_cast<size_t>(source_length)) {
-                success = false;
-                break;
-            }
-            const auto compressed_length = ZSTD_compress(compressed.data(), compressed.size(), source.data(),
-                                                         static_cast<size_t>(source_length), 1);
-            if (ZSTD_isError(compressed_length) ||
-                compressed_length > static_cast<size_t>((std::numeric_limits<int64_t>::max)() - file_offset) ||
-                fwrite(compressed.data(), 1, compressed_length, output) != compressed_length) {
-                success = false;
+        return file_ptr;
+    }
+
+    void payload_block_cache_t::evict_(int64_t limit) {
+        while (cached_bytes_ > limit && !blocks_.empty()) {
+            cached_bytes_ -= static_cast<int64_t>(blocks_.back().bytes.size());
+            block_index_.erase(blocks_.back().key);
+            blocks_.pop_back();
+        }
+    }
+
+    const std::vector<omega_byte_t> *
+    payload_block_cache_t::block_(const omega_byte_payload_struct *payload,
+                                  const std::vector<compressed_payload_block_t> &blocks, int64_t block_index) {
+        const block_key_t key{payload->block_cache_id, block_index};
+        if (const auto found = block_index_.find(key); found != block_index_.end()) {
+            ++hits_;
+            blocks_.splice(blocks_.begin(), blocks_, found->second);
+            return &found->second->bytes;
+        }
+        ++misses_;
+        const auto &block = blocks[static_cast<size_t>(block_index)];
+        auto *file = file_(payload);
+        if (!file) { return nullptr; }
+        if (limit_ < block.uncompressed_length) {
+            // The budget can't hold the block, so it's decoded without being cached
+            try {
+                decoded_.resize(static_cast<size_t>(block.uncompressed_length));
+            } catch (const std::bad_alloc &) { return nullptr; }
+            return read_block_(file, block, compressed_, decoded_.data(), decompression_context_) ? &decoded_
+                                                                                                   : nullptr;
+        }
+        evict_(limit_ - block.uncompressed_length);
+        try {
+            blocks_.push_front({key, {}});
+            blocks_.front().bytes.resize(static_cast<size_t>(block.uncompressed_length));
+            block_index_.emplace(key, blocks_.begin());
+        } catch (const std::bad_alloc &) {
+            if (!blocks_.empty() && blocks_.front().key == key) { blocks_.pop_front(); }
+            return nullptr;
+        }
+        cached_bytes_ += block.uncompressed_length;
+        if (!read_block_(file, block, compressed_, blocks_.front().bytes.data(), decompression_context_)) {
+            cached_bytes_ -= block.uncompressed_length;
+            block_index_.erase(key);
+            blocks_.pop_front();
+            return nullptr;
+        }
+        return &blocks_.front().bytes;
+    }
+
+    int payload_block_cache_t::read(const omega_byte_payload_struct *payload,
+                                    const std::vector<compressed_payload_block_t> *blocks, int64_t offset,
+                                    omega_byte_t *buffer, int64_t byte_count) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (!blocks) {
+            auto *file = file_(payload);
+            if (!file || !seek_(file, offset)) { return -1; }
+            return fread(buffer, 1, static_cast<size_t>(byte_count), file) == static_cast<size_t>(byte_count) ? 0 : -1;
+        }
+        // Every block but the last decodes to PAYLOAD_BLOCK_SIZE bytes
+        int64_t copied = 0;
+        for (auto block_index = offset / PAYLOAD_BLOCK_SIZE; copied < byte_count; ++block_index) {
+            if (block_index >= static_cast<int64_t>(blocks->size())) { return -1; }
+            const auto *decoded = block_(payload, *blocks, block_index);
+            if (!decoded) { return -1; }
+            const auto block_offset = offset + copied - block_index * PAYLOAD_BLOCK_SIZE;
+            const auto copy_length =
+                    (std::min)(byte_count - copied, static_cast<int64_t>(decoded->size()) - block_offset);
+            if (copy_length <= 0) { return -1; }
+            std::memcpy(buffer + copied, decoded->data() + block_offset, static_cast<size_t>(copy_length));
+            copied += copy_length;
+        }
+        return 0;
+    }
+
+    void payload_block_cache_t::forget(uint64_t payload_id) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (auto iter = files_.begin(); iter != files_.end(); ++iter) {
+            if (iter->payload_id == payload_id) {
+                fclose(iter->file_ptr);
+                files_.erase(iter);
                 break;
             }
-            blocks.push_back({file_offset, static_cast<int64_t>(compressed_length), source_length});
-            file_offset += static_cast<int64_t>(compressed_length);
-            remaining -= source_length;
-        }
-        if (fflush(output) != 0) { success = false; }
-        if (fclose(output) != 0) { success = false; }
-        fclose(input);
-
-        // Preserve raw storage unless compression saves enough to justify block metadata and decode cost.
-        const auto metadata_bytes = static_cast<int64_t>(blocks.size() * sizeof(compressed_payload_block_t));
-        const auto minimum_savings = (std::max)(int64_t{4096}, payload->length / 20);
-        if (!success || file_offset > payload->length - (std::min)(payload->length, metadata_bytes) ||
-            file_offset + metadata_bytes > payload->length - (std::min)(payload->length, minimum_savings)) {
-            omega_util_remove_file(compressed_path.c_str());
-            return success ? 0 : -1;
-        }
-        if (rename(payload->file_path.c_str(), raw_path.c_str()) != 0) {
-            omega_util_remove_file(compressed_path.c_str());
-            return -1;
         }
-        if (rename(compressed_path.c_str(), payload->file_path.c_str()) != 0) {
-            rename(raw_path.c_str(), payload->file_path.c_str());
-            omega_util_remove_file(compressed_path.c_str());
+        for (auto iter = block_index_.lower_bound({payload_id, 0});
+             iter != block_index_.end() && iter->first.first == payload_id;) {
+            cached_bytes_ -= static_cast<int64_t>(iter->second->bytes.size());
+            blocks_.erase(iter->second);
+            iter = block_index_.erase(iter);
+        }
+    }
+
+    void payload_block_cache_t::set_limit(int64_t limit) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        limit_ = (std::max)(limit, int64_t{0});
+        evict_(limit_);
+    }
+
+    void payload_block_cache_t::get_stats(int64_t &hits, int64_t &misses, int64_t &cached_bytes,
+                                          int64_t &limit) const {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        hits = hits_;
+        misses = misses_;
+        cached_bytes = cached_bytes_;
+        limit = limit_;
+    }
+
+    int omega_payload_compress_file_(omega_byte_payload_struct *payload,
+                                     const std::shared_ptr<payload_block_cache_t> &block_cache) {
+        if (!payload || payload->storage != OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED || payload->length <= 0 ||
+            payload->file_path.empty()) {
             return -1;
         }
-        omega_util_remove_file(raw_path.c_str());
-        payload->compressed_blocks = std::move(blocks);
+        if (block_cache && !payload->block_cache) {
+            payload->block_cache = block_cache;
+            payload->block_cache_id = payload_block_cache_t::next_payload_id();
+        }
+        // The payload is readable raw until the compressed file is published, so it stays raw if compression can't
+        // be queued
+        try {
+            auto job = std::make_shared<payload_compression_job_t>(payload->file_path, payload->length,
+                                                                   payload->block_cache, payload->block_cache_id);
+            if (payload_compressor_t::instance().submit(job)) { payload->compression = std::move(job); }
+        } catch (const std::bad_alloc &) {}
         return 0;
     }
 
@@ -114,7 +229,14 @@ namespace omega_edit::internal {
             return -1;
         }
         if (byte_count == 0) { return 0; }
-        if (payload->compressed_blocks.empty()) {
+        std::unique_lock<std::mutex> compression_lock;
+        const std::vector<compressed_payload_block_t> *blocks = nullptr;
+        if (payload->compression) {
+            compression_lock = std::unique_lock<std::mutex>(payload->compression->mutex);
+            if (payload->compression->published) { blocks = &payload->compression->blocks; }
+        }
+        if (payload->block_cache) { return payload->block_cache->read(payload, blocks, offset, buffer, byte_count); }
+        if (!blocks) {
             return omega_util_read_file_segment(payload->file_path.c_str(), offset, buffer, byte_count) == byte_count
                            ? 0
                            : -1;
@@ -123,15 +245,13 @@ namespace omega_edit::internal {
         std::vector<omega_byte_t> decoded;
         try {
             const auto max_compressed =
-                    std::max_element(payload->compressed_blocks.begin(), payload->compressed_blocks.end(),
-                                     [](const auto &left, const auto &right) {
-                                         return left.compressed_length < right.compressed_length;
-                                     });
+                    std::max_element(blocks->begin(), blocks->end(), [](const auto &left, const auto &right) {
+                        return left.compressed_length < right.compressed_length;
+                    });
             const auto max_decoded =
-                    std::max_element(payload->compressed_blocks.begin(), payload->compressed_blocks.end(),
-                                     [](const auto &left, const auto &right) {
-                                         return left.uncompressed_length < right.uncompressed_length;
-                                     });
+                    std::max_element(blocks->begin(), blocks->end(), [](const auto &left, const auto &right) {
+                        return left.uncompressed_length < right.uncompressed_length;
+                    });
             compressed.resize(static_cast<size_t>(max_compressed->compressed_length));
             decoded.resize(static_cast<size_t>(max_decoded->uncompressed_length));
         } catch (const std::bad_alloc &) { return -1; }
@@ -140,7 +260,7 @@ namespace omega_edit::internal {
         int64_t block_start = 0;
         int64_t copied = 0;
         bool success = true;
-        for (const auto &block : payload->compressed_blocks) {
+        for (const auto &block : *blocks) {
             const auto block_end = block_start + block.uncompressed_length;
             if (block_end <= offset) {
                 block_start = block_end;
@@ -166,4 +286,20 @@ namespace omega_edit::internal {
         fclose(file);
         return success && copied == byte_count ? 0 : -1;
     }
+
+    void omega_payload_wait_for_compression_(const omega_byte_payload_struct *payload) {
+        if (payload && payload->compression) { payload_compressor_t::instance().wait(*payload->compression); }
+    }
+
+    void omega_payload_release_(omega_byte_payload_struct *payload) {
+        if (payload->compression) {
+            payload_compressor_t::instance().cancel(*payload->compression);
+            payload->compression.reset();
+        }
+        if (payload->block_cache) {
+            payload->block_cache->forget(payload->block_cache_id);
+            payload->block_cache.reset();
+        }
+        payload->block_cache_id = 0;
+    }
 }// namespace omega_edit::internal
@@ -24,20 +24,40 @@
 #include "impl_/session_def.hpp"
 #include <algorithm>
 #include <cassert>
+#include <climits>
+#include <condition_variable>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
 #include <utility>
 
+using omega_edit::internal::borrow_data_segment_;
+using omega_edit::internal::byte_regex_t;
 using omega_edit::internal::omega_data_borrow_;
 using omega_edit::internal::omega_data_create_;
 using omega_edit::internal::omega_data_destroy_;
 using omega_edit::internal::omega_data_get_data_;
+using omega_edit::internal::omega_data_get_data_const_;
+using omega_edit::internal::model_segment_kind_t;
+using omega_edit::internal::omega_model_segment_get_kind_;
+using omega_edit::internal::omega_session_get_search_index_;
 using omega_edit::internal::populate_data_segment_;
 using omega_edit::internal::safe_add_int64_;
+using omega_edit::internal::search_index_t;
 
 constexpr auto MAX_SEGMENT_LENGTH = static_cast<int64_t>(OMEGA_SEARCH_PATTERN_LENGTH_LIMIT) << 1;
 
+// Smallest window read by a regex search, which doubles as a search goes without finding a match
+constexpr int64_t MIN_REGEX_WINDOW_LENGTH = 64 * 1024;
+static_assert(0 < OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT &&
+                      OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT < OMEGA_SEARCH_PATTERN_LENGTH_LIMIT,
+              "a regex match and the bytes around it must fit in one window");
+
 static inline omega_byte_t ascii_to_lower_(omega_byte_t byte, void *) {
     return byte >= 0x41 && byte <= 0x5A ? static_cast<omega_byte_t>(byte + 0x20) : byte;
 }
@@ -347,6 +367,14 @@ static omega_util_byte_transform_t case_folding_transform_(omega_search_case_fol
     }
 }
 
+// Fills the fold table for the case folding mode, returning false if the mode matches bytes exactly
+static bool build_fold_table_(omega_search_case_folding_t case_folding, omega_byte_t (&fold_table)[UCHAR_MAX + 1]) {
+    const auto byte_transform = case_folding_transform_(case_folding);
+    if (!byte_transform) { return false; }
+    omega_util_fill_byte_table(fold_table, byte_transform, nullptr);
+    return true;
+}
+
 static bool case_folding_is_valid_(omega_search_case_folding_t case_folding) {
     switch (case_folding) {
         case OMEGA_SEARCH_CASE_FOLDING_NONE:
@@ -386,19 +414,23 @@ omega_search_context_t *omega_search_create_context_bytes(omega_session_t *sessi
             match_context_ptr->session_offset = session_offset;
             match_context_ptr->session_length = session_length_computed;
             match_context_ptr->match_offset = session_end;
-            match_context_ptr->byte_transform = case_folding_transform_(case_folding);
             omega_data_create_(&match_context_ptr->pattern, pattern_length);
             const auto pattern_data_ptr = omega_data_get_data_(&match_context_ptr->pattern, pattern_length);
             memcpy(pattern_data_ptr, pattern, pattern_length);
-            if (match_context_ptr->byte_transform) {
-                omega_util_apply_byte_transform(pattern_data_ptr, pattern_length, match_context_ptr->byte_transform,
-                                                nullptr);
+            // Fold the pattern once here, the matcher folds the session data as it compares
+            omega_byte_t fold_table[UCHAR_MAX + 1];
+            const auto is_folded = build_fold_table_(case_folding, fold_table);
+            if (is_folded) {
+                for (int64_t i = 0; i < pattern_length; ++i) { pattern_data_ptr[i] = fold_table[pattern_data_ptr[i]]; }
             }
             pattern_data_ptr[pattern_length] = '\0';
-            // create a skip table for patterns with lengths greater than 1 byte
-            match_context_ptr->skip_table_ptr =
-                    omega_find_create_skip_table(pattern_data_ptr, pattern_length, is_reverse_search);
+            match_context_ptr->skip_table_ptr = omega_find_create_folded_skip_table(
+                    pattern_data_ptr, pattern_length, is_reverse_search, is_folded ? fold_table : nullptr);
             if (!match_context_ptr->skip_table_ptr) { return nullptr; }
+            // The search index holds ASCII lowercased trigrams, so it can't rule out matches under other foldings
+            if (case_folding == OMEGA_SEARCH_CASE_FOLDING_NONE || case_folding == OMEGA_SEARCH_CASE_FOLDING_ASCII) {
+                search_index_t::make_query(pattern_data_ptr, pattern_length, match_context_ptr->index_query);
+            }
             session_ptr->search_contexts_.push_back(match_context_ptr);
             return match_context_ptr.get();
         } catch (const std::bad_alloc &) { return nullptr; }
@@ -406,6 +438,56 @@ omega_search_context_t *omega_search_create_context_bytes(omega_session_t *sessi
     return nullptr;
 }
 
+omega_search_context_t *omega_search_create_pattern_context(omega_session_t *session_ptr, const omega_byte_t *pattern,
+                                                            int64_t pattern_length,
+                                                            omega_search_pattern_syntax_t pattern_syntax,
+                                                            int64_t session_offset, int64_t session_length,
+                                                            omega_search_case_folding_t case_folding) {
+    if (!session_ptr || !pattern || pattern_length <= 0 || pattern_length >= OMEGA_SEARCH_PATTERN_LENGTH_LIMIT ||
+        session_offset < 0) {
+        return nullptr;
+    }
+    if (!case_folding_is_valid_(case_folding)) { return nullptr; }
+    byte_regex_t::syntax_t syntax;
+    switch (pattern_syntax) {
+        case OMEGA_SEARCH_PATTERN_SYNTAX_REGEX:
+            syntax = byte_regex_t::syntax_t::regex;
+            break;
+        case OMEGA_SEARCH_PATTERN_SYNTAX_HEX_MASK:
+            syntax = byte_regex_t::syntax_t::hex_mask;
+            break;
+        default:
+            return nullptr;
+    }
+    const auto computed_file_size = omega_session_get_computed_file_size(session_ptr);
+    if (computed_file_size < 0 || session_offset > computed_file_size) { return nullptr; }
+    const auto session_length_computed = session_length ? session_length : computed_file_size - session_offset;
+    int64_t session_end = 0;
+    if (session_length_computed < 0 || !safe_add_int64_(session_offset, session_length_computed, session_end) ||
+        session_end > computed_file_size) {
+        return nullptr;
+    }
+    try {
+        omega_byte_t fold_table[UCHAR_MAX + 1];
+        const auto is_folded = build_fold_table_(case_folding, fold_table);
+        const auto search_context_ptr = std::make_shared<omega_search_context_t>();
+        search_context_ptr->regex_ptr = std::make_unique<byte_regex_t>(
+                pattern, pattern_length, syntax, is_folded ? fold_table : nullptr,
+                OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT, static_cast<size_t>(OMEGA_SEARCH_DFA_CACHE_LIMIT));
+        search_context_ptr->session_ptr = session_ptr;
+        search_context_ptr->pattern_length = pattern_length;
+        search_context_ptr->session_offset = session_offset;
+        search_context_ptr->session_length = session_length_computed;
+        search_context_ptr->match_offset = session_end;
+        omega_data_create_(&search_context_ptr->pattern, pattern_length);
+        memcpy(omega_data_get_data_(&search_context_ptr->pattern, pattern_length), pattern, pattern_length);
+        session_ptr->search_contexts_.push_back(search_context_ptr);
+        return search_context_ptr.get();
+    } catch (const std::bad_alloc &) { return nullptr; } catch (const std::invalid_argument &) {
+        return nullptr;
+    } catch (const std::length_error &) { return nullptr; }
+}
+
 omega_search_context_t *omega_search_create_context(omega_session_t *session_ptr, const char *pattern,
                                                     int64_t pattern_length, int64_t session_offset,
                                                     int64_t session_length, omega_search_case_folding_t case_folding,
@@ -417,7 +499,7 @@ omega_search_context_t *omega_search_create_context(omega_session_t *session_ptr
 }
 
 int omega_search_context_is_reverse_search(const omega_search_context_t *search_context_ptr) {
-    if (!search_context_ptr) { return 0; }
+    if (!search_context_ptr || search_context_ptr->regex_ptr) { return 0; }
     return omega_find_is_reversed(search_context_ptr->skip_table_ptr);
 }
 
@@ -441,6 +523,190 @@ int64_t omega_search_context_get_pattern_length(const omega_search_context_t *se
     return search_context_ptr->pattern_length;
 }
 
+int64_t omega_search_context_get_match_length(const omega_search_context_t *search_context_ptr) {
+    if (!search_context_ptr) { return 0; }
+    return search_context_ptr->regex_ptr ? search_context_ptr->match_length : search_context_ptr->pattern_length;
+}
+
+int omega_search_context_pin_content(omega_search_context_t *search_context_ptr) {
+    if (!search_context_ptr || !search_context_ptr->session_ptr) { return -1; }
+    if (search_context_ptr->content_pin_id) { return 0; }
+    auto *const session_ptr = search_context_ptr->session_ptr;
+    const auto &model_ptr = session_ptr->models_.back();
+    const auto pin_id = session_ptr->last_content_pin_id_ + 1;
+    try {
+        model_ptr->pinned_segments.emplace(pin_id, model_ptr->model_segments.clone());
+    } catch (const std::bad_alloc &) { return -1; }
+    session_ptr->last_content_pin_id_ = pin_id;
+    search_context_ptr->content_pin_id = pin_id;
+    return 0;
+}
+
+/*
+ * Finds the content a search context searches: the model and segments it pinned, or else the session's current
+ * content.  Returns null if the pinned content went away with its checkpoint.
+ */
+static const omega_model_t *search_content_(const omega_search_context_t *search_context_ptr,
+                                            const omega_model_segments_t *&model_segments_ptr) {
+    const auto *session_ptr = search_context_ptr->session_ptr;
+    if (!search_context_ptr->content_pin_id) {
+        model_segments_ptr = &session_ptr->models_.back()->model_segments;
+        return session_ptr->models_.back().get();
+    }
+    for (const auto *models_ptr : {&session_ptr->models_, &session_ptr->checkpoint_future_models_}) {
+        for (const auto &model_ptr : *models_ptr) {
+            const auto iter = model_ptr->pinned_segments.find(search_context_ptr->content_pin_id);
+            if (iter != model_ptr->pinned_segments.end()) {
+                model_segments_ptr = &iter->second;
+                return model_ptr.get();
+            }
+        }
+    }
+    return nullptr;
+}
+
+// Releases the content pinned by a search context, if its checkpoint still has it
+static void unpin_content_(const omega_search_context_t *search_context_ptr) {
+    auto *const session_ptr = search_context_ptr->session_ptr;
+    for (auto *models_ptr : {&session_ptr->models_, &session_ptr->checkpoint_future_models_}) {
+        for (auto &model_ptr : *models_ptr) {
+            if (model_ptr->pinned_segments.erase(search_context_ptr->content_pin_id)) { return; }
+        }
+    }
+}
+
+// Gets the bytes of the data segment from the content a search context searches, borrowing them when possible
+static const omega_byte_t *borrow_search_segment_(const omega_search_context_t *search_context_ptr,
+                                                  omega_segment_t *data_segment_ptr) {
+    const omega_model_segments_t *model_segments_ptr = nullptr;
+    const auto *model_ptr = search_content_(search_context_ptr, model_segments_ptr);
+    return model_ptr ? borrow_data_segment_(model_ptr, *model_segments_ptr, data_segment_ptr) : nullptr;
+}
+
+/*
+ * Makes the scratch bytes of a regex search hold the session bytes [offset, offset + length), reading (or borrowing) a
+ * window of at least window_length bytes starting at offset unless it already holds them.  Returns a pointer to the
+ * byte at offset and sets available to the number of bytes held from there, or returns null on failure.
+ */
+static const omega_byte_t *regex_window_(omega_search_context_t *search_context_ptr, int64_t offset, int64_t length,
+                                         int64_t window_length, int64_t session_end, int64_t &available) {
+    const auto scratch_end = search_context_ptr->scratch_offset + search_context_ptr->scratch_length;
+    if (search_context_ptr->scratch_offset <= offset && offset + length <= scratch_end) {
+        available = scratch_end - offset;
+        return search_context_ptr->scratch_data + (offset - search_context_ptr->scratch_offset);
+    }
+    omega_segment_t data_segment;
+    data_segment.offset = offset;
+    data_segment.capacity = std::min(session_end - offset, std::max(window_length, length));
+    if (search_context_ptr->scratch_capacity < data_segment.capacity) {
+        try {
+            omega_data_t scratch_buffer{};
+            omega_data_create_(&scratch_buffer, data_segment.capacity);
+            search_context_ptr->scratch_buffer = std::move(scratch_buffer);
+        } catch (const std::bad_alloc &) { return nullptr; }
+        search_context_ptr->scratch_capacity = data_segment.capacity;
+    }
+    search_context_ptr->scratch_length = 0;
+    omega_data_borrow_(&data_segment.data,
+                       omega_data_get_data_(&search_context_ptr->scratch_buffer, search_context_ptr->scratch_capacity),
+                       data_segment.capacity);
+    const auto *window_data = borrow_search_segment_(search_context_ptr, &data_segment);
+    if (!window_data) { return nullptr; }
+    search_context_ptr->scratch_data = window_data;
+    search_context_ptr->scratch_offset = offset;
+    search_context_ptr->scratch_length = data_segment.length;
+    available = data_segment.length;
+    return window_data;
+}
+
+/*
+ * Finds the next leftmost-longest match of a regex or hex mask.  A forward DFA streams through the session to where the
+ * earliest-ending match ends.  The leftmost match can't start more than max_length bytes before that, nor end more than
+ * max_length bytes after it, so the starts are then resolved within that neighbourhood: by trying each position with an
+ * anchored DFA while that's cheap, otherwise by finding every start with a reverse DFA.
+ */
+static int next_regex_match_(omega_search_context_t *search_context_ptr, int64_t advance_context) {
+    auto &regex = *search_context_ptr->regex_ptr;
+    int64_t session_end = 0;
+    if (!safe_add_int64_(search_context_ptr->session_offset, search_context_ptr->session_length, session_end)) {
+        return -1;
+    }
+    auto search_offset = search_context_ptr->session_offset;
+    if (search_context_ptr->match_offset != session_end &&
+        !safe_add_int64_(search_context_ptr->match_offset, advance_context, search_offset)) {
+        return -1;
+    }
+    const auto max_length = regex.max_length();
+    // The session may have changed since the last call, so nothing read then is reused
+    search_context_ptr->scratch_length = 0;
+    auto window_length = std::max(MIN_REGEX_WINDOW_LENGTH, 2 * max_length + 1);
+    std::vector<int64_t> starts;
+    while (search_offset <= session_end - regex.min_length()) {
+        // Scan for the end of the earliest-ending match
+        auto state = regex.find_end_start();
+        int64_t match_end = -1;
+        for (auto position = search_offset; match_end < 0 && position < session_end;) {
+            int64_t available = 0;
+            const auto *window_data =
+                    regex_window_(search_context_ptr, position, 1, window_length, session_end, available);
+            if (!window_data) { return -1; }
+            if (available <= 0) { break; }
+            window_length = std::min(window_length << 1, MAX_SEGMENT_LENGTH);
+            const auto found = regex.find_end(window_data, std::min(available, session_end - position), state);
+            if (found < 0) {
+                position += available;
+            } else {
+                match_end = position + found;
+            }
+        }
+        if (match_end < 0) { break; }
+
+        // Resolve the leftmost match, which starts in [low, match_end] and ends by high
+        const auto low = std::max(search_offset, match_end - max_length);
+        const auto high = std::min(session_end, match_end + max_length);
+        int64_t available = 0;
+        const auto *data = regex_window_(search_context_ptr, low, high - low, window_length, session_end, available);
+        if (!data || available < high - low) { return -1; }
+        auto budget = 2 * (high - low);
+        auto start = low;
+        try {
+            for (; start <= match_end && 0 <= budget; ++start) {
+                int64_t scanned = 0;
+                const auto length =
+                        regex.longest_match(data + (start - low), std::min(max_length, high - start), scanned);
+                if (length) {
+                    search_context_ptr->match_offset = start;
+                    search_context_ptr->match_length = length;
+                    return 1;
+                }
+                budget -= scanned;
+            }
+            if (start <= match_end) {
+                regex.find_starts(data, high - low, starts);
+                for (auto iter = starts.rbegin(); iter != starts.rend() && low + *iter <= match_end; ++iter) {
+                    if (low + *iter < start) { continue; }
+                    int64_t scanned = 0;
+                    const auto length = regex.longest_match(data + *iter, std::min(max_length, high - low - *iter),
+                                                            scanned);
+                    if (length) {
+                        search_context_ptr->match_offset = low + *iter;
+                        search_context_ptr->match_length = length;
+                        return 1;
+                    }
+                }
+            }
+        } catch (const std::bad_alloc &) { return -1; }
+
+        // Only matches longer than the match length limit start in [low, match_end]
+        search_offset = match_end + 1;
+    }
+
+    // No match remains, so the match offset is the end of the searched range
+    search_context_ptr->match_offset = session_end;
+    search_context_ptr->match_length = 0;
+    return 0;
+}
+
 /*
  * Function to find the next match of the pattern in the given context, advancing the context as required.
  * The function uses an algorithm that can search in both forward and reverse direction.
@@ -450,10 +716,117 @@ int64_t omega_search_context_get_pattern_length(const omega_search_context_t *se
  * then it skips to 1 + window_capacity - needle_length, as far as we can skip, with just enough backward coverage to
  * catch patterns that were on the window boundary.
  */
-int omega_search_next_match(omega_search_context_t *search_context_ptr, int64_t advance_context) {
-    // Sanity checks for the arguments.
-    if (!search_context_ptr || !search_context_ptr->session_ptr || advance_context < 0) { return 0; }
+/*
+ * Finds the first run of content offsets in [from, to) at which a literal pattern could start, according to the search
+ * index of the original file.  Matches that lie entirely within original bytes can only start where the index allows,
+ * while inserted bytes aren't indexed, so a match could start anywhere in them or straddle into them.  Returns false if
+ * no match can start in [from, to).  The run is at most limit long.
+ */
+static bool next_candidate_run_(const omega_model_segments_t &model_segments, const search_index_t &index,
+                                const search_index_t::query_t &query, int64_t pattern_length, int64_t from, int64_t to,
+                                int64_t limit, int64_t &run_begin, int64_t &run_end) {
+    const auto computed_length = model_segments.computed_length();
+    bool has_run = false;
+    // Adds [begin, end) to the run, returning false once the run is complete
+    const auto extend_run = [&](int64_t begin, int64_t end) {
+        begin = std::max(begin, from);
+        end = std::min(end, to);
+        if (begin >= end) { return true; }
+        if (!has_run) {
+            has_run = true;
+            run_begin = begin;
+            run_end = end;
+        } else if (begin > run_end) {
+            return false;
+        } else {
+            run_end = std::max(run_end, end);
+        }
+        return run_end - run_begin < limit;
+    };
+    const auto end = model_segments.end();
+    auto iter = from < computed_length ? model_segments.find(from) : end;
+    while (iter != end && iter.computed_offset() < to) {
+        const auto segment_begin = iter.computed_offset();
+        auto segment_end = segment_begin + iter->computed_length;
+        if (omega_model_segment_get_kind_(iter.change()) == model_segment_kind_t::SEGMENT_INSERT) {
+            ++iter;
+            if (!extend_run(segment_begin, segment_end)) { break; }
+            continue;
+        }
 
+        // Coalesce the read segments that are contiguous in the original file
+        const auto file_begin = iter->change_offset;
+        for (++iter; iter != end; ++iter) {
+            if (omega_model_segment_get_kind_(iter.change()) != model_segment_kind_t::SEGMENT_READ ||
+                iter->change_offset != file_begin + (segment_end - segment_begin)) {
+                break;
+            }
+            segment_end += iter->computed_length;
+        }
+        const auto inner_end = std::min(segment_end - pattern_length + 1, to);
+        auto position = std::max(from, segment_begin);
+        auto is_complete = false;
+        while (position < inner_end) {
+            // Once there's a run, only a candidate that continues it is of interest
+            const auto search_end = has_run ? std::min(inner_end, run_end + 1) : inner_end;
+            int64_t file_run_begin = 0;
+            int64_t file_run_end = 0;
+            if (!index.next_candidates(query, file_begin + (position - segment_begin),
+                                       file_begin + (search_end - segment_begin), limit, file_run_begin,
+                                       file_run_end)) {
+                is_complete = has_run;
+                break;
+            }
+            position = segment_begin + (file_run_end - file_begin);
+            if (!extend_run(segment_begin + (file_run_begin - file_begin), position)) {
+                is_complete = true;
+                break;
+            }
+        }
+        if (is_complete) { break; }
+        // Matches starting in the last pattern_length - 1 bytes straddle into the next segment
+        if (segment_end < computed_length &&
+            !extend_run(std::max(segment_begin, segment_end - pattern_length + 1), segment_end)) {
+            break;
+        }
+    }
+    if (has_run) { run_end = std::min(run_end, run_begin + limit); }
+    return has_run;
+}
+
+/*
+ * Forward literal search that only reads the runs of the content the search index can't rule out, starting from
+ * data_segment.offset.  The data segment's buffer must hold data_segment.capacity bytes, which must be at least the
+ * pattern length.
+ */
+static int next_indexed_match_(omega_search_context_t *search_context_ptr, const omega_model_t *model_ptr,
+                               const omega_model_segments_t &model_segments, const search_index_t &index,
+                               omega_segment_t &data_segment, int64_t last_offset) {
+    const auto pattern_length = search_context_ptr->pattern_length;
+    const auto *pattern = omega_data_get_data_(&search_context_ptr->pattern, pattern_length);
+    const auto capacity = data_segment.capacity;
+    const auto positions_end = last_offset - pattern_length + 1;
+    int64_t run_begin = 0;
+    int64_t run_end = 0;
+    for (auto offset = data_segment.offset;
+         next_candidate_run_(model_segments, index, search_context_ptr->index_query, pattern_length, offset,
+                             positions_end, capacity - pattern_length + 1, run_begin, run_end);
+         offset = run_end) {
+        data_segment.offset = run_begin;
+        data_segment.capacity = run_end - run_begin + pattern_length - 1;
+        const auto *segment_data_ptr = borrow_data_segment_(model_ptr, model_segments, &data_segment);
+        if (!segment_data_ptr || data_segment.length != data_segment.capacity) { return -1; }
+        if (const auto *found = omega_find(segment_data_ptr, data_segment.length, search_context_ptr->skip_table_ptr,
+                                           pattern, pattern_length)) {
+            search_context_ptr->match_offset = data_segment.offset + (found - segment_data_ptr);
+            return 1;
+        }
+    }
+    search_context_ptr->match_offset = last_offset;
+    return 0;
+}
+
+static int next_match_(omega_search_context_t *search_context_ptr, int64_t advance_context) {
     // Calculate the last offset in the session. If we have no match, then this will be the match offset.
     int64_t last_offset = 0;
     if (!safe_add_int64_(search_context_ptr->session_offset, search_context_ptr->session_length, last_offset)) {
@@ -533,23 +906,25 @@ int omega_search_next_match(omega_search_context_t *search_context_ptr, int64_t
                 return -1;
             }
             data_segment.offset = is_begin ? search_context_ptr->session_offset : next_offset;
+            if (!search_context_ptr->index_query.empty()) {
+                const omega_model_segments_t *model_segments_ptr = nullptr;
+                const auto *model_ptr = search_content_(search_context_ptr, model_segments_ptr);
+                if (!model_ptr) { return -1; }
+                const auto index_ptr = omega_session_get_search_index_(search_context_ptr->session_ptr, model_ptr);
+                if (index_ptr) {
+                    return next_indexed_match_(search_context_ptr, model_ptr, *model_segments_ptr, *index_ptr,
+                                               data_segment, last_offset);
+                }
+            }
         }
 
         // Loop until a match is found, or we have searched the entire segment.
         do {
-            // Populate the data segment to be searched.
-            if (populate_data_segment_(search_context_ptr->session_ptr, &data_segment) != 0) { return -1; }
-
-            // Get a pointer to the segment data.
-            auto *segment_data_ptr = omega_segment_get_data(&data_segment);
-
-            // If a byte transformation function is set in the context, apply it to the segment data.
-            if (search_context_ptr->byte_transform) {
-                omega_util_apply_byte_transform(segment_data_ptr, data_segment.length,
-                                                search_context_ptr->byte_transform, nullptr);
-            }
+            // Get the data segment to be searched, borrowed from the mapped file or read into the scratch buffer.
+            const auto *segment_data_ptr = borrow_search_segment_(search_context_ptr, &data_segment);
+            if (!segment_data_ptr) { return -1; }
 
-            // Try to find the pattern in the current segment.
+            // Try to find the pattern in the current segment, case folding (if any) is done by the matcher.
             if (auto *found = omega_find(segment_data_ptr, data_segment.length, search_context_ptr->skip_table_ptr,
                                          pattern, search_context_ptr->pattern_length)) {
                 // If a match is found, update the match offset in the search context.
@@ -577,6 +952,69 @@ int omega_search_next_match(omega_search_context_t *search_context_ptr, int64_t
     return 0;
 }
 
+int omega_search_next_match(omega_search_context_t *search_context_ptr, int64_t advance_context) {
+    return omega_search_next_match_bounded(search_context_ptr, advance_context, 0);
+}
+
+/*
+ * Bounds a literal search by narrowing the searched range to the starting offsets it may try, then searching that from
+ * its beginning.  The full range is restored before returning, and where the scan stopped is kept for the next call.
+ */
+int omega_search_next_match_bounded(omega_search_context_t *search_context_ptr, int64_t advance_context,
+                                    int64_t scan_length) {
+    // Sanity checks for the arguments.
+    if (!search_context_ptr || !search_context_ptr->session_ptr || advance_context < 0 || scan_length < 0) {
+        return 0;
+    }
+    if (search_context_ptr->regex_ptr) { return next_regex_match_(search_context_ptr, advance_context); }
+    if (!scan_length && search_context_ptr->scan_offset < 0) {
+        return next_match_(search_context_ptr, advance_context);
+    }
+    const auto pattern_length = search_context_ptr->pattern_length;
+    int64_t session_end = 0;
+    if (!safe_add_int64_(search_context_ptr->session_offset, search_context_ptr->session_length, session_end)) {
+        return -1;
+    }
+    const auto is_reverse = omega_find_is_reversed(search_context_ptr->skip_table_ptr);
+
+    // The starting offsets left to try are [first, last], reverse matches end before the previous match
+    auto first = search_context_ptr->session_offset;
+    auto last = session_end - pattern_length;
+    if (0 <= search_context_ptr->scan_offset) {
+        (is_reverse ? last : first) = search_context_ptr->scan_offset;
+    } else if (search_context_ptr->match_offset != session_end) {
+        if (is_reverse ? !safe_add_int64_(search_context_ptr->match_offset - pattern_length + 1, -advance_context, last)
+                       : !safe_add_int64_(search_context_ptr->match_offset, advance_context, first)) {
+            return -1;
+        }
+    }
+    search_context_ptr->scan_offset = -1;
+    if (first > last) {
+        search_context_ptr->match_offset = session_end;
+        return 0;
+    }
+    const auto is_bounded = scan_length && scan_length <= last - first;
+    if (is_bounded && is_reverse) {
+        first = last - scan_length + 1;
+    } else if (is_bounded) {
+        last = first + scan_length - 1;
+    }
+
+    const auto session_offset = search_context_ptr->session_offset;
+    const auto session_length = search_context_ptr->session_length;
+    search_context_ptr->session_offset = first;
+    search_context_ptr->session_length = last - first + pattern_length;
+    search_context_ptr->match_offset = first + search_context_ptr->session_length;
+    const auto result = next_match_(search_context_ptr, 0);
+    search_context_ptr->session_offset = session_offset;
+    search_context_ptr->session_length = session_length;
+    if (result != 0) { return result; }
+    search_context_ptr->match_offset = session_end;
+    if (!is_bounded) { return 0; }
+    search_context_ptr->scan_offset = is_reverse ? first - 1 : last + 1;
+    return 2;
+}
+
 void omega_search_destroy_context(omega_search_context_t *const search_context_ptr) {
     if (search_context_ptr) {
         for (auto iter = search_context_ptr->session_ptr->search_contexts_.rbegin();
@@ -588,9 +1026,405 @@ void omega_search_destroy_context(omega_search_context_t *const search_context_p
                     search_context_ptr->skip_table_ptr = nullptr;
                 }
                 omega_data_destroy_(&search_context_ptr->scratch_buffer, search_context_ptr->scratch_capacity);
+                if (search_context_ptr->content_pin_id) { unpin_content_(search_context_ptr); }
                 search_context_ptr->session_ptr->search_contexts_.erase(std::next(iter).base());
                 break;
             }
         }
     }
 }
+
+namespace {
+    /*
+     * Shared state of a parallel find-all search.  Workers claim chunks in order, read them from the session one at a
+     * time (the session's file handle and payload storage aren't safe for concurrent reads), then scan them
+     * concurrently.  At most max_pending chunks are claimed ahead of the one being reported, which bounds memory.
+     */
+    class find_all_job_t {
+    public:
+        find_all_job_t(omega_session_t *session_ptr, const omega_search_context_t *search_context_ptr,
+                       int64_t chunk_length)
+            : session_ptr_(session_ptr),
+              index_ptr_(search_context_ptr->index_query.empty()
+                                 ? nullptr
+                                 : omega_session_get_search_index_(session_ptr, session_ptr->models_.back().get())),
+              index_query_ptr_(&search_context_ptr->index_query), skip_table_ptr_(search_context_ptr->skip_table_ptr),
+              pattern_(omega_data_get_data_const_(&search_context_ptr->pattern, search_context_ptr->pattern_length)),
+              pattern_length_(search_context_ptr->pattern_length),
+              session_offset_(search_context_ptr->session_offset), chunk_length_(chunk_length) {
+            // Matches can start anywhere up to session_end - pattern_length
+            const auto position_count =
+                    search_context_ptr->session_length - search_context_ptr->pattern_length + 1;
+            positions_end_ = session_offset_ + position_count;
+            chunk_count_ = (position_count + chunk_length - 1) / chunk_length;
+        }
+
+        int64_t chunk_count() const { return chunk_count_; }
+
+        // Appends the offsets of matches starting in the chunk, reading only the runs the search index can't rule out
+        int scan_chunk(int64_t chunk_index, omega_data_t &buffer, int64_t &buffer_capacity,
+                       std::vector<int64_t> &matches) {
+            const auto chunk_offset = session_offset_ + chunk_index * chunk_length_;
+            const auto chunk_end = std::min(chunk_offset + chunk_length_, positions_end_);
+            if (!index_ptr_) { return scan_run_(chunk_offset, chunk_end, buffer, buffer_capacity, matches); }
+            int64_t run_begin = 0;
+            int64_t run_end = 0;
+            for (auto offset = chunk_offset;
+                 next_candidate_run_(session_ptr_->models_.back()->model_segments, *index_ptr_, *index_query_ptr_,
+                                     pattern_length_, offset, chunk_end, chunk_length_, run_begin, run_end);
+                 offset = run_end) {
+                if (scan_run_(run_begin, run_end, buffer, buffer_capacity, matches) != 0) { return -1; }
+            }
+            return 0;
+        }
+
+        // Worker thread body: scan chunks until there are none left or the search stops.  Nothing may escape a worker
+        // thread, so any exception fails the search instead.
+        void work() noexcept {
+            try {
+                omega_data_t buffer{};
+                int64_t buffer_capacity = 0;
+                for (;;) {
+                    int64_t chunk_index = 0;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        claimable_.wait(lock, [this] {
+                            return is_stopped_ || is_failed_ || next_claim_ == chunk_count_ ||
+                                   next_claim_ < next_report_ + max_pending_;
+                        });
+                        if (is_stopped_ || is_failed_ || next_claim_ == chunk_count_) { return; }
+                        chunk_index = next_claim_++;
+                    }
+                    std::vector<int64_t> matches;
+                    if (scan_chunk(chunk_index, buffer, buffer_capacity, matches) != 0) {
+                        fail_();
+                        return;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        results_[chunk_index] = std::move(matches);
+                    }
+                    reportable_.notify_one();
+                }
+            } catch (...) { fail_(); }
+        }
+
+        // Waits for the next chunk in order, returning false if a worker failed
+        bool take_next(std::vector<int64_t> &matches) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            reportable_.wait(lock, [this] { return is_failed_ || results_.count(next_report_) != 0; });
+            if (is_failed_) { return false; }
+            const auto iter = results_.find(next_report_++);
+            matches = std::move(iter->second);
+            results_.erase(iter);
+            lock.unlock();
+            claimable_.notify_all();
+            return true;
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                is_stopped_ = true;
+            }
+            claimable_.notify_all();
+        }
+
+        void set_max_pending(int64_t max_pending) { max_pending_ = max_pending; }
+
+    private:
+        void fail_() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                is_failed_ = true;
+            }
+            reportable_.notify_one();
+            claimable_.notify_all();
+        }
+
+        // Reads the match positions [run_begin, run_end) plus pattern_length - 1 bytes of overlap, and scans them
+        int scan_run_(int64_t run_begin, int64_t run_end, omega_data_t &buffer, int64_t &buffer_capacity,
+                      std::vector<int64_t> &matches) {
+            const auto read_length = run_end - run_begin + pattern_length_ - 1;
+            if (buffer_capacity < read_length) {
+                omega_data_t new_buffer{};
+                omega_data_create_(&new_buffer, read_length);
+                buffer = std::move(new_buffer);
+                buffer_capacity = read_length;
+            }
+            omega_segment_t data_segment;
+            data_segment.offset = run_begin;
+            data_segment.capacity = read_length;
+            omega_data_borrow_(&data_segment.data, omega_data_get_data_(&buffer, buffer_capacity), read_length);
+            const omega_byte_t *run_data;
+            {
+                std::lock_guard<std::mutex> read_lock(read_mutex_);
+                const auto &model_ptr = session_ptr_->models_.back();
+                run_data = borrow_data_segment_(model_ptr.get(), model_ptr->model_segments, &data_segment);
+            }
+            if (!run_data || data_segment.length != read_length) { return -1; }
+            int64_t position = 0;
+            while (const auto *found = omega_find(run_data + position, static_cast<size_t>(read_length - position),
+                                                  skip_table_ptr_, pattern_, static_cast<size_t>(pattern_length_))) {
+                position = found - run_data;
+                matches.push_back(run_begin + position);
+                ++position;
+            }
+            return 0;
+        }
+
+        omega_session_t *session_ptr_;
+        std::shared_ptr<const search_index_t> index_ptr_;
+        const search_index_t::query_t *index_query_ptr_;
+        const omega_find_skip_table_t *skip_table_ptr_;
+        const omega_byte_t *pattern_;
+        int64_t pattern_length_;
+        int64_t session_offset_;
+        int64_t chunk_length_;
+        int64_t positions_end_{};
+        int64_t chunk_count_{};
+        std::mutex read_mutex_;
+        std::mutex mutex_;
+        std::condition_variable claimable_;
+        std::condition_variable reportable_;
+        std::map<int64_t, std::vector<int64_t>> results_;
+        int64_t next_claim_{};
+        int64_t next_report_{};
+        int64_t max_pending_{1};
+        bool is_stopped_{};
+        bool is_failed_{};
+    };
+
+    // Worker threads of a find-all job, stopped and joined on every way out of the search so none is left joinable
+    class find_all_workers_t {
+    public:
+        explicit find_all_workers_t(find_all_job_t &job) : job_(job) {}
+
+        find_all_workers_t(const find_all_workers_t &) = delete;
+
+        auto operator=(const find_all_workers_t &) -> find_all_workers_t & = delete;
+
+        ~find_all_workers_t() {
+            job_.stop();
+            for (auto &worker : workers_) { worker.join(); }
+        }
+
+        // Starts up to worker_count workers, returning how many started
+        auto start(int64_t worker_count) -> int64_t {
+            workers_.reserve(static_cast<size_t>(worker_count));
+            try {
+                for (int64_t i = 0; i < worker_count; ++i) { workers_.emplace_back(&find_all_job_t::work, &job_); }
+            } catch (const std::system_error &) {
+                // Carry on with the workers that did start
+            } catch (const std::bad_alloc &) {}
+            return static_cast<int64_t>(workers_.size());
+        }
+
+    private:
+        find_all_job_t &job_;
+        std::vector<std::thread> workers_{};
+    };
+}// namespace
+
+int64_t omega_search_find_all(omega_session_t *session_ptr, const omega_byte_t *pattern, int64_t pattern_length,
+                              int64_t session_offset, int64_t session_length, omega_search_case_folding_t case_folding,
+                              int64_t limit, int thread_count, omega_search_matches_cbk_t cbk, void *user_data_ptr) {
+    if (!cbk || limit < 0 || thread_count < 0) { return -1; }
+    // The search context validates the arguments, folds the pattern, and builds the skip table shared by the workers
+    const std::unique_ptr<omega_search_context_t, decltype(&omega_search_destroy_context)> search_context_ptr(
+            omega_search_create_context_bytes(session_ptr, pattern, pattern_length, session_offset, session_length,
+                                              case_folding, 0),
+            &omega_search_destroy_context);
+    if (!search_context_ptr) { return -1; }
+
+    int64_t match_count = 0;
+    // Reports one chunk's matches, returning false once the limit is reached or the callback cancels
+    const auto report = [&](std::vector<int64_t> &matches) {
+        auto count = static_cast<int64_t>(matches.size());
+        const auto is_limited = limit > 0 && limit - match_count <= count;
+        if (is_limited) { count = limit - match_count; }
+        match_count += count;
+        return cbk(matches.data(), count, user_data_ptr) == 0 && !is_limited;
+    };
+
+    try {
+        find_all_job_t job(session_ptr, search_context_ptr.get(), OMEGA_SEARCH_PARALLEL_CHUNK_LENGTH);
+        auto worker_count = static_cast<int64_t>(thread_count ? thread_count : std::thread::hardware_concurrency());
+        worker_count = std::min(worker_count, job.chunk_count());
+        std::vector<int64_t> matches;
+        if (worker_count <= 1) {
+            // Not worth any threads, so scan the chunks in order here
+            omega_data_t buffer{};
+            int64_t buffer_capacity = 0;
+            for (int64_t chunk_index = 0; chunk_index < job.chunk_count(); ++chunk_index) {
+                matches.clear();
+                if (job.scan_chunk(chunk_index, buffer, buffer_capacity, matches) != 0) { return -1; }
+                if (!report(matches)) { break; }
+            }
+            return match_count;
+        }
+
+        job.set_max_pending(2 * worker_count);
+        find_all_workers_t workers(job);
+        if (workers.start(worker_count) == 0) { return -1; }
+        for (int64_t chunk_index = 0; chunk_index < job.chunk_count(); ++chunk_index) {
+            if (!job.take_next(matches)) { return -1; }
+            if (!report(matches)) { break; }
+        }
+        return match_count;
+    } catch (const std::bad_alloc &) { return -1; }
+}
+
+omega_multi_search_context_t *omega_search_create_multi_context(omega_session_t *session_ptr,
+                                                                const omega_byte_t *const *patterns,
+                                                                const int64_t *pattern_lengths, int64_t pattern_count,
+                                                                int64_t session_offset, int64_t session_length,
+                                                                omega_search_case_folding_t case_folding) {
+    if (!session_ptr || !patterns || !pattern_lengths || pattern_count <= 0 || session_offset < 0) { return nullptr; }
+    if (!case_folding_is_valid_(case_folding)) { return nullptr; }
+    for (int64_t i = 0; i < pattern_count; ++i) {
+        if (!patterns[i] || pattern_lengths[i] <= 0 || pattern_lengths[i] >= OMEGA_SEARCH_PATTERN_LENGTH_LIMIT) {
+            return nullptr;
+        }
+    }
+    const auto computed_file_size = omega_session_get_computed_file_size(session_ptr);
+    if (computed_file_size < 0 || session_offset > computed_file_size) { return nullptr; }
+    const auto session_length_computed = session_length ? session_length : computed_file_size - session_offset;
+    int64_t session_end = 0;
+    if (session_length_computed < 0 || !safe_add_int64_(session_offset, session_length_computed, session_end) ||
+        session_end > computed_file_size) {
+        return nullptr;
+    }
+    try {
+        omega_byte_t fold_table[UCHAR_MAX + 1];
+        const auto is_folded = build_fold_table_(case_folding, fold_table);
+        const auto search_context_ptr = std::make_shared<omega_multi_search_context_t>();
+        search_context_ptr->automaton_ptr = std::make_unique<omega_multi_search_context_t::automaton_t>(
+                patterns, pattern_lengths, pattern_count, is_folded ? fold_table : nullptr);
+        search_context_ptr->session_ptr = session_ptr;
+        search_context_ptr->session_offset = session_offset;
+        search_context_ptr->session_length = session_length_computed;
+        search_context_ptr->match_offset = session_end;
+        search_context_ptr->window_offset = session_offset;
+        session_ptr->multi_search_contexts_.push_back(search_context_ptr);
+        return search_context_ptr.get();
+    } catch (const std::bad_alloc &) { return nullptr; } catch (const std::length_error &) { return nullptr; }
+}
+
+/*
+ * Feeds the session to the automaton one window at a time, stopping whenever the automaton reaches a state that
+ * completes a pattern, then reports that state's patterns followed by those of its output links.  The automaton state
+ * carries across windows, so unlike omega_search_next_match no window overlap is needed and every byte is read once.
+ */
+int omega_search_next_multi_match(omega_multi_search_context_t *search_context_ptr) {
+    using automaton_t = omega_multi_search_context_t::automaton_t;
+
+    if (!search_context_ptr || !search_context_ptr->session_ptr) { return 0; }
+    const auto &automaton = *search_context_ptr->automaton_ptr;
+    int64_t session_end = 0;
+    if (!safe_add_int64_(search_context_ptr->session_offset, search_context_ptr->session_length, session_end)) {
+        return -1;
+    }
+
+    for (;;) {
+        // Report the remaining patterns that end at the current position
+        while (search_context_ptr->output_state != automaton_t::npos) {
+            size_t output_count = 0;
+            const auto *pattern_ids = automaton.outputs(search_context_ptr->output_state, output_count);
+            if (search_context_ptr->output_index < output_count) {
+                const auto pattern_id = pattern_ids[search_context_ptr->output_index++];
+                search_context_ptr->match_pattern_id = pattern_id;
+                search_context_ptr->match_offset = search_context_ptr->window_offset +
+                                                   search_context_ptr->window_position -
+                                                   automaton.pattern_length(pattern_id);
+                return 1;
+            }
+            search_context_ptr->output_state = automaton.output_link(search_context_ptr->output_state);
+            search_context_ptr->output_index = 0;
+        }
+
+        // Read the next window once every byte of the current one has been fed
+        if (search_context_ptr->window_position == search_context_ptr->window_length) {
+            const auto next_offset = search_context_ptr->window_offset + search_context_ptr->window_length;
+            if (next_offset >= session_end) { break; }
+            omega_segment_t data_segment;
+            data_segment.offset = next_offset;
+            data_segment.capacity = std::min(session_end - next_offset, MAX_SEGMENT_LENGTH);
+            if (search_context_ptr->window_capacity < data_segment.capacity) {
+                try {
+                    omega_data_t window{};
+                    omega_data_create_(&window, data_segment.capacity);
+                    search_context_ptr->window = std::move(window);
+                } catch (const std::bad_alloc &) { return -1; }
+                search_context_ptr->window_capacity = data_segment.capacity;
+            }
+            omega_data_borrow_(
+                    &data_segment.data,
+                    omega_data_get_data_(&search_context_ptr->window, search_context_ptr->window_capacity),
+                    data_segment.capacity);
+            if (populate_data_segment_(search_context_ptr->session_ptr, &data_segment) != 0) { return -1; }
+            if (data_segment.length <= 0) { break; }
+            search_context_ptr->window_offset = next_offset;
+            search_context_ptr->window_length = data_segment.length;
+            search_context_ptr->window_position = 0;
+        }
+
+        // Feed the window until a state completes a pattern
+        const auto *window_data =
+                omega_data_get_data_(&search_context_ptr->window, search_context_ptr->window_capacity);
+        auto state = search_context_ptr->state;
+        auto position = search_context_ptr->window_position;
+        const auto window_length = search_context_ptr->window_length;
+        while (position < window_length) {
+            state = automaton.next(state, window_data[position++]);
+            if (state & automaton_t::output_flag) {
+                state &= ~automaton_t::output_flag;
+                search_context_ptr->output_state = state;
+                search_context_ptr->output_index = 0;
+                break;
+            }
+        }
+        search_context_ptr->state = state;
+        search_context_ptr->window_position = position;
+    }
+
+    // No match remains, so the match offset is the end of the searched range
+    search_context_ptr->match_offset = session_end;
+    search_context_ptr->match_pattern_id = -1;
+    return 0;
+}
+
+int64_t omega_search_multi_context_get_match_offset(const omega_multi_search_context_t *search_context_ptr) {
+    if (!search_context_ptr) { return -1; }
+    return search_context_ptr->match_offset;
+}
+
+int64_t omega_search_multi_context_get_match_pattern_id(const omega_multi_search_context_t *search_context_ptr) {
+    if (!search_context_ptr) { return -1; }
+    return search_context_ptr->match_pattern_id;
+}
+
+int64_t omega_search_multi_context_get_pattern_count(const omega_multi_search_context_t *search_context_ptr) {
+    if (!search_context_ptr) { return 0; }
+    return search_context_ptr->automaton_ptr->pattern_count();
+}
+
+int64_t omega_search_multi_context_get_pattern_length(const omega_multi_search_context_t *search_context_ptr,
+                                                      int64_t pattern_id) {
+    if (!search_context_ptr || pattern_id < 0 || pattern_id >= search_context_ptr->automaton_ptr->pattern_count()) {
+        return 0;
+    }
+    return search_context_ptr->automaton_ptr->pattern_length(pattern_id);
+}
+
+void omega_search_destroy_multi_context(omega_multi_search_context_t *const search_context_ptr) {
+    if (search_context_ptr) {
+        auto &contexts = search_context_ptr->session_ptr->multi_search_contexts_;
+        for (auto iter = contexts.rbegin(); iter != contexts.rend(); ++iter) {
+            if (search_context_ptr == iter->get()) {
+                contexts.erase(std::next(iter).base());
+                break;
+            }
+        }
+    }
+}
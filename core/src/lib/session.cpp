@@ -33,12 +33,16 @@
 #include <limits>
 
 using omega_edit::internal::change_kind_t;
+using omega_edit::internal::model_file_is_unchanged_;
 using omega_edit::internal::omega_change_get_kind_;
 using omega_edit::internal::omega_change_get_transaction_bit_;
 using omega_edit::internal::omega_data_get_data_;
+using omega_edit::internal::omega_payload_wait_for_compression_;
 using omega_edit::internal::omega_session_end_event_batch_;
 using omega_edit::internal::populate_data_segment_;
 using omega_edit::internal::safe_add_int64_;
+using omega_edit::internal::search_index_builder_t;
+using omega_edit::internal::search_index_t;
 
 namespace {
     constexpr int64_t OMEGA_SESSION_SCAN_BUFFER_SIZE = 65536;
@@ -76,6 +80,8 @@ int omega_session_get_segment(const omega_session_t *session_ptr, omega_segment_
 
 int64_t omega_session_get_original_file_size(const omega_session_t *session_ptr) {
     if (!session_ptr || session_ptr->models_.empty() || !session_ptr->models_.front()) { return -1; }
+    // While a lazy snapshot is being copied, its file isn't complete yet
+    if (session_ptr->original_snapshot_copier_) { return session_ptr->original_file_length_; }
     return omega_util_file_size(omega_session_get_original_snapshot_file_path(session_ptr));
 }
 
@@ -109,20 +115,14 @@ int64_t omega_session_get_num_viewports(const omega_session_t *session_ptr) {
 
 int64_t omega_session_get_num_search_contexts(const omega_session_t *session_ptr) {
     if (!session_ptr) { return 0; }
-    return (int64_t) session_ptr->search_contexts_.size();
+    return (int64_t) (session_ptr->search_contexts_.size() + session_ptr->multi_search_contexts_.size());
 }
 
 int64_t omega_session_get_computed_file_size(const omega_session_t *session_ptr) {
     if (!session_ptr) { return 0; }
     assert(session_ptr->models_.back());
-    int64_t last_segment_end = 0;
-    if (!session_ptr->models_.back()->model_segments.empty() &&
-        !safe_add_int64_(session_ptr->models_.back()->model_segments.back()->computed_offset,
-                         session_ptr->models_.back()->model_segments.back()->computed_length, last_segment_end)) {
-        return -1;
-    }
-    const auto computed_file_size = session_ptr->models_.back()->model_segments.empty() ? 0 : last_segment_end;
-    return computed_file_size;
+    // The piece tree keeps the total segment length at its root, so this does not walk the segments
+    return session_ptr->models_.back()->model_segments.computed_length();
 }
 
 int64_t omega_session_get_num_changes(const omega_session_t *session_ptr) {
@@ -164,10 +164,16 @@ const char *omega_session_get_file_path(const omega_session_t *session_ptr) {
 }
 
 const char *omega_session_get_original_snapshot_file_path(const omega_session_t *session_ptr) {
-    if (!session_ptr || session_ptr->checkpoint_file_name_.empty()) { return nullptr; }
+    if (!session_ptr || session_ptr->checkpoint_file_name_.empty() || session_ptr->original_snapshot_copier_) {
+        return nullptr;
+    }
     return session_ptr->checkpoint_file_name_.c_str();
 }
 
+int omega_session_has_in_place_save_journal(const omega_session_t *session_ptr) {
+    return session_ptr && session_ptr->in_place_journal_found_ ? 1 : 0;
+}
+
 const char *omega_session_get_latest_checkpoint_file_path(const omega_session_t *session_ptr) {
     if (!session_ptr || omega_session_get_num_checkpoints(session_ptr) <= 0) { return nullptr; }
     assert(session_ptr->models_.back());
@@ -526,6 +532,137 @@ int64_t omega_session_set_change_inline_payload_limit(omega_session_t *session_p
     return session_ptr->change_inline_payload_limit_;
 }
 
+namespace {
+    struct payload_cache_stats_t {
+        int64_t hits{};
+        int64_t misses{};
+        int64_t cached_bytes{};
+        int64_t limit{};
+    };
+
+    auto get_payload_cache_stats_(const omega_session_t *session_ptr) -> payload_cache_stats_t {
+        payload_cache_stats_t stats;
+        if (session_ptr && session_ptr->payload_block_cache_) {
+            session_ptr->payload_block_cache_->get_stats(stats.hits, stats.misses, stats.cached_bytes, stats.limit);
+        }
+        return stats;
+    }
+}// namespace
+
+int64_t omega_session_get_payload_cache_limit(const omega_session_t *session_ptr) {
+    return get_payload_cache_stats_(session_ptr).limit;
+}
+
+int64_t omega_session_set_payload_cache_limit(omega_session_t *session_ptr, int64_t limit) {
+    if (!session_ptr || !session_ptr->payload_block_cache_ || limit < 0) { return 0; }
+    session_ptr->payload_block_cache_->set_limit(limit);
+    return omega_session_get_payload_cache_limit(session_ptr);
+}
+
+int64_t omega_session_get_payload_cache_hits(const omega_session_t *session_ptr) {
+    return get_payload_cache_stats_(session_ptr).hits;
+}
+
+int64_t omega_session_get_payload_cache_misses(const omega_session_t *session_ptr) {
+    return get_payload_cache_stats_(session_ptr).misses;
+}
+
+int64_t omega_session_get_payload_cache_bytes(const omega_session_t *session_ptr) {
+    return get_payload_cache_stats_(session_ptr).cached_bytes;
+}
+
+int omega_session_wait_for_payload_compression(const omega_session_t *session_ptr) {
+    if (!session_ptr) { return -1; }
+    for (const auto *models : {&session_ptr->models_, &session_ptr->checkpoint_future_models_}) {
+        for (const auto &model_ptr : *models) {
+            for (const auto *changes : {&model_ptr->changes, &model_ptr->changes_undone}) {
+                for (const auto &change_ptr : *changes) {
+                    omega_payload_wait_for_compression_(&change_ptr->data);
+                    omega_payload_wait_for_compression_(&change_ptr->inverse_data);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+int omega_session_build_search_index(omega_session_t *session_ptr) {
+    if (!session_ptr || session_ptr->checkpoint_file_name_.empty() || session_ptr->models_.front()->file_path.empty()) {
+        return -1;
+    }
+    try {
+        if (!session_ptr->search_index_builder_) {
+            session_ptr->search_index_builder_ = std::make_unique<search_index_builder_t>();
+        }
+        // The saved index is named after the original file, and is only saved if a later session can tell it's stale
+        std::string index_path;
+        const auto *const normalized_path =
+                omega_util_normalize_path(session_ptr->models_.front()->file_path.c_str(), nullptr);
+        if (session_ptr->original_file_modification_time_valid_ && normalized_path) {
+            uint64_t path_hash = 0xcbf29ce484222325ULL;// FNV-1a
+            for (const auto *c = normalized_path; *c; ++c) {
+                path_hash = (path_hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3ULL;
+            }
+            char index_filename[FILENAME_MAX + 1];
+            if (FILENAME_MAX > snprintf(static_cast<char *>(index_filename), FILENAME_MAX,
+                                        "%s%c.OmegaEdit-index.%016llx", session_ptr->checkpoint_directory_.c_str(),
+                                        omega_util_directory_separator(), static_cast<unsigned long long>(path_hash))) {
+                index_path.assign(index_filename);
+            }
+        }
+        // Sessions with a pending lazy snapshot index the original file, which is what they read
+        const auto &source_path = session_ptr->original_snapshot_copier_ ? session_ptr->models_.front()->file_path
+                                                                         : session_ptr->checkpoint_file_name_;
+        return session_ptr->search_index_builder_->start(source_path, index_path,
+                                                         session_ptr->original_file_modification_time_);
+    } catch (const std::bad_alloc &) { return -1; }
+}
+
+int omega_session_wait_for_search_index(omega_session_t *session_ptr) {
+    if (!session_ptr || !session_ptr->search_index_builder_) { return -1; }
+    return session_ptr->search_index_builder_->wait() ? 0 : -1;
+}
+
+int omega_session_wait_for_original_snapshot(omega_session_t *session_ptr) {
+    if (!session_ptr) { return -1; }
+    return omega_edit::internal::omega_session_adopt_original_snapshot_(session_ptr, true);
+}
+
+int omega_edit::internal::omega_session_adopt_original_snapshot_(omega_session_t *session_ptr, bool wait) noexcept {
+    assert(session_ptr);
+    auto &copier_ptr = session_ptr->original_snapshot_copier_;
+    if (!copier_ptr) { return 0; }
+    if (!wait && !copier_ptr->is_finished()) { return 0; }
+    if (!copier_ptr->wait()) {
+        // The session keeps reading the original file, so check it now, failing every read from it if it changed
+        copier_ptr->verify_source_is_unchanged();
+        return -1;
+    }
+    auto *const snapshot_file_ptr = FOPEN(session_ptr->checkpoint_file_name_.c_str(), "rb");
+    if (!snapshot_file_ptr) { return -1; }
+    // The snapshot holds the same bytes as the original file did, so the original model's segments still apply
+    const auto &model_ptr = session_ptr->models_.front();
+    model_ptr->file_map.unmap();
+    if (model_ptr->file_ptr) { FCLOSE(model_ptr->file_ptr); }
+    model_ptr->file_ptr = snapshot_file_ptr;
+    model_ptr->file_map.map(snapshot_file_ptr);
+    model_ptr->original_snapshot_copier_ptr = nullptr;
+    copier_ptr.reset();
+    return 0;
+}
+
+std::shared_ptr<const search_index_t>
+omega_edit::internal::omega_session_get_search_index_(const omega_session_t *session_ptr,
+                                                      const omega_model_t *model_ptr) {
+    // Checkpoint models read their checkpoint file rather than the indexed original
+    // Nor can an index rule out matches in an original file that has changed since it was indexed
+    if (!session_ptr->search_index_builder_ || model_ptr != session_ptr->models_.front().get() ||
+        !model_ptr->file_ptr || !model_file_is_unchanged_(model_ptr)) {
+        return nullptr;
+    }
+    return session_ptr->search_index_builder_->index();
+}
+
 bool omega_edit::internal::omega_session_get_transaction_bit_(const omega_session_t *session_ptr) {
     return (session_ptr->models_.back()->changes.empty()) ||
            omega_change_get_transaction_bit_(session_ptr->models_.back()->changes.back().get());
@@ -16,8 +16,12 @@
 #include "../include/omega_edit/edit.h"
 #include "../include/omega_edit/segment.h"
 #include "../include/omega_edit/session.h"
+#include "impl_/internal_fun.hpp"
+#include "impl_/segment_def.hpp"
+#include "impl_/sha256.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <cstdio>
@@ -32,6 +36,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -46,12 +51,22 @@
 #undef max
 #endif
 #else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
 
+using omega_edit::internal::omega_data_borrow_;
+using omega_edit::internal::populate_data_segment_;
+using omega_edit::internal::sha256_digest_t;
+using omega_edit::internal::sha256_t;
+
 namespace {
     constexpr size_t OMEGA_SCHEMA_REGEX_CACHE_LIMIT = 128;
     constexpr size_t OMEGA_SCHEMA_REGEX_MAX_PATTERN_BYTES = 4096;
@@ -66,10 +81,57 @@ namespace {
         std::string args_schema;
     };
 
+    class plugin_library_t {
+    public:
+        explicit plugin_library_t(const std::string &path) {
+#ifdef _WIN32
+            handle_ = LoadLibraryA(path.c_str());
+#else
+            handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+        }
+
+        plugin_library_t(const plugin_library_t &) = delete;
+        auto operator=(const plugin_library_t &) -> plugin_library_t & = delete;
+
+        ~plugin_library_t() {
+            if (!handle_) { return; }
+#ifdef _WIN32
+            FreeLibrary(handle_);
+#else
+            dlclose(handle_);
+#endif
+        }
+
+        auto ok() const -> bool { return handle_ != nullptr; }
+
+        auto symbol(const char *name) const -> void * {
+            if (!handle_) { return nullptr; }
+#ifdef _WIN32
+            return reinterpret_cast<void *>(GetProcAddress(handle_, name));
+#else
+            return dlsym(handle_, name);
+#endif
+        }
+
+    private:
+#ifdef _WIN32
+        HMODULE handle_{};
+#else
+        void *handle_{};
+#endif
+    };
+
     struct loaded_plugin_t {
         omega_transform_plugin_info_t info{};
         plugin_info_storage_t info_storage;
         std::string path;
+        std::string canonical_path;
+        // Loaded on the first apply after the plugin is trusted, and kept until the registry is destroyed
+        std::mutex in_process_mutex;
+        std::unique_ptr<plugin_library_t> in_process_library;
+        omega_transform_plugin_apply_fn in_process_apply{};
+        sha256_digest_t in_process_digest{};
     };
 
     std::mutex g_schema_regex_cache_mutex;
@@ -683,6 +745,7 @@ namespace {
         plugin.info.operation = info.operation;
         plugin.info.flags = info.flags;
         plugin.info.support = info.support;
+        plugin.info.chunk_alignment = info.chunk_alignment;
         plugin.info.id = plugin.info_storage.id.empty() ? nullptr : plugin.info_storage.id.c_str();
         plugin.info.name = plugin.info_storage.name.empty() ? nullptr : plugin.info_storage.name.c_str();
         plugin.info.description =
@@ -701,6 +764,8 @@ namespace {
                (info.support == OMEGA_TRANSFORM_PLUGIN_SUPPORT_PRODUCTION ||
                 info.support == OMEGA_TRANSFORM_PLUGIN_SUPPORT_EXPERIMENTAL ||
                 info.support == OMEGA_TRANSFORM_PLUGIN_SUPPORT_TEST) &&
+               ((info.flags & OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL) == 0U ||
+                info.operation == OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE) &&
                args_schema_is_valid_(info.args_schema);
     }
 
@@ -725,12 +790,23 @@ namespace {
     }
 
     constexpr int64_t TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES = 1024 * 1024;
+    // Longest frame a pooled host may send, since larger replacements come back in shared memory or as output frames
+    // of at most TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES, leaving room for the rest of a response
+    constexpr int64_t PROCESS_HOST_FRAME_LENGTH_LIMIT = OMEGA_MEMORY_BUFFER_LIMIT + TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES;
     constexpr int64_t TRANSFORM_PLUGIN_CONTIGUOUS_INPUT_LIMIT_BYTES = 4 * 1024 * 1024;
     constexpr size_t TRANSFORM_PLUGIN_FILE_BACKED_ALLOC_LIMIT_BYTES = 64U * 1024U * 1024U;
     constexpr uint32_t PROCESS_HOST_INFO_MAGIC = 0x4F454931U;
     constexpr uint32_t PROCESS_HOST_REQUEST_MAGIC = 0x4F455251U;
     constexpr uint32_t PROCESS_HOST_RESPONSE_MAGIC = 0x4F455253U;
     constexpr uint32_t PROCESS_HOST_PROGRESS_MAGIC = 0x4F455047U;
+    constexpr uint32_t PROCESS_HOST_READY_MAGIC = 0x4F455244U;
+    constexpr uint32_t PROCESS_HOST_CANCEL_MAGIC = 0x4F45434EU;
+    constexpr uint32_t PROCESS_HOST_SHARED_RESPONSE_MAGIC = 0x4F45524DU;
+    constexpr uint32_t PROCESS_HOST_OUTPUT_MAGIC = 0x4F454F54U;
+    constexpr uint8_t PROCESS_HOST_REQUEST_WANTS_PROGRESS = 0x01U;
+    constexpr uint8_t PROCESS_HOST_REQUEST_WANTS_CANCEL = 0x02U;
+    constexpr uint8_t PROCESS_HOST_REQUEST_SHARED_INPUT = 0x04U;
+    constexpr uint8_t PROCESS_HOST_REQUEST_WANTS_OUTPUT = 0x08U;
 
     class file_backed_buffer_t {
     public:
@@ -803,6 +879,51 @@ namespace {
             return buffer;
         }
 
+#ifndef _WIN32
+        /*
+         * Maps shared memory received from a plugin host, taking ownership of the descriptor.  The host keeps its own
+         * descriptor, so the memory is only mapped if it's sealed against being written, shrunk, or grown; otherwise
+         * (or where memory can't be sealed) the bytes are copied, so the host can't change them or cause SIGBUS.
+         */
+        static auto adopt(int fd, size_t size) -> std::shared_ptr<file_backed_buffer_t> {
+            auto buffer = std::shared_ptr<file_backed_buffer_t>(new file_backed_buffer_t());
+            buffer->fd_ = fd;
+            if (size == 0 || static_cast<uint64_t>(size) > static_cast<uint64_t>((std::numeric_limits<off_t>::max)())) {
+                return nullptr;
+            }
+#ifdef F_GET_SEALS
+            constexpr auto required_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+            struct stat file_stat {};
+            const auto seals = fcntl(fd, F_GET_SEALS);
+            if (0 <= seals && (seals & required_seals) == required_seals && fstat(fd, &file_stat) == 0 &&
+                static_cast<off_t>(size) <= file_stat.st_size) {
+                // Sealed memory can't be written through a shared mapping, so it's mapped copy-on-write
+                void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) { return nullptr; }
+                buffer->data_ = static_cast<omega_byte_t *>(mapped);
+                buffer->size_ = size;
+                return buffer;
+            }
+#endif
+            void *copied = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (copied == MAP_FAILED) { return nullptr; }
+            buffer->data_ = static_cast<omega_byte_t *>(copied);
+            buffer->size_ = size;
+            for (size_t position = 0; position < size;) {
+                const auto count = pread(fd, buffer->data_ + position, size - position, static_cast<off_t>(position));
+                if (count < 0 && errno == EINTR) { continue; }
+                if (count <= 0) { return nullptr; }
+                position += static_cast<size_t>(count);
+            }
+            return buffer;
+        }
+
+        // Opens a read-only descriptor for the buffer's file, for sharing it with a plugin host, or returns -1
+        auto open_read_only() const -> int {
+            return path_.empty() ? -1 : open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        }
+#endif
+
         auto data() const -> omega_byte_t * { return data_; }
 
     private:
@@ -862,18 +983,23 @@ namespace {
         auto *state = static_cast<plugin_allocator_state_t *>(user_data_ptr);
         const auto requested_size = size == 0 ? 1 : size;
         void *ptr = nullptr;
-        if (requested_size > TRANSFORM_PLUGIN_FILE_BACKED_ALLOC_LIMIT_BYTES && state && state->allocation_store) {
-            auto file_backed =
-                    file_backed_buffer_t::create(state->checkpoint_directory, "OmegaEdit-xform-alloc", requested_size);
-            if (file_backed) {
-                ptr = file_backed->data();
-                state->allocation_store->add(ptr, std::move(file_backed));
+        // Plugins call this through C, so failures are reported as null rather than thrown
+        try {
+            if (requested_size > TRANSFORM_PLUGIN_FILE_BACKED_ALLOC_LIMIT_BYTES && state && state->allocation_store) {
+                const auto file_backed = file_backed_buffer_t::create(state->checkpoint_directory,
+                                                                      "OmegaEdit-xform-alloc", requested_size);
+                if (file_backed) {
+                    state->allocation_store->add(file_backed->data(), file_backed);
+                    ptr = file_backed->data();
+                }
+            } else {
+                ptr = std::malloc(requested_size);
             }
-        } else {
-            ptr = std::malloc(requested_size);
+            if (ptr && state) { state->allocations.push_back(ptr); }
+        } catch (const std::bad_alloc &) {
+            if (ptr) { release_plugin_allocation_(state ? state->allocation_store : nullptr, ptr); }
+            return nullptr;
         }
-
-        if (ptr && state) { state->allocations.push_back(ptr); }
         return ptr;
     }
 
@@ -924,12 +1050,17 @@ namespace {
         void *progress_user_data_ptr{};
         omega_transform_plugin_is_cancelled_t is_cancelled{};
         void *cancel_user_data_ptr{};
+        // Window the session's data segments are populated into, reused across reads
+        std::unique_ptr<omega_byte_t[]> window{};
+        int64_t window_capacity{};
     };
 
     struct materialized_input_t {
         std::vector<omega_byte_t> bytes;
         std::shared_ptr<file_backed_buffer_t> file_backed;
         int64_t length{};
+        // Offset of these bytes within the caller's range when they are one shard of a chunk-parallel apply
+        int64_t range_offset{};
 
         auto data() const -> const omega_byte_t * {
             if (file_backed) { return file_backed->data(); }
@@ -1015,22 +1146,21 @@ namespace {
         const auto read_length = std::min(std::min(length, remaining), TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES);
         if (read_length == 0) { return 0; }
 
-        auto *segment = omega_segment_create(read_length);
-        if (!segment) { return -1; }
-        const auto rc = omega_session_get_segment(reader->session_ptr, segment, reader->offset + relative_offset);
-        if (rc != 0) {
-            omega_segment_destroy(segment);
-            return -1;
-        }
-
-        const auto segment_length = std::min(read_length, omega_segment_get_length(segment));
-        auto *data = omega_segment_get_data(segment);
-        if (segment_length > 0 && !data) {
-            omega_segment_destroy(segment);
-            return -1;
-        }
-        if (segment_length > 0) { std::memcpy(buffer, data, static_cast<size_t>(segment_length)); }
-        omega_segment_destroy(segment);
+        // Data segments are null-terminated, so they are populated into a window one byte larger than the read
+        if (reader->window_capacity < read_length) {
+            try {
+                reader->window = std::make_unique<omega_byte_t[]>(static_cast<size_t>(read_length) + 1U);
+            } catch (const std::bad_alloc &) { return -1; }
+            reader->window_capacity = read_length;
+        }
+        omega_segment_t segment;
+        segment.offset = reader->offset + relative_offset;
+        segment.capacity = read_length;
+        omega_data_borrow_(&segment.data, reader->window.get(), read_length);
+        if (populate_data_segment_(reader->session_ptr, &segment) != 0) { return -1; }
+
+        const auto segment_length = std::min(read_length, segment.length);
+        if (segment_length > 0) { std::memcpy(buffer, reader->window.get(), static_cast<size_t>(segment_length)); }
         if (segment_length > 0 && reader->progress) {
             const auto processed = std::min(reader->length, relative_offset + segment_length);
             if (processed > reader->furthest_read) {
@@ -1179,6 +1309,14 @@ namespace {
         scoped_temp_file_t(const scoped_temp_file_t &) = delete;
         auto operator=(const scoped_temp_file_t &) -> scoped_temp_file_t & = delete;
         scoped_temp_file_t(scoped_temp_file_t &&other) noexcept : path_(std::move(other.path_)) { other.path_.clear(); }
+        auto operator=(scoped_temp_file_t &&other) noexcept -> scoped_temp_file_t & {
+            if (this != &other) {
+                reset();
+                path_ = std::move(other.path_);
+                other.path_.clear();
+            }
+            return *this;
+        }
         ~scoped_temp_file_t() { reset(); }
 
         auto path() const -> const std::string & { return path_; }
@@ -1194,6 +1332,24 @@ namespace {
         std::string path_;
     };
 
+    /**
+     * File collecting a replacement the plugin streams through the request writer.  Per-request hosts append to it
+     * directly, while pooled hosts send chunks over their channel, so it is only created once the first chunk arrives.
+     */
+    struct plugin_output_t {
+        const char *directory{};
+        scoped_temp_file_t file;
+        int64_t length{};
+    };
+
+    auto create_plugin_output_file_(plugin_output_t &output) -> bool {
+        if (!output.file.path().empty()) { return true; }
+        std::string path;
+        if (!create_temp_file_path_(output.directory, "OmegaEdit-xform-output", path)) { return false; }
+        output.file = scoped_temp_file_t(std::move(path));
+        return true;
+    }
+
     auto run_host_command_(const std::string &host_path, const std::string &command, const std::string &plugin_path,
                            const std::string &request_path, const std::string &response_path,
                            const host_command_monitor_t *monitor = nullptr) -> bool {
@@ -1267,15 +1423,252 @@ namespace {
 #endif
     }
 
+#ifndef _WIN32
+    /**
+     * A long-lived host process serving requests for one plugin over a socket pair, so repeated applies skip process
+     * start up and plugin loading.  Destroying the worker kills the process; a worker that fails a request in any way
+     * is destroyed rather than reused.
+     */
+    class host_worker_t {
+    public:
+        host_worker_t(const host_worker_t &) = delete;
+        auto operator=(const host_worker_t &) -> host_worker_t & = delete;
+
+        ~host_worker_t() {
+            close(fd_);
+            kill(pid_, SIGKILL);
+            while (waitpid(pid_, nullptr, 0) < 0 && errno == EINTR) {}
+        }
+
+        static auto spawn(const std::string &host_path, const std::string &plugin_path)
+                -> std::unique_ptr<host_worker_t> {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) { return nullptr; }
+            fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#ifndef MSG_NOSIGNAL
+            const int no_sigpipe = 1;
+            setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+            const auto executable = host_path.empty() ? std::string("omega-transform-plugin-host") : host_path;
+            std::string command = "--serve";
+            std::string plugin = plugin_path;
+            char *argv[] = {const_cast<char *>(executable.c_str()), command.data(), plugin.data(), nullptr};
+
+            const auto pid = fork();
+            if (pid < 0) {
+                close(fds[0]);
+                close(fds[1]);
+                return nullptr;
+            }
+            if (pid == 0) {
+                if (dup2(fds[1], STDIN_FILENO) < 0) { _exit(127); }
+                execvp(argv[0], argv);
+                _exit(127);
+            }
+            close(fds[1]);
+
+            std::unique_ptr<host_worker_t> worker(new host_worker_t(pid, fds[0]));
+            uint32_t magic = 0;
+            std::string body;
+            int32_t status = -1;
+            std::istringstream in;
+            if (!worker->receive_frame(magic, body, nullptr) || magic != PROCESS_HOST_READY_MAGIC) { return nullptr; }
+            in.str(body);
+            if (!read_pod_(in, status) || status != 0) { return nullptr; }
+            return worker;
+        }
+
+        auto send(const void *buffer, size_t length) -> bool {
+            const auto *bytes = static_cast<const char *>(buffer);
+            while (length > 0) {
+#ifdef MSG_NOSIGNAL
+                const auto count = ::send(fd_, bytes, length, MSG_NOSIGNAL);
+#else
+                const auto count = ::send(fd_, bytes, length, 0);
+#endif
+                if (count < 0 && errno == EINTR) { continue; }
+                if (count <= 0) { return false; }
+                bytes += count;
+                length -= static_cast<size_t>(count);
+            }
+            return true;
+        }
+
+        auto send_frame(uint32_t magic, const std::string &body) -> bool {
+            const auto length = static_cast<int64_t>(body.size());
+            return send(&magic, sizeof(magic)) && send(&length, sizeof(length)) && send(body.data(), body.size());
+        }
+
+        /**
+         * Passes a descriptor to the host as ancillary data on a single marker byte following the current frame.
+         */
+        auto send_descriptor(int descriptor) -> bool {
+            char marker = 0;
+            iovec iov{&marker, 1};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message{};
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            auto *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+            ssize_t count = 0;
+#ifdef MSG_NOSIGNAL
+            do { count = sendmsg(fd_, &message, MSG_NOSIGNAL); } while (count < 0 && errno == EINTR);
+#else
+            do { count = sendmsg(fd_, &message, 0); } while (count < 0 && errno == EINTR);
+#endif
+            return count == 1;
+        }
+
+        auto receive_descriptor(int &descriptor, const host_command_monitor_t *monitor) -> bool {
+            if (!wait_readable(monitor)) { return false; }
+            char marker = 0;
+            iovec iov{&marker, 1};
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+            msghdr message{};
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            ssize_t count = 0;
+#ifdef MSG_CMSG_CLOEXEC
+            do { count = recvmsg(fd_, &message, MSG_CMSG_CLOEXEC); } while (count < 0 && errno == EINTR);
+#else
+            do { count = recvmsg(fd_, &message, 0); } while (count < 0 && errno == EINTR);
+#endif
+            const auto *header = CMSG_FIRSTHDR(&message);
+            if (count != 1 || !header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+                return false;
+            }
+            std::memcpy(&descriptor, CMSG_DATA(header), sizeof(int));
+            fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+            return true;
+        }
+
+        /**
+         * Reads one frame from the host, polling the monitor while waiting so progress and cancellation stay live.  A
+         * frame longer than PROCESS_HOST_FRAME_LENGTH_LIMIT fails before anything is allocated for it.
+         * @throws std::bad_alloc if the frame body can't be allocated
+         */
+        auto receive_frame(uint32_t &magic, std::string &body, const host_command_monitor_t *monitor) -> bool {
+            int64_t length = 0;
+            if (!receive(&magic, sizeof(magic), monitor) || !receive(&length, sizeof(length), monitor) ||
+                length < 0 || length > PROCESS_HOST_FRAME_LENGTH_LIMIT) {
+                return false;
+            }
+            size_t body_size = 0;
+            if (!int64_to_size_(length, body_size)) { return false; }
+            body.assign(body_size, '\0');
+            return body_size == 0 || receive(body.data(), body_size, monitor);
+        }
+
+    private:
+        host_worker_t(pid_t pid, int fd) : pid_(pid), fd_(fd) {}
+
+        auto wait_readable(const host_command_monitor_t *monitor) -> bool {
+            while (true) {
+                if (monitor && !poll_host_command_monitor_(monitor)) { return false; }
+                pollfd poll_fd{fd_, POLLIN, 0};
+                const auto ready = poll(&poll_fd, 1, monitor ? 50 : -1);
+                if (ready > 0) { return true; }
+                if (ready < 0 && errno != EINTR) { return false; }
+            }
+        }
+
+        auto receive(void *buffer, size_t length, const host_command_monitor_t *monitor) -> bool {
+            auto *bytes = static_cast<char *>(buffer);
+            while (length > 0) {
+                if (!wait_readable(monitor)) { return false; }
+                const auto count = recv(fd_, bytes, length, 0);
+                if (count < 0 && errno == EINTR) { continue; }
+                if (count <= 0) { return false; }
+                bytes += count;
+                length -= static_cast<size_t>(count);
+            }
+            return true;
+        }
+
+        pid_t pid_;
+        int fd_;
+    };
+
+    /**
+     * Idle host workers kept per plugin path.  Workers are checked out for the length of one request, so concurrent
+     * applies of the same plugin each get their own process; at most the pool limit of them are kept afterwards.
+     */
+    class host_worker_pool_t {
+    public:
+        auto acquire(const std::string &host_path, const std::string &plugin_path, bool &reused)
+                -> std::unique_ptr<host_worker_t> {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto &idle = idle_[plugin_path];
+                if (!idle.empty()) {
+                    auto worker = std::move(idle.back());
+                    idle.pop_back();
+                    reused = true;
+                    return worker;
+                }
+            }
+            reused = false;
+            return host_worker_t::spawn(host_path, plugin_path);
+        }
+
+        void release(const std::string &plugin_path, std::unique_ptr<host_worker_t> worker) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &idle = idle_[plugin_path];
+            if (static_cast<int64_t>(idle.size()) < limit_) { idle.push_back(std::move(worker)); }
+        }
+
+        auto limit() const -> int64_t {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return limit_;
+        }
+
+        void set_limit(int64_t limit) {
+            std::vector<std::unique_ptr<host_worker_t>> retired;
+            std::lock_guard<std::mutex> lock(mutex_);
+            limit_ = limit;
+            for (auto &entry : idle_) {
+                while (static_cast<int64_t>(entry.second.size()) > limit_) {
+                    retired.push_back(std::move(entry.second.back()));
+                    entry.second.pop_back();
+                }
+            }
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        int64_t limit_{OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT};
+        std::unordered_map<std::string, std::vector<std::unique_ptr<host_worker_t>>> idle_;
+    };
+#else
+    // Windows hosts are started for each request
+    class host_worker_pool_t {
+    public:
+        auto limit() const -> int64_t { return 0; }
+        void set_limit(int64_t) {}
+    };
+#endif
+
     auto write_host_apply_request_(const std::string &request_path, int64_t session_offset, int64_t session_length,
                                    const char *options_json, const materialized_input_t &input,
-                                   const std::string &progress_path, const std::string &cancel_path) -> bool {
+                                   const std::string &progress_path, const std::string &cancel_path,
+                                   const std::string &output_path) -> bool {
         std::ofstream out(request_path, std::ios::binary | std::ios::trunc);
         if (!out) { return false; }
         return write_pod_(out, PROCESS_HOST_REQUEST_MAGIC) && write_pod_(out, session_offset) &&
-               write_pod_(out, session_length) && write_pod_(out, TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES) &&
+               write_pod_(out, session_length) && write_pod_(out, input.range_offset) &&
+               write_pod_(out, TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES) &&
                write_string_(out, options_json) && write_bytes_(out, input.data(), input.length) &&
-               write_string_(out, progress_path.c_str()) && write_string_(out, cancel_path.c_str());
+               write_string_(out, progress_path.c_str()) && write_string_(out, cancel_path.c_str()) &&
+               write_string_(out, output_path.c_str());
     }
 
     struct host_apply_control_t {
@@ -1287,6 +1680,9 @@ namespace {
         omega_transform_plugin_is_cancelled_t is_cancelled{};
         void *cancel_user_data_ptr{};
         bool cancel_requested{};
+#ifndef _WIN32
+        host_worker_t *worker{};
+#endif
     };
 
     auto write_host_cancel_request_(const std::string &cancel_path, bool cancel) -> bool {
@@ -1297,10 +1693,30 @@ namespace {
     }
 
     auto request_host_cancel_(host_apply_control_t &control) -> bool {
+#ifndef _WIN32
+        if (control.worker) {
+            if (control.cancel_requested) { return true; }
+            control.cancel_requested = true;
+            return control.worker->send_frame(PROCESS_HOST_CANCEL_MAGIC, std::string());
+        }
+#endif
         control.cancel_requested = true;
         return write_host_cancel_request_(control.cancel_path, true);
     }
 
+    auto read_host_progress_fields_(std::istream &in, omega_transform_plugin_progress_t &progress, std::string &phase,
+                                    std::string &message) -> bool {
+        progress = {};
+        if (!read_pod_(in, progress.processed_bytes) || !read_pod_(in, progress.total_bytes) ||
+            !read_pod_(in, progress.percent) || !read_pod_(in, progress.flags) || !read_string_(in, phase) ||
+            !read_string_(in, message)) {
+            return false;
+        }
+        progress.phase = phase.empty() ? nullptr : phase.c_str();
+        progress.message = message.empty() ? nullptr : message.c_str();
+        return true;
+    }
+
     auto read_host_progress_events_(host_apply_control_t &control) -> bool {
         if (!control.progress || control.progress_path.empty()) { return true; }
 
@@ -1311,28 +1727,17 @@ namespace {
         while (true) {
             const auto record_start = in.tellg();
             uint32_t magic = 0;
-            int64_t processed_bytes = 0;
-            int64_t total_bytes = 0;
-            double percent = 0.0;
-            uint32_t flags = 0;
+            omega_transform_plugin_progress_t progress{};
             std::string phase;
             std::string message;
             if (!read_pod_(in, magic)) { break; }
             if (magic != PROCESS_HOST_PROGRESS_MAGIC) { return false; }
-            if (!read_pod_(in, processed_bytes) || !read_pod_(in, total_bytes) || !read_pod_(in, percent) ||
-                !read_pod_(in, flags) || !read_string_(in, phase) || !read_string_(in, message)) {
+            if (!read_host_progress_fields_(in, progress, phase, message)) {
                 in.clear();
                 in.seekg(record_start);
                 break;
             }
 
-            omega_transform_plugin_progress_t progress{};
-            progress.processed_bytes = processed_bytes;
-            progress.total_bytes = total_bytes;
-            progress.percent = percent;
-            progress.flags = flags;
-            progress.phase = phase.empty() ? nullptr : phase.c_str();
-            progress.message = message.empty() ? nullptr : message.c_str();
             if (control.progress(&progress, control.progress_user_data_ptr) != 0 && !request_host_cancel_(control)) {
                 return false;
             }
@@ -1366,7 +1771,7 @@ namespace {
         int32_t operation = 0;
         int32_t support = 0;
         if (!read_pod_(in, info.abi_version) || !read_pod_(in, operation) || !read_pod_(in, info.flags) ||
-            !read_pod_(in, support)) {
+            !read_pod_(in, support) || !read_pod_(in, info.chunk_alignment)) {
             return false;
         }
 
@@ -1416,15 +1821,10 @@ namespace {
         return true;
     }
 
-    auto read_host_apply_response_(const std::string &response_path, plugin_allocator_state_t &allocator_state,
-                                   omega_transform_plugin_response_t &response) -> bool {
-        std::ifstream in(response_path, std::ios::binary);
-        uint32_t magic = 0;
+    auto read_host_apply_response_body_(std::istream &in, plugin_allocator_state_t &allocator_state,
+                                        omega_transform_plugin_response_t &response) -> bool {
         int32_t status = -1;
-        if (!in || !read_pod_(in, magic) || magic != PROCESS_HOST_RESPONSE_MAGIC || !read_pod_(in, status) ||
-            status != 0) {
-            return false;
-        }
+        if (!read_pod_(in, status) || status != 0) { return false; }
 
         uint32_t flags = 0;
         std::vector<omega_byte_t> replacement;
@@ -1448,6 +1848,14 @@ namespace {
                copy_host_string_(allocator_state, result_mime_type, has_result_mime_type, &response.result_mime_type);
     }
 
+    auto read_host_apply_response_(const std::string &response_path, plugin_allocator_state_t &allocator_state,
+                                   omega_transform_plugin_response_t &response) -> bool {
+        std::ifstream in(response_path, std::ios::binary);
+        uint32_t magic = 0;
+        return in && read_pod_(in, magic) && magic == PROCESS_HOST_RESPONSE_MAGIC &&
+               read_host_apply_response_body_(in, allocator_state, response);
+    }
+
     auto materialize_reader_input_(int64_t session_length, const char *checkpoint_directory,
                                    omega_transform_plugin_read_t read, void *reader_user_data_ptr,
                                    int64_t preferred_chunk_size, omega_transform_plugin_progress_cbk_t progress,
@@ -1502,12 +1910,13 @@ namespace {
         return 0;
     }
 
-    auto invoke_isolated_plugin_(const loaded_plugin_t &plugin, const std::string &host_path, int64_t session_offset,
-                                 int64_t session_length, const char *options_json, const materialized_input_t &input,
-                                 plugin_allocator_state_t &allocator_state,
-                                 omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
-                                 omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
-                                 omega_transform_plugin_response_t &response) -> bool {
+    auto invoke_host_command_plugin_(const loaded_plugin_t &plugin, const std::string &host_path,
+                                     int64_t session_offset, int64_t session_length, const char *options_json,
+                                     const materialized_input_t &input, plugin_output_t *output,
+                                     plugin_allocator_state_t &allocator_state,
+                                     omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                                     omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                                     omega_transform_plugin_response_t &response) -> bool {
         std::string request_path;
         std::string response_path;
         std::string progress_path;
@@ -1524,6 +1933,7 @@ namespace {
             !create_temp_file_path_(checkpoint_directory, "OmegaEdit-xform-cancel", cancel_path)) {
             return false;
         }
+        if (output && !create_plugin_output_file_(*output)) { return false; }
         scoped_temp_file_t request_file(request_path);
         scoped_temp_file_t response_file(response_path);
         scoped_temp_file_t progress_file(progress_path);
@@ -1534,7 +1944,7 @@ namespace {
 
         if (!write_host_cancel_request_(cancel_path, false)) { return false; }
         if (!write_host_apply_request_(request_path, session_offset, session_length, options_json, input, progress_path,
-                                       cancel_path)) {
+                                       cancel_path, output ? output->file.path() : std::string())) {
             return false;
         }
         if (!run_host_command_(host_path, "--apply", plugin.path, request_path, response_path,
@@ -1542,7 +1952,685 @@ namespace {
             return false;
         }
         if (!poll_host_apply_control_(&control) || control.cancel_requested) { return false; }
-        return read_host_apply_response_(response_path, allocator_state, response);
+        if (!read_host_apply_response_(response_path, allocator_state, response)) { return false; }
+        if (output && (response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U) {
+            output->length = omega_util_file_size(output->file.path().c_str());
+            response.replacement_length = output->length;
+            return output->length >= 0;
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    auto send_host_apply_request_(host_worker_t &worker, int64_t session_offset, int64_t session_length,
+                                  const char *options_json, const materialized_input_t &input, uint8_t request_flags)
+            -> bool {
+        // Inputs already materialized in a mapped file are shared with the host rather than copied to it
+        const auto shared_input = input.file_backed != nullptr;
+        const auto flags =
+                static_cast<uint8_t>(request_flags | (shared_input ? PROCESS_HOST_REQUEST_SHARED_INPUT : 0U));
+        const auto options_length = static_cast<int64_t>(options_json ? std::strlen(options_json) : 0);
+        const auto body_length = static_cast<int64_t>(6 * sizeof(int64_t) + sizeof(uint8_t)) + options_length +
+                                 (shared_input ? 0 : input.length);
+        std::ostringstream header;
+        if (!write_pod_(header, PROCESS_HOST_REQUEST_MAGIC) || !write_pod_(header, body_length) ||
+            !write_pod_(header, session_offset) || !write_pod_(header, session_length) ||
+            !write_pod_(header, input.range_offset) || !write_pod_(header, TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES) ||
+            !write_pod_(header, flags) || !write_string_(header, options_json) || !write_pod_(header, input.length)) {
+            return false;
+        }
+        const auto header_bytes = header.str();
+        if (!worker.send(header_bytes.data(), header_bytes.size())) { return false; }
+        if (shared_input) {
+            // The host only reads the input, so it gets a descriptor it can't write or truncate the input through
+            const auto descriptor = input.file_backed->open_read_only();
+            if (descriptor < 0) { return false; }
+            const auto is_sent = worker.send_descriptor(descriptor);
+            close(descriptor);
+            return is_sent;
+        }
+        return input.length == 0 || worker.send(input.data(), static_cast<size_t>(input.length));
+    }
+
+    auto read_host_shared_apply_response_body_(std::istream &in, int descriptor,
+                                               plugin_allocator_state_t &allocator_state,
+                                               omega_transform_plugin_response_t &response) -> bool {
+        int32_t status = -1;
+        uint32_t flags = 0;
+        int64_t replacement_length = 0;
+        std::vector<omega_byte_t> result;
+        std::string result_label;
+        std::string result_mime_type;
+        bool has_result_label = false;
+        bool has_result_mime_type = false;
+        size_t replacement_size = 0;
+        if (!read_pod_(in, status) || status != 0 || !read_pod_(in, flags) || !read_pod_(in, replacement_length) ||
+            !int64_to_size_(replacement_length, replacement_size) || !read_bytes_(in, result) ||
+            !read_optional_string_(in, result_label, has_result_label) ||
+            !read_optional_string_(in, result_mime_type, has_result_mime_type) || !allocator_state.allocation_store) {
+            close(descriptor);
+            return false;
+        }
+
+        auto replacement = file_backed_buffer_t::adopt(descriptor, replacement_size);
+        if (!replacement) { return false; }
+        response = {};
+        response.flags = flags;
+        response.replacement_bytes = replacement->data();
+        response.replacement_length = replacement_length;
+        allocator_state.allocations.push_back(response.replacement_bytes);
+        allocator_state.allocation_store->add(response.replacement_bytes, std::move(replacement));
+        return copy_host_bytes_(allocator_state, result, &response.result_bytes, &response.result_length) &&
+               copy_host_string_(allocator_state, result_label, has_result_label, &response.result_label) &&
+               copy_host_string_(allocator_state, result_mime_type, has_result_mime_type, &response.result_mime_type);
+    }
+
+    auto invoke_pooled_plugin_(host_worker_pool_t &workers, const loaded_plugin_t &plugin,
+                               const std::string &host_path, int64_t session_offset, int64_t session_length,
+                               const char *options_json, const materialized_input_t &input,
+                               plugin_output_t *output, plugin_allocator_state_t &allocator_state,
+                               omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                               omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                               omega_transform_plugin_response_t &response) -> bool {
+        const auto request_flags =
+                static_cast<uint8_t>((progress ? PROCESS_HOST_REQUEST_WANTS_PROGRESS : 0U) |
+                                     ((progress || is_cancelled) ? PROCESS_HOST_REQUEST_WANTS_CANCEL : 0U) |
+                                     (output ? PROCESS_HOST_REQUEST_WANTS_OUTPUT : 0U));
+        bool reused = false;
+        auto worker = workers.acquire(host_path, plugin.path, reused);
+        if (!worker) { return false; }
+        const auto send_request = [&](host_worker_t &target) {
+            return send_host_apply_request_(target, session_offset, session_length, options_json, input,
+                                            request_flags);
+        };
+        if (!send_request(*worker)) {
+            // An idle worker may have exited since its last request, so retry once with a fresh one
+            if (!reused) { return false; }
+            worker = host_worker_t::spawn(host_path, plugin.path);
+            if (!worker || !send_request(*worker)) { return false; }
+        }
+
+        host_apply_control_t control{};
+        control.progress = progress;
+        control.progress_user_data_ptr = progress_user_data_ptr;
+        control.is_cancelled = is_cancelled;
+        control.cancel_user_data_ptr = cancel_user_data_ptr;
+        control.worker = worker.get();
+        host_command_monitor_t monitor{poll_host_apply_control_, &control};
+        const auto *monitor_ptr = (progress || is_cancelled) ? &monitor : nullptr;
+        std::ofstream output_stream;
+        while (true) {
+            uint32_t magic = 0;
+            std::string body;
+            if (!worker->receive_frame(magic, body, monitor_ptr)) { return false; }
+            std::istringstream in(body);
+            if (magic == PROCESS_HOST_PROGRESS_MAGIC) {
+                omega_transform_plugin_progress_t progress_event{};
+                std::string phase;
+                std::string message;
+                if (!read_host_progress_fields_(in, progress_event, phase, message)) { return false; }
+                if (progress && progress(&progress_event, progress_user_data_ptr) != 0 &&
+                    !request_host_cancel_(control)) {
+                    return false;
+                }
+                continue;
+            }
+            if (magic == PROCESS_HOST_OUTPUT_MAGIC) {
+                // Streamed replacement chunks go straight to the output file, so only one is ever held in memory
+                if (!output || !create_plugin_output_file_(*output)) { return false; }
+                if (!output_stream.is_open()) {
+                    output_stream.open(output->file.path(), std::ios::binary | std::ios::trunc);
+                }
+                if (!output_stream.write(body.data(), static_cast<std::streamsize>(body.size()))) { return false; }
+                output->length += static_cast<int64_t>(body.size());
+                continue;
+            }
+            int descriptor = -1;
+            if (magic == PROCESS_HOST_SHARED_RESPONSE_MAGIC && !worker->receive_descriptor(descriptor, monitor_ptr)) {
+                return false;
+            }
+            if (magic != PROCESS_HOST_RESPONSE_MAGIC && magic != PROCESS_HOST_SHARED_RESPONSE_MAGIC) { return false; }
+
+            // The response ends the request whatever its status, leaving the worker ready for the next one
+            control.worker = nullptr;
+            workers.release(plugin.path, std::move(worker));
+            if (output_stream.is_open()) {
+                output_stream.close();
+                if (output_stream.fail()) {
+                    if (descriptor >= 0) { close(descriptor); }
+                    return false;
+                }
+            }
+            if (descriptor < 0) {
+                if (control.cancel_requested || !read_host_apply_response_body_(in, allocator_state, response)) {
+                    return false;
+                }
+                if (output && (response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U) {
+                    response.replacement_length = output->length;
+                }
+                return true;
+            }
+            if (control.cancel_requested) {
+                close(descriptor);
+                return false;
+            }
+            return read_host_shared_apply_response_body_(in, descriptor, allocator_state, response);
+        }
+    }
+#endif
+
+    auto invoke_isolated_plugin_(host_worker_pool_t &workers, const loaded_plugin_t &plugin,
+                                 const std::string &host_path, int64_t session_offset, int64_t session_length,
+                                 const char *options_json, const materialized_input_t &input,
+                                 plugin_output_t *output, plugin_allocator_state_t &allocator_state,
+                                 omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                                 omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                                 omega_transform_plugin_response_t &response) -> bool {
+#ifndef _WIN32
+        if (workers.limit() > 0) {
+            // A worker whose request can't be allocated is dropped with the request rather than returned to the pool
+            try {
+                return invoke_pooled_plugin_(workers, plugin, host_path, session_offset, session_length, options_json,
+                                             input, output, allocator_state, progress, progress_user_data_ptr,
+                                             is_cancelled, cancel_user_data_ptr, response);
+            } catch (const std::bad_alloc &) { return false; } catch (const std::length_error &) { return false; }
+        }
+#endif
+        return invoke_host_command_plugin_(plugin, host_path, session_offset, session_length, options_json, input,
+                                           output, allocator_state, progress, progress_user_data_ptr, is_cancelled,
+                                           cancel_user_data_ptr, response);
+    }
+
+    /**
+     * A plugin library file opened once, so the contents hashed to check it's trusted are the contents loaded.  On
+     * POSIX it must be a regular file that neither its group nor others can write, and on Windows it can't be written
+     * while it's open.
+     */
+    class library_file_t {
+    public:
+        explicit library_file_t(const std::string &path) : path_(path) {
+#ifdef _WIN32
+            handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+            fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+            struct stat file_stat {};
+            if (fd_ >= 0 && (0 != fstat(fd_, &file_stat) || !S_ISREG(file_stat.st_mode) ||
+                             (file_stat.st_mode & (S_IWGRP | S_IWOTH)) != 0)) {
+                close(fd_);
+                fd_ = -1;
+            }
+#endif
+        }
+
+        library_file_t(const library_file_t &) = delete;
+        auto operator=(const library_file_t &) -> library_file_t & = delete;
+
+        ~library_file_t() {
+#ifdef _WIN32
+            if (handle_ != INVALID_HANDLE_VALUE) { CloseHandle(handle_); }
+#else
+            if (fd_ >= 0) { close(fd_); }
+#endif
+        }
+
+        auto ok() const -> bool {
+#ifdef _WIN32
+            return handle_ != INVALID_HANDLE_VALUE;
+#else
+            return fd_ >= 0;
+#endif
+        }
+
+        /**
+         * Computes the SHA-256 digest of the library
+         * @param digest set to the digest
+         * @param copy_fd if non-negative, descriptor the library is also copied to
+         * @return true on success, false on failure
+         */
+        auto compute_digest(sha256_digest_t &digest, int copy_fd = -1) const -> bool {
+            if (!ok()) { return false; }
+            try {
+                sha256_t hasher;
+                std::vector<char> buffer(64 * 1024);
+#ifdef _WIN32
+                (void) copy_fd;
+                LARGE_INTEGER start{};
+                if (!SetFilePointerEx(handle_, start, nullptr, FILE_BEGIN)) { return false; }
+                for (DWORD count = 0;; hasher.update(buffer.data(), count)) {
+                    if (!ReadFile(handle_, buffer.data(), static_cast<DWORD>(buffer.size()), &count, nullptr)) {
+                        return false;
+                    }
+                    if (count == 0) { break; }
+                }
+#else
+                for (off_t offset = 0;;) {
+                    const auto count = pread(fd_, buffer.data(), buffer.size(), offset);
+                    if (count < 0 && errno == EINTR) { continue; }
+                    if (count < 0) { return false; }
+                    if (count == 0) { break; }
+                    hasher.update(buffer.data(), static_cast<size_t>(count));
+                    for (ssize_t written = 0; copy_fd >= 0 && written < count;) {
+                        const auto result =
+                                write(copy_fd, buffer.data() + written, static_cast<size_t>(count - written));
+                        if (result < 0 && errno == EINTR) { continue; }
+                        if (result <= 0) { return false; }
+                        written += result;
+                    }
+                    offset += count;
+                }
+#endif
+                digest = hasher.finish();
+                return true;
+            } catch (const std::bad_alloc &) { return false; }
+        }
+
+        /**
+         * Loads the library, provided it has the expected digest.  Linux loads it through the open descriptor, other
+         * POSIX systems hash a copy in a private directory and load that, and Windows loads it by path while the open
+         * handle keeps it from being written.
+         * @param expected_digest digest the library must have
+         * @return loaded library, or nullptr on failure
+         */
+        auto load(const sha256_digest_t &expected_digest) const -> std::unique_ptr<plugin_library_t> {
+            sha256_digest_t digest{};
+            std::unique_ptr<plugin_library_t> library;
+            try {
+#if defined(_WIN32)
+                if (!compute_digest(digest) || digest != expected_digest) { return nullptr; }
+                library = std::make_unique<plugin_library_t>(path_);
+#elif defined(__linux__)
+                if (!compute_digest(digest) || digest != expected_digest) { return nullptr; }
+                library = std::make_unique<plugin_library_t>("/proc/self/fd/" + std::to_string(fd_));
+#else
+                std::error_code error;
+                auto directory = (std::filesystem::temp_directory_path(error) / "omega_edit_plugin_XXXXXX").string();
+                if (error || !mkdtemp(directory.data())) { return nullptr; }
+                const auto copy_path = directory + "/" + std::filesystem::path(path_).filename().string();
+                const auto copy_fd = open(copy_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0700);
+                auto copied = copy_fd >= 0 && compute_digest(digest, copy_fd);
+                copied = copy_fd >= 0 && 0 == close(copy_fd) && copied && digest == expected_digest;
+                if (copied) { library = std::make_unique<plugin_library_t>(copy_path); }
+                unlink(copy_path.c_str());
+                rmdir(directory.c_str());
+#endif
+            } catch (const std::bad_alloc &) { return nullptr; }
+            if (!library || !library->ok()) { return nullptr; }
+            return library;
+        }
+
+    private:
+        std::string path_;
+#ifdef _WIN32
+        HANDLE handle_{INVALID_HANDLE_VALUE};
+#else
+        int fd_{-1};
+#endif
+    };
+
+    /**
+     * Loads a trusted plugin into this process on first use, checking that its library still has the trusted digest
+     * and still describes the plugin registered from its path.  A library already loaded under a different digest
+     * is not reloaded, so it fails until the registry is destroyed.
+     */
+    auto load_in_process_plugin_(loaded_plugin_t &plugin, const sha256_digest_t &trusted_digest)
+            -> omega_transform_plugin_apply_fn {
+        const std::lock_guard<std::mutex> lock(plugin.in_process_mutex);
+        if (plugin.in_process_apply) {
+            return plugin.in_process_digest == trusted_digest ? plugin.in_process_apply : nullptr;
+        }
+        if (plugin.canonical_path.empty()) { return nullptr; }
+        std::unique_ptr<plugin_library_t> library;
+        try {
+            library = library_file_t(plugin.canonical_path).load(trusted_digest);
+        } catch (const std::bad_alloc &) { return nullptr; }
+        if (!library) { return nullptr; }
+        const auto get_info = reinterpret_cast<omega_transform_plugin_get_info_fn>(
+                library->symbol("omega_transform_plugin_get_info"));
+        const auto apply =
+                reinterpret_cast<omega_transform_plugin_apply_fn>(library->symbol("omega_transform_plugin_apply"));
+        omega_transform_plugin_info_t info{};
+        if (!get_info || !apply || get_info(&info) != 0 || !plugin_info_is_valid_(info) ||
+            std::strcmp(info.id, plugin.info.id) != 0 || info.operation != plugin.info.operation ||
+            info.flags != plugin.info.flags || info.chunk_alignment != plugin.info.chunk_alignment) {
+            return nullptr;
+        }
+        plugin.in_process_library = std::move(library);
+        plugin.in_process_apply = apply;
+        plugin.in_process_digest = trusted_digest;
+        return apply;
+    }
+
+    struct in_process_output_t {
+        plugin_output_t *output{};
+        std::ofstream stream;
+    };
+
+    auto write_in_process_output_(const omega_byte_t *bytes, int64_t length, void *user_data_ptr) -> int {
+        auto *state = static_cast<in_process_output_t *>(user_data_ptr);
+        if (!state || !state->output || length < 0 || (!bytes && length > 0) ||
+            state->output->length > std::numeric_limits<int64_t>::max() - length) {
+            return -1;
+        }
+        if (length == 0) { return 0; }
+        if (!state->stream.is_open()) {
+            if (!create_plugin_output_file_(*state->output)) { return -1; }
+            state->stream.open(state->output->file.path(), std::ios::binary | std::ios::trunc);
+            if (!state->stream) { return -1; }
+        }
+        if (!state->stream.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(length))) {
+            return -1;
+        }
+        state->output->length += length;
+        return 0;
+    }
+
+    /**
+     * Applies a trusted plugin in this process.  The plugin reads the range through the given reader, so streaming
+     * plugins need no materialized input, and the caller's progress and cancellation callbacks are passed through.
+     * The plugin must already have been loaded by load_in_process_plugin_.
+     */
+    auto invoke_in_process_plugin_(loaded_plugin_t &plugin, int64_t session_offset, int64_t session_length,
+                                   const char *options_json, const materialized_input_t &input,
+                                   omega_transform_plugin_read_t read, void *reader_user_data_ptr,
+                                   plugin_output_t *output, plugin_allocator_state_t &allocator_state,
+                                   omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                                   omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                                   omega_transform_plugin_response_t &response) -> bool {
+        omega_transform_plugin_apply_fn apply{};
+        {
+            const std::lock_guard<std::mutex> lock(plugin.in_process_mutex);
+            apply = plugin.in_process_apply;
+        }
+        if (!apply) { return false; }
+
+        in_process_output_t writer{output, {}};
+        omega_transform_plugin_request_t request{};
+        request.input_bytes = input.data();
+        request.input_length = input.length;
+        request.session_offset = session_offset;
+        request.session_length = session_length;
+        request.options_json = options_json;
+        request.alloc = plugin_alloc_;
+        request.allocator_user_data_ptr = &allocator_state;
+        request.read = read;
+        request.reader_user_data_ptr = reader_user_data_ptr;
+        request.preferred_chunk_size = TRANSFORM_PLUGIN_STREAM_CHUNK_BYTES;
+        request.progress = progress;
+        request.progress_user_data_ptr = progress_user_data_ptr;
+        request.is_cancelled = is_cancelled;
+        request.cancel_user_data_ptr = cancel_user_data_ptr;
+        request.write = output ? write_in_process_output_ : nullptr;
+        request.writer_user_data_ptr = &writer;
+        request.range_offset = input.range_offset;
+        if (apply(&request, &response) != 0) { return false; }
+
+        if (writer.stream.is_open()) {
+            writer.stream.close();
+            if (writer.stream.fail()) { return false; }
+        }
+        const auto written = output ? output->length : 0;
+        if ((response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U) {
+            return !response.replacement_bytes && response.replacement_length == written;
+        }
+        return written == 0;
+    }
+
+    auto read_materialized_input_(int64_t relative_offset, omega_byte_t *buffer, int64_t length,
+                                  void *user_data_ptr) -> int64_t {
+        const auto *input = static_cast<const materialized_input_t *>(user_data_ptr);
+        if (!input || !buffer || relative_offset < 0 || length < 0 || relative_offset > input->length) { return -1; }
+        const auto read_length = std::min(length, input->length - relative_offset);
+        if (read_length > 0) {
+            std::memcpy(buffer, input->data() + relative_offset, static_cast<size_t>(read_length));
+        }
+        return read_length;
+    }
+
+    class plugin_shard_monitor_t;
+
+    /**
+     * One shard of a chunk-parallel apply.  Each shard has its own input, allocations, and response, so shards only
+     * share the monitor that combines their progress and cancellation for the caller.  The input is dropped once the
+     * shard is applied, and any replacement is left in the shard's output file.
+     */
+    struct plugin_shard_t {
+        plugin_shard_monitor_t *monitor{};
+        int64_t range_offset{};
+        int64_t length{};
+        materialized_input_t input;
+        plugin_allocator_state_t allocator_state;
+        plugin_output_t output;
+        omega_transform_plugin_response_t response{};
+        int64_t processed_bytes{};
+        bool invoked{};
+        bool is_unchanged{};
+    };
+
+    /**
+     * Serializes calls into the caller's progress and cancellation callbacks from the shard workers, reporting the
+     * progress of all shards together, and cancels the remaining shards once any of them fails.
+     */
+    class plugin_shard_monitor_t {
+    public:
+        plugin_shard_monitor_t(std::vector<plugin_shard_t> &shards, int64_t length,
+                               omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                               omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr)
+            : shards_(shards), length_(length), progress_(progress), progress_user_data_ptr_(progress_user_data_ptr),
+              is_cancelled_(is_cancelled), cancel_user_data_ptr_(cancel_user_data_ptr) {}
+
+        auto has_progress() const -> bool { return progress_ != nullptr; }
+
+        auto report(plugin_shard_t &shard, const omega_transform_plugin_progress_t &shard_progress) -> int {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if ((shard_progress.flags & OMEGA_TRANSFORM_PROGRESS_HAS_PROCESSED_BYTES) != 0U) {
+                shard.processed_bytes = std::max<int64_t>(0, std::min(shard_progress.processed_bytes, shard.length));
+            }
+            int64_t processed_bytes = 0;
+            for (const auto &entry : shards_) { processed_bytes += entry.processed_bytes; }
+            auto progress = shard_progress;
+            progress.processed_bytes = processed_bytes;
+            progress.total_bytes = length_;
+            progress.percent = (static_cast<double>(processed_bytes) / static_cast<double>(length_)) * 100.0;
+            progress.flags = OMEGA_TRANSFORM_PROGRESS_HAS_PROCESSED_BYTES | OMEGA_TRANSFORM_PROGRESS_HAS_TOTAL_BYTES |
+                             OMEGA_TRANSFORM_PROGRESS_HAS_PERCENT;
+            if (progress_(&progress, progress_user_data_ptr_) == 0) { return 0; }
+            failed_ = true;
+            return -1;
+        }
+
+        auto is_cancelled() -> bool {
+            if (failed_) { return true; }
+            if (!is_cancelled_) { return false; }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (is_cancelled_(cancel_user_data_ptr_) != 0) { failed_ = true; }
+            return failed_;
+        }
+
+        void fail() { failed_ = true; }
+
+        auto failed() const -> bool { return failed_; }
+
+    private:
+        std::mutex mutex_;
+        std::atomic<bool> failed_{};
+        std::vector<plugin_shard_t> &shards_;
+        int64_t length_{};
+        omega_transform_plugin_progress_cbk_t progress_{};
+        void *progress_user_data_ptr_{};
+        omega_transform_plugin_is_cancelled_t is_cancelled_{};
+        void *cancel_user_data_ptr_{};
+    };
+
+    auto report_plugin_shard_progress_(const omega_transform_plugin_progress_t *progress_ptr,
+                                       void *user_data_ptr) -> int {
+        auto *shard = static_cast<plugin_shard_t *>(user_data_ptr);
+        if (!shard || !progress_ptr) { return 0; }
+        return shard->monitor->report(*shard, *progress_ptr);
+    }
+
+    auto plugin_shard_is_cancelled_(void *user_data_ptr) -> int {
+        const auto *shard = static_cast<plugin_shard_t *>(user_data_ptr);
+        return shard && shard->monitor->is_cancelled() ? 1 : 0;
+    }
+
+    auto plugin_shard_response_is_valid_(const plugin_shard_t &shard) -> bool {
+        const auto &response = shard.response;
+        if (response.result_bytes || response.result_length != 0 || response.result_label ||
+            response.result_mime_type) {
+            return false;
+        }
+        if (plugin_response_has_no_content_change_(response)) {
+            return !response.replacement_bytes && response.replacement_length == 0 && shard.output.length == 0;
+        }
+        if ((response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U) {
+            return !response.replacement_bytes && response.replacement_length == shard.output.length;
+        }
+        return shard.output.length == 0 &&
+               plugin_buffer_is_valid_(response.replacement_bytes, response.replacement_length);
+    }
+
+    /**
+     * Leaves a shard's replacement in its output file, writing a buffered replacement there so that the shards can
+     * replace the range from their files in order.
+     */
+    auto keep_plugin_shard_output_(plugin_shard_t &shard) -> bool {
+        const auto &response = shard.response;
+        if (plugin_response_has_no_content_change_(response) ||
+            (response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U) {
+            return plugin_response_has_no_content_change_(response) || create_plugin_output_file_(shard.output);
+        }
+        if (!create_plugin_output_file_(shard.output)) { return false; }
+        std::ofstream out(shard.output.file.path(), std::ios::binary | std::ios::trunc);
+        if (!out || (response.replacement_length > 0 &&
+                     !out.write(reinterpret_cast<const char *>(response.replacement_bytes),
+                                static_cast<std::streamsize>(response.replacement_length)))) {
+            return false;
+        }
+        out.close();
+        shard.output.length = response.replacement_length;
+        return !out.fail();
+    }
+
+    /**
+     * Splits the range of a chunk-parallel replace plugin into shards at multiples of its chunk alignment, applies
+     * the shards on concurrent workers, and replaces the range with their replacements in one transform change.  Each
+     * worker reads its own shard, holding a lock while it reads since sessions are not safe to read from several
+     * threads, and frees the shard's input as soon as the shard is applied.
+     */
+    auto apply_plugin_shards_(host_worker_pool_t &workers, loaded_plugin_t &plugin, const std::string &host_path,
+                              bool trusted, plugin_allocation_store_t &allocation_store, omega_session_t *session_ptr,
+                              int64_t offset, int64_t length, int64_t shard_count, const char *options_json,
+                              omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                              omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                              omega_transform_plugin_response_t *response_ptr, int64_t *change_serial_out) -> int {
+        const auto alignment = static_cast<int64_t>(std::max(plugin.info.chunk_alignment, 1U));
+        auto shard_length = (length + shard_count - 1) / shard_count;
+        shard_length = ((shard_length + alignment - 1) / alignment) * alignment;
+        shard_count = (length + shard_length - 1) / shard_length;
+
+        const auto *const checkpoint_directory = omega_session_get_checkpoint_directory(session_ptr);
+        std::vector<plugin_shard_t> shards(static_cast<size_t>(shard_count));
+        plugin_shard_monitor_t monitor(shards, length, progress, progress_user_data_ptr, is_cancelled,
+                                       cancel_user_data_ptr);
+        for (int64_t i = 0; i < shard_count; ++i) {
+            auto &shard = shards[static_cast<size_t>(i)];
+            shard.monitor = &monitor;
+            shard.range_offset = i * shard_length;
+            shard.length = std::min(shard_length, length - shard.range_offset);
+            shard.allocator_state = {checkpoint_directory, &allocation_store, {}};
+            shard.output.directory = checkpoint_directory;
+        }
+
+        std::mutex session_mutex;
+        const auto apply_shard = [&](plugin_shard_t &shard) {
+            if (monitor.failed()) { return; }
+            {
+                const std::lock_guard<std::mutex> lock(session_mutex);
+                if (monitor.failed() ||
+                    0 != read_session_range_(session_ptr, offset + shard.range_offset, shard.length, nullptr, nullptr,
+                                             plugin_shard_is_cancelled_, &shard, shard.input)) {
+                    monitor.fail();
+                    return;
+                }
+            }
+            shard.input.range_offset = shard.range_offset;
+            const auto shard_progress = monitor.has_progress() ? report_plugin_shard_progress_ : nullptr;
+            const auto shard_offset = offset + shard.range_offset;
+            shard.invoked =
+                    trusted ? invoke_in_process_plugin_(plugin, shard_offset, shard.length, options_json, shard.input,
+                                                        read_materialized_input_, &shard.input, &shard.output,
+                                                        shard.allocator_state, shard_progress, &shard,
+                                                        plugin_shard_is_cancelled_, &shard, shard.response)
+                            : invoke_isolated_plugin_(workers, plugin, host_path, shard_offset, shard.length,
+                                                      options_json, shard.input, &shard.output, shard.allocator_state,
+                                                      shard_progress, &shard, plugin_shard_is_cancelled_, &shard,
+                                                      shard.response);
+            shard.input = {};
+            if (!shard.invoked || !plugin_shard_response_is_valid_(shard) || !keep_plugin_shard_output_(shard)) {
+                monitor.fail();
+            }
+            shard.is_unchanged = plugin_response_has_no_content_change_(shard.response);
+            release_unclaimed_plugin_allocations_(shard.allocator_state, shard.response);
+            clear_plugin_response_(shard.allocator_state, &shard.response);
+        };
+
+        // A shard that throws fails the apply rather than escaping its thread
+        const auto try_apply_shard = [&](plugin_shard_t &shard) {
+            try {
+                apply_shard(shard);
+            } catch (...) {
+                monitor.fail();
+                release_unclaimed_plugin_allocations_(shard.allocator_state, shard.response);
+                clear_plugin_response_(shard.allocator_state, &shard.response);
+            }
+        };
+
+        // The first shard is applied on this thread, along with any whose worker thread could not be started
+        std::vector<std::thread> threads;
+        std::vector<plugin_shard_t *> unstarted;
+        try {
+            threads.reserve(shards.size() - 1);
+            unstarted.reserve(shards.size() - 1);
+            for (size_t i = 1; i < shards.size(); ++i) {
+                try {
+                    threads.emplace_back([&try_apply_shard, &shards, i]() { try_apply_shard(shards[i]); });
+                } catch (const std::system_error &) { unstarted.push_back(&shards[i]); }
+            }
+        } catch (const std::bad_alloc &) {
+            monitor.fail();
+            for (auto &thread : threads) { thread.join(); }
+            return -1;
+        }
+        try_apply_shard(shards.front());
+        for (auto *shard : unstarted) { try_apply_shard(*shard); }
+        for (auto &thread : threads) { thread.join(); }
+        if (monitor.failed() || monitor.is_cancelled()) { return -1; }
+
+        // Unchanged shards are copied from the session while the range is replaced, and the rest from their outputs
+        int64_t replacement_length = 0;
+        int64_t change_serial = 0;
+        try {
+            std::vector<int64_t> part_lengths;
+            std::vector<const char *> file_paths;
+            part_lengths.reserve(shards.size());
+            file_paths.reserve(shards.size());
+            for (const auto &shard : shards) {
+                part_lengths.push_back(shard.length);
+                file_paths.push_back(shard.is_unchanged ? nullptr : shard.output.file.path().c_str());
+                replacement_length += shard.is_unchanged ? shard.length : shard.output.length;
+            }
+            change_serial = omega_edit_replace_files_as_transform(session_ptr, offset, shard_count, part_lengths.data(),
+                                                                  file_paths.data(), plugin.info.id, options_json);
+        } catch (const std::bad_alloc &) { return -1; }
+        if (change_serial < 0) { return -1; }
+        if (change_serial_out && change_serial > 0) { *change_serial_out = change_serial; }
+        if (response_ptr) {
+            response_ptr->flags = change_serial == 0 ? OMEGA_TRANSFORM_PLUGIN_RESPONSE_NO_CONTENT_CHANGE
+                                                     : OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT;
+            response_ptr->replacement_length = change_serial == 0 ? 0 : replacement_length;
+        }
+        return 0;
     }
 
     auto env_value_is_true_(const char *value) -> bool {
@@ -1560,7 +2648,11 @@ namespace {
 struct omega_transform_plugin_registry_struct {
     std::vector<std::unique_ptr<loaded_plugin_t>> plugins;
     plugin_allocation_store_t allocation_store;
+    host_worker_pool_t host_workers;
+    std::mutex trusted_mutex;
+    std::map<std::string, sha256_digest_t> trusted_libraries;///< library SHA-256 digests by canonical path
     std::string host_path;
+    std::atomic<int> parallel_thread_count{};
     bool allow_experimental{};
     bool allow_test{};
 };
@@ -1579,11 +2671,44 @@ namespace {
         }
         return false;
     }
+
+    // Shards a chunk-parallel plugin's range is split into, or 1 when the range is applied as one request
+    auto plugin_shard_count_(const omega_transform_plugin_registry_t *registry_ptr, const loaded_plugin_t &plugin,
+                             int64_t length) -> int64_t {
+        if ((plugin.info.flags & OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL) == 0U) { return 1; }
+        const auto parallel_thread_count = registry_ptr->parallel_thread_count.load();
+        const auto thread_count =
+                parallel_thread_count > 0 ? static_cast<int64_t>(parallel_thread_count)
+                                          : static_cast<int64_t>((std::max)(std::thread::hardware_concurrency(), 1U));
+        return std::max<int64_t>(1, std::min<int64_t>(thread_count, length / OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH));
+    }
+
+    /**
+     * Determines if a plugin runs in this process, which it does when its library's canonical path is trusted, and
+     * loads it if so.  Returns 0 when the plugin is isolated, 1 when it is trusted and loaded, and -1 when it is
+     * trusted but its library can't be loaded or no longer has the contents it was trusted with.
+     */
+    auto load_trusted_plugin_(omega_transform_plugin_registry_t *registry_ptr, loaded_plugin_t &plugin) -> int {
+        sha256_digest_t trusted_digest{};
+        {
+            const std::lock_guard<std::mutex> lock(registry_ptr->trusted_mutex);
+            const auto iter = registry_ptr->trusted_libraries.find(plugin.canonical_path);
+            if (plugin.canonical_path.empty() || iter == registry_ptr->trusted_libraries.end()) { return 0; }
+            trusted_digest = iter->second;
+        }
+        return load_in_process_plugin_(plugin, trusted_digest) ? 1 : -1;
+    }
 }// namespace
 
 omega_transform_plugin_registry_t *omega_transform_plugin_registry_create(void) {
-    auto *registry = new omega_transform_plugin_registry_t();
-    if (const auto *env = std::getenv("OMEGA_EDIT_TRANSFORM_PLUGIN_HOST")) { registry->host_path = env; }
+    auto *registry = new (std::nothrow) omega_transform_plugin_registry_t();
+    if (!registry) { return nullptr; }
+    try {
+        if (const auto *env = std::getenv("OMEGA_EDIT_TRANSFORM_PLUGIN_HOST")) { registry->host_path = env; }
+    } catch (const std::bad_alloc &) {
+        delete registry;
+        return nullptr;
+    }
     registry->allow_experimental = env_value_is_true_(std::getenv("OMEGA_EDIT_TRANSFORM_PLUGIN_ALLOW_EXPERIMENTAL"));
     registry->allow_test = env_value_is_true_(std::getenv("OMEGA_EDIT_TRANSFORM_PLUGIN_ALLOW_TEST"));
     return registry;
@@ -1595,43 +2720,90 @@ int omega_transform_plugin_registry_register_plugin(omega_transform_plugin_regis
                                                     const char *plugin_path) {
     if (!registry_ptr || !plugin_path || !*plugin_path) { return -1; }
 
-    auto plugin = std::make_unique<loaded_plugin_t>();
-    plugin->path = plugin_path;
-    std::string response_path;
-    if (!create_temp_file_path_(nullptr, "OmegaEdit-xform-info", response_path)) { return -1; }
-    scoped_temp_file_t response_file(response_path);
-    if (!run_host_command_(registry_ptr->host_path, "--get-info", plugin->path, "", response_path) ||
-        !read_host_info_response_(response_path, *plugin)) {
-        return -1;
-    }
-    if (!plugin_support_allowed_(registry_ptr, plugin->info.support)) { return -1; }
-    if (omega_transform_plugin_registry_find_info(registry_ptr, plugin->info.id) != nullptr) { return -1; }
+    try {
+        auto plugin = std::make_unique<loaded_plugin_t>();
+        plugin->path = plugin_path;
+        std::error_code canonical_error;
+        const auto canonical_path = std::filesystem::canonical(plugin->path, canonical_error);
+        if (!canonical_error) { plugin->canonical_path = canonical_path.string(); }
+        std::string response_path;
+        if (!create_temp_file_path_(nullptr, "OmegaEdit-xform-info", response_path)) { return -1; }
+        scoped_temp_file_t response_file(response_path);
+        if (!run_host_command_(registry_ptr->host_path, "--get-info", plugin->path, "", response_path) ||
+            !read_host_info_response_(response_path, *plugin)) {
+            return -1;
+        }
+        if (!plugin_support_allowed_(registry_ptr, plugin->info.support)) { return -1; }
+        if (omega_transform_plugin_registry_find_info(registry_ptr, plugin->info.id) != nullptr) { return -1; }
 
-    registry_ptr->plugins.push_back(std::move(plugin));
+        registry_ptr->plugins.push_back(std::move(plugin));
+    } catch (const std::bad_alloc &) { return -1; } catch (const std::length_error &) { return -1; }
     return 0;
 }
 
 int omega_transform_plugin_registry_register_directory(omega_transform_plugin_registry_t *registry_ptr,
                                                        const char *plugin_directory) {
     if (!registry_ptr || !plugin_directory || !*plugin_directory) { return -1; }
-    const std::filesystem::path directory(plugin_directory);
 
     int loaded_count = 0;
     try {
+        const std::filesystem::path directory(plugin_directory);
         if (!std::filesystem::is_directory(directory)) { return -1; }
         for (const auto &entry : std::filesystem::directory_iterator(directory)) {
             if (!entry.is_regular_file() || !plugin_extension_is_supported_(entry.path())) { continue; }
             const auto path = entry.path().string();
             if (0 == omega_transform_plugin_registry_register_plugin(registry_ptr, path.c_str())) { ++loaded_count; }
         }
-    } catch (const std::filesystem::filesystem_error &) { return loaded_count > 0 ? loaded_count : -1; }
+    } catch (const std::filesystem::filesystem_error &) {
+        return loaded_count > 0 ? loaded_count : -1;
+    } catch (const std::bad_alloc &) { return loaded_count > 0 ? loaded_count : -1; }
     return loaded_count;
 }
 
 int omega_transform_plugin_registry_set_host_path(omega_transform_plugin_registry_t *registry_ptr,
                                                   const char *host_path) {
     if (!registry_ptr || !registry_ptr->plugins.empty()) { return -1; }
-    registry_ptr->host_path = host_path ? host_path : "";
+    try {
+        registry_ptr->host_path = host_path ? host_path : "";
+    } catch (const std::bad_alloc &) { return -1; }
+    return 0;
+}
+
+int omega_transform_plugin_registry_set_host_pool_limit(omega_transform_plugin_registry_t *registry_ptr,
+                                                        int64_t limit) {
+    if (!registry_ptr || limit < 0) { return -1; }
+    try {
+        registry_ptr->host_workers.set_limit(limit);
+    } catch (const std::bad_alloc &) { return -1; }
+    return 0;
+}
+
+int omega_transform_plugin_registry_set_plugin_trusted(omega_transform_plugin_registry_t *registry_ptr,
+                                                       const char *plugin_path, int trusted) {
+    if (!registry_ptr || !plugin_path || !*plugin_path) { return -1; }
+    try {
+        // A library that no longer exists can still be untrusted by the path it was trusted under
+        std::error_code error;
+        const auto canonical_path = trusted ? std::filesystem::canonical(plugin_path, error)
+                                            : std::filesystem::weakly_canonical(plugin_path, error);
+        if (error) { return -1; }
+        if (!trusted) {
+            const std::lock_guard<std::mutex> lock(registry_ptr->trusted_mutex);
+            registry_ptr->trusted_libraries.erase(canonical_path.string());
+            return 0;
+        }
+        sha256_digest_t digest{};
+        if (!library_file_t(canonical_path.string()).compute_digest(digest)) { return -1; }
+        const std::lock_guard<std::mutex> lock(registry_ptr->trusted_mutex);
+        registry_ptr->trusted_libraries[canonical_path.string()] = digest;
+    } catch (const std::bad_alloc &) { return -1; }
+    return 0;
+}
+
+int omega_transform_plugin_registry_set_parallel_thread_count(omega_transform_plugin_registry_t *registry_ptr,
+                                                              int thread_count) {
+    if (!registry_ptr || thread_count < 0) { return -1; }
+    registry_ptr->parallel_thread_count.store(thread_count);
     return 0;
 }
 
@@ -1653,7 +2825,9 @@ int64_t omega_transform_plugin_registry_get_count(const omega_transform_plugin_r
 }
 
 int omega_transform_plugin_options_match_args_schema(const char *options_json, const char *args_schema) {
-    return options_match_args_schema_(options_json, args_schema) ? 0 : -1;
+    try {
+        return options_match_args_schema_(options_json, args_schema) ? 0 : -1;
+    } catch (const std::bad_alloc &) { return -1; }
 }
 
 const omega_transform_plugin_info_t *
@@ -1668,7 +2842,7 @@ omega_transform_plugin_registry_find_info(const omega_transform_plugin_registry_
     if (!registry_ptr || !plugin_id || !*plugin_id) { return nullptr; }
     const auto iter =
             std::find_if(registry_ptr->plugins.cbegin(), registry_ptr->plugins.cend(),
-                         [plugin_id](const auto &plugin) { return plugin->info.id == std::string(plugin_id); });
+                         [plugin_id](const auto &plugin) { return std::strcmp(plugin->info.id, plugin_id) == 0; });
     return iter != registry_ptr->plugins.cend() ? &(*iter)->info : nullptr;
 }
 
@@ -1698,20 +2872,18 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_and_serial(
             nullptr, nullptr, response_ptr, change_serial_out);
 }
 
-int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_serial(
-        omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id, omega_session_t *session_ptr,
-        int64_t offset, int64_t length, const char *options_json, omega_transform_plugin_progress_cbk_t progress,
-        void *progress_user_data_ptr, omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
-        omega_transform_plugin_response_t *response_ptr, int64_t *change_serial_out) {
-    if (response_ptr) { omega_transform_plugin_response_clear(response_ptr); }
-    if (change_serial_out) { *change_serial_out = 0; }
+static int apply_to_session_(omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id,
+                             omega_session_t *session_ptr, int64_t offset, int64_t length, const char *options_json,
+                             omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                             omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                             omega_transform_plugin_response_t *response_ptr, int64_t *change_serial_out) {
     if (!registry_ptr || !plugin_id || !*plugin_id || !session_ptr || offset < 0 || length < 0) { return -1; }
     if (is_cancelled && is_cancelled(cancel_user_data_ptr) != 0) { return -1; }
 
     // The registry owns plugin lookup/lifetime, but omega_session_t itself is not thread-safe.
     // Callers that share sessions across threads must hold their session/core lock across this call.
     auto iter = std::find_if(registry_ptr->plugins.begin(), registry_ptr->plugins.end(),
-                             [plugin_id](const auto &plugin) { return plugin->info.id == std::string(plugin_id); });
+                             [plugin_id](const auto &plugin) { return std::strcmp(plugin->info.id, plugin_id) == 0; });
     if (iter == registry_ptr->plugins.end()) { return -1; }
     if (0 != omega_transform_plugin_options_match_args_schema(options_json, (*iter)->info.args_schema)) { return -1; }
 
@@ -1721,10 +2893,25 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_se
     if (requested_length < 0) { return -1; }
 
     const auto operation = (*iter)->info.operation;
-
+    const auto trust = load_trusted_plugin_(registry_ptr, **iter);
+    if (trust < 0) { return -1; }
+    const auto trusted = trust > 0;
+
+    const auto shard_count = plugin_shard_count_(registry_ptr, **iter, requested_length);
+    if (shard_count > 1) {
+        return apply_plugin_shards_(registry_ptr->host_workers, **iter, registry_ptr->host_path, trusted,
+                                    registry_ptr->allocation_store, session_ptr, offset, requested_length, shard_count,
+                                    options_json, progress, progress_user_data_ptr, is_cancelled, cancel_user_data_ptr,
+                                    response_ptr, change_serial_out);
+    }
+
+    // Trusted streaming plugins read the session directly rather than a materialized copy of the range
+    const auto reads_session = trusted && ((*iter)->info.flags & OMEGA_TRANSFORM_PLUGIN_FLAG_STREAMING) != 0U;
+    session_range_reader_t reader{session_ptr,  offset, requested_length, 0, progress, progress_user_data_ptr,
+                                  is_cancelled, cancel_user_data_ptr};
     materialized_input_t input;
-    if (0 != read_session_range_(session_ptr, offset, length, progress, progress_user_data_ptr, is_cancelled,
-                                 cancel_user_data_ptr, input)) {
+    if (!reads_session && 0 != read_session_range_(session_ptr, offset, length, progress, progress_user_data_ptr,
+                                                   is_cancelled, cancel_user_data_ptr, input)) {
         return -1;
     }
 
@@ -1732,11 +2919,23 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_se
                                              &registry_ptr->allocation_store,
                                              {}};
 
+    // Replace operations may stream their replacement into a file rather than returning it in one buffer
+    const auto replaces = operation == OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE ||
+                          operation == OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE_AND_INSPECT;
+    plugin_output_t output{allocator_state.checkpoint_directory, {}, 0};
+
     omega_transform_plugin_response_t plugin_response{};
     if (is_cancelled && is_cancelled(cancel_user_data_ptr) != 0) { return -1; }
-    if (!invoke_isolated_plugin_(**iter, registry_ptr->host_path, offset, requested_length, options_json, input,
-                                 allocator_state, progress, progress_user_data_ptr, is_cancelled, cancel_user_data_ptr,
-                                 plugin_response)) {
+    const auto invoked =
+            trusted ? invoke_in_process_plugin_(**iter, offset, requested_length, options_json, input,
+                                                read_session_range_chunk_, &reader, replaces ? &output : nullptr,
+                                                allocator_state, progress, progress_user_data_ptr, is_cancelled,
+                                                cancel_user_data_ptr, plugin_response)
+                    : invoke_isolated_plugin_(registry_ptr->host_workers, **iter, registry_ptr->host_path, offset,
+                                              requested_length, options_json, input, replaces ? &output : nullptr,
+                                              allocator_state, progress, progress_user_data_ptr, is_cancelled,
+                                              cancel_user_data_ptr, plugin_response);
+    if (!invoked) {
         release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
         clear_plugin_response_(allocator_state, &plugin_response);
         return -1;
@@ -1746,14 +2945,21 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_se
         clear_plugin_response_(allocator_state, &plugin_response);
         return -1;
     }
-    if (!plugin_buffer_is_valid_(plugin_response.replacement_bytes, plugin_response.replacement_length) ||
-        !plugin_buffer_is_valid_(plugin_response.result_bytes, plugin_response.result_length)) {
+    const auto streamed = (plugin_response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U;
+    if (streamed ? !replaces || plugin_response.replacement_bytes != nullptr ||
+                           plugin_response.replacement_length != output.length
+                 : !plugin_buffer_is_valid_(plugin_response.replacement_bytes, plugin_response.replacement_length)) {
+        release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
+        clear_plugin_response_(allocator_state, &plugin_response);
+        return -1;
+    }
+    if (!plugin_buffer_is_valid_(plugin_response.result_bytes, plugin_response.result_length)) {
         release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
         clear_plugin_response_(allocator_state, &plugin_response);
         return -1;
     }
     if (plugin_response_has_no_content_change_(plugin_response) &&
-        (plugin_response.replacement_bytes != nullptr || plugin_response.replacement_length != 0)) {
+        (streamed || plugin_response.replacement_bytes != nullptr || plugin_response.replacement_length != 0)) {
         release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
         clear_plugin_response_(allocator_state, &plugin_response);
         return -1;
@@ -1770,9 +2976,14 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_se
         if (no_content_change) {
             if (change_serial_out) { *change_serial_out = 0; }
         } else {
-            const auto change_serial = omega_edit_replace_bytes_as_transform(
-                    session_ptr, offset, requested_length, plugin_response.replacement_bytes,
-                    plugin_response.replacement_length, plugin_id, options_json);
+            const auto change_serial =
+                    streamed && plugin_response.replacement_length > 0
+                            ? omega_edit_replace_file_as_transform(session_ptr, offset, requested_length,
+                                                                   output.file.path().c_str(), plugin_id,
+                                                                   options_json)
+                            : omega_edit_replace_bytes_as_transform(
+                                      session_ptr, offset, requested_length, plugin_response.replacement_bytes,
+                                      plugin_response.replacement_length, plugin_id, options_json);
             if (change_serial <= 0) {
                 release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
                 clear_plugin_response_(allocator_state, &plugin_response);
@@ -1787,6 +2998,20 @@ int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_se
     return 0;
 }
 
+int omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_serial(
+        omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id, omega_session_t *session_ptr,
+        int64_t offset, int64_t length, const char *options_json, omega_transform_plugin_progress_cbk_t progress,
+        void *progress_user_data_ptr, omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+        omega_transform_plugin_response_t *response_ptr, int64_t *change_serial_out) {
+    if (response_ptr) { omega_transform_plugin_response_clear(response_ptr); }
+    if (change_serial_out) { *change_serial_out = 0; }
+    try {
+        return apply_to_session_(registry_ptr, plugin_id, session_ptr, offset, length, options_json, progress,
+                                 progress_user_data_ptr, is_cancelled, cancel_user_data_ptr, response_ptr,
+                                 change_serial_out);
+    } catch (...) { return -1; }
+}
+
 int omega_transform_plugin_registry_inspect_reader(omega_transform_plugin_registry_t *registry_ptr,
                                                    const char *plugin_id, int64_t session_offset,
                                                    int64_t session_length, const char *options_json,
@@ -1801,37 +3026,47 @@ int omega_transform_plugin_registry_inspect_reader(omega_transform_plugin_regist
             response_ptr);
 }
 
-int omega_transform_plugin_registry_inspect_reader_with_cancel(
-        omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id, int64_t session_offset,
-        int64_t session_length, const char *options_json, const char *checkpoint_directory,
-        omega_transform_plugin_read_t read, void *reader_user_data_ptr, int64_t preferred_chunk_size,
-        omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
-        omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
-        omega_transform_plugin_response_t *response_ptr) {
-    if (response_ptr) { omega_transform_plugin_response_clear(response_ptr); }
+static int inspect_reader_(omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id,
+                           int64_t session_offset, int64_t session_length, const char *options_json,
+                           const char *checkpoint_directory, omega_transform_plugin_read_t read,
+                           void *reader_user_data_ptr, int64_t preferred_chunk_size,
+                           omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+                           omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+                           omega_transform_plugin_response_t *response_ptr) {
     if (!registry_ptr || !plugin_id || !*plugin_id || session_offset < 0 || session_length < 0 || !read) { return -1; }
     if (is_cancelled && is_cancelled(cancel_user_data_ptr) != 0) { return -1; }
 
     auto iter = std::find_if(registry_ptr->plugins.begin(), registry_ptr->plugins.end(),
-                             [plugin_id](const auto &plugin) { return plugin->info.id == std::string(plugin_id); });
+                             [plugin_id](const auto &plugin) { return std::strcmp(plugin->info.id, plugin_id) == 0; });
     if (iter == registry_ptr->plugins.end()) { return -1; }
     if ((*iter)->info.operation != OMEGA_TRANSFORM_PLUGIN_OPERATION_INSPECT) { return -1; }
     if (((*iter)->info.flags & OMEGA_TRANSFORM_PLUGIN_FLAG_STREAMING) == 0U) { return -1; }
     if (0 != omega_transform_plugin_options_match_args_schema(options_json, (*iter)->info.args_schema)) { return -1; }
 
+    // Trusted plugins are handed the caller's reader, while isolated ones need the range materialized for the host
+    const auto trust = load_trusted_plugin_(registry_ptr, **iter);
+    if (trust < 0) { return -1; }
+    const auto trusted = trust > 0;
     plugin_allocator_state_t allocator_state{checkpoint_directory, &registry_ptr->allocation_store, {}};
     materialized_input_t input;
-    if (0 != materialize_reader_input_(session_length, checkpoint_directory, read, reader_user_data_ptr,
-                                       preferred_chunk_size, progress, progress_user_data_ptr, is_cancelled,
-                                       cancel_user_data_ptr, input)) {
+    if (!trusted && 0 != materialize_reader_input_(session_length, checkpoint_directory, read, reader_user_data_ptr,
+                                                   preferred_chunk_size, progress, progress_user_data_ptr,
+                                                   is_cancelled, cancel_user_data_ptr, input)) {
         return -1;
     }
 
     omega_transform_plugin_response_t plugin_response{};
     if (is_cancelled && is_cancelled(cancel_user_data_ptr) != 0) { return -1; }
-    if (!invoke_isolated_plugin_(**iter, registry_ptr->host_path, session_offset, session_length, options_json, input,
-                                 allocator_state, progress, progress_user_data_ptr, is_cancelled, cancel_user_data_ptr,
-                                 plugin_response)) {
+    const auto invoked =
+            trusted ? invoke_in_process_plugin_(**iter, session_offset, session_length, options_json, input, read,
+                                                reader_user_data_ptr, nullptr, allocator_state, progress,
+                                                progress_user_data_ptr, is_cancelled, cancel_user_data_ptr,
+                                                plugin_response)
+                    : invoke_isolated_plugin_(registry_ptr->host_workers, **iter, registry_ptr->host_path,
+                                              session_offset, session_length, options_json, input, nullptr,
+                                              allocator_state, progress, progress_user_data_ptr, is_cancelled,
+                                              cancel_user_data_ptr, plugin_response);
+    if (!invoked) {
         release_unclaimed_plugin_allocations_(allocator_state, plugin_response);
         clear_plugin_response_(allocator_state, &plugin_response);
         return -1;
@@ -1854,6 +3089,21 @@ int omega_transform_plugin_registry_inspect_reader_with_cancel(
     return 0;
 }
 
+int omega_transform_plugin_registry_inspect_reader_with_cancel(
+        omega_transform_plugin_registry_t *registry_ptr, const char *plugin_id, int64_t session_offset,
+        int64_t session_length, const char *options_json, const char *checkpoint_directory,
+        omega_transform_plugin_read_t read, void *reader_user_data_ptr, int64_t preferred_chunk_size,
+        omega_transform_plugin_progress_cbk_t progress, void *progress_user_data_ptr,
+        omega_transform_plugin_is_cancelled_t is_cancelled, void *cancel_user_data_ptr,
+        omega_transform_plugin_response_t *response_ptr) {
+    if (response_ptr) { omega_transform_plugin_response_clear(response_ptr); }
+    try {
+        return inspect_reader_(registry_ptr, plugin_id, session_offset, session_length, options_json,
+                               checkpoint_directory, read, reader_user_data_ptr, preferred_chunk_size, progress,
+                               progress_user_data_ptr, is_cancelled, cancel_user_data_ptr, response_ptr);
+    } catch (...) { return -1; }
+}
+
 void omega_transform_plugin_response_clear(omega_transform_plugin_response_t *response_ptr) {
     if (!response_ptr) { return; }
     release_plugin_allocation_(nullptr, response_ptr->replacement_bytes);
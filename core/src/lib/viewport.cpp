@@ -24,9 +24,10 @@
 #include <new>
 #include <utility>
 
+using omega_edit::internal::borrow_data_segment_;
+using omega_edit::internal::omega_data_borrow_;
 using omega_edit::internal::omega_data_create_;
 using omega_edit::internal::omega_data_destroy_;
-using omega_edit::internal::populate_data_segment_;
 using omega_edit::internal::safe_add_int64_;
 
 const omega_session_t *omega_viewport_get_session(const omega_viewport_t *viewport_ptr) {
@@ -115,7 +116,9 @@ int omega_viewport_modify(omega_viewport_t *viewport_ptr, int64_t offset, int64_
                 omega_data_create_(&replacement_data, capacity);
             } catch (const std::bad_alloc &) { return -1; }
             omega_data_destroy_(&viewport_ptr->data_segment.data, omega_viewport_get_capacity(viewport_ptr));
-            viewport_ptr->data_segment.data = std::move(replacement_data);
+            omega_data_destroy_(&viewport_ptr->buffer, omega_viewport_get_capacity(viewport_ptr));
+            viewport_ptr->buffer = std::move(replacement_data);
+            omega_data_borrow_(&viewport_ptr->data_segment.data, viewport_ptr->buffer.data(), capacity);
             viewport_ptr->data_segment.offset = offset;
             viewport_ptr->data_segment.is_floating = (bool) is_floating;
             viewport_ptr->data_segment.offset_adjustment = 0;
@@ -137,9 +140,23 @@ const omega_byte_t *omega_viewport_get_data(const omega_viewport_t *viewport_ptr
     if (!viewport_ptr) { return nullptr; }
     const auto mut_viewport_ptr = const_cast<omega_viewport_t *>(viewport_ptr);
     if (0 != omega_viewport_has_changes(viewport_ptr)) {
-        // Clean the dirty read with a fresh data segment population
-        mut_viewport_ptr->data_segment.capacity = std::abs(viewport_ptr->data_segment.capacity);
-        if (populate_data_segment_(viewport_ptr->session_ptr, &mut_viewport_ptr->data_segment) != 0) { return nullptr; }
+        // Clean the dirty read, borrowing the bytes when they all lie in one mapped run of the file or one inline
+        // insert, and populating the viewport buffer otherwise.  Borrowed bytes stay valid while the viewport is clean,
+        // because any change that could release them marks the viewport dirty.
+        omega_edit::internal::omega_session_adopt_original_snapshot_(viewport_ptr->session_ptr, false);
+        auto &data_segment = mut_viewport_ptr->data_segment;
+        const auto capacity = std::abs(data_segment.capacity);
+        data_segment.capacity = capacity;
+        try {
+            omega_data_borrow_(&data_segment.data, mut_viewport_ptr->buffer.data(), capacity);
+            const auto &model_ptr = viewport_ptr->session_ptr->models_.back();
+            const auto *data = borrow_data_segment_(model_ptr.get(), model_ptr->model_segments, &data_segment);
+            if (!data) { return nullptr; }
+            // The data segment never writes through a borrowed pointer, so dropping const here is safe
+            if (data != mut_viewport_ptr->buffer.data()) {
+                omega_data_borrow_(&data_segment.data, const_cast<omega_byte_t *>(data), data_segment.length);
+            }
+        } catch (const std::bad_alloc &) { return nullptr; }
         assert(omega_viewport_get_length(viewport_ptr) == viewport_ptr->data_segment.length);
     }
     return omega_segment_get_data(&mut_viewport_ptr->data_segment);
@@ -0,0 +1,126 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "omega_edit.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    using benchmark_clock_t = std::chrono::steady_clock;
+
+    constexpr size_t buffer_bytes = 64U * 1024U * 1024U;
+
+    omega_byte_t to_upper_callback(omega_byte_t byte, void *) {
+        return (byte >= 'a' && byte <= 'z') ? static_cast<omega_byte_t>(byte - ('a' - 'A')) : byte;
+    }
+
+    omega_byte_t xor_callback(omega_byte_t byte, void *user_data_ptr) {
+        return omega_util_mask_byte(byte, *static_cast<const omega_byte_t *>(user_data_ptr), MASK_XOR);
+    }
+
+    std::vector<omega_byte_t> mixed_bytes(size_t length) {
+        std::vector<omega_byte_t> bytes(length);
+        uint32_t state = 0x12345678U;
+        for (auto &byte : bytes) {
+            state = state * 1664525U + 1013904223U;
+            byte = static_cast<omega_byte_t>(state >> 24U);
+        }
+        return bytes;
+    }
+
+    // Times the given kernel over a fresh copy of the input, returning MiB/s and leaving the result in output
+    double mib_per_second(const std::vector<omega_byte_t> &input, std::vector<omega_byte_t> &output,
+                          const std::function<void(omega_byte_t *, int64_t)> &kernel) {
+        output = input;
+        const auto begin = benchmark_clock_t::now();
+        kernel(output.data(), static_cast<int64_t>(output.size()));
+        const auto seconds = std::chrono::duration<double>(benchmark_clock_t::now() - begin).count();
+        return static_cast<double>(output.size()) / (1024.0 * 1024.0) / seconds;
+    }
+
+    double millis_per_session_transform(const std::vector<omega_byte_t> &input,
+                                        const std::function<int(omega_session_t *)> &apply) {
+        auto *session_ptr = omega_edit_create_session_from_bytes(input.data(), static_cast<int64_t>(input.size()),
+                                                                 nullptr, nullptr, NO_EVENTS, nullptr);
+        REQUIRE(session_ptr);
+        const auto begin = benchmark_clock_t::now();
+        REQUIRE(0 == apply(session_ptr));
+        const auto millis = std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+        omega_edit_destroy_session(session_ptr);
+        return millis;
+    }
+}// namespace
+
+TEST_CASE("Benchmark byte transform kernels", "[.][ByteTransformBenchmark]") {
+    const auto input = mixed_bytes(buffer_bytes);
+    std::vector<omega_byte_t> expected;
+    std::vector<omega_byte_t> actual;
+
+    omega_byte_t upper_table[256];
+    omega_util_fill_byte_table(upper_table, to_upper_callback, nullptr);
+    const auto upper_callback_rate = mib_per_second(input, expected, [](omega_byte_t *buffer, int64_t length) {
+        omega_util_apply_byte_transform(buffer, length, to_upper_callback, nullptr);
+    });
+    const auto upper_table_rate = mib_per_second(input, actual, [&upper_table](omega_byte_t *buffer, int64_t length) {
+        omega_util_apply_byte_table(buffer, length, upper_table);
+    });
+    REQUIRE(expected == actual);
+    const auto upper_kernel_rate = mib_per_second(input, actual, omega_util_ascii_to_upper);
+    REQUIRE(expected == actual);
+
+    omega_byte_t operand = 0xFF;
+    const auto xor_callback_rate = mib_per_second(input, expected, [&operand](omega_byte_t *buffer, int64_t length) {
+        omega_util_apply_byte_transform(buffer, length, xor_callback, &operand);
+    });
+    const auto xor_kernel_rate = mib_per_second(input, actual, [operand](omega_byte_t *buffer, int64_t length) {
+        omega_util_apply_mask(buffer, length, operand, MASK_XOR);
+    });
+    REQUIRE(expected == actual);
+
+    std::cout << "\nByte transform kernel benchmark: " << (buffer_bytes >> 20U) << " MiB buffer\n";
+    std::cout << "  ascii upper, per-byte callback: " << upper_callback_rate << " MiB/s\n";
+    std::cout << "  ascii upper, lookup table:      " << upper_table_rate << " MiB/s\n";
+    std::cout << "  ascii upper, kernel:            " << upper_kernel_rate << " MiB/s\n";
+    std::cout << "  xor 0xFF, per-byte callback:    " << xor_callback_rate << " MiB/s\n";
+    std::cout << "  xor 0xFF, kernel:               " << xor_kernel_rate << " MiB/s\n";
+}
+
+TEST_CASE("Benchmark session byte transforms", "[.][ByteTransformBenchmark]") {
+    const auto input = mixed_bytes(buffer_bytes);
+
+    const auto callback_ms = millis_per_session_transform(input, [](omega_session_t *session_ptr) {
+        return omega_edit_apply_transform(session_ptr, to_upper_callback, nullptr, 0, 0);
+    });
+    omega_byte_t upper_table[256];
+    omega_util_fill_byte_table(upper_table, to_upper_callback, nullptr);
+    const auto table_ms = millis_per_session_transform(input, [&upper_table](omega_session_t *session_ptr) {
+        return omega_edit_apply_table_transform(session_ptr, upper_table, 0, 0);
+    });
+    const auto builtin_ms = millis_per_session_transform(input, [](omega_session_t *session_ptr) {
+        return omega_edit_apply_builtin_transform(session_ptr, {OMEGA_EDIT_TRANSFORM_ASCII_TO_UPPER, 0}, 0, 0);
+    });
+
+    std::cout << "\nSession byte transform benchmark: ascii upper over " << (buffer_bytes >> 20U) << " MiB\n";
+    std::cout << "  callback: " << callback_ms << " ms\n";
+    std::cout << "  table:    " << table_ms << " ms\n";
+    std::cout << "  builtin:  " << builtin_ms << " ms\n";
+}
@@ -0,0 +1,78 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed on an "AS IS" BASIS, WITHOUT    *
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the License for the specific language         *
+ * governing permissions and limitations under the License.                                                           *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include <omega_edit/transform_plugin_sdk.h>
+
+static omega_byte_t transform_byte(omega_byte_t byte) {
+    return (byte >= 'a' && byte <= 'z') ? (omega_byte_t) (byte - ('a' - 'A')) : byte;
+}
+
+OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_get_info(omega_transform_plugin_info_t *info_ptr) {
+    if (!info_ptr) { return -1; }
+    info_ptr->id = "omega.test.chunk_parallel";
+    info_ptr->name = "Chunk Parallel Test";
+    info_ptr->description = "Test plugin that upper-cases ASCII letters and removes dashes, in shards.";
+    info_ptr->operation = OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE;
+    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE | OMEGA_TRANSFORM_PLUGIN_FLAG_MAY_SHRINK |
+                      OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL;
+    info_ptr->args_schema = OMEGA_TRANSFORM_PLUGIN_NO_ARGS_SCHEMA;
+    info_ptr->support = OMEGA_TRANSFORM_PLUGIN_SUPPORT_TEST;
+    info_ptr->abi_version = OMEGA_TRANSFORM_PLUGIN_ABI_VERSION;
+    return 0;
+}
+
+/*
+ * Ranges without lowercase letters or dashes are reported unchanged, ranges starting with a digit are streamed, and
+ * the rest are returned in one buffer, so a sharded apply mixes all three kinds of response.
+ */
+OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_apply(const omega_transform_plugin_request_t *request_ptr,
+                                                               omega_transform_plugin_response_t *response_ptr) {
+    if (!request_ptr || !response_ptr || !request_ptr->alloc || request_ptr->input_length < 0 ||
+        (request_ptr->input_length > 0 && !request_ptr->input_bytes)) {
+        return -1;
+    }
+    const omega_byte_t *input = request_ptr->input_bytes;
+    int64_t changed = 0;
+    for (int64_t i = 0; i < request_ptr->input_length && !changed; ++i) {
+        changed = input[i] == '-' || transform_byte(input[i]) != input[i];
+    }
+    if (!changed) { return omega_transform_plugin_sdk_set_no_content_change(response_ptr); }
+
+    if (input[0] >= '0' && input[0] <= '9' && omega_transform_plugin_sdk_can_stream_replacement(request_ptr)) {
+        omega_byte_t chunk[4096];
+        int64_t length = 0;
+        for (int64_t i = 0; i < request_ptr->input_length; ++i) {
+            if (input[i] != '-') { chunk[length++] = transform_byte(input[i]); }
+            if (length == (int64_t) sizeof(chunk) || (i + 1 == request_ptr->input_length && length > 0)) {
+                if (omega_transform_plugin_sdk_write_replacement(request_ptr, response_ptr, chunk, length) != 0) {
+                    return -1;
+                }
+                length = 0;
+            }
+        }
+        response_ptr->flags |= OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT;
+        return 0;
+    }
+
+    omega_byte_t *replacement =
+            (omega_byte_t *) omega_transform_plugin_sdk_alloc(request_ptr, (size_t) request_ptr->input_length);
+    if (!replacement) { return -1; }
+    int64_t length = 0;
+    for (int64_t i = 0; i < request_ptr->input_length; ++i) {
+        if (input[i] != '-') { replacement[length++] = transform_byte(input[i]); }
+    }
+    response_ptr->replacement_bytes = replacement;
+    response_ptr->replacement_length = length;
+    return 0;
+}
@@ -13,6 +13,7 @@
  **********************************************************************************************************************/
 
 #include "../lib/impl_/data_def.hpp"
+#include "../lib/impl_/find.h"
 #include "../lib/impl_/safe_math.hpp"
 #include "../lib/impl_/session_def.hpp"
 #include "../lib/impl_/viewport_def.hpp"
@@ -28,6 +29,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <algorithm>
+#include <climits>
 #include <cstdio>
 #include <cstring>
 #include <filesystem>
@@ -256,6 +259,71 @@ TEST_CASE("Unknown case folding identifiers are rejected", "[EdgeCase][Search]")
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Vector find paths agree with the scalar search", "[EdgeCase][Search]") {
+    const auto default_isa = omega_find_get_isa();
+    uint32_t state = 0x9e3779b9U;
+    const auto next_byte = [&state](uint32_t alphabet_size) {
+        state = state * 1664525U + 1013904223U;
+        return static_cast<unsigned char>('a' + (state >> 24) % alphabet_size);
+    };
+    // ASCII folding, plus a third byte folding to 'a' so that needle byte can't use the vector filter
+    unsigned char fold_table[UCHAR_MAX + 1];
+    for (auto byte = 0; byte <= UCHAR_MAX; ++byte) {
+        fold_table[byte] = static_cast<unsigned char>(byte >= 'A' && byte <= 'Z' ? byte + 0x20 : byte);
+    }
+    fold_table[0x01] = 'a';
+
+    for (const auto isa : {OMEGA_FIND_ISA_SCALAR, OMEGA_FIND_ISA_SSE2, OMEGA_FIND_ISA_AVX2}) {
+        // Unsupported instruction sets are clamped, so every requested path runs on some implementation
+        REQUIRE(omega_find_set_isa(isa) <= default_isa);
+        for (const bool is_folded : {false, true}) {
+            const auto equals = [&](unsigned char haystack_byte, unsigned char needle_byte) {
+                return (is_folded ? fold_table[haystack_byte] : haystack_byte) == needle_byte;
+            };
+            for (const uint32_t alphabet_size : {2U, 4U, 26U}) {
+                for (size_t haystack_length = 1; haystack_length <= 160; haystack_length += 7) {
+                    std::vector<unsigned char> haystack(haystack_length);
+                    for (auto &byte : haystack) {
+                        byte = next_byte(alphabet_size);
+                        if (is_folded && (state & 0x300U) == 0x100U) { byte = static_cast<unsigned char>(byte - 0x20); }
+                        if (is_folded && (state & 0x300U) == 0x200U && byte == 'a') { byte = 0x01; }
+                    }
+                    for (const size_t needle_length : {1, 2, 3, 5, 16, 17, 33, 70}) {
+                        // Take needles from the haystack when possible so there are matches near the block boundaries
+                        std::vector<unsigned char> needle(needle_length);
+                        if (needle_length <= haystack_length && (state & 1U) == 0) {
+                            const auto start = (state >> 8) % (haystack_length - needle_length + 1);
+                            std::copy_n(haystack.begin() + static_cast<std::ptrdiff_t>(start), needle_length,
+                                        needle.begin());
+                        } else {
+                            for (auto &byte : needle) { byte = next_byte(alphabet_size); }
+                        }
+                        if (is_folded) {
+                            for (auto &byte : needle) { byte = fold_table[byte]; }
+                        }
+                        const auto to_pointer = [&haystack](std::vector<unsigned char>::const_iterator found) {
+                            return found == haystack.cend() ? nullptr : haystack.data() + (found - haystack.cbegin());
+                        };
+                        const auto find = [&](int is_reverse) {
+                            const auto skip_table = omega_find_create_folded_skip_table(
+                                    needle.data(), needle_length, is_reverse, is_folded ? fold_table : nullptr);
+                            const auto *found = omega_find(haystack.data(), haystack_length, skip_table,
+                                                           needle.data(), needle_length);
+                            omega_find_destroy_skip_table(skip_table);
+                            return found;
+                        };
+                        REQUIRE(to_pointer(std::search(haystack.cbegin(), haystack.cend(), needle.cbegin(),
+                                                       needle.cend(), equals)) == find(0));
+                        REQUIRE(to_pointer(std::find_end(haystack.cbegin(), haystack.cend(), needle.cbegin(),
+                                                         needle.cend(), equals)) == find(1));
+                    }
+                }
+            }
+        }
+    }
+    REQUIRE(default_isa == omega_find_set_isa(default_isa));
+}
+
 TEST_CASE("Replace all folds EBCDIC CP037 bytes", "[EdgeCase][CheckpointReplaceAll]") {
     const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, 0, nullptr);
     REQUIRE(session_ptr);
@@ -843,18 +911,20 @@ TEST_CASE("Public Search Replace And Viewport APIs Reject Int64 Overflow Ranges"
     omega_edit_destroy_session(session_ptr);
 }
 
-TEST_CASE("Computed File Size Returns -1 On Segment Overflow", "[EdgeCase][Overflow]") {
+TEST_CASE("Segment Length Overflow Is Rejected By Model Updates", "[EdgeCase][Overflow]") {
     const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, 0, nullptr);
     REQUIRE(session_ptr);
     REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "abc"));
     REQUIRE(3 == omega_session_get_computed_file_size(session_ptr));
 
-    // Directly corrupt the last segment so computed_offset + computed_length overflows int64.
-    auto &seg = session_ptr->models_.back()->model_segments.back();
-    seg->computed_offset = (std::numeric_limits<int64_t>::max)();
-    seg->computed_length = 1;
+    // Directly corrupt the only segment so that adding any further segment overflows the piece tree aggregates.
+    auto &segments = session_ptr->models_.back()->model_segments;
+    REQUIRE(1 == segments.size());
+    const_cast<omega_model_segment_t &>(*segments.begin()).computed_length = (std::numeric_limits<int64_t>::max)();
 
-    REQUIRE(-1 == omega_session_get_computed_file_size(session_ptr));
+    REQUIRE(-1 == omega_edit_insert_string(session_ptr, 0, "Y"));
+    REQUIRE(1 == omega_session_get_num_changes(session_ptr));
+    REQUIRE(-1 == omega_check_model(session_ptr));
 
     omega_edit_destroy_session(session_ptr);
 }
@@ -868,34 +938,37 @@ TEST_CASE("Failed Model Update Preserves Segment Metadata", "[EdgeCase][Overflow
     auto &segments = session_ptr->models_.back()->model_segments;
     REQUIRE(3 == segments.size());
 
-    auto *const overflow_segment_ptr = segments[1].get();
-    overflow_segment_ptr->computed_offset = (std::numeric_limits<int64_t>::max)();
+    // Grow the first segment so the model spans exactly INT64_MAX bytes, leaving no room for another byte
+    const_cast<omega_model_segment_t &>(*segments.begin()).computed_length = (std::numeric_limits<int64_t>::max)() - 3;
 
     struct segment_snapshot_t {
-        omega_model_segment_t *segment_ptr;
         int64_t computed_offset;
         int64_t computed_length;
         int64_t change_offset;
-        const_omega_change_ptr_t change_ptr;
+        const omega_change_t *change_ptr;
         omega_change_payload_role_t payload_role;
     };
-    std::vector<segment_snapshot_t> segment_snapshots;
-    for (const auto &segment_ptr : segments) {
-        segment_snapshots.push_back({segment_ptr.get(), segment_ptr->computed_offset, segment_ptr->computed_length,
-                                     segment_ptr->change_offset, segment_ptr->change_ptr, segment_ptr->payload_role});
-    }
+    const auto snapshot_segments = [&segments]() {
+        std::vector<segment_snapshot_t> result;
+        for (auto iter = segments.begin(); iter != segments.end(); ++iter) {
+            result.push_back({iter.computed_offset(), iter->computed_length, iter->change_offset, iter.change(),
+                              iter->payload_role});
+        }
+        return result;
+    };
+    const auto segment_snapshots = snapshot_segments();
     const auto change_count = omega_session_get_num_changes(session_ptr);
 
     REQUIRE(-1 == omega_edit_insert_string(session_ptr, 0, "Y"));
 
-    REQUIRE(segment_snapshots.size() == segments.size());
-    for (size_t i = 0; i < segments.size(); ++i) {
-        CHECK(segment_snapshots[i].segment_ptr == segments[i].get());
-        CHECK(segment_snapshots[i].computed_offset == segments[i]->computed_offset);
-        CHECK(segment_snapshots[i].computed_length == segments[i]->computed_length);
-        CHECK(segment_snapshots[i].change_offset == segments[i]->change_offset);
-        CHECK(segment_snapshots[i].change_ptr == segments[i]->change_ptr);
-        CHECK(segment_snapshots[i].payload_role == segments[i]->payload_role);
+    const auto current_snapshots = snapshot_segments();
+    REQUIRE(segment_snapshots.size() == current_snapshots.size());
+    for (size_t i = 0; i < current_snapshots.size(); ++i) {
+        CHECK(segment_snapshots[i].computed_offset == current_snapshots[i].computed_offset);
+        CHECK(segment_snapshots[i].computed_length == current_snapshots[i].computed_length);
+        CHECK(segment_snapshots[i].change_offset == current_snapshots[i].change_offset);
+        CHECK(segment_snapshots[i].change_ptr == current_snapshots[i].change_ptr);
+        CHECK(segment_snapshots[i].payload_role == current_snapshots[i].payload_role);
     }
     CHECK(change_count == omega_session_get_num_changes(session_ptr));
 
@@ -1026,14 +1099,39 @@ TEST_CASE("Floating Viewport Adjustment Overflow Is Rejected Without Undefined A
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Model Segment Pool Releases Unreferenced Nodes And Changes", "[EdgeCase][ModelUpdate]") {
+    const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, 0, nullptr);
+    REQUIRE(session_ptr);
+    omega_session_set_undo_snapshot_interval(session_ptr, 0);
+    const auto &pool = session_ptr->models_.back()->segment_pool;
+
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "abcdef"));
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 3, "XYZ"));
+    REQUIRE(3 == session_ptr->models_.back()->model_segments.size());
+    REQUIRE(3 == pool.live_node_count());
+    REQUIRE(2 == pool.live_change_count());
+
+    // Deleting the inserted run drops the only segment referring to the second change
+    REQUIRE(0 < omega_edit_delete(session_ptr, 3, 3));
+    REQUIRE("abcdef" == omega_session_get_segment_string(session_ptr, 0, 6));
+    REQUIRE(1 == pool.live_change_count());
+    REQUIRE(0 == omega_check_model(session_ptr));
+
+    REQUIRE(0 == omega_edit_clear_changes(session_ptr));
+    REQUIRE(0 == pool.live_node_count());
+    REQUIRE(0 == pool.live_change_count());
+
+    omega_edit_destroy_session(session_ptr);
+}
+
 TEST_CASE("Model Check Rejects Arithmetic Overflow In Segment Bounds", "[EdgeCase][Overflow]") {
     const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, 0, nullptr);
     REQUIRE(session_ptr);
     REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "abc"));
 
-    auto &seg = session_ptr->models_.back()->model_segments.back();
-    seg->change_offset = (std::numeric_limits<int64_t>::max)();
-    seg->computed_length = 1;
+    // Only the change offset is corrupted, so the piece tree aggregates stay consistent and the bounds check trips
+    auto &seg = const_cast<omega_model_segment_t &>(*session_ptr->models_.back()->model_segments.find(0));
+    seg.change_offset = (std::numeric_limits<int64_t>::max)();
 
     REQUIRE(-1 == omega_check_model(session_ptr));
 
@@ -1088,8 +1186,8 @@ TEST_CASE("Search Reports Backing Read Failures", "[EdgeCase][Search]") {
             omega_search_create_context_string(session_ptr, "a", 1, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, false);
     REQUIRE(search_context);
 
-    auto &first_segment = session_ptr->models_.back()->model_segments.front();
-    first_segment->change_offset = omega_session_get_original_file_size(session_ptr) + 1024;
+    auto &first_segment = const_cast<omega_model_segment_t &>(*session_ptr->models_.back()->model_segments.begin());
+    first_segment.change_offset = omega_session_get_original_file_size(session_ptr) + 1024;
 
     REQUIRE(-1 == omega_search_next_match(search_context, 1));
 
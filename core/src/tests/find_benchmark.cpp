@@ -0,0 +1,117 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "../lib/impl_/find.h"
+#include "omega_edit.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    using benchmark_clock_t = std::chrono::steady_clock;
+
+    const char *isa_name(omega_find_isa_t isa) {
+        switch (isa) {
+            case OMEGA_FIND_ISA_AVX2:
+                return "avx2";
+            case OMEGA_FIND_ISA_SSE2:
+                return "sse2";
+            default:
+                return "scalar";
+        }
+    }
+
+    // Haystack of pseudo-random bytes, with the needle planted every match_spacing bytes (0 for no planted matches)
+    std::vector<unsigned char> make_haystack(size_t length, const std::vector<unsigned char> &needle,
+                                             size_t match_spacing) {
+        std::vector<unsigned char> haystack(length);
+        uint32_t state = 0x2545F491U;
+        for (auto &byte : haystack) {
+            state = state * 1664525U + 1013904223U;
+            byte = static_cast<unsigned char>(state >> 24);
+        }
+        if (match_spacing != 0) {
+            for (size_t offset = match_spacing / 2; offset + needle.size() <= length; offset += match_spacing) {
+                std::copy(needle.begin(), needle.end(), haystack.begin() + static_cast<std::ptrdiff_t>(offset));
+            }
+        }
+        return haystack;
+    }
+
+    // Counts every match by restarting the search just past the previous one, returning the scan rate in MiB/s
+    double scan_rate(const std::vector<unsigned char> &haystack, const std::vector<unsigned char> &needle,
+                     int is_reverse, int64_t &match_count) {
+        const auto skip_table_ptr = omega_find_create_skip_table(needle.data(), needle.size(), is_reverse);
+        match_count = 0;
+        const auto begin = benchmark_clock_t::now();
+        if (is_reverse) {
+            auto remaining = haystack.size();
+            while (const auto *found =
+                           omega_find(haystack.data(), remaining, skip_table_ptr, needle.data(), needle.size())) {
+                ++match_count;
+                remaining = static_cast<size_t>(found - haystack.data()) + needle.size() - 1;
+            }
+        } else {
+            const auto *position = haystack.data();
+            const auto *end = haystack.data() + haystack.size();
+            while (const auto *found = omega_find(position, static_cast<size_t>(end - position), skip_table_ptr,
+                                                  needle.data(), needle.size())) {
+                ++match_count;
+                position = found + 1;
+            }
+        }
+        const auto seconds = std::chrono::duration<double>(benchmark_clock_t::now() - begin).count();
+        omega_find_destroy_skip_table(skip_table_ptr);
+        return static_cast<double>(haystack.size()) / (1024.0 * 1024.0) / seconds;
+    }
+}// namespace
+
+TEST_CASE("Benchmark scalar and vector find by needle length and match density", "[.][FindBenchmark]") {
+    constexpr size_t haystack_length = 64 * 1024 * 1024;
+    const auto best_isa = omega_find_get_isa();
+
+    std::cout << "\nFind benchmark: " << haystack_length / (1024 * 1024) << " MiB haystack, MiB/s (best isa "
+              << isa_name(best_isa) << ")\n";
+    for (const size_t needle_length : {2, 4, 8, 16, 32, 64}) {
+        std::vector<unsigned char> needle(needle_length);
+        for (size_t i = 0; i < needle_length; ++i) { needle[i] = static_cast<unsigned char>(0xA5 ^ (i * 37)); }
+        for (const size_t match_spacing : {0, 65536, 256}) {
+            const auto haystack = make_haystack(haystack_length, needle, match_spacing);
+            std::cout << "  needle " << needle_length << ", "
+                      << (match_spacing ? "1 match / " + std::to_string(match_spacing) + " bytes" : "no matches")
+                      << ":";
+            int64_t expected_count = -1;
+            for (int isa = OMEGA_FIND_ISA_SCALAR; isa <= best_isa; ++isa) {
+                REQUIRE(isa == omega_find_set_isa(static_cast<omega_find_isa_t>(isa)));
+                int64_t forward_count = 0;
+                int64_t reverse_count = 0;
+                const auto forward_rate = scan_rate(haystack, needle, 0, forward_count);
+                const auto reverse_rate = scan_rate(haystack, needle, 1, reverse_count);
+                if (expected_count < 0) { expected_count = forward_count; }
+                REQUIRE(expected_count == forward_count);
+                REQUIRE(expected_count == reverse_count);
+                std::cout << " " << isa_name(static_cast<omega_find_isa_t>(isa)) << " " << forward_rate << " fwd / "
+                          << reverse_rate << " rev;";
+            }
+            std::cout << " " << expected_count << " matches\n";
+        }
+    }
+    omega_find_set_isa(best_isa);
+}
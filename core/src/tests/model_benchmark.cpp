@@ -0,0 +1,249 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "../lib/impl_/change_def.hpp"
+#include "../lib/impl_/model_segment_tree.hpp"
+#include "omega_edit.h"
+#include "omega_edit/config.h"
+#include "omega_edit/stl_string_adaptor.hpp"
+
+#include <test_util.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    using benchmark_clock_t = std::chrono::steady_clock;
+    using omega_edit::internal::model_segment_pool_t;
+    using omega_edit::internal::model_segment_tree_t;
+
+    // Small deterministic generator so every run probes the same offsets
+    struct offset_generator_t {
+        uint64_t state{0x2545F4914F6CDD1DULL};
+
+        int64_t next(int64_t bound) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return bound > 0 ? static_cast<int64_t>(state % static_cast<uint64_t>(bound)) : 0;
+        }
+    };
+
+    double micros_per_op(const benchmark_clock_t::time_point &begin, const benchmark_clock_t::time_point &end,
+                         int op_count) {
+        return std::chrono::duration<double, std::micro>(end - begin).count() / static_cast<double>(op_count);
+    }
+
+    // Set OMEGA_EDIT_BENCHMARK_BYTES to benchmark a different file size
+    int64_t benchmark_file_size() {
+        int64_t file_size = 1024LL * 1024 * 1024;
+        if (const auto *size_str = std::getenv("OMEGA_EDIT_BENCHMARK_BYTES"); size_str && *size_str) {
+            file_size = std::strtoll(size_str, nullptr, 10);
+        }
+        return file_size;
+    }
+
+    void write_benchmark_file(const std::string &file_name_str, int64_t file_size) {
+        const auto file_ptr = FOPEN(file_name_str.c_str(), "wb");
+        REQUIRE(file_ptr);
+        std::vector<char> block(1024 * 1024);
+        offset_generator_t generator;
+        for (auto &byte : block) { byte = static_cast<char>(generator.next(256)); }
+        for (int64_t offset = 0; offset < file_size; offset += static_cast<int64_t>(block.size())) {
+            const auto count = static_cast<size_t>(std::min(static_cast<int64_t>(block.size()), file_size - offset));
+            REQUIRE(count == fwrite(block.data(), 1, count, file_ptr));
+        }
+        FCLOSE(file_ptr);
+    }
+}// namespace
+
+TEST_CASE("Benchmark piece tree edit and lookup latency by segment count", "[.][ModelBenchmark]") {
+    constexpr int op_count = 10000;
+    const auto change_ptr = std::make_shared<omega_change_t>();
+    change_ptr->serial = 1;
+    change_ptr->length = 4;
+
+    std::cout << "\nPiece tree benchmark: " << op_count << " operations per size\n";
+    for (const int segment_count : {1000, 10000, 100000, 1000000}) {
+        model_segment_pool_t pool;
+        model_segment_tree_t segments(&pool);
+        offset_generator_t generator;
+        // Insert on segment boundaries so the tree ends up with exactly segment_count segments
+        for (int i = 0; i < segment_count; ++i) {
+            REQUIRE(0 == segments.insert(4 * generator.next(i + 1), change_ptr, 0, 4));
+        }
+        REQUIRE(static_cast<size_t>(segment_count) == segments.size());
+
+        auto begin = benchmark_clock_t::now();
+        for (int i = 0; i < op_count; ++i) {
+            REQUIRE(0 == segments.insert(generator.next(segments.computed_length() + 1), change_ptr, 0, 4));
+        }
+        const auto insert_us = micros_per_op(begin, benchmark_clock_t::now(), op_count);
+
+        begin = benchmark_clock_t::now();
+        int64_t probe_total = 0;
+        for (int i = 0; i < op_count; ++i) {
+            const auto iter = segments.find(generator.next(segments.computed_length()));
+            REQUIRE(iter != segments.end());
+            probe_total += iter.computed_offset();
+        }
+        const auto find_us = micros_per_op(begin, benchmark_clock_t::now(), op_count);
+
+        begin = benchmark_clock_t::now();
+        for (int i = 0; i < op_count; ++i) {
+            REQUIRE(0 == segments.erase(generator.next(segments.computed_length() - 3), 3));
+        }
+        const auto erase_us = micros_per_op(begin, benchmark_clock_t::now(), op_count);
+
+        REQUIRE(segments.validate());
+        REQUIRE(0 <= probe_total);
+        std::cout << "  " << segment_count << " segments: insert " << insert_us << " us, find " << find_us
+                  << " us, erase " << erase_us << " us\n";
+    }
+}
+
+TEST_CASE("Benchmark session edit and read latency by segment count", "[.][ModelBenchmark]") {
+    constexpr int op_count = 200;
+    constexpr int64_t read_length = 64;
+
+    std::cout << "\nSession benchmark: " << op_count << " operations per size\n";
+    for (const int segment_count : {1000, 10000, 100000}) {
+        auto *session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+        REQUIRE(session_ptr);
+        // Keep periodic snapshots out of the measurement so only the model update is timed
+        omega_session_set_undo_snapshot_interval(session_ptr, 0);
+        offset_generator_t generator;
+        for (int i = 0; i < segment_count; ++i) {
+            const auto offset = generator.next(omega_session_get_computed_file_size(session_ptr) + 1);
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, offset, "abcd"));
+        }
+
+        auto begin = benchmark_clock_t::now();
+        for (int i = 0; i < op_count; ++i) {
+            const auto offset = generator.next(omega_session_get_computed_file_size(session_ptr) + 1);
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, offset, "wxyz"));
+        }
+        const auto insert_us = micros_per_op(begin, benchmark_clock_t::now(), op_count);
+
+        begin = benchmark_clock_t::now();
+        for (int i = 0; i < op_count; ++i) {
+            const auto offset =
+                    generator.next(omega_session_get_computed_file_size(session_ptr) - read_length);
+            REQUIRE(read_length ==
+                    static_cast<int64_t>(omega_session_get_segment_string(session_ptr, offset, read_length).size()));
+        }
+        const auto read_us = micros_per_op(begin, benchmark_clock_t::now(), op_count);
+
+        std::cout << "  " << segment_count << " segments: insert " << insert_us << " us, read " << read_us
+                  << " us\n";
+        omega_edit_destroy_session(session_ptr);
+    }
+}
+
+TEST_CASE("Benchmark session open latency with eager and lazy snapshots", "[.][ModelBenchmark]") {
+    const auto file_size = benchmark_file_size();
+    const auto file_name_str = std::string(MAKE_PATH("open_benchmark.dat"));
+    write_benchmark_file(file_name_str, file_size);
+
+    std::cout << "\nSession open benchmark: " << file_size << " byte file\n";
+    for (const auto lazy_snapshot : {OMEGA_EDIT_FALSE, OMEGA_EDIT_TRUE}) {
+        omega_edit_session_options_t options{};
+        options.event_interest = NO_EVENTS;
+        options.lazy_snapshot = lazy_snapshot;
+        const auto begin = benchmark_clock_t::now();
+        auto *session_ptr = omega_edit_create_session_with_options(file_name_str.c_str(), &options);
+        REQUIRE(session_ptr);
+        const auto open_ms = std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+        REQUIRE(64 == static_cast<int64_t>(omega_session_get_segment_string(session_ptr, file_size / 2, 64).size()));
+        const auto read_ms = std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+        REQUIRE(0 == omega_session_wait_for_original_snapshot(session_ptr));
+        const auto snapshot_ms = std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+        std::cout << "  " << (lazy_snapshot ? "lazy" : "eager") << " snapshot: open " << open_ms
+                  << " ms, first read " << read_ms << " ms, snapshot ready " << snapshot_ms << " ms\n";
+        omega_edit_destroy_session(session_ptr);
+    }
+    omega_util_remove_file(file_name_str.c_str());
+}
+
+TEST_CASE("Benchmark saving a large file with a few patches", "[.][ModelBenchmark]") {
+    const auto file_size = benchmark_file_size();
+    const auto file_name_str = std::string(MAKE_PATH("save_benchmark.dat"));
+    const auto saved_file_name_str = std::string(MAKE_PATH("save_benchmark.out.dat"));
+    write_benchmark_file(file_name_str, file_size);
+    auto *session_ptr = omega_edit_create_session(file_name_str.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    offset_generator_t generator;
+    constexpr int patch_count = 16;
+    for (int i = 0; i < patch_count; ++i) {
+        REQUIRE(0 < omega_edit_overwrite_string(session_ptr, generator.next(file_size - 8), "patched!"));
+    }
+
+    // Unchanged ranges are copied within the kernel (or shared by a reflink) where the platform supports it
+    const auto begin = benchmark_clock_t::now();
+    REQUIRE(0 == omega_edit_save(session_ptr, saved_file_name_str.c_str(), IO_FLG_OVERWRITE, nullptr));
+    const auto save_ms = std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+    REQUIRE(file_size == omega_util_file_size(saved_file_name_str.c_str()));
+    std::cout << "\nSession save benchmark: " << file_size << " byte file, " << patch_count << " patches\n"
+              << "  save " << save_ms << " ms, "
+              << static_cast<double>(file_size) / (1024.0 * 1024.0) / (save_ms / 1000.0) << " MiB/s\n";
+    omega_edit_destroy_session(session_ptr);
+    omega_util_remove_file(saved_file_name_str.c_str());
+    omega_util_remove_file(file_name_str.c_str());
+}
+
+TEST_CASE("Benchmark applying an edit script", "[.][ModelBenchmark]") {
+    constexpr int64_t record_length = 64;
+    const auto *const replacement = reinterpret_cast<const omega_byte_t *>("pin");
+
+    std::cout << "\nEdit script benchmark: one replacement per " << record_length << " byte record\n";
+    for (const int op_count : {1000, 10000, 100000}) {
+        const std::string content(static_cast<size_t>(op_count * record_length), 'x');
+        std::vector<omega_edit_script_op_t> ops;
+        ops.reserve(op_count);
+        for (int64_t i = 0; i < op_count; ++i) {
+            // Each replacement removes three bytes, which moves the later records up
+            ops.push_back({i * (record_length - 3) + 10, 6, OMEGA_EDIT_SCRIPT_REPLACE, replacement, 3});
+        }
+
+        double script_ms = 0;
+        double stepped_ms = 0;
+        for (const auto is_stepped : {false, true}) {
+            auto *session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+            REQUIRE(session_ptr);
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, content));
+            const auto begin = benchmark_clock_t::now();
+            if (is_stepped) {
+                REQUIRE(0 == omega_session_begin_transaction(session_ptr));
+                for (const auto &op : ops) { REQUIRE(0 == omega_edit_apply_script(session_ptr, &op, 1)); }
+                REQUIRE(0 == omega_session_end_transaction(session_ptr));
+            } else {
+                REQUIRE(0 == omega_edit_apply_script(session_ptr, ops.data(), ops.size()));
+            }
+            const auto elapsed_ms =
+                    std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+            (is_stepped ? stepped_ms : script_ms) = elapsed_ms;
+            REQUIRE(op_count * (record_length - 3) == omega_session_get_computed_file_size(session_ptr));
+            omega_edit_destroy_session(session_ptr);
+        }
+        std::cout << "  " << op_count << " ops: script " << script_ms << " ms, op by op " << stepped_ms << " ms\n";
+    }
+}
@@ -0,0 +1,151 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "omega_edit.h"
+#include "omega_edit/stl_string_adaptor.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Count every allocation made through operator new, including those made inside the library, and track the bytes
+// that are live. Each block carries a small header recording its size so that frees can be accounted for.
+namespace {
+    constexpr size_t allocation_header_size = alignof(std::max_align_t);
+
+    std::atomic<int64_t> allocation_count{0};
+    std::atomic<int64_t> allocated_bytes{0};
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_live_bytes{0};
+
+    void *counted_allocate(size_t size) noexcept {
+        auto *block_ptr = static_cast<unsigned char *>(std::malloc(size + allocation_header_size));
+        if (!block_ptr) { return nullptr; }
+        *reinterpret_cast<size_t *>(block_ptr) = size;
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+        const auto live = live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) +
+                          static_cast<int64_t>(size);
+        auto peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+        return block_ptr + allocation_header_size;
+    }
+
+    void counted_free(void *ptr) noexcept {
+        if (!ptr) { return; }
+        auto *block_ptr = static_cast<unsigned char *>(ptr) - allocation_header_size;
+        live_bytes.fetch_sub(static_cast<int64_t>(*reinterpret_cast<size_t *>(block_ptr)), std::memory_order_relaxed);
+        std::free(block_ptr);
+    }
+
+    struct allocation_sample_t {
+        int64_t count;
+        int64_t bytes;
+        int64_t live;
+
+        static allocation_sample_t take() {
+            return {allocation_count.load(), allocated_bytes.load(), live_bytes.load()};
+        }
+    };
+
+    void reset_peak() { peak_live_bytes.store(live_bytes.load()); }
+
+    // Small deterministic generator so every run edits the same offsets
+    struct offset_generator_t {
+        uint64_t state{0x2545F4914F6CDD1DULL};
+
+        int64_t next(int64_t bound) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return bound > 0 ? static_cast<int64_t>(state % static_cast<uint64_t>(bound)) : 0;
+        }
+    };
+}// namespace
+
+void *operator new(size_t size) {
+    if (auto *ptr = counted_allocate(size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    if (auto *ptr = counted_allocate(size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return counted_allocate(size); }
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return counted_allocate(size); }
+
+void operator delete(void *ptr) noexcept { counted_free(ptr); }
+
+void operator delete[](void *ptr) noexcept { counted_free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { counted_free(ptr); }
+
+void operator delete[](void *ptr, size_t) noexcept { counted_free(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { counted_free(ptr); }
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { counted_free(ptr); }
+
+TEST_CASE("Benchmark model memory and allocations per edit by segment count", "[.][ModelMemoryBenchmark]") {
+    constexpr int edit_count = 1000;
+    constexpr int undo_count = 100;
+
+    std::cout << "\nModel memory benchmark: " << edit_count << " inserts and " << undo_count
+              << " undos per size (operator new only)\n";
+    for (const int segment_count : {1000, 10000, 100000}) {
+        auto *session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+        REQUIRE(session_ptr);
+        offset_generator_t generator;
+        for (int i = 0; i < segment_count; ++i) {
+            const auto offset = generator.next(omega_session_get_computed_file_size(session_ptr) + 1);
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, offset, "abcd"));
+        }
+
+        reset_peak();
+        const auto before_edits = allocation_sample_t::take();
+        int failed_edits = 0;
+        for (int i = 0; i < edit_count; ++i) {
+            const auto offset = generator.next(omega_session_get_computed_file_size(session_ptr) + 1);
+            if (0 >= omega_edit_insert_string(session_ptr, offset, "wxyz")) { ++failed_edits; }
+        }
+        const auto after_edits = allocation_sample_t::take();
+        const auto edit_peak = peak_live_bytes.load() - before_edits.live;
+
+        reset_peak();
+        int failed_undos = 0;
+        for (int i = 0; i < undo_count; ++i) {
+            if (0 <= omega_edit_undo_last_change(session_ptr)) { ++failed_undos; }
+        }
+        const auto after_undos = allocation_sample_t::take();
+        const auto undo_peak = peak_live_bytes.load() - after_edits.live;
+
+        REQUIRE(0 == failed_edits);
+        REQUIRE(0 == failed_undos);
+        std::cout << "  " << segment_count << " segments: " << (after_edits.count - before_edits.count) / edit_count
+                  << " allocations and " << (after_edits.bytes - before_edits.bytes) / edit_count
+                  << " bytes per edit, retained " << (after_edits.live - before_edits.live) / edit_count
+                  << " bytes per edit, peak growth " << edit_peak << " bytes; "
+                  << (after_undos.count - after_edits.count) / undo_count << " allocations per undo, peak growth "
+                  << undo_peak << " bytes\n";
+        omega_edit_destroy_session(session_ptr);
+    }
+}
@@ -28,12 +28,18 @@
 #include <catch2/matchers/catch_matchers_contains.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
 #include <sys/stat.h>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -118,6 +124,92 @@ TEST_CASE("Apply Script", "[EditScript]") {
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Apply Script in one pass matches applying its ops in turn", "[EditScript]") {
+    const auto bytes = [](const char *cstr) { return reinterpret_cast<const omega_byte_t *>(cstr); };
+    const string original = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    // Applies the script to one session and its ops one at a time to another, then compares the two histories
+    const auto check_script = [&](const vector<omega_edit_script_op_t> &ops, const string &expected) {
+        TestSession scripted(nullptr, nullptr, NO_EVENTS);
+        TestSession stepped(nullptr, nullptr, NO_EVENTS);
+        REQUIRE(scripted);
+        REQUIRE(stepped);
+        for (auto *session_ptr : {scripted.get(), stepped.get()}) {
+            REQUIRE(0 < omega_session_set_undo_snapshot_interval(session_ptr, 3));
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, original));
+        }
+
+        REQUIRE(0 == omega_edit_apply_script(scripted.get(), ops.data(), ops.size()));
+        REQUIRE(0 == omega_session_begin_transaction(stepped.get()));
+        for (const auto &op : ops) { REQUIRE(0 == omega_edit_apply_script(stepped.get(), &op, 1)); }
+        REQUIRE(0 == omega_session_end_transaction(stepped.get()));
+
+        REQUIRE(expected == content_string(scripted.get()));
+        REQUIRE(expected == content_string(stepped.get()));
+        REQUIRE(model_valid(scripted.get()));
+        REQUIRE(2 == omega_session_get_num_change_transactions(scripted.get()));
+        const auto num_changes = omega_session_get_num_changes(stepped.get());
+        REQUIRE(num_changes == omega_session_get_num_changes(scripted.get()));
+        REQUIRE(check_serials_contiguous(scripted.get()).contiguous);
+        for (int64_t serial = 1; serial <= num_changes; ++serial) {
+            const auto *expected_change = omega_session_get_change(stepped.get(), serial);
+            const auto *change = omega_session_get_change(scripted.get(), serial);
+            REQUIRE(change);
+            REQUIRE(omega_change_get_kind_as_char(expected_change) == omega_change_get_kind_as_char(change));
+            REQUIRE(omega_change_get_offset(expected_change) == omega_change_get_offset(change));
+            REQUIRE(omega_change_get_length(expected_change) == omega_change_get_length(change));
+            REQUIRE(omega_change_get_transaction_bit(expected_change) == omega_change_get_transaction_bit(change));
+            REQUIRE(omega_change_get_transaction_start_serial(expected_change) ==
+                    omega_change_get_transaction_start_serial(change));
+            REQUIRE(omega_change_get_string(expected_change) == omega_change_get_string(change));
+        }
+
+        const auto expected_round_trip = verify_undo_redo_round_trip(stepped.get());
+        const auto round_trip = verify_undo_redo_round_trip(scripted.get());
+        REQUIRE(round_trip.ok);
+        REQUIRE(round_trip.model_valid_throughout);
+        REQUIRE(expected_round_trip.trajectory == round_trip.trajectory);
+
+        // Undoing part of the script and editing again forks the history as usual
+        REQUIRE(0 > omega_edit_undo_last_change(scripted.get()));
+        REQUIRE(0 == omega_edit_apply_script(scripted.get(), ops.data(), ops.size()));
+        REQUIRE(expected == content_string(scripted.get()));
+        REQUIRE(0 == omega_session_get_num_undone_changes(scripted.get()));
+        REQUIRE(model_valid(scripted.get()));
+    };
+
+    SECTION("Ops moving forward") {
+        check_script({{0, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("<<"), 2},
+                      {2, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("["), 1},
+                      {5, 2, OMEGA_EDIT_SCRIPT_DELETE, nullptr, 0},
+                      {5, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("##"), 2},
+                      {10, 3, OMEGA_EDIT_SCRIPT_OVERWRITE, bytes("XYZ"), 3},
+                      {14, 4, OMEGA_EDIT_SCRIPT_REPLACE, bytes("r"), 1},
+                      {17, 2, OMEGA_EDIT_SCRIPT_REPLACE, bytes("RR"), 2},
+                      {36, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes(">>"), 2}},
+                     "<<[01##456XYZarfgRRjklmnopqrstuvwxyz>>");
+    }
+
+    SECTION("Ops moving backward") {
+        check_script({{36, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes(">>"), 2},
+                      {30, 6, OMEGA_EDIT_SCRIPT_DELETE, nullptr, 0},
+                      {30, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("++"), 2},
+                      {30, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("--"), 2},
+                      {20, 5, OMEGA_EDIT_SCRIPT_REPLACE, bytes("r"), 1},
+                      {10, 3, OMEGA_EDIT_SCRIPT_OVERWRITE, bytes("XYZ"), 3},
+                      {2, 3, OMEGA_EDIT_SCRIPT_REPLACE, bytes("abcdef"), 6},
+                      {0, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("<<"), 2}},
+                     "<<01abcdef56789XYZdefghijrpqrst--++>>");
+    }
+
+    SECTION("Ops in no single direction") {
+        check_script({{10, 0, OMEGA_EDIT_SCRIPT_INSERT, bytes("<"), 1},
+                      {2, 2, OMEGA_EDIT_SCRIPT_DELETE, nullptr, 0},
+                      {20, 1, OMEGA_EDIT_SCRIPT_OVERWRITE, bytes("!"), 1}},
+                     "01456789<abcdefghijk!mnopqrstuvwxyz");
+    }
+}
+
 TEST_CASE("Overwrite undo restores captured inverse bytes", "[UndoTests][PayloadTests]") {
     TestSession session(nullptr, nullptr, NO_EVENTS);
     REQUIRE(session);
@@ -221,6 +313,7 @@ TEST_CASE("Compressible file-backed delete payloads use bounded zstd blocks", "[
         const auto *change_ptr = omega_session_get_last_change(session.get());
         REQUIRE(change_ptr);
         REQUIRE(OMEGA_CHANGE_DATA_STORAGE_FILE_BACKED == omega_change_get_data_storage(change_ptr));
+        REQUIRE(0 == omega_session_wait_for_payload_compression(session.get()));
 
         std::vector<fs::path> payload_files;
         for (const auto &entry : fs::directory_iterator(checkpoint_scratch.str())) {
@@ -242,6 +335,111 @@ TEST_CASE("Compressible file-backed delete payloads use bounded zstd blocks", "[
     }
 }
 
+TEST_CASE("File-backed payloads are compressed in the background", "[UndoTests][PayloadTests]") {
+    const ScratchDir data_scratch;
+    const ScratchDir checkpoint_scratch;
+    const auto file_path = (fs::path(data_scratch.str()) / "background-payloads.dat").string();
+    constexpr int64_t byte_count = 4 * 1024 * 1024;
+    std::string content(static_cast<size_t>(byte_count), '\0');
+    // The first half repeats a short pattern, the second half is noise that zstd can't shrink
+    uint32_t state = 12345;
+    for (int64_t i = 0; i < byte_count; ++i) {
+        state = state * 1103515245U + 12345U;
+        content[static_cast<size_t>(i)] = i < byte_count / 2 ? "OmegaEdit"[i % 9] : static_cast<char>(state >> 24);
+    }
+    std::ofstream(file_path, std::ios::binary).write(content.data(), byte_count);
+
+    DirAudit audit(checkpoint_scratch.str());
+    {
+        TestSession session(file_path.c_str(), checkpoint_scratch.c_str(), NO_EVENTS);
+        REQUIRE(session);
+        REQUIRE(1 == omega_session_set_change_inline_payload_limit(session.get(), 1));
+        REQUIRE(0 < omega_edit_delete(session.get(), byte_count / 2, byte_count / 2));
+        REQUIRE(0 < omega_edit_delete(session.get(), 0, byte_count / 2));
+
+        // Payloads read the same whether or not their compression has finished
+        const auto *noise_bytes = omega_change_get_bytes(omega_session_get_change(session.get(), 1));
+        REQUIRE(noise_bytes);
+        REQUIRE(0 == std::memcmp(noise_bytes, content.data() + byte_count / 2, byte_count / 2));
+        REQUIRE(-2 == omega_edit_undo_last_change(session.get()));
+        REQUIRE(content.substr(0, 4096) == content_string(session.get()).substr(0, 4096));
+        REQUIRE(0 == omega_session_wait_for_payload_compression(session.get()));
+        REQUIRE(0 == omega_session_wait_for_payload_compression(session.get()));
+
+        std::vector<uintmax_t> payload_sizes;
+        for (const auto &entry : fs::directory_iterator(checkpoint_scratch.str())) {
+            REQUIRE(entry.path().extension() != ".tmp");
+            if (entry.is_regular_file() && entry.path().filename().string().find("-payload.") != std::string::npos) {
+                payload_sizes.push_back(fs::file_size(entry.path()));
+            }
+        }
+        std::sort(payload_sizes.begin(), payload_sizes.end());
+        REQUIRE(payload_sizes.size() == 2);
+        REQUIRE(payload_sizes.front() < static_cast<uintmax_t>(byte_count / 100));
+        REQUIRE(payload_sizes.back() == static_cast<uintmax_t>(byte_count / 2));
+        REQUIRE(content == content_string(session.get()) + content.substr(byte_count / 2));
+        REQUIRE(-1 == omega_edit_undo_last_change(session.get()));
+        REQUIRE(content == content_string(session.get()));
+        REQUIRE(model_valid(session.get()));
+
+        // Sessions can end while their payloads are still being compressed
+        REQUIRE(0 < omega_edit_delete(session.get(), 0, byte_count));
+    }
+    REQUIRE(-1 == omega_session_wait_for_payload_compression(nullptr));
+}
+
+TEST_CASE("Reads of compressed payloads reuse decoded blocks", "[UndoTests][PayloadTests]") {
+    const ScratchDir data_scratch;
+    const ScratchDir checkpoint_scratch;
+    const auto file_path = (fs::path(data_scratch.str()) / "cached-delete-payload.dat").string();
+    constexpr int64_t byte_count = 3 * 1024 * 1024 + 17;
+    auto *file_ptr = fill_file(file_path.c_str(), byte_count, "0123456789", 10);
+    REQUIRE(file_ptr);
+    FCLOSE(file_ptr);
+
+    TestSession session(file_path.c_str(), checkpoint_scratch.c_str(), NO_EVENTS);
+    REQUIRE(session);
+    REQUIRE(OMEGA_PAYLOAD_CACHE_LIMIT == omega_session_get_payload_cache_limit(session.get()));
+    REQUIRE(1 == omega_session_set_change_inline_payload_limit(session.get(), 1));
+    REQUIRE(0 < omega_edit_delete(session.get(), 0, byte_count));
+    REQUIRE(0 == omega_session_wait_for_payload_compression(session.get()));
+
+    // Undoing the delete reads the file content back from the compressed payload of the deleted bytes
+    REQUIRE(0 > omega_edit_undo_last_change(session.get()));
+    const auto check_viewport = [&](omega_viewport_t *viewport_ptr, int64_t offset) {
+        REQUIRE(0 == omega_viewport_modify(viewport_ptr, offset, 64, 0));
+        const auto *data = omega_viewport_get_data(viewport_ptr);
+        REQUIRE(64 == omega_viewport_get_length(viewport_ptr));
+        for (int64_t i = 0; i < 64; ++i) { REQUIRE(data[i] == static_cast<omega_byte_t>('0' + (offset + i) % 10)); }
+    };
+    auto *viewport_ptr = omega_edit_create_viewport(session.get(), 0, 64, 0, nullptr, nullptr, NO_EVENTS);
+    REQUIRE(viewport_ptr);
+
+    // A viewport straddling the first two blocks decodes each once, then scrolling within them hits the cache
+    check_viewport(viewport_ptr, 1024 * 1024 - 32);
+    const auto misses = omega_session_get_payload_cache_misses(session.get());
+    REQUIRE(0 < misses);
+    REQUIRE(0 < omega_session_get_payload_cache_bytes(session.get()));
+    const auto hits = omega_session_get_payload_cache_hits(session.get());
+    for (int64_t offset = 1024 * 1024 - 48; offset < 1024 * 1024 + 16; offset += 8) {
+        check_viewport(viewport_ptr, offset);
+    }
+    REQUIRE(misses == omega_session_get_payload_cache_misses(session.get()));
+    REQUIRE(hits < omega_session_get_payload_cache_hits(session.get()));
+    check_viewport(viewport_ptr, byte_count - 64);
+    REQUIRE(misses < omega_session_get_payload_cache_misses(session.get()));
+
+    // Without a budget nothing stays cached, and every read decodes again
+    REQUIRE(0 == omega_session_set_payload_cache_limit(session.get(), 0));
+    REQUIRE(0 == omega_session_get_payload_cache_bytes(session.get()));
+    const auto uncached_misses = omega_session_get_payload_cache_misses(session.get());
+    check_viewport(viewport_ptr, 100);
+    check_viewport(viewport_ptr, 200);
+    REQUIRE(uncached_misses + 2 == omega_session_get_payload_cache_misses(session.get()));
+    REQUIRE(0 == omega_session_get_payload_cache_bytes(session.get()));
+    REQUIRE(model_valid(session.get()));
+}
+
 TEST_CASE("Large overwrite inverse payloads are file backed", "[UndoTests][PayloadTests]") {
     const ScratchDir data_scratch;
     const ScratchDir checkpoint_scratch;
@@ -347,6 +545,45 @@ TEST_CASE("Apply Builtin Transform", "[EditTransform]") {
     REQUIRE(audit.unchanged());
 }
 
+TEST_CASE("Apply Table Transform", "[EditTransform]") {
+    const ScratchDir scratch;
+    DirAudit audit(scratch.str());
+    {
+        TestSession session(nullptr, scratch.c_str());
+        REQUIRE(session);
+        auto *session_ptr = session.get();
+
+        REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "Abc xyz 09!"));
+        omega_byte_t rot13[256];
+        omega_util_fill_byte_table(
+                rot13,
+                [](omega_byte_t byte, void *) -> omega_byte_t {
+                    if (byte >= 'a' && byte <= 'z') { return static_cast<omega_byte_t>('a' + (byte - 'a' + 13) % 26); }
+                    if (byte >= 'A' && byte <= 'Z') { return static_cast<omega_byte_t>('A' + (byte - 'A' + 13) % 26); }
+                    return byte;
+                },
+                nullptr);
+        REQUIRE(0 == omega_edit_apply_table_transform(session_ptr, rot13, 0, 7));
+        REQUIRE("Nop klm 09!" == content_string(session_ptr));
+        REQUIRE(model_valid(session_ptr));
+        const auto change_ptr = omega_session_get_last_change(session_ptr);
+        REQUIRE(change_ptr);
+        REQUIRE('T' == omega_change_get_kind_as_char(change_ptr));
+        REQUIRE(std::string("table") == omega_change_get_transform_id(change_ptr));
+        REQUIRE(7 == omega_change_get_length(change_ptr));
+
+        REQUIRE(0 == omega_edit_apply_table_transform(session_ptr, rot13, 0, 0));
+        REQUIRE("Abc xyz 09!" == content_string(session_ptr));
+        REQUIRE(-3 == omega_edit_undo_last_change(session_ptr));
+        REQUIRE("Nop klm 09!" == content_string(session_ptr));
+        REQUIRE(model_valid(session_ptr));
+
+        REQUIRE(-1 == omega_edit_apply_table_transform(session_ptr, nullptr, 0, 0));
+        REQUIRE(-1 == omega_edit_apply_table_transform(nullptr, rot13, 0, 0));
+    }
+    REQUIRE(audit.unchanged());
+}
+
 TEST_CASE("A transform after undo discards the abandoned transform redo branch", "[EditTransform][UndoTests]") {
     const ScratchDir scratch;
     DirAudit audit(scratch.str());
@@ -1298,6 +1535,709 @@ TEST_CASE("Search-Reverse", "[SearchTests]") {
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Search-Bounded", "[SearchTests]") {
+    const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "aaaa needle aaneedleneedle aa needle a"));
+
+    // Steps a search with the given scan limit to the end, counting the steps that reached the limit
+    const auto collect = [&](const char *pattern, int is_reverse, int64_t scan_length, int64_t &limited_steps) {
+        auto *search_context_ptr = omega_search_create_context(session_ptr, pattern, 0, 0, 0,
+                                                               OMEGA_SEARCH_CASE_FOLDING_NONE, is_reverse);
+        REQUIRE(search_context_ptr);
+        std::vector<int64_t> offsets;
+        limited_steps = 0;
+        int rc;
+        while ((rc = omega_search_next_match_bounded(search_context_ptr, 1, scan_length)) > 0) {
+            if (rc == 2) {
+                ++limited_steps;
+            } else {
+                offsets.push_back(omega_search_context_get_match_offset(search_context_ptr));
+            }
+        }
+        REQUIRE(0 == rc);
+        REQUIRE(omega_search_context_get_session_offset(search_context_ptr) == 0);
+        REQUIRE(omega_search_context_get_session_length(search_context_ptr) ==
+                omega_session_get_computed_file_size(session_ptr));
+        omega_search_destroy_context(search_context_ptr);
+        return offsets;
+    };
+
+    // Bounded searches find the same matches as unbounded ones, in both directions
+    int64_t limited_steps = 0;
+    for (const auto *pattern : {"needle", "a", "aa"}) {
+        for (const auto is_reverse : {0, 1}) {
+            const auto expected = collect(pattern, is_reverse, 0, limited_steps);
+            REQUIRE(0 == limited_steps);
+            REQUIRE(!expected.empty());
+            for (const int64_t scan_length : {1, 2, 3, 7, 1000}) {
+                REQUIRE(collect(pattern, is_reverse, scan_length, limited_steps) == expected);
+                if (scan_length == 1) { REQUIRE(0 < limited_steps); }
+                if (scan_length == 1000) { REQUIRE(0 == limited_steps); }
+            }
+        }
+    }
+    REQUIRE(collect("needle", 0, 0, limited_steps) == std::vector<int64_t>{5, 14, 20, 30});
+    REQUIRE(collect("needle", 1, 0, limited_steps) == std::vector<int64_t>{30, 20, 14, 5});
+
+    // After reaching its limit, a search continues where it stopped even if the next call is unbounded
+    auto *search_context_ptr = omega_search_create_context(session_ptr, "needle", 0, 0, 0,
+                                                           OMEGA_SEARCH_CASE_FOLDING_NONE, 0);
+    REQUIRE(search_context_ptr);
+    REQUIRE(2 == omega_search_next_match_bounded(search_context_ptr, 1, 5));
+    REQUIRE(1 == omega_search_next_match_bounded(search_context_ptr, 1, 1));
+    REQUIRE(5 == omega_search_context_get_match_offset(search_context_ptr));
+    REQUIRE(2 == omega_search_next_match_bounded(search_context_ptr, 1, 8));
+    REQUIRE(1 == omega_search_next_match(search_context_ptr, 1));
+    REQUIRE(14 == omega_search_context_get_match_offset(search_context_ptr));
+    REQUIRE(0 == omega_search_next_match_bounded(search_context_ptr, 1, -1));
+    omega_search_destroy_context(search_context_ptr);
+    omega_edit_destroy_session(session_ptr);
+}
+
+
+TEST_CASE("Search-Multi-Pattern", "[SearchTests]") {
+    const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    const std::string text = "The pursuit of happiness is a fundamental human goal. The pursuit of knowledge is "
+                             "equally important. It is through the pursuit of our passions that we truly live.";
+    omega_edit_insert_string(session_ptr, 0, text);
+    const std::vector<std::string> patterns = {"PURSUIT OF", "the", "of", "suit", "the", "pursuit"};
+    std::vector<const omega_byte_t *> pattern_ptrs;
+    std::vector<int64_t> pattern_lengths;
+    for (const auto &pattern : patterns) {
+        pattern_ptrs.push_back(reinterpret_cast<const omega_byte_t *>(pattern.data()));
+        pattern_lengths.push_back(static_cast<int64_t>(pattern.size()));
+    }
+    const auto collect = [&](int64_t offset, int64_t length, omega_search_case_folding_t case_folding) {
+        auto *search_context_ptr =
+                omega_search_create_multi_context(session_ptr, pattern_ptrs.data(), pattern_lengths.data(),
+                                                  static_cast<int64_t>(patterns.size()), offset, length, case_folding);
+        REQUIRE(search_context_ptr);
+        REQUIRE(1 == omega_session_get_num_search_contexts(session_ptr));
+        REQUIRE(static_cast<int64_t>(patterns.size()) ==
+                omega_search_multi_context_get_pattern_count(search_context_ptr));
+        std::vector<std::pair<int64_t, int64_t>> matches;
+        while (omega_search_next_multi_match(search_context_ptr) > 0) {
+            matches.emplace_back(omega_search_multi_context_get_match_offset(search_context_ptr),
+                                 omega_search_multi_context_get_match_pattern_id(search_context_ptr));
+        }
+        REQUIRE(-1 == omega_search_multi_context_get_match_pattern_id(search_context_ptr));
+        omega_search_destroy_multi_context(search_context_ptr);
+        REQUIRE(0 == omega_session_get_num_search_contexts(session_ptr));
+        return matches;
+    };
+    // Every (offset, pattern) occurrence, in the order the matches end and then longest pattern first
+    const auto expected = [&](int64_t offset, int64_t length, bool fold) {
+        const auto lower = [fold](char c) { return fold ? static_cast<char>(std::tolower(c)) : c; };
+        std::vector<std::tuple<int64_t, int64_t, int64_t>> occurrences;
+        for (int64_t id = 0; id < static_cast<int64_t>(patterns.size()); ++id) {
+            const auto &pattern = patterns[static_cast<size_t>(id)];
+            const auto pattern_length = static_cast<int64_t>(pattern.size());
+            for (auto position = offset; position + pattern_length <= offset + length; ++position) {
+                if (std::equal(pattern.begin(), pattern.end(), text.begin() + position,
+                               [&](char a, char b) { return lower(a) == lower(b); })) {
+                    occurrences.emplace_back(position + pattern_length, -pattern_length, id);
+                }
+            }
+        }
+        std::sort(occurrences.begin(), occurrences.end());
+        std::vector<std::pair<int64_t, int64_t>> matches;
+        for (const auto &[end, negative_length, id] : occurrences) { matches.emplace_back(end + negative_length, id); }
+        return matches;
+    };
+    const auto text_length = static_cast<int64_t>(text.size());
+    REQUIRE(expected(0, text_length, true) == collect(0, 0, OMEGA_SEARCH_CASE_FOLDING_ASCII));
+    REQUIRE(expected(0, text_length, false) == collect(0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE));
+    REQUIRE(expected(10, 60, true) == collect(10, 60, OMEGA_SEARCH_CASE_FOLDING_ASCII));
+    const auto folded_matches = collect(0, 0, OMEGA_SEARCH_CASE_FOLDING_ASCII);
+    REQUIRE(folded_matches.size() > 3);
+    REQUIRE(std::make_pair(int64_t{0}, int64_t{1}) == folded_matches[0]);
+    REQUIRE(std::make_pair(int64_t{0}, int64_t{4}) == folded_matches[1]);
+    REQUIRE(std::make_pair(int64_t{4}, int64_t{5}) == folded_matches[2]);
+    REQUIRE(std::make_pair(int64_t{7}, int64_t{3}) == folded_matches[3]);
+
+    // Invalid patterns are rejected
+    const int64_t empty_length = 0;
+    REQUIRE(nullptr == omega_search_create_multi_context(session_ptr, pattern_ptrs.data(), &empty_length, 1, 0, 0,
+                                                         OMEGA_SEARCH_CASE_FOLDING_NONE));
+    REQUIRE(nullptr == omega_search_create_multi_context(session_ptr, pattern_ptrs.data(), pattern_lengths.data(), 0, 0,
+                                                         0, OMEGA_SEARCH_CASE_FOLDING_NONE));
+
+    // Pattern sets beyond the configured count or total length limits are rejected
+    const std::vector<const omega_byte_t *> many_pattern_ptrs(OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT + 1,
+                                                              pattern_ptrs[0]);
+    const std::vector<int64_t> many_pattern_lengths(many_pattern_ptrs.size(), 1);
+    REQUIRE(nullptr == omega_search_create_multi_context(session_ptr, many_pattern_ptrs.data(),
+                                                         many_pattern_lengths.data(),
+                                                         static_cast<int64_t>(many_pattern_ptrs.size()), 0, 0,
+                                                         OMEGA_SEARCH_CASE_FOLDING_NONE));
+    const std::string long_pattern(OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT / 4, 'x');
+    const auto *long_pattern_ptr = reinterpret_cast<const omega_byte_t *>(long_pattern.data());
+    const auto long_pattern_length = static_cast<int64_t>(long_pattern.size());
+    const omega_byte_t *long_pattern_ptrs[] = {long_pattern_ptr, long_pattern_ptr, long_pattern_ptr, long_pattern_ptr,
+                                               long_pattern_ptr};
+    const int64_t long_pattern_lengths[] = {long_pattern_length, long_pattern_length, long_pattern_length,
+                                            long_pattern_length, 1};
+    REQUIRE(nullptr == omega_search_create_multi_context(session_ptr, long_pattern_ptrs, long_pattern_lengths, 5, 0, 0,
+                                                         OMEGA_SEARCH_CASE_FOLDING_NONE));
+
+    // The automaton state carries across the windows read from the session
+    const std::string needle = "needle";
+    const auto window_boundary = static_cast<int64_t>(OMEGA_SEARCH_PATTERN_LENGTH_LIMIT) << 1;
+    omega_edit_insert_string(session_ptr, 0, std::string(static_cast<size_t>(window_boundary) - 3, 'x') + needle);
+    const omega_byte_t *needle_ptr = reinterpret_cast<const omega_byte_t *>(needle.data());
+    const auto needle_length = static_cast<int64_t>(needle.size());
+    auto *search_context_ptr = omega_search_create_multi_context(session_ptr, &needle_ptr, &needle_length, 1, 0, 0,
+                                                                 OMEGA_SEARCH_CASE_FOLDING_NONE);
+    REQUIRE(search_context_ptr);
+    auto *single_context_ptr =
+            omega_search_create_context(session_ptr, "needle", 0, 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0);
+    REQUIRE(single_context_ptr);
+    REQUIRE(2 == omega_session_get_num_search_contexts(session_ptr));
+    omega_search_destroy_context(single_context_ptr);
+    REQUIRE(1 == omega_session_get_num_search_contexts(session_ptr));
+    REQUIRE(1 == omega_search_next_multi_match(search_context_ptr));
+    REQUIRE(window_boundary - 3 == omega_search_multi_context_get_match_offset(search_context_ptr));
+    REQUIRE(0 == omega_search_multi_context_get_match_pattern_id(search_context_ptr));
+    REQUIRE(0 == omega_search_next_multi_match(search_context_ptr));
+
+    // Contexts still open are destroyed with the session
+    omega_edit_destroy_session(session_ptr);
+}
+TEST_CASE("Search-Find-All", "[SearchTests]") {
+    const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    // Spans several parallel search chunks, with needles straddling the chunk boundaries
+    const auto chunk_length = static_cast<int64_t>(OMEGA_SEARCH_PARALLEL_CHUNK_LENGTH);
+    std::string text(static_cast<size_t>(chunk_length * 2 + chunk_length / 2), '.');
+    for (const auto position : {int64_t{0}, int64_t{100}}) { text.replace(static_cast<size_t>(position), 6, "NeedLe"); }
+    for (const auto position : {chunk_length - 3, chunk_length * 2 - 1, static_cast<int64_t>(text.size()) - 6}) {
+        text.replace(static_cast<size_t>(position), 6, "needle");
+    }
+    text.replace(static_cast<size_t>(chunk_length + 10), 5, "aaaaa");
+    omega_edit_insert_string(session_ptr, 0, text);
+    const auto text_length = static_cast<int64_t>(text.size());
+    REQUIRE(text_length == omega_session_get_computed_file_size(session_ptr));
+
+    // Every (possibly overlapping) occurrence of the pattern in the given range
+    const auto expected = [&](const std::string &pattern, int64_t offset, int64_t length, bool fold) {
+        const auto lower = [fold](char c) { return fold ? static_cast<char>(std::tolower(c)) : c; };
+        std::vector<int64_t> offsets;
+        const auto pattern_length = static_cast<int64_t>(pattern.size());
+        for (auto position = offset; position + pattern_length <= offset + length; ++position) {
+            if (std::equal(pattern.begin(), pattern.end(), text.begin() + position,
+                           [&](char a, char b) { return lower(a) == lower(b); })) {
+                offsets.push_back(position);
+            }
+        }
+        return offsets;
+    };
+    struct collector_t {
+        std::vector<int64_t> offsets;
+        int64_t callback_count = 0;
+        int64_t cancel_after = 0;
+    };
+    const auto collect_cbk = [](const int64_t *match_offsets, int64_t match_count, void *user_data_ptr) -> int {
+        auto &collector = *static_cast<collector_t *>(user_data_ptr);
+        collector.offsets.insert(collector.offsets.end(), match_offsets, match_offsets + match_count);
+        return ++collector.callback_count == collector.cancel_after ? 1 : 0;
+    };
+    const auto find_all = [&](const std::string &pattern, int64_t offset, int64_t length,
+                              omega_search_case_folding_t case_folding, int64_t limit, int thread_count,
+                              collector_t &collector) {
+        return omega_search_find_all(session_ptr, reinterpret_cast<const omega_byte_t *>(pattern.data()),
+                                     static_cast<int64_t>(pattern.size()), offset, length, case_folding, limit,
+                                     thread_count, collect_cbk, &collector);
+    };
+
+    for (const int thread_count : {0, 1, 2, 3, 8}) {
+        collector_t collector;
+        REQUIRE(2 == find_all("NeedLe", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, thread_count, collector));
+        REQUIRE(expected("NeedLe", 0, text_length, false) == collector.offsets);
+        REQUIRE(3 == collector.callback_count);
+
+        collector = {};
+        REQUIRE(5 == find_all("needle", 0, 0, OMEGA_SEARCH_CASE_FOLDING_ASCII, 0, thread_count, collector));
+        REQUIRE(expected("needle", 0, text_length, true) == collector.offsets);
+
+        // Overlapping matches are all reported
+        collector = {};
+        REQUIRE(4 == find_all("aa", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, thread_count, collector));
+        REQUIRE(expected("aa", 0, text_length, false) == collector.offsets);
+
+        // A range that starts and ends mid-chunk
+        collector = {};
+        const auto offset = chunk_length - 3;
+        const auto length = chunk_length + 8;
+        REQUIRE(2 == find_all("needle", offset, length, OMEGA_SEARCH_CASE_FOLDING_ASCII, 0, thread_count, collector));
+        REQUIRE(expected("needle", offset, length, true) == collector.offsets);
+
+        // The limit truncates the results
+        collector = {};
+        REQUIRE(3 == find_all("needle", 0, 0, OMEGA_SEARCH_CASE_FOLDING_ASCII, 3, thread_count, collector));
+        auto limited = expected("needle", 0, text_length, true);
+        limited.resize(3);
+        REQUIRE(limited == collector.offsets);
+
+        // A non-zero callback return cancels the search
+        collector = {};
+        collector.cancel_after = 1;
+        REQUIRE(3 == find_all("needle", 0, 0, OMEGA_SEARCH_CASE_FOLDING_ASCII, 0, thread_count, collector));
+        REQUIRE(1 == collector.callback_count);
+
+        // Patterns that aren't there are reported as empty chunks
+        collector = {};
+        REQUIRE(0 == find_all("haystack", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, thread_count, collector));
+        REQUIRE(collector.offsets.empty());
+        REQUIRE(3 == collector.callback_count);
+    }
+
+    // Invalid arguments are rejected
+    collector_t collector;
+    const auto *pattern = reinterpret_cast<const omega_byte_t *>("needle");
+    REQUIRE(-1 == omega_search_find_all(session_ptr, pattern, 6, 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, 0, nullptr,
+                                        nullptr));
+    REQUIRE(-1 == find_all("needle", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, -1, 0, collector));
+    REQUIRE(-1 == find_all("needle", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, -1, collector));
+    REQUIRE(-1 == find_all("", 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, 0, collector));
+    REQUIRE(-1 == find_all("needle", text_length, 1, OMEGA_SEARCH_CASE_FOLDING_NONE, 0, 0, collector));
+    REQUIRE(0 == collector.callback_count);
+    omega_edit_destroy_session(session_ptr);
+}
+TEST_CASE("Search-Pattern", "[SearchTests]") {
+    const auto session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    std::string text("xxMZ");
+    text += std::string(58, '\xEE') + std::string("PE\0\0", 4) + "yy Needle needles NEEDLE 12345 aab";
+    omega_edit_insert_bytes(session_ptr, 0, reinterpret_cast<const omega_byte_t *>(text.data()),
+                            static_cast<int64_t>(text.size()));
+    // All the (offset, length) matches of the pattern, moving past each match
+    const auto collect = [&](const std::string &pattern, omega_search_pattern_syntax_t syntax,
+                             omega_search_case_folding_t case_folding, int64_t offset = 0, int64_t length = 0) {
+        auto *search_context_ptr = omega_search_create_pattern_context(
+                session_ptr, reinterpret_cast<const omega_byte_t *>(pattern.data()),
+                static_cast<int64_t>(pattern.size()), syntax, offset, length, case_folding);
+        REQUIRE(search_context_ptr);
+        REQUIRE(0 == omega_search_context_is_reverse_search(search_context_ptr));
+        std::vector<std::pair<int64_t, int64_t>> matches;
+        int64_t advance = 0;
+        while (omega_search_next_match(search_context_ptr, advance) > 0) {
+            advance = omega_search_context_get_match_length(search_context_ptr);
+            matches.emplace_back(omega_search_context_get_match_offset(search_context_ptr), advance);
+        }
+        REQUIRE(0 == omega_search_context_get_match_length(search_context_ptr));
+        omega_search_destroy_context(search_context_ptr);
+        return matches;
+    };
+    using matches_t = std::vector<std::pair<int64_t, int64_t>>;
+    const auto regex = OMEGA_SEARCH_PATTERN_SYNTAX_REGEX;
+    const auto hex_mask = OMEGA_SEARCH_PATTERN_SYNTAX_HEX_MASK;
+    const auto none = OMEGA_SEARCH_CASE_FOLDING_NONE;
+    const auto ascii = OMEGA_SEARCH_CASE_FOLDING_ASCII;
+    const auto needle_offset = static_cast<int64_t>(text.find("Needle"));
+    const auto digits_offset = static_cast<int64_t>(text.find("12345"));
+
+    REQUIRE(matches_t{{2, 64}} == collect(R"(MZ.{58}PE\0\x00)", regex, none));
+    std::string mask = "4d5a";
+    for (int i = 0; i < 58; ++i) { mask += " ??"; }
+    REQUIRE(matches_t{{2, 64}} == collect(mask + "50 45 0? ?0", hex_mask, none));
+    REQUIRE(matches_t{{digits_offset, 5}} == collect(R"(\d+)", regex, none));
+    REQUIRE(matches_t{{digits_offset + 1, 3}} == collect("[2-4]{1,3}", regex, none));
+    REQUIRE(matches_t{{needle_offset, 6}, {needle_offset + 7, 7}} == collect("[Nn]eedles?", regex, none));
+    REQUIRE(3 == collect("needle", regex, ascii).size());
+    REQUIRE(matches_t{{needle_offset, 6}, {needle_offset + 7, 7}, {needle_offset + 15, 6}} ==
+            collect("needle(s|)", regex, ascii));
+    REQUIRE(matches_t{{needle_offset + 7, 6}} == collect("n(ee|x)dle", regex, none));
+    // Leftmost, then longest: "aab" is found rather than "ab" or "a"
+    REQUIRE(matches_t{{static_cast<int64_t>(text.size()) - 3, 3}} == collect("a|ab|a+b", regex, none));
+    // Searching a subrange
+    REQUIRE(matches_t{{needle_offset + 7, 6}} == collect("needle", regex, none, needle_offset + 1, 15));
+
+    // Malformed patterns, patterns matching an empty sequence, and overly long patterns are rejected
+    const auto is_rejected = [&](const std::string &pattern, omega_search_pattern_syntax_t syntax) {
+        return nullptr == omega_search_create_pattern_context(session_ptr,
+                                                              reinterpret_cast<const omega_byte_t *>(pattern.data()),
+                                                              static_cast<int64_t>(pattern.size()), syntax, 0, 0, none);
+    };
+    for (const std::string pattern :
+         {"", "(", "a)", "*a", "a{2,1}", "a{1001}", "[a", "a*", "(a|)", "\\q", "^a", "\\x4"}) {
+        REQUIRE(is_rejected(pattern, regex));
+    }
+    for (const std::string pattern : {"4", "4G", "?"}) { REQUIRE(is_rejected(pattern, hex_mask)); }
+    REQUIRE(is_rejected("(x{1000}|y){1000}", regex));
+    REQUIRE(0 == omega_session_get_num_search_contexts(session_ptr));
+
+    // Agree with a reference matcher on random patterns over a small alphabet.  The reference computes the set of
+    // offsets where each subpattern can end, given where it starts.
+    uint32_t random_state = 12345;
+    const auto random = [&random_state](uint32_t bound) {
+        random_state = random_state * 1664525U + 1013904223U;
+        return (random_state >> 8) % bound;
+    };
+    std::string haystack;
+    for (int i = 0; i < 120; ++i) { haystack += "abc"[random(3)]; }
+    using ends_t = std::function<std::set<size_t>(size_t)>;
+    const auto bytes_ends = [&haystack](const std::string &bytes) -> ends_t {
+        return [&haystack, bytes](size_t start) {
+            if (start < haystack.size() && bytes.find(haystack[start]) != std::string::npos) {
+                return std::set<size_t>{start + 1};
+            }
+            return std::set<size_t>{};
+        };
+    };
+    const auto concat_ends = [](const ends_t &first, const ends_t &second) -> ends_t {
+        return [first, second](size_t start) {
+            std::set<size_t> ends;
+            for (const auto middle : first(start)) {
+                const auto second_ends = second(middle);
+                ends.insert(second_ends.begin(), second_ends.end());
+            }
+            return ends;
+        };
+    };
+    const auto repeat_ends = [](const ends_t &child, size_t min, size_t max) -> ends_t {
+        return [child, min, max](size_t start) {
+            std::set<size_t> ends;
+            std::set<size_t> current{start};
+            if (min == 0) { ends.insert(start); }
+            for (size_t count = 1; count <= max && !current.empty(); ++count) {
+                std::set<size_t> next;
+                for (const auto middle : current) {
+                    const auto child_ends = child(middle);
+                    next.insert(child_ends.begin(), child_ends.end());
+                }
+                if (min <= count) {
+                    // Past the minimum, only ends not reached before lead anywhere new
+                    for (auto iter = next.begin(); iter != next.end();) {
+                        iter = ends.insert(*iter).second || count == min ? std::next(iter) : next.erase(iter);
+                    }
+                }
+                current = std::move(next);
+            }
+            return ends;
+        };
+    };
+    const auto memoized_ends = [](const ends_t &ends) -> ends_t {
+        return [ends, memo = std::make_shared<std::map<size_t, std::set<size_t>>>()](size_t start) {
+            const auto iter = memo->find(start);
+            return iter != memo->end() ? iter->second : (*memo)[start] = ends(start);
+        };
+    };
+    const std::function<std::pair<std::string, ends_t>(int)> random_pattern = [&](int depth) {
+        std::string pattern;
+        ends_t ends = [](size_t start) { return std::set<size_t>{start}; };
+        const auto term_count = 1 + random(3);
+        for (uint32_t i = 0; i < term_count; ++i) {
+            std::string term;
+            ends_t term_ends;
+            switch (depth < 2 ? random(6) : random(3)) {
+                case 0:
+                    term = std::string(1, "abc"[random(3)]);
+                    term_ends = bytes_ends(term);
+                    break;
+                case 1:
+                    term = ".";
+                    term_ends = bytes_ends("abc");
+                    break;
+                case 2:
+                    term = random(2) ? "[ab]" : "[^a]";
+                    term_ends = bytes_ends(term == "[ab]" ? "ab" : "bc");
+                    break;
+                case 3: {
+                    const auto [first, first_ends] = random_pattern(depth + 1);
+                    const auto [second, second_ends] = random_pattern(depth + 1);
+                    term = "(" + first + "|" + second + ")";
+                    term_ends = [first_ends = first_ends, second_ends = second_ends](size_t start) {
+                        auto alternate_ends = first_ends(start);
+                        const auto more_ends = second_ends(start);
+                        alternate_ends.insert(more_ends.begin(), more_ends.end());
+                        return alternate_ends;
+                    };
+                    break;
+                }
+                default: {
+                    const auto [group, group_ends] = random_pattern(depth + 1);
+                    term = "(" + group + ")";
+                    term_ends = group_ends;
+                    break;
+                }
+            }
+            switch (random(8)) {
+                case 0:
+                    term += "*";
+                    term_ends = repeat_ends(term_ends, 0, SIZE_MAX);
+                    break;
+                case 1:
+                    term += "+";
+                    term_ends = repeat_ends(term_ends, 1, SIZE_MAX);
+                    break;
+                case 2:
+                    term += "?";
+                    term_ends = repeat_ends(term_ends, 0, 1);
+                    break;
+                case 3:
+                    term += "{1,3}";
+                    term_ends = repeat_ends(term_ends, 1, 3);
+                    break;
+                default:
+                    break;
+            }
+            pattern += term;
+            ends = concat_ends(ends, memoized_ends(term_ends));
+        }
+        return std::make_pair(pattern, memoized_ends(ends));
+    };
+    const auto haystack_session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    omega_edit_insert_string(haystack_session_ptr, 0, haystack);
+    int compared_count = 0;
+    for (int trial = 0; trial < 300; ++trial) {
+        const auto [pattern, pattern_ends] = random_pattern(0);
+        auto *search_context_ptr = omega_search_create_pattern_context(
+                haystack_session_ptr, reinterpret_cast<const omega_byte_t *>(pattern.data()),
+                static_cast<int64_t>(pattern.size()), regex, 0, 0, none);
+        if (!search_context_ptr) {
+            // Only patterns that can match an empty sequence are rejected
+            REQUIRE(pattern_ends(0).count(0));
+            continue;
+        }
+        // Every match, moving one byte past the start of each
+        std::vector<std::pair<int64_t, int64_t>> expected;
+        for (size_t start = 0; start < haystack.size(); ++start) {
+            const auto ends = pattern_ends(start);
+            if (!ends.empty() && start < *ends.rbegin()) {
+                expected.emplace_back(static_cast<int64_t>(start), static_cast<int64_t>(*ends.rbegin() - start));
+            }
+        }
+        std::vector<std::pair<int64_t, int64_t>> actual;
+        int64_t advance = 0;
+        while (omega_search_next_match(search_context_ptr, advance) > 0) {
+            actual.emplace_back(omega_search_context_get_match_offset(search_context_ptr),
+                                omega_search_context_get_match_length(search_context_ptr));
+            advance = 1;
+        }
+        omega_search_destroy_context(search_context_ptr);
+        INFO(pattern);
+        REQUIRE(expected == actual);
+        ++compared_count;
+    }
+    REQUIRE(100 < compared_count);
+    omega_edit_destroy_session(haystack_session_ptr);
+
+    // Matches straddling window boundaries, and unbounded repetitions capped by the match length limit
+    const auto window_boundary = int64_t{64 * 1024};
+    omega_edit_insert_string(session_ptr, 0, std::string(static_cast<size_t>(window_boundary) - 3, 'x'));
+    const auto straddle = collect("x{3}MZ", regex, none);
+    REQUIRE(matches_t{{window_boundary - 4, 5}} == straddle);
+    const auto length_limit = static_cast<int64_t>(OMEGA_SEARCH_REGEX_MATCH_LENGTH_LIMIT);
+    omega_edit_insert_string(session_ptr, 0, std::string(static_cast<size_t>(length_limit), 'x'));
+    REQUIRE(matches_t{{0, length_limit}, {length_limit, window_boundary - 1}} ==
+            collect("x+", regex, none));
+    omega_edit_destroy_session(session_ptr);
+}
+TEST_CASE("Search-Index", "[SearchTests]") {
+    const auto file_name_str = std::string(MAKE_PATH("search_index.dat"));
+    const auto checkpoint_dir = DATA_DIR / "search_index_checkpoint";
+    const auto checkpoint_dir_str = checkpoint_dir.string();
+    fs::remove_all(checkpoint_dir);
+    fs::create_directories(checkpoint_dir);
+
+    // Filler that shares no trigram with the needles, so the index rules out most blocks
+    const auto block_length = static_cast<int64_t>(OMEGA_SEARCH_INDEX_BLOCK_LENGTH);
+    std::string text(static_cast<size_t>(20 * block_length + 123), ' ');
+    uint32_t state = 12345;
+    for (auto &c : text) {
+        state = state * 1103515245U + 12345U;
+        c = "abc "[state >> 30];
+    }
+    const auto plant = [&](int64_t offset, const std::string &bytes) { text.replace(offset, bytes.size(), bytes); };
+    plant(3 * block_length + 1000, "Needle");
+    plant(6 * block_length - 3, "needle");// straddles two blocks
+    plant(8 * block_length, "need");
+    plant(static_cast<int64_t>(text.size()) - 6, "NEEDLE");
+    const auto insert_before_offset = 12 * block_length + 500;
+    plant(insert_before_offset, "dle");
+    const auto insert_after_offset = 15 * block_length + 200;
+    plant(insert_after_offset, "nee");
+    const auto delete_offset = 17 * block_length + 10;
+    plant(delete_offset, "ne");
+    plant(delete_offset + 100, "edle");
+    {
+        std::ofstream out(file_name_str, std::ios::binary | std::ios::trunc);
+        REQUIRE(out.write(text.data(), static_cast<std::streamsize>(text.size())));
+    }
+
+    // Every (possibly overlapping) occurrence of the pattern in the given range of the text
+    const auto expected = [&](const std::string &pattern, int64_t offset, int64_t length, bool fold) {
+        const auto lower = [fold](char c) { return fold ? static_cast<char>(std::tolower(c)) : c; };
+        std::vector<int64_t> offsets;
+        const auto pattern_length = static_cast<int64_t>(pattern.size());
+        for (auto position = offset; position + pattern_length <= offset + length; ++position) {
+            if (std::equal(pattern.begin(), pattern.end(), text.begin() + position,
+                           [&](char a, char b) { return lower(a) == lower(b); })) {
+                offsets.push_back(position);
+            }
+        }
+        return offsets;
+    };
+    const auto collect_cbk = [](const int64_t *match_offsets, int64_t match_count, void *user_data_ptr) -> int {
+        auto &offsets = *static_cast<std::vector<int64_t> *>(user_data_ptr);
+        offsets.insert(offsets.end(), match_offsets, match_offsets + match_count);
+        return 0;
+    };
+    // Compares the matches found by stepping a search context and by find-all against the text
+    const auto check_searches = [&](omega_session_t *session_ptr) {
+        const auto text_length = static_cast<int64_t>(text.size());
+        REQUIRE(text_length == omega_session_get_computed_file_size(session_ptr));
+        for (const auto &[pattern, case_folding] :
+             std::vector<std::pair<std::string, omega_search_case_folding_t>>{
+                     {"needle", OMEGA_SEARCH_CASE_FOLDING_ASCII},
+                     {"Needle", OMEGA_SEARCH_CASE_FOLDING_NONE},
+                     {"eedl", OMEGA_SEARCH_CASE_FOLDING_NONE},
+                     {"dle", OMEGA_SEARCH_CASE_FOLDING_ASCII},
+                     {"need", OMEGA_SEARCH_CASE_FOLDING_WINDOWS_1252}}) {
+            const auto fold = case_folding != OMEGA_SEARCH_CASE_FOLDING_NONE;
+            const auto *pattern_ptr = reinterpret_cast<const omega_byte_t *>(pattern.data());
+            const auto pattern_length = static_cast<int64_t>(pattern.size());
+            for (const auto &[offset, length] : std::vector<std::pair<int64_t, int64_t>>{
+                         {0, text_length}, {5 * block_length, 4 * block_length}, {6 * block_length - 2, 100}}) {
+                const auto search_context_ptr = omega_search_create_context_bytes(
+                        session_ptr, pattern_ptr, pattern_length, offset, length, case_folding, 0);
+                REQUIRE(search_context_ptr);
+                std::vector<int64_t> offsets;
+                while (0 < omega_search_next_match(search_context_ptr, 1)) {
+                    offsets.push_back(omega_search_context_get_match_offset(search_context_ptr));
+                }
+                omega_search_destroy_context(search_context_ptr);
+                const auto expected_offsets = expected(pattern, offset, length, fold);
+                REQUIRE(expected_offsets == offsets);
+                for (const int thread_count : {1, 3}) {
+                    offsets.clear();
+                    REQUIRE(static_cast<int64_t>(expected_offsets.size()) ==
+                            omega_search_find_all(session_ptr, pattern_ptr, pattern_length, offset, length,
+                                                  case_folding, 0, thread_count, collect_cbk, &offsets));
+                    REQUIRE(expected_offsets == offsets);
+                }
+            }
+        }
+    };
+
+    auto session_ptr = omega_edit_create_session(file_name_str.c_str(), nullptr, nullptr, NO_EVENTS,
+                                                 checkpoint_dir_str.c_str());
+    REQUIRE(session_ptr);
+    REQUIRE(-1 == omega_session_wait_for_search_index(session_ptr));
+    check_searches(session_ptr);
+    REQUIRE(0 == omega_session_build_search_index(session_ptr));
+    REQUIRE(0 == omega_session_build_search_index(session_ptr));
+    REQUIRE(0 == omega_session_wait_for_search_index(session_ptr));
+    check_searches(session_ptr);
+
+    // Matches that straddle inserted and original bytes, or original bytes that are no longer adjacent
+    REQUIRE(0 < omega_edit_delete(session_ptr, delete_offset + 2, 98));
+    text.erase(delete_offset + 2, 98);
+    REQUIRE(0 < omega_edit_insert(session_ptr, insert_after_offset + 3, "dle", 3));
+    text.insert(insert_after_offset + 3, "dle");
+    REQUIRE(0 < omega_edit_insert(session_ptr, insert_before_offset, "nee", 3));
+    text.insert(insert_before_offset, "nee");
+    REQUIRE(0 < omega_edit_insert(session_ptr, 10 * block_length + 7, "NeedlE", 6));
+    text.insert(10 * block_length + 7, "NeedlE");
+    check_searches(session_ptr);
+    omega_edit_destroy_session(session_ptr);
+
+    // The index was saved in the checkpoint directory, and a new session on the same file reuses it
+    std::vector<fs::path> index_files;
+    for (const auto &entry : fs::directory_iterator(checkpoint_dir)) {
+        if (entry.path().filename().string().rfind(".OmegaEdit-index.", 0) == 0) {
+            index_files.push_back(entry.path());
+        }
+    }
+    REQUIRE(1 == index_files.size());
+    const auto index_write_time = fs::last_write_time(index_files.front());
+    session_ptr = omega_edit_create_session(file_name_str.c_str(), nullptr, nullptr, NO_EVENTS,
+                                            checkpoint_dir_str.c_str());
+    REQUIRE(session_ptr);
+    REQUIRE(0 == omega_session_build_search_index(session_ptr));
+    REQUIRE(0 == omega_session_wait_for_search_index(session_ptr));
+    REQUIRE(index_write_time == fs::last_write_time(index_files.front()));
+    text.assign(std::istreambuf_iterator<char>(std::ifstream(file_name_str, std::ios::binary).rdbuf()), {});
+    check_searches(session_ptr);
+    omega_edit_destroy_session(session_ptr);
+
+    // Destroying a session stops an index build that's still running
+    session_ptr = omega_edit_create_session(file_name_str.c_str(), nullptr, nullptr, NO_EVENTS,
+                                            checkpoint_dir_str.c_str());
+    REQUIRE(session_ptr);
+    REQUIRE(0 == omega_session_build_search_index(session_ptr));
+    omega_edit_destroy_session(session_ptr);
+
+    // Sessions without an original file have nothing to index
+    session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(-1 == omega_session_build_search_index(session_ptr));
+    REQUIRE(-1 == omega_session_wait_for_search_index(session_ptr));
+    omega_edit_destroy_session(session_ptr);
+
+    omega_util_remove_file(file_name_str.c_str());
+    fs::remove_all(checkpoint_dir);
+}
+
+TEST_CASE("Search-Pinned-Content", "[SearchTests]") {
+    const ScratchDir scratch;
+    TestSession session(nullptr, scratch.c_str());
+    REQUIRE(session);
+    auto *session_ptr = session.get();
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "needle hay needle hay neeedle"));
+
+    // Steps a search context to the end, editing the session before each step
+    const auto collect = [&](omega_search_context_t *search_context_ptr) {
+        std::vector<int64_t> offsets;
+        int64_t advance = 0;
+        for (;;) {
+            REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "needle "));
+            const auto rc = omega_search_next_match(search_context_ptr, advance);
+            if (rc <= 0) {
+                REQUIRE(rc == 0);
+                break;
+            }
+            advance = 1;
+            offsets.push_back(omega_search_context_get_match_offset(search_context_ptr));
+        }
+        omega_search_destroy_context(search_context_ptr);
+        return offsets;
+    };
+
+    // Pinned searches find the matches in the content as it was when pinned
+    auto *search_context_ptr = omega_search_create_context(session_ptr, "needle", 0, 0, 0,
+                                                           OMEGA_SEARCH_CASE_FOLDING_NONE, 0);
+    REQUIRE(search_context_ptr);
+    REQUIRE(0 == omega_search_context_pin_content(search_context_ptr));
+    REQUIRE(0 == omega_search_context_pin_content(search_context_ptr));
+    REQUIRE(collect(search_context_ptr) == std::vector<int64_t>{0, 11});
+    search_context_ptr = omega_search_create_context(session_ptr, "NEEDLE", 0, 10, 0,
+                                                     OMEGA_SEARCH_CASE_FOLDING_ASCII, 1);
+    REQUIRE(search_context_ptr);
+    REQUIRE(0 == omega_search_context_pin_content(search_context_ptr));
+    REQUIRE(collect(search_context_ptr) == std::vector<int64_t>{32, 21, 14});
+    const std::string pattern = "ne+dle";
+    search_context_ptr = omega_search_create_pattern_context(
+            session_ptr, reinterpret_cast<const omega_byte_t *>(pattern.data()), static_cast<int64_t>(pattern.size()),
+            OMEGA_SEARCH_PATTERN_SYNTAX_REGEX, 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE);
+    REQUIRE(search_context_ptr);
+    REQUIRE(0 == omega_search_context_pin_content(search_context_ptr));
+    REQUIRE(collect(search_context_ptr) == std::vector<int64_t>{0, 7, 14, 21, 28, 35, 42, 49, 60, 71});
+
+    // Pinned content belongs to the checkpoint that was current, so it's lost if that checkpoint is destroyed
+    REQUIRE(0 == omega_edit_create_checkpoint(session_ptr));
+    search_context_ptr = omega_search_create_context(session_ptr, "hay", 0, 0, 0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0);
+    REQUIRE(search_context_ptr);
+    REQUIRE(0 == omega_search_context_pin_content(search_context_ptr));
+    REQUIRE(0 < omega_search_next_match(search_context_ptr, 0));
+    REQUIRE(0 == omega_edit_destroy_last_checkpoint(session_ptr));
+    REQUIRE(0 > omega_search_next_match(search_context_ptr, 1));
+    omega_search_destroy_context(search_context_ptr);
+    REQUIRE(-1 == omega_search_context_pin_content(nullptr));
+}
+
 TEST_CASE("File Viewing", "[InitTests]") {
     auto const fill = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
     auto const fill_length = static_cast<int64_t>(strlen(fill));
@@ -1445,6 +2385,52 @@ TEST_CASE("Viewports", "[ViewportTests]") {
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Viewports borrow bytes that lie in one segment", "[ViewportTests]") {
+    const std::string content = "0123456789abcdefghijklmnopqrstuvwxyz";
+    const auto session_ptr =
+            omega_edit_create_session_from_bytes(reinterpret_cast<const omega_byte_t *>(content.data()),
+                                                 static_cast<int64_t>(content.size()), nullptr, nullptr, NO_EVENTS,
+                                                 nullptr);
+    REQUIRE(session_ptr);
+    const auto viewport_ptr = omega_edit_create_viewport(session_ptr, 4, 8, 0, nullptr, nullptr, NO_EVENTS);
+    const auto other_viewport_ptr = omega_edit_create_viewport(session_ptr, 4, 8, 0, nullptr, nullptr, NO_EVENTS);
+    REQUIRE(viewport_ptr);
+    REQUIRE(other_viewport_ptr);
+
+    // Both viewports lie in the same run of the mapped snapshot, so they borrow the same bytes
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "456789ab");
+    REQUIRE(omega_viewport_get_string(other_viewport_ptr) == "456789ab");
+    REQUIRE(omega_viewport_get_data(viewport_ptr) == omega_viewport_get_data(other_viewport_ptr));
+
+    // Straddling an insert, each viewport reads into its own buffer
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 6, "ABCDEFGHIJ"));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "45ABCDEF");
+    REQUIRE(omega_viewport_get_string(other_viewport_ptr) == "45ABCDEF");
+    REQUIRE(omega_viewport_get_data(viewport_ptr) != omega_viewport_get_data(other_viewport_ptr));
+
+    // Inside the insert, both viewports borrow its inline bytes
+    REQUIRE(0 == omega_viewport_modify(viewport_ptr, 7, 8, 0));
+    REQUIRE(0 == omega_viewport_modify(other_viewport_ptr, 7, 8, 0));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "BCDEFGHI");
+    REQUIRE(omega_viewport_get_data(viewport_ptr) == omega_viewport_get_data(other_viewport_ptr));
+
+    // Undoing the insert makes the viewports dirty, so they let go of its bytes
+    REQUIRE(0 > omega_edit_undo_last_change(session_ptr));
+    REQUIRE(0 != omega_viewport_has_changes(viewport_ptr));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "789abcde");
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "xyz"));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "456789ab");
+    REQUIRE(omega_viewport_get_string(other_viewport_ptr) == "456789ab");
+
+    // Viewports borrowing a checkpoint's mapped file read the earlier content again once it is destroyed
+    REQUIRE(0 == omega_edit_create_checkpoint(session_ptr));
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 0, "X"));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "456789ab");
+    REQUIRE(0 == omega_edit_destroy_last_checkpoint(session_ptr));
+    REQUIRE(omega_viewport_get_string(viewport_ptr) == "456789ab");
+    omega_edit_destroy_session(session_ptr);
+}
+
 TEST_CASE("Segment Small Data Optimization", "[SegmentTests]") {
     // Small segments (capacity <= 7) use inline storage
     auto *small_seg = omega_segment_create(5);
@@ -13,8 +13,18 @@
  **********************************************************************************************************************/
 
 #include <omega_edit/transform_plugin_sdk.h>
+#include <stdio.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+static int applied_count = 0;
+
 OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_get_info(omega_transform_plugin_info_t *info_ptr) {
     if (!info_ptr) { return -1; }
     info_ptr->id = "omega.test.process_isolation";
@@ -34,6 +44,42 @@ OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_apply(const omega_trans
         (request_ptr->input_length > 0 && !request_ptr->input_bytes)) {
         return -1;
     }
+    ++applied_count;
+    if (request_ptr->input_length == 5 && memcmp(request_ptr->input_bytes, "count", 5) == 0) {
+        char count[16];
+        const int count_length = snprintf(count, sizeof(count), "%d", applied_count);
+        return omega_transform_plugin_sdk_set_replacement(request_ptr, response_ptr, (const omega_byte_t *) count,
+                                                          (int64_t) count_length);
+    }
+    if (request_ptr->input_length == 3 && memcmp(request_ptr->input_bytes, "pid", 3) == 0) {
+        char pid[32];
+        const int pid_length = snprintf(pid, sizeof(pid), "%ld", (long) getpid());
+        return omega_transform_plugin_sdk_set_replacement(request_ptr, response_ptr, (const omega_byte_t *) pid,
+                                                          (int64_t) pid_length);
+    }
+    if (request_ptr->input_length >= 6 && memcmp(request_ptr->input_bytes, "invert", 6) == 0) {
+        omega_byte_t *inverted =
+                (omega_byte_t *) omega_transform_plugin_sdk_alloc(request_ptr, (size_t) request_ptr->input_length);
+        if (!inverted) { return -1; }
+        for (int64_t i = 0; i < request_ptr->input_length; ++i) {
+            inverted[i] = (omega_byte_t) ~request_ptr->input_bytes[i];
+        }
+        response_ptr->replacement_bytes = inverted;
+        response_ptr->replacement_length = request_ptr->input_length;
+        return 0;
+    }
+    if (request_ptr->input_length >= 6 && memcmp(request_ptr->input_bytes, "stream", 6) == 0) {
+        omega_byte_t chunk[4096];
+        for (int64_t offset = 0; offset < request_ptr->input_length; offset += (int64_t) sizeof(chunk)) {
+            int64_t length = request_ptr->input_length - offset;
+            if (length > (int64_t) sizeof(chunk)) { length = (int64_t) sizeof(chunk); }
+            for (int64_t i = 0; i < length; ++i) { chunk[i] = (omega_byte_t) ~request_ptr->input_bytes[offset + i]; }
+            if (omega_transform_plugin_sdk_write_replacement(request_ptr, response_ptr, chunk, length) != 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
     if (request_ptr->input_length == 5 && memcmp(request_ptr->input_bytes, "crash", 5) == 0) {
         volatile int *boom = (volatile int *) 0;
         *boom = 1;
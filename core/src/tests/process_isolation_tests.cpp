@@ -15,8 +15,17 @@
 #include <catch2/catch_test_macros.hpp>
 #include <omega_edit/transform.h>
 
+#include <filesystem>
+#include <fstream>
 #include <string>
 
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 #ifndef OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE
 #error "OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE must be defined by the test build"
 #endif
@@ -25,6 +34,10 @@
 #error "OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN must be defined by the test build"
 #endif
 
+#ifndef OMEGA_EDIT_CHUNK_PARALLEL_PLUGIN
+#error "OMEGA_EDIT_CHUNK_PARALLEL_PLUGIN must be defined by the test build"
+#endif
+
 using omega_test::content_string;
 using omega_test::TestSession;
 
@@ -60,6 +73,10 @@ namespace {
         return 0;
     }
 
+    int cancel_worker_progress(const omega_transform_plugin_progress_t *progress_ptr, void *) {
+        return progress_ptr && progress_ptr->phase && std::string(progress_ptr->phase) == "worker" ? 1 : 0;
+    }
+
     int cancel_after_callback(void *user_data_ptr) {
         auto *state = static_cast<CancellationState *>(user_data_ptr);
         if (!state) { return 0; }
@@ -124,3 +141,266 @@ TEST_CASE("Transform plugins run out of process and crashes do not kill the call
     REQUIRE(content_string(cancelled.get()) == "cancel");
     REQUIRE(omega_session_get_num_changes(cancelled.get()) == 0);
 }
+
+TEST_CASE("Transform plugin hosts are reused across applies and replaced after crashes", "[Transform][Isolation]") {
+    const auto apply_count = [](omega_transform_plugin_registry_t *registry_ptr) {
+        const auto *count_input = reinterpret_cast<const omega_byte_t *>("count");
+        TestSession session = TestSession::from_bytes(count_input, 5);
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry_ptr, "omega.test.process_isolation",
+                                                                      session.get(), 0, 0, nullptr, nullptr));
+        return content_string(session.get());
+    };
+
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(-1 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, -1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+
+    SECTION("Per-request hosts") {
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, 0));
+        REQUIRE(apply_count(registry.ptr) == "1");
+        REQUIRE(apply_count(registry.ptr) == "1");
+    }
+#ifndef _WIN32
+    SECTION("Pooled hosts") {
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, 1));
+        REQUIRE(apply_count(registry.ptr) == "1");
+        REQUIRE(apply_count(registry.ptr) == "2");
+
+        const auto *crashing_input = reinterpret_cast<const omega_byte_t *>("crash");
+        TestSession crashing = TestSession::from_bytes(crashing_input, 5);
+        REQUIRE(-1 == omega_transform_plugin_registry_apply_to_session(registry.ptr, "omega.test.process_isolation",
+                                                                       crashing.get(), 0, 0, nullptr, nullptr));
+        REQUIRE(content_string(crashing.get()) == "crash");
+        REQUIRE(apply_count(registry.ptr) == "1");
+
+        // A request cancelled from its progress callback leaves the host usable
+        const auto *progress_input = reinterpret_cast<const omega_byte_t *>("progress");
+        TestSession cancelled = TestSession::from_bytes(progress_input, 8);
+        REQUIRE(-1 == omega_transform_plugin_registry_apply_to_session_with_progress(
+                              registry.ptr, "omega.test.process_isolation", cancelled.get(), 0, 0, nullptr,
+                              cancel_worker_progress, nullptr, nullptr));
+        REQUIRE(content_string(cancelled.get()) == "progress");
+        REQUIRE(apply_count(registry.ptr) == "3");
+
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, 0));
+        REQUIRE(apply_count(registry.ptr) == "1");
+    }
+#endif
+}
+
+#ifndef _WIN32
+TEST_CASE("Pooled transform plugin hosts can't make the caller allocate oversized frames", "[Transform][Isolation]") {
+    // This host announces a ready frame far longer than any response when serving, and is the real host otherwise
+    const auto host_path = std::filesystem::temp_directory_path() /
+                           ("omega_edit_oversized_host_" + std::to_string(static_cast<long>(getpid())) + ".sh");
+    {
+        std::ofstream host(host_path);
+        host << "#!/bin/sh\n"
+             << "if [ \"$1\" = --serve ]; then\n"
+             << "  printf '\\104\\122\\105\\117\\377\\377\\377\\377\\377\\377\\377\\177' >&0\n"
+             << "  exec sleep 5\n"
+             << "fi\n"
+             << "exec '" << OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE << "' \"$@\"\n";
+    }
+    std::filesystem::permissions(host_path, std::filesystem::perms::owner_all);
+
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, host_path.string().c_str()));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+    TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>("count"), 5);
+    REQUIRE(-1 == omega_transform_plugin_registry_apply_to_session(registry.ptr, "omega.test.process_isolation",
+                                                                   session.get(), 0, 0, nullptr, nullptr));
+    REQUIRE(content_string(session.get()) == "count");
+    std::filesystem::remove(host_path);
+}
+#endif
+
+TEST_CASE("Large transform payloads round trip through plugin hosts", "[Transform][Isolation]") {
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+
+    // Larger than the limits for contiguous input and in-memory host allocations
+    std::string input(6 * 1024 * 1024 + 3, '\0');
+    for (size_t i = 0; i < input.size(); ++i) { input[i] = static_cast<char>((i * 131U + (i >> 12U)) & 0xFFU); }
+    input.replace(0, 6, "invert");
+    std::string expected = input;
+    for (auto &ch : expected) { ch = static_cast<char>(~static_cast<unsigned char>(ch)); }
+
+    for (const int64_t pool_limit : {0, 1}) {
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, pool_limit));
+        for (int round = 0; round < 2; ++round) {
+            TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>(input.data()),
+                                                          static_cast<int64_t>(input.size()));
+            REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(
+                                 registry.ptr, "omega.test.process_isolation", session.get(), 0, 0, nullptr, nullptr));
+            REQUIRE(content_string(session.get()) == expected);
+        }
+    }
+}
+
+TEST_CASE("Transform plugins stream replacements into checkpoint files", "[Transform][Isolation]") {
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+
+    for (const size_t input_length : {size_t{6}, size_t{3 * 1024 * 1024 + 5}}) {
+        std::string input(input_length, '\0');
+        for (size_t i = 0; i < input.size(); ++i) { input[i] = static_cast<char>((i * 167U + (i >> 9U)) & 0xFFU); }
+        input.replace(0, 6, "stream");
+        std::string expected = input;
+        for (auto &ch : expected) { ch = static_cast<char>(~static_cast<unsigned char>(ch)); }
+
+        for (const int64_t pool_limit : {0, 1}) {
+            REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry.ptr, pool_limit));
+            TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>(input.data()),
+                                                          static_cast<int64_t>(input.size()));
+            omega_transform_plugin_response_t response{};
+            int64_t serial = 0;
+            REQUIRE(0 == omega_transform_plugin_registry_apply_to_session_with_progress_and_serial(
+                                 registry.ptr, "omega.test.process_isolation", session.get(), 0, 0, nullptr, nullptr,
+                                 nullptr, &response, &serial));
+            REQUIRE((response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U);
+            REQUIRE(response.replacement_bytes == nullptr);
+            REQUIRE(response.replacement_length == static_cast<int64_t>(input.size()));
+            REQUIRE(serial > 0);
+            REQUIRE(content_string(session.get()) == expected);
+            REQUIRE(-serial == omega_edit_undo_last_change(session.get()));
+            REQUIRE(content_string(session.get()) == input);
+            omega_transform_plugin_response_clear(&response);
+        }
+    }
+}
+
+TEST_CASE("Trusted transform plugins run in process", "[Transform][Isolation]") {
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+    REQUIRE(-1 == omega_transform_plugin_registry_set_plugin_trusted(nullptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, 1));
+    REQUIRE(-1 == omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, nullptr, 1));
+    REQUIRE(-1 == omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, "", 1));
+    // Trust follows the library path, not the id a plugin reports about itself
+    REQUIRE(-1 == omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, "omega.test.process_isolation", 1));
+
+    const auto plugin_pid = [&registry]() {
+        TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>("pid"), 3);
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry.ptr, "omega.test.process_isolation",
+                                                                      session.get(), 0, 0, nullptr, nullptr));
+        return content_string(session.get());
+    };
+    const auto own_pid = std::to_string(static_cast<long>(getpid()));
+    REQUIRE(plugin_pid() != own_pid);
+    REQUIRE(0 ==
+            omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, 1));
+    REQUIRE(plugin_pid() == own_pid);
+
+    // Trusted plugins get the same response handling, including streamed replacements
+    for (const std::string prefix : {"invert", "stream"}) {
+        std::string input(5 * 1024 * 1024 + 7, '\0');
+        for (size_t i = 0; i < input.size(); ++i) { input[i] = static_cast<char>((i * 193U) & 0xFFU); }
+        input.replace(0, prefix.size(), prefix);
+        std::string expected = input;
+        for (auto &ch : expected) { ch = static_cast<char>(~static_cast<unsigned char>(ch)); }
+        TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>(input.data()),
+                                                      static_cast<int64_t>(input.size()));
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry.ptr, "omega.test.process_isolation",
+                                                                      session.get(), 0, 0, nullptr, nullptr));
+        REQUIRE(content_string(session.get()) == expected);
+    }
+
+    REQUIRE(0 ==
+            omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, 0));
+    REQUIRE(plugin_pid() != own_pid);
+
+    // A trusted library that changes afterwards is not loaded until it is trusted again
+    const auto library_path = std::filesystem::temp_directory_path() /
+                              ("omega_edit_trusted_" + own_pid +
+                               std::filesystem::path(OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN).extension().string());
+    std::filesystem::copy_file(OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, library_path,
+                               std::filesystem::copy_options::overwrite_existing);
+    const auto library = library_path.string();
+    Registry copy_registry;
+    REQUIRE(copy_registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(copy_registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(copy_registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(copy_registry.ptr, library.c_str()));
+
+    // A library that its group or others could rewrite is never trusted
+    std::filesystem::permissions(library_path, std::filesystem::perms::group_write,
+                                 std::filesystem::perm_options::add);
+    REQUIRE(-1 == omega_transform_plugin_registry_set_plugin_trusted(copy_registry.ptr, library.c_str(), 1));
+    std::filesystem::permissions(library_path,
+                                 std::filesystem::perms::group_write | std::filesystem::perms::others_write,
+                                 std::filesystem::perm_options::remove);
+    REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(copy_registry.ptr, library.c_str(), 1));
+    std::ofstream(library_path, std::ios::binary | std::ios::app) << "changed";
+    TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>("pid"), 3);
+    REQUIRE(-1 == omega_transform_plugin_registry_apply_to_session(copy_registry.ptr, "omega.test.process_isolation",
+                                                                   session.get(), 0, 0, nullptr, nullptr));
+    REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(copy_registry.ptr, library.c_str(), 1));
+    REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(copy_registry.ptr, "omega.test.process_isolation",
+                                                                  session.get(), 0, 0, nullptr, nullptr));
+    REQUIRE(content_string(session.get()) == own_pid);
+    std::filesystem::remove(library_path);
+}
+
+TEST_CASE("Sharded transform plugins match a serial apply", "[Transform][Isolation]") {
+    Registry registry;
+    REQUIRE(registry.ptr != nullptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry.ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry.ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry.ptr, OMEGA_EDIT_CHUNK_PARALLEL_PLUGIN));
+
+    // Split four ways, the range has a streamed first shard, an unchanged shard, and buffered shards around it
+    const int64_t range_offset = 5;
+    const auto range_length = 4 * OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH + 13;
+    std::string input(static_cast<size_t>(range_offset + range_length + 7), '-');
+    static const std::string text = "ab-cD ef-Gh";
+    for (int64_t i = 0; i < range_length; ++i) {
+        const auto is_unchanged = 20 * i >= 9 * range_length && 5 * i < 4 * range_length;
+        input[static_cast<size_t>(range_offset + i)] = is_unchanged ? 'Q' : text[static_cast<size_t>(i) % text.size()];
+    }
+    input[static_cast<size_t>(range_offset)] = '0';
+    std::string expected = input.substr(0, static_cast<size_t>(range_offset));
+    for (int64_t i = 0; i < range_length; ++i) {
+        const auto ch = input[static_cast<size_t>(range_offset + i)];
+        if (ch != '-') { expected.push_back(ch >= 'a' && ch <= 'z' ? static_cast<char>(ch - ('a' - 'A')) : ch); }
+    }
+    expected += input.substr(static_cast<size_t>(range_offset + range_length));
+
+    const auto apply = [&registry, &input, range_offset, range_length](int thread_count) {
+        REQUIRE(0 == omega_transform_plugin_registry_set_parallel_thread_count(registry.ptr, thread_count));
+        TestSession session = TestSession::from_bytes(reinterpret_cast<const omega_byte_t *>(input.data()),
+                                                      static_cast<int64_t>(input.size()));
+        const auto changes = omega_session_get_num_changes(session.get());
+        omega_transform_plugin_response_t response{};
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry.ptr, "omega.test.chunk_parallel",
+                                                                      session.get(), range_offset, range_length,
+                                                                      nullptr, &response));
+        REQUIRE(changes + 1 == omega_session_get_num_changes(session.get()));
+        const auto content = content_string(session.get());
+        REQUIRE(static_cast<int64_t>(content.size()) == static_cast<int64_t>(input.size()) - range_length +
+                                                                 response.replacement_length);
+        omega_transform_plugin_response_clear(&response);
+        return content;
+    };
+    for (const auto trusted : {0, 1}) {
+        REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(registry.ptr, OMEGA_EDIT_CHUNK_PARALLEL_PLUGIN,
+                                                                        trusted));
+        const auto serial = apply(1);
+        REQUIRE(serial == expected);
+        REQUIRE(apply(4) == serial);
+    }
+}
@@ -0,0 +1,128 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "omega_edit.h"
+#include "omega_edit/config.h"
+
+#include <test_util.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    using benchmark_clock_t = std::chrono::steady_clock;
+
+    // Planted every planted_spacing bytes: a DOS stub header, a PE signature 60 bytes after it, and a date
+    constexpr int64_t planted_spacing = 1024 * 1024;
+    const std::string planted_header = std::string("MZ") + std::string(58, '\x90') + std::string("PE\0\0", 4);
+    const std::string planted_date = "2024-06-30";
+
+    // Writes a file of pseudo-random bytes with the planted patterns
+    void write_haystack_file(const char *file_name, int64_t file_size) {
+        const auto file_ptr = FOPEN(file_name, "wb");
+        REQUIRE(file_ptr);
+        std::vector<char> block(static_cast<size_t>(planted_spacing));
+        uint32_t state = 0x2545F491U;
+        for (int64_t offset = 0; offset < file_size; offset += planted_spacing) {
+            for (auto &byte : block) {
+                state = state * 1664525U + 1013904223U;
+                byte = static_cast<char>(state >> 24);
+            }
+            planted_header.copy(block.data() + planted_spacing / 4, planted_header.size());
+            planted_date.copy(block.data() + planted_spacing / 2, planted_date.size());
+            const auto count = static_cast<size_t>(std::min(planted_spacing, file_size - offset));
+            REQUIRE(count == fwrite(block.data(), 1, count, file_ptr));
+        }
+        FCLOSE(file_ptr);
+    }
+
+    // Finds every non-overlapping match with the given context, returning the scan rate in MiB/s
+    double scan_rate(omega_search_context_t *search_context_ptr, int64_t session_length, int64_t &match_count) {
+        REQUIRE(search_context_ptr);
+        match_count = 0;
+        const auto begin = benchmark_clock_t::now();
+        int64_t advance = 0;
+        while (omega_search_next_match(search_context_ptr, advance) > 0) {
+            ++match_count;
+            advance = omega_search_context_get_match_length(search_context_ptr);
+        }
+        const auto seconds = std::chrono::duration<double>(benchmark_clock_t::now() - begin).count();
+        omega_search_destroy_context(search_context_ptr);
+        return static_cast<double>(session_length) / (1024.0 * 1024.0) / seconds;
+    }
+}// namespace
+
+TEST_CASE("Benchmark regex and hex mask search over a multi-gigabyte file", "[.][RegexBenchmark]") {
+    // Set OMEGA_EDIT_BENCHMARK_BYTES to benchmark a different file size
+    int64_t file_size = 2LL * 1024 * 1024 * 1024;
+    if (const auto *size_str = std::getenv("OMEGA_EDIT_BENCHMARK_BYTES"); size_str && *size_str) {
+        file_size = std::strtoll(size_str, nullptr, 10);
+    }
+    REQUIRE(planted_spacing <= file_size);
+    const auto file_name_str = std::string(MAKE_PATH("regex_benchmark.dat"));
+    write_haystack_file(file_name_str.c_str(), file_size);
+    const auto session_ptr = omega_edit_create_session(file_name_str.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(file_size == omega_session_get_computed_file_size(session_ptr));
+    const auto planted_count = (file_size - planted_spacing / 2 - static_cast<int64_t>(planted_date.size())) /
+                                       planted_spacing + 1;
+
+    std::string hex_mask = "4D 5A";
+    for (int i = 0; i < 58; ++i) { hex_mask += " ??"; }
+    hex_mask += " 50 45 00 00";
+    const struct {
+        const char *label;
+        std::string pattern;
+        omega_search_pattern_syntax_t syntax;
+        omega_search_case_folding_t case_folding;
+    } cases[] = {
+            {"regex MZ.{58}PE\\0\\0", R"(MZ.{58}PE\0\0)", OMEGA_SEARCH_PATTERN_SYNTAX_REGEX,
+             OMEGA_SEARCH_CASE_FOLDING_NONE},
+            {"hex mask 4D 5A ??x58 50 45 00 00", hex_mask, OMEGA_SEARCH_PATTERN_SYNTAX_HEX_MASK,
+             OMEGA_SEARCH_CASE_FOLDING_NONE},
+            {"regex \\d{4}-\\d\\d-\\d\\d", R"(\d{4}-\d\d-\d\d)", OMEGA_SEARCH_PATTERN_SYNTAX_REGEX,
+             OMEGA_SEARCH_CASE_FOLDING_NONE},
+            {"regex (mz|pe)\\0\\0 folded", R"((mz|pe)\0\0)", OMEGA_SEARCH_PATTERN_SYNTAX_REGEX,
+             OMEGA_SEARCH_CASE_FOLDING_ASCII},
+    };
+
+    std::cout << "\nRegex benchmark: " << file_size / (1024 * 1024) << " MiB file, MiB/s\n";
+    int64_t match_count = 0;
+    const auto literal_rate = scan_rate(omega_search_create_context_bytes(
+                                                session_ptr, reinterpret_cast<const omega_byte_t *>("PE\0\0"), 4, 0,
+                                                0, OMEGA_SEARCH_CASE_FOLDING_NONE, 0),
+                                        file_size, match_count);
+    std::cout << "  literal PE\\0\\0 (baseline): " << literal_rate << " (" << match_count << " matches)\n";
+    REQUIRE(planted_count <= match_count);
+    for (const auto &benchmark_case : cases) {
+        const auto rate = scan_rate(omega_search_create_pattern_context(
+                                            session_ptr, reinterpret_cast<const omega_byte_t *>(
+                                                                 benchmark_case.pattern.data()),
+                                            static_cast<int64_t>(benchmark_case.pattern.size()),
+                                            benchmark_case.syntax, 0, 0, benchmark_case.case_folding),
+                                    file_size, match_count);
+        std::cout << "  " << benchmark_case.label << ": " << rate << " (" << match_count << " matches)\n";
+        REQUIRE(planted_count <= match_count);
+    }
+    omega_edit_destroy_session(session_ptr);
+    std::filesystem::remove(file_name_str);
+}
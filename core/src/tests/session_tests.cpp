@@ -25,6 +25,8 @@
 #include <chrono>
 #include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <sys/stat.h>
 #include <thread>
 #ifdef OMEGA_BUILD_WINDOWS
 #include <windows.h>
@@ -600,6 +602,122 @@ TEST_CASE("Session owned snapshot file accessors expose original and latest chec
     omega_edit_destroy_session(session_ptr);
 }
 
+TEST_CASE("Lazy snapshot sessions read the original until the snapshot is copied",
+          "[SessionCheckpointTests][SnapshotFiles]") {
+    const auto in_path = std::string(MAKE_PATH("lazy_snapshot.dat"));
+    write_test_file(in_path.c_str(), "0123456789");
+    omega_edit_session_options_t options{};
+    options.event_interest = NO_EVENTS;
+    options.lazy_snapshot = OMEGA_EDIT_TRUE;
+
+    auto session_ptr = omega_edit_create_session_with_options(in_path.c_str(), &options);
+    REQUIRE(session_ptr);
+    REQUIRE(10 == omega_session_get_original_file_size(session_ptr));
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 0, "ab"));
+    REQUIRE(omega_session_get_segment_string(session_ptr, 0, 12) == "ab0123456789");
+    REQUIRE(0 == omega_session_wait_for_original_snapshot(session_ptr));
+    const auto *snapshot_path = omega_session_get_original_snapshot_file_path(session_ptr);
+    REQUIRE(snapshot_path);
+    REQUIRE(0 == omega_util_compare_files(in_path.c_str(), snapshot_path));
+    REQUIRE(10 == omega_session_get_original_file_size(session_ptr));
+    REQUIRE(omega_session_get_segment_string(session_ptr, 0, 12) == "ab0123456789");
+    omega_edit_destroy_session(session_ptr);
+
+    // Saving over the original waits for the snapshot, so the session keeps its original content
+    session_ptr = omega_edit_create_session_with_options(in_path.c_str(), &options);
+    REQUIRE(session_ptr);
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 0, "X"));
+    REQUIRE(0 == omega_edit_save(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr));
+    REQUIRE(nullptr != omega_session_get_original_snapshot_file_path(session_ptr));
+    REQUIRE(0 > omega_edit_undo_last_change(session_ptr));
+    REQUIRE(omega_session_get_segment_string(session_ptr, 0, 10) == "0123456789");
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 10, "!"));
+    REQUIRE(0 == omega_edit_save(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr));
+    omega_edit_destroy_session(session_ptr);
+    session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(omega_session_get_segment_string(session_ptr, 0, 11) == "0123456789!");
+    REQUIRE(0 == omega_session_wait_for_original_snapshot(session_ptr));
+    omega_edit_destroy_session(session_ptr);
+    omega_util_remove_file(in_path.c_str());
+}
+
+TEST_CASE("Lazy snapshot sessions fail reads once the original changes", "[SessionCheckpointTests][SnapshotFiles]") {
+    // Large enough that the original is changed before its snapshot is copied
+    const auto in_path = std::string(MAKE_PATH("lazy_snapshot_changed.dat"));
+    const auto out_path = std::string(MAKE_PATH("lazy_snapshot_changed.out.dat"));
+    write_test_file(in_path.c_str(), std::string(64 * 1024 * 1024, '.').c_str());
+    omega_edit_session_options_t options{};
+    options.event_interest = NO_EVENTS;
+    options.lazy_snapshot = OMEGA_EDIT_TRUE;
+
+    const auto session_ptr = omega_edit_create_session_with_options(in_path.c_str(), &options);
+    REQUIRE(session_ptr);
+    {
+        std::ofstream output(in_path, std::ios::binary | std::ios::app);
+        output << "changed";
+    }
+    REQUIRE(-1 == omega_session_wait_for_original_snapshot(session_ptr));
+    const auto segment_ptr = omega_segment_create(10);
+    REQUIRE(segment_ptr);
+    REQUIRE(0 != omega_session_get_segment(session_ptr, segment_ptr, 0));
+    omega_segment_destroy(segment_ptr);
+    REQUIRE(0 != omega_edit_save(session_ptr, out_path.c_str(), IO_FLG_OVERWRITE, nullptr));
+    REQUIRE(0 == omega_util_file_exists(out_path.c_str()));
+    omega_edit_destroy_session(session_ptr);
+    omega_util_remove_file(in_path.c_str());
+}
+
+TEST_CASE("Mapped snapshot reads follow edits and checkpoints", "[SessionCheckpointTests][SnapshotFiles]") {
+    // Long enough for the reads of a search to be hinted as sequential scans of the mapped snapshot
+    std::string expected(static_cast<size_t>(OMEGA_FILE_MAP_SEQUENTIAL_LENGTH * 3), '.');
+    for (size_t position = 0; position < expected.size(); position += 1000) { expected.replace(position, 3, "abc"); }
+    const auto session_ptr =
+            omega_edit_create_session_from_bytes(reinterpret_cast<const omega_byte_t *>(expected.data()),
+                                                 static_cast<int64_t>(expected.size()), nullptr, nullptr, NO_EVENTS,
+                                                 nullptr);
+    REQUIRE(session_ptr);
+    const auto edit = [&](int64_t offset, int64_t delete_length, const std::string &insert) {
+        if (delete_length) { REQUIRE(0 < omega_edit_delete(session_ptr, offset, delete_length)); }
+        if (!insert.empty()) { REQUIRE(0 < omega_edit_insert_string(session_ptr, offset, insert)); }
+        expected.replace(static_cast<size_t>(offset), static_cast<size_t>(delete_length), insert);
+    };
+    // Compares reads and searches, which borrow runs of the mapped file, with the expected content
+    const auto check = [&]() {
+        const auto length = static_cast<int64_t>(expected.size());
+        REQUIRE(length == omega_session_get_computed_file_size(session_ptr));
+        REQUIRE(omega_session_get_segment_string(session_ptr, 0, length) == expected);
+        REQUIRE(omega_session_get_segment_string(session_ptr, 999, 5) == expected.substr(999, 5));
+        std::vector<int64_t> expected_matches;
+        for (auto position = expected.find("abc"); position != std::string::npos;
+             position = expected.find("abc", position + 1)) {
+            expected_matches.push_back(static_cast<int64_t>(position));
+        }
+        for (const auto is_reverse : {0, 1}) {
+            auto *search_context_ptr = omega_search_create_context(session_ptr, "abc", 0, 0, 0,
+                                                                   OMEGA_SEARCH_CASE_FOLDING_NONE, is_reverse);
+            REQUIRE(search_context_ptr);
+            std::vector<int64_t> matches;
+            while (omega_search_next_match(search_context_ptr, 1) > 0) {
+                matches.push_back(omega_search_context_get_match_offset(search_context_ptr));
+            }
+            omega_search_destroy_context(search_context_ptr);
+            if (is_reverse) { std::reverse(matches.begin(), matches.end()); }
+            REQUIRE(matches == expected_matches);
+        }
+    };
+    check();
+    edit(1500, 0, "xabcx");
+    edit(2999, 2, "ab");
+    edit(50000, 200000, "");
+    check();
+    REQUIRE(0 == omega_edit_create_checkpoint(session_ptr));
+    check();
+    edit(0, 10, "abc");
+    check();
+    omega_edit_destroy_session(session_ptr);
+}
+
 TEST_CASE("Empty Session File Tests", "[EmptySessionFileTests]") {
     file_info_t file_info;
     file_info.num_changes = 0;
@@ -858,6 +976,180 @@ TEST_CASE("Guarded session save fails closed at the publish boundary", "[Session
     omega_util_remove_file(saved_path.c_str());
 }
 
+TEST_CASE("Saved unchanged ranges match whether or not the kernel copies them", "[SessionSaveTests]") {
+    // Long enough that unchanged ranges are offloaded to the kernel, with edits both on and off block boundaries
+    std::string expected(static_cast<size_t>(OMEGA_COPY_OFFLOAD_MIN_LENGTH * 16), '\0');
+    for (size_t i = 0; i < expected.size(); ++i) { expected[i] = static_cast<char>((i * 31 + i / 4096) & 0xFF); }
+    const auto in_path = std::string(MAKE_PATH("session_save_offload.dat"));
+    const auto out_path = std::string(MAKE_PATH("session_save_offload.out.dat"));
+    {
+        std::ofstream output(in_path, std::ios::binary | std::ios::trunc);
+        output.write(expected.data(), static_cast<std::streamsize>(expected.size()));
+    }
+    const auto session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    const auto edit = [&](int64_t offset, int64_t delete_length, const std::string &insert) {
+        if (delete_length) { REQUIRE(0 < omega_edit_delete(session_ptr, offset, delete_length)); }
+        if (!insert.empty()) { REQUIRE(0 < omega_edit_insert_string(session_ptr, offset, insert)); }
+        expected.replace(static_cast<size_t>(offset), static_cast<size_t>(delete_length), insert);
+    };
+    const auto check_saved = [&]() {
+        REQUIRE(0 == omega_edit_save(session_ptr, out_path.c_str(), IO_FLG_OVERWRITE, nullptr));
+        std::ifstream input(out_path, std::ios::binary);
+        const std::string saved((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        REQUIRE(saved.size() == expected.size());
+        REQUIRE(saved == expected);
+    };
+    check_saved();
+    edit(4097, 0, "patch");
+    edit(OMEGA_COPY_OFFLOAD_MIN_LENGTH * 4, 4096, std::string(4096, 'x'));
+    edit(OMEGA_COPY_OFFLOAD_MIN_LENGTH * 8 + 3, 100, "");
+    check_saved();
+
+    // Checkpoints stream unchanged ranges the same way
+    REQUIRE(0 == omega_edit_create_checkpoint(session_ptr));
+    edit(1, 1, "y");
+    check_saved();
+    omega_edit_destroy_session(session_ptr);
+    omega_util_remove_file(out_path.c_str());
+    omega_util_remove_file(in_path.c_str());
+}
+
+TEST_CASE("In-place saves write only changed ranges and roll back on request when interrupted", "[SessionSaveTests]") {
+    std::string expected(256 * 1024, '\0');
+    for (size_t i = 0; i < expected.size(); ++i) { expected[i] = static_cast<char>('a' + i % 26); }
+    const auto in_path = std::string(MAKE_PATH("session_save_in_place.dat"));
+    const auto link_path = std::string(MAKE_PATH("session_save_in_place.link.dat"));
+    const auto journal_path = in_path + ".OmegaEdit-journal";
+    const auto write_file = [](const std::string &path, const std::string &bytes) {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+    const auto read_file = [](const std::string &path) {
+        std::ifstream input(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    };
+    write_file(in_path, expected);
+    omega_util_remove_file(link_path.c_str());
+    omega_util_remove_file(journal_path.c_str());
+
+    // A hard link sees in-place writes, but keeps the old content when the file is replaced
+    std::error_code link_error;
+    std::filesystem::create_hard_link(in_path, link_path, link_error);
+    const auto has_link = !link_error;
+    omega_edit_save_options_t options{};
+    options.in_place = OMEGA_EDIT_TRUE;
+    auto session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 10, "HELLO"));
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 100000, "WORLD"));
+    REQUIRE(0 < omega_edit_delete(session_ptr, 200000, 3));
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 200010, "xyz"));
+    expected.replace(10, 5, "HELLO");
+    expected.replace(100000, 5, "WORLD");
+    expected.erase(200000, 3);
+    expected.insert(200010, "xyz");
+    REQUIRE(0 == omega_edit_save_with_options(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr, &options));
+    REQUIRE(read_file(in_path) == expected);
+    if (has_link) { REQUIRE(read_file(link_path) == expected); }
+    REQUIRE(0 == omega_util_file_exists(journal_path.c_str()));
+
+    // Ranges written by an earlier in-place save are rewritten even after the change that dirtied them is undone
+    REQUIRE(0 > omega_edit_undo_last_change(session_ptr));
+    REQUIRE(0 > omega_edit_undo_last_change(session_ptr));
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 0, "!"));
+    expected = omega_session_get_segment_string(session_ptr, 0, omega_session_get_computed_file_size(session_ptr));
+    REQUIRE(0 == omega_edit_save_with_options(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr, &options));
+    REQUIRE(read_file(in_path) == expected);
+    if (has_link) { REQUIRE(read_file(link_path) == expected); }
+
+    // Changing the length replaces the whole file instead
+    REQUIRE(0 < omega_edit_insert_string(session_ptr, 5, "longer"));
+    expected.insert(5, "longer");
+    REQUIRE(0 == omega_edit_save_with_options(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr, &options));
+    REQUIRE(read_file(in_path) == expected);
+    if (has_link) { REQUIRE(read_file(link_path) != expected); }
+    omega_edit_destroy_session(session_ptr);
+
+    // A journal left by an interrupted save holds the tag, range count, file length, device, inode, owner, and pre-save
+    // modification time of the file, then each range and its bytes, then a checksum of all of that
+    const auto write_journal = [&](const std::string &original_bytes, int64_t offset, int64_t inode_delta = 0,
+                                   uint64_t checksum_delta = 0) {
+        struct stat file_stat {};
+        REQUIRE(0 == stat(in_path.c_str(), &file_stat));
+        int64_t modification_time = 0;
+        REQUIRE(0 == omega_util_get_modification_time(in_path.c_str(), &modification_time));
+        const int64_t fields[] = {1,
+                                  static_cast<int64_t>(expected.size()),
+                                  static_cast<int64_t>(file_stat.st_dev),
+                                  static_cast<int64_t>(file_stat.st_ino) + inode_delta,
+                                  static_cast<int64_t>(file_stat.st_uid),
+                                  modification_time,
+                                  offset,
+                                  static_cast<int64_t>(original_bytes.size())};
+        auto contents = std::string("OMEGAJN2") + std::string(reinterpret_cast<const char *>(fields), sizeof(fields)) +
+                        original_bytes;
+        uint64_t checksum = 0xcbf29ce484222325ULL;// FNV-1a
+        for (const auto byte : contents) {
+            checksum ^= static_cast<unsigned char>(byte);
+            checksum *= 0x100000001b3ULL;
+        }
+        checksum += checksum_delta;
+        contents.append(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+        write_file(journal_path, contents);
+    };
+    write_journal(expected.substr(1000, 4), 1000);
+    auto torn = expected;
+    torn.replace(1000, 4, "TORN");
+    write_file(in_path, torn);
+    REQUIRE(0 == omega_edit_roll_back_in_place_save(in_path.c_str()));
+    REQUIRE(read_file(in_path) == expected);
+    REQUIRE(0 == omega_util_file_exists(journal_path.c_str()));
+    REQUIRE(0 == omega_edit_roll_back_in_place_save(in_path.c_str()));
+
+    // Creating a session only reports the journal, and in-place saves wait until it's rolled back explicitly
+    write_journal(expected.substr(2000, 4), 2000);
+    torn = expected;
+    torn.replace(2000, 4, "TORN");
+    write_file(in_path, torn);
+    session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 != omega_session_has_in_place_save_journal(session_ptr));
+    REQUIRE(omega_session_get_segment_string(session_ptr, 2000, 4) == "TORN");
+    REQUIRE(read_file(in_path) == torn);
+    REQUIRE(0 < omega_edit_overwrite_string(session_ptr, 0, "?"));
+    REQUIRE(0 != omega_edit_save_with_options(session_ptr, in_path.c_str(), IO_FLG_OVERWRITE, nullptr, &options));
+    REQUIRE(read_file(in_path) == torn);
+    omega_edit_destroy_session(session_ptr);
+    REQUIRE(0 == omega_edit_roll_back_in_place_save(in_path.c_str()));
+    REQUIRE(read_file(in_path) == expected);
+    session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 == omega_session_has_in_place_save_journal(session_ptr));
+    omega_edit_destroy_session(session_ptr);
+
+    // A journal that's corrupt, written for another file, or doesn't fit the file is refused and left alone
+    write_journal(expected.substr(2000, 4), 2000, 0, 1);
+    write_file(in_path, torn);
+    REQUIRE(0 != omega_edit_roll_back_in_place_save(in_path.c_str()));
+    REQUIRE(read_file(in_path) == torn);
+    REQUIRE(0 != omega_util_file_exists(journal_path.c_str()));
+    write_journal(expected.substr(2000, 4), 2000, 1);
+    REQUIRE(0 != omega_edit_roll_back_in_place_save(in_path.c_str()));
+    REQUIRE(read_file(in_path) == torn);
+    write_journal(expected.substr(2000, 4), 2000);
+    write_file(in_path, torn + "extra");
+    REQUIRE(0 != omega_edit_roll_back_in_place_save(in_path.c_str()));
+    REQUIRE(read_file(in_path) == torn + "extra");
+    session_ptr = omega_edit_create_session(in_path.c_str(), nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 != omega_session_has_in_place_save_journal(session_ptr));
+    omega_edit_destroy_session(session_ptr);
+    omega_util_remove_file(journal_path.c_str());
+    omega_util_remove_file(link_path.c_str());
+    omega_util_remove_file(in_path.c_str());
+}
+
 TEST_CASE("Named options and explicit C-string helpers", "[SessionApiTests]") {
     auto *session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
     REQUIRE(session_ptr);
@@ -1152,6 +1444,11 @@ TEST_CASE("Null Pointer Safety", "[NullSafety]") {
     REQUIRE(0 == omega_session_get_num_change_transactions(nullptr));
     REQUIRE(0 == omega_session_get_change_inline_payload_limit(nullptr));
     REQUIRE(0 == omega_session_set_change_inline_payload_limit(nullptr, 32));
+    REQUIRE(0 == omega_session_get_payload_cache_limit(nullptr));
+    REQUIRE(0 == omega_session_set_payload_cache_limit(nullptr, 32));
+    REQUIRE(0 == omega_session_get_payload_cache_hits(nullptr));
+    REQUIRE(0 == omega_session_get_payload_cache_misses(nullptr));
+    REQUIRE(0 == omega_session_get_payload_cache_bytes(nullptr));
 
     // These should not crash (void returns)
     omega_session_pause_viewport_event_callbacks(nullptr);
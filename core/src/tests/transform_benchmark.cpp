@@ -0,0 +1,130 @@
+/**********************************************************************************************************************
+ * Copyright (c) 2021 Concurrent Technologies Corporation.                                                            *
+ *                                                                                                                    *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance     *
+ * with the License.  You may obtain a copy of the License at                                                         *
+ *                                                                                                                    *
+ *     http://www.apache.org/licenses/LICENSE-2.0                                                                     *
+ *                                                                                                                    *
+ * Unless required by applicable law or agreed to in writing, software is distributed under the License is            *
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or                   *
+ * implied.  See the License for the specific language governing permissions and limitations under the License.       *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "omega_edit.h"
+#include "omega_edit/transform.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#ifndef OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE
+#error "OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE must be defined by the test build"
+#endif
+
+#ifndef OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN
+#error "OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN must be defined by the test build"
+#endif
+
+namespace {
+    using benchmark_clock_t = std::chrono::steady_clock;
+
+    double micros_per_apply(omega_transform_plugin_registry_t *registry_ptr, int64_t pool_limit, int applies) {
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry_ptr, pool_limit));
+        const auto *input = reinterpret_cast<const omega_byte_t *>("abc");
+        auto *session_ptr = omega_edit_create_session_from_bytes(input, 3, nullptr, nullptr, NO_EVENTS, nullptr);
+        REQUIRE(session_ptr);
+
+        // Warm up so pooled hosts are already running when timing starts
+        omega_transform_plugin_response_t response{};
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry_ptr, "omega.test.process_isolation",
+                                                                      session_ptr, 0, 0, nullptr, &response));
+        omega_transform_plugin_response_clear(&response);
+
+        const auto begin = benchmark_clock_t::now();
+        for (int i = 0; i < applies; ++i) {
+            REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(
+                                 registry_ptr, "omega.test.process_isolation", session_ptr, 0, 0, nullptr, &response));
+            omega_transform_plugin_response_clear(&response);
+        }
+        const auto end = benchmark_clock_t::now();
+
+        omega_edit_destroy_session(session_ptr);
+        return std::chrono::duration<double, std::micro>(end - begin).count() / static_cast<double>(applies);
+    }
+
+    double millis_per_large_apply(omega_transform_plugin_registry_t *registry_ptr, int64_t pool_limit,
+                                  const std::string &input, int applies) {
+        REQUIRE(0 == omega_transform_plugin_registry_set_host_pool_limit(registry_ptr, pool_limit));
+        double total_ms = 0.0;
+        for (int i = 0; i < applies; ++i) {
+            auto *session_ptr =
+                    omega_edit_create_session_from_bytes(reinterpret_cast<const omega_byte_t *>(input.data()),
+                                                         static_cast<int64_t>(input.size()), nullptr, nullptr,
+                                                         NO_EVENTS, nullptr);
+            REQUIRE(session_ptr);
+            const auto begin = benchmark_clock_t::now();
+            REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(
+                                 registry_ptr, "omega.test.process_isolation", session_ptr, 0, 0, nullptr, nullptr));
+            total_ms += std::chrono::duration<double, std::milli>(benchmark_clock_t::now() - begin).count();
+            omega_edit_destroy_session(session_ptr);
+        }
+        return total_ms / static_cast<double>(applies);
+    }
+}// namespace
+
+TEST_CASE("Benchmark transform plugin apply latency", "[.][TransformBenchmark]") {
+    constexpr int applies = 200;
+
+    auto *registry_ptr = omega_transform_plugin_registry_create();
+    REQUIRE(registry_ptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry_ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry_ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry_ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+
+    const auto per_request_us = micros_per_apply(registry_ptr, 0, applies);
+    const auto pooled_us = micros_per_apply(registry_ptr, OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT, applies);
+    REQUIRE(0 ==
+            omega_transform_plugin_registry_set_plugin_trusted(registry_ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, 1));
+    const auto trusted_us = micros_per_apply(registry_ptr, OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT, applies);
+
+    std::cout << "\nTransform plugin apply benchmark: " << applies << " small applies\n";
+    std::cout << "  host per request: " << per_request_us << " us/apply\n";
+    std::cout << "  pooled hosts:     " << pooled_us << " us/apply\n";
+    std::cout << "  trusted:          " << trusted_us << " us/apply\n";
+
+    omega_transform_plugin_registry_destroy(registry_ptr);
+}
+
+TEST_CASE("Benchmark transform plugin large payload exchange", "[.][TransformBenchmark]") {
+    constexpr int applies = 5;
+    constexpr size_t payload_bytes = 64U * 1024U * 1024U;
+
+    auto *registry_ptr = omega_transform_plugin_registry_create();
+    REQUIRE(registry_ptr);
+    REQUIRE(0 == omega_transform_plugin_registry_set_host_path(registry_ptr, OMEGA_EDIT_PLUGIN_HOST_EXECUTABLE));
+    REQUIRE(0 == omega_transform_plugin_registry_set_allow_test(registry_ptr, 1));
+    REQUIRE(0 == omega_transform_plugin_registry_register_plugin(registry_ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN));
+
+    std::string input(payload_bytes, 'x');
+    input.replace(0, 6, "invert");
+    const auto file_exchange_ms = millis_per_large_apply(registry_ptr, 0, input, applies);
+    const auto shared_exchange_ms =
+            millis_per_large_apply(registry_ptr, OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT, input, applies);
+    REQUIRE(0 ==
+            omega_transform_plugin_registry_set_plugin_trusted(registry_ptr, OMEGA_EDIT_PROCESS_ISOLATION_PLUGIN, 1));
+    const auto trusted_ms =
+            millis_per_large_apply(registry_ptr, OMEGA_TRANSFORM_PLUGIN_HOST_POOL_LIMIT, input, applies);
+
+    std::cout << "\nTransform plugin payload benchmark: " << applies << " applies of " << (payload_bytes >> 20U)
+              << " MiB\n";
+    std::cout << "  file exchange:   " << file_exchange_ms << " ms/apply\n";
+    std::cout << "  shared exchange: " << shared_exchange_ms << " ms/apply\n";
+    std::cout << "  trusted:         " << trusted_ms << " ms/apply\n";
+
+    omega_transform_plugin_registry_destroy(registry_ptr);
+}
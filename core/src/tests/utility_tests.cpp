@@ -130,6 +130,58 @@ TEST_CASE("File Transformer", "[TransformerTest]") {
     REQUIRE(0 == omega_util_file_exists(MAKE_PATH("test1.actual.transformed.3.dat")));
 }
 
+TEST_CASE("Byte Table And Buffer Kernels", "[TransformerTest]") {
+    // Every byte value, offset by one so the kernels also see a length that is not a multiple of the unroll factor
+    omega_byte_t all_bytes[257];
+    for (int i = 0; i < 257; ++i) { all_bytes[i] = static_cast<omega_byte_t>(i + 255); }
+
+    omega_byte_t upper_table[256];
+    omega_util_fill_byte_table(upper_table, to_upper, nullptr);
+    for (int byte = 0; byte < 256; ++byte) {
+        REQUIRE(to_upper(static_cast<omega_byte_t>(byte), nullptr) == upper_table[byte]);
+    }
+
+    omega_byte_t expected[257];
+    omega_byte_t actual[257];
+    memcpy(expected, all_bytes, sizeof(all_bytes));
+    omega_util_apply_byte_transform(expected, sizeof(expected), to_upper, nullptr);
+    memcpy(actual, all_bytes, sizeof(all_bytes));
+    omega_util_apply_byte_table(actual, sizeof(actual), upper_table);
+    REQUIRE(0 == memcmp(expected, actual, sizeof(actual)));
+    memcpy(actual, all_bytes, sizeof(all_bytes));
+    omega_util_ascii_to_upper(actual, sizeof(actual));
+    REQUIRE(0 == memcmp(expected, actual, sizeof(actual)));
+
+    memcpy(expected, all_bytes, sizeof(all_bytes));
+    omega_util_apply_byte_transform(expected, sizeof(expected), to_lower, nullptr);
+    memcpy(actual, all_bytes, sizeof(all_bytes));
+    omega_util_ascii_to_lower(actual, sizeof(actual));
+    REQUIRE(0 == memcmp(expected, actual, sizeof(actual)));
+
+    for (const auto mask_kind : {MASK_AND, MASK_OR, MASK_XOR}) {
+        memcpy(actual, all_bytes, sizeof(all_bytes));
+        omega_util_apply_mask(actual, sizeof(actual), 0x5A, mask_kind);
+        for (int i = 0; i < 257; ++i) { REQUIRE(omega_util_mask_byte(all_bytes[i], 0x5A, mask_kind) == actual[i]); }
+    }
+
+    // Only the given length is transformed
+    memcpy(actual, all_bytes, sizeof(all_bytes));
+    omega_util_apply_mask(actual, 3, 0xFF, MASK_XOR);
+    REQUIRE(static_cast<omega_byte_t>(~all_bytes[2]) == actual[2]);
+    REQUIRE(0 == memcmp(all_bytes + 3, actual + 3, sizeof(actual) - 3));
+
+    omega_byte_t lower_table[256];
+    omega_util_fill_byte_table(lower_table, to_lower, nullptr);
+    REQUIRE(0 == omega_util_apply_byte_table_to_file(MAKE_PATH("test1.dat"),
+                                                     MAKE_PATH("test1.actual.transformed.4.dat"), upper_table, 0, 0));
+    REQUIRE(0 == omega_util_compare_files(MAKE_PATH("test1.expected.transformed.1.dat"),
+                                          MAKE_PATH("test1.actual.transformed.4.dat")));
+    REQUIRE(0 == omega_util_apply_byte_table_to_file(MAKE_PATH("test1.dat"),
+                                                     MAKE_PATH("test1.actual.transformed.5.dat"), lower_table, 37, 10));
+    REQUIRE(0 == omega_util_compare_files(MAKE_PATH("test1.expected.transformed.2.dat"),
+                                          MAKE_PATH("test1.actual.transformed.5.dat")));
+}
+
 TEST_CASE("Null Pointer Safety - Utility", "[NullSafety]") {
     // Buffer shift null safety
     REQUIRE(-1 == omega_util_right_shift_buffer(nullptr, 10, 3, 0));
@@ -137,6 +189,11 @@ TEST_CASE("Null Pointer Safety - Utility", "[NullSafety]") {
 
     // Apply transform null safety (should not crash)
     omega_util_apply_byte_transform(nullptr, 10, to_upper, nullptr);
+    omega_util_apply_byte_table(nullptr, 10, nullptr);
+    omega_util_apply_mask(nullptr, 10, 0xFF, MASK_XOR);
+    omega_util_ascii_to_upper(nullptr, 10);
+    omega_util_ascii_to_lower(nullptr, 10);
+    omega_util_fill_byte_table(nullptr, to_upper, nullptr);
 
     // Write segment null safety
     REQUIRE(-1 == omega_util_write_segment_to_file(nullptr, 0, 10, nullptr));
@@ -147,6 +204,7 @@ TEST_CASE("Null Pointer Safety - Utility", "[NullSafety]") {
     REQUIRE(-1 == omega_util_apply_byte_transform_to_file("test.dat", "out.dat", nullptr, nullptr, 0, 0));
     REQUIRE(-1 == omega_util_apply_byte_transform_to_file("test.dat", "out.dat", to_upper, nullptr, -1, 0));
     REQUIRE(-1 == omega_util_apply_byte_transform_to_file("test.dat", "out.dat", to_upper, nullptr, 0, -1));
+    REQUIRE(-1 == omega_util_apply_byte_table_to_file("test.dat", "out.dat", nullptr, 0, 0));
 
     // String comparison null safety
     REQUIRE(0 == omega_util_strncmp(nullptr, nullptr, 5));
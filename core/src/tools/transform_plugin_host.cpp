@@ -26,7 +26,14 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <cerrno>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #endif
 
 namespace {
@@ -34,6 +41,18 @@ namespace {
     constexpr uint32_t HOST_REQUEST_MAGIC = 0x4F455251U; // OERQ
     constexpr uint32_t HOST_RESPONSE_MAGIC = 0x4F455253U;// OERS
     constexpr uint32_t HOST_PROGRESS_MAGIC = 0x4F455047U;// OEPG
+    constexpr uint32_t HOST_READY_MAGIC = 0x4F455244U;   // OERD
+    constexpr uint32_t HOST_CANCEL_MAGIC = 0x4F45434EU;  // OECN
+    constexpr uint32_t HOST_SHARED_RESPONSE_MAGIC = 0x4F45524DU;// OERM
+    constexpr uint32_t HOST_OUTPUT_MAGIC = 0x4F454F54U;          // OEOT
+    constexpr uint8_t HOST_REQUEST_WANTS_PROGRESS = 0x01U;
+    constexpr uint8_t HOST_REQUEST_WANTS_CANCEL = 0x02U;
+    constexpr uint8_t HOST_REQUEST_SHARED_INPUT = 0x04U;
+    constexpr uint8_t HOST_REQUEST_WANTS_OUTPUT = 0x08U;
+    // Served plugins get allocations at least this large in shared memory, so replacements are handed back by mapping
+    constexpr size_t HOST_SHARED_ALLOC_MIN_BYTES = 4U * 1024U * 1024U;
+    // Streamed replacement chunks are split into output frames no longer than this, which the client relies on
+    constexpr int64_t HOST_OUTPUT_FRAME_BYTES = 1024 * 1024;
 
     struct dynamic_library_t {
 #ifdef _WIN32
@@ -120,17 +139,93 @@ namespace {
                                                         static_cast<std::streamsize>(bytes.size())));
     }
 
+    struct shared_allocation_t {
+        void *data{};
+        size_t size{};
+        int fd = -1;
+        bool is_mapped = true;///< False once unmapped to seal the memory, when data only identifies the allocation
+    };
+
     struct allocation_state_t {
         std::vector<void *> allocations;
+        std::vector<shared_allocation_t> shared_allocations;
+        bool allow_shared{};
     };
 
+#ifndef _WIN32
+    auto create_shared_allocation(size_t size, shared_allocation_t &allocation) -> bool {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+        const auto fd = memfd_create("omega-transform", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+        char path[] = "/tmp/.omega-transform.XXXXXX";
+        const auto fd = mkstemp(path);
+        if (fd >= 0) { unlink(path); }
+#endif
+        if (fd < 0) { return false; }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            return false;
+        }
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        allocation = {data, size, fd};
+        return true;
+    }
+#endif
+
     auto host_alloc(size_t size, void *user_data_ptr) -> void * {
         auto *state = static_cast<allocation_state_t *>(user_data_ptr);
+#ifndef _WIN32
+        shared_allocation_t shared{};
+        if (state && state->allow_shared && size >= HOST_SHARED_ALLOC_MIN_BYTES &&
+            create_shared_allocation(size, shared)) {
+            state->shared_allocations.push_back(shared);
+            state->allocations.push_back(shared.data);
+            return shared.data;
+        }
+#endif
         void *ptr = std::malloc(size == 0 ? 1 : size);
         if (ptr && state) { state->allocations.push_back(ptr); }
         return ptr;
     }
 
+    auto find_shared_allocation(allocation_state_t &state, const void *ptr) -> shared_allocation_t * {
+        const auto iter = std::find_if(state.shared_allocations.begin(), state.shared_allocations.end(),
+                                       [ptr](const auto &allocation) { return allocation.data == ptr; });
+        return iter != state.shared_allocations.end() ? &*iter : nullptr;
+    }
+
+#ifndef _WIN32
+    /*
+     * Seals shared memory against being written, shrunk, or grown before it's handed to the client, which only maps
+     * sealed memory and copies anything else.  Writable shared mappings prevent sealing, so the host's is removed.
+     */
+    void seal_shared_allocation(shared_allocation_t &allocation) {
+        munmap(allocation.data, allocation.size);
+        allocation.is_mapped = false;
+#ifdef F_ADD_SEALS
+        fcntl(allocation.fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE);
+#endif
+    }
+#endif
+
+    void free_allocation(allocation_state_t &state, void *ptr) {
+        const auto iter = std::find_if(state.shared_allocations.begin(), state.shared_allocations.end(),
+                                       [ptr](const auto &allocation) { return allocation.data == ptr; });
+        if (iter == state.shared_allocations.end()) {
+            std::free(ptr);
+            return;
+        }
+#ifndef _WIN32
+        if (iter->is_mapped) { munmap(iter->data, iter->size); }
+        close(iter->fd);
+#endif
+        state.shared_allocations.erase(iter);
+    }
+
     auto response_owns(const omega_transform_plugin_response_t &response, void *ptr) -> bool {
         return ptr == response.replacement_bytes || ptr == response.result_bytes || ptr == response.result_label ||
                ptr == response.result_mime_type;
@@ -138,29 +233,89 @@ namespace {
 
     void release_allocations(allocation_state_t &state, const omega_transform_plugin_response_t &response) {
         for (auto *ptr : state.allocations) {
-            if (!response_owns(response, ptr)) { std::free(ptr); }
+            if (!response_owns(response, ptr)) { free_allocation(state, ptr); }
         }
         state.allocations.clear();
     }
 
-    void clear_response(omega_transform_plugin_response_t &response) {
-        std::free(response.replacement_bytes);
-        std::free(response.result_bytes);
-        std::free(response.result_label);
-        std::free(response.result_mime_type);
+    void clear_response(allocation_state_t &state, omega_transform_plugin_response_t &response) {
+        free_allocation(state, response.replacement_bytes);
+        free_allocation(state, response.result_bytes);
+        free_allocation(state, response.result_label);
+        free_allocation(state, response.result_mime_type);
         response = {};
     }
 
     struct request_input_t {
-        std::vector<omega_byte_t> bytes;
+        const omega_byte_t *bytes{};
+        int64_t length{};
         int64_t session_length{};
     };
 
     struct callback_state_t {
-        std::string progress_path;
-        std::string cancel_path;
+        std::string progress_path{};
+        std::string cancel_path{};
+        std::string output_path{};
+        std::ofstream output{};
+        int channel_fd = -1;
+        bool report_progress{};
+        bool check_cancel{};
+        bool stream_output{};
+        bool cancelled{};
+        int64_t output_length{};
     };
 
+#ifndef _WIN32
+    auto read_fd_exact(int fd, void *buffer, size_t length) -> bool {
+        auto *bytes = static_cast<char *>(buffer);
+        while (length > 0) {
+            const auto count = read(fd, bytes, length);
+            if (count < 0 && errno == EINTR) { continue; }
+            if (count <= 0) { return false; }
+            bytes += count;
+            length -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    auto write_fd_all(int fd, const void *buffer, size_t length) -> bool {
+        const auto *bytes = static_cast<const char *>(buffer);
+        while (length > 0) {
+            const auto count = write(fd, bytes, length);
+            if (count < 0 && errno == EINTR) { continue; }
+            if (count <= 0) { return false; }
+            bytes += count;
+            length -= static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    auto write_frame(int fd, uint32_t magic, const std::string &body) -> bool {
+        const auto length = static_cast<int64_t>(body.size());
+        return write_fd_all(fd, &magic, sizeof(magic)) && write_fd_all(fd, &length, sizeof(length)) &&
+               write_fd_all(fd, body.data(), body.size());
+    }
+
+    // Consumes a cancel frame the client sent while the plugin runs; anything else on the channel is a protocol error
+    auto channel_is_cancelled(callback_state_t &state) -> bool {
+        while (!state.cancelled) {
+            pollfd poll_fd{state.channel_fd, POLLIN, 0};
+            const auto ready = poll(&poll_fd, 1, 0);
+            if (ready < 0 && errno == EINTR) { continue; }
+            if (ready <= 0) { break; }
+            uint32_t magic = 0;
+            int64_t length = 0;
+            if (!read_fd_exact(state.channel_fd, &magic, sizeof(magic)) ||
+                !read_fd_exact(state.channel_fd, &length, sizeof(length)) || magic != HOST_CANCEL_MAGIC ||
+                length != 0) {
+                std::_Exit(1);
+            }
+            state.cancelled = true;
+        }
+        return state.cancelled;
+    }
+#endif
+
     auto host_read(int64_t relative_offset, omega_byte_t *buffer, int64_t length, void *user_data_ptr) -> int64_t {
         auto *input = static_cast<request_input_t *>(user_data_ptr);
         if (!input || !buffer || relative_offset < 0 || length < 0 || relative_offset > input->session_length) {
@@ -168,17 +323,18 @@ namespace {
         }
         const auto available = std::min<int64_t>(input->session_length - relative_offset, length);
         if (available <= 0) { return 0; }
-        if (relative_offset > static_cast<int64_t>(input->bytes.size()) ||
-            available > static_cast<int64_t>(input->bytes.size()) - relative_offset) {
-            return -1;
-        }
-        std::memcpy(buffer, input->bytes.data() + relative_offset, static_cast<size_t>(available));
+        if (relative_offset > input->length || available > input->length - relative_offset) { return -1; }
+        std::memcpy(buffer, input->bytes + relative_offset, static_cast<size_t>(available));
         return available;
     }
 
     auto host_is_cancelled(void *user_data_ptr) -> int {
         auto *state = static_cast<callback_state_t *>(user_data_ptr);
-        if (!state || state->cancel_path.empty()) { return 0; }
+        if (!state) { return 0; }
+#ifndef _WIN32
+        if (state->channel_fd >= 0) { return channel_is_cancelled(*state) ? 1 : 0; }
+#endif
+        if (state->cancel_path.empty()) { return 0; }
 
         std::ifstream in(state->cancel_path, std::ios::binary);
         uint8_t cancel = 0;
@@ -188,6 +344,18 @@ namespace {
     auto host_progress(const omega_transform_plugin_progress_t *progress_ptr, void *user_data_ptr) -> int {
         auto *state = static_cast<callback_state_t *>(user_data_ptr);
         if (!state || !progress_ptr) { return 0; }
+#ifndef _WIN32
+        if (state->channel_fd >= 0) {
+            std::ostringstream out;
+            if (!write_pod(out, progress_ptr->processed_bytes) || !write_pod(out, progress_ptr->total_bytes) ||
+                !write_pod(out, progress_ptr->percent) || !write_pod(out, progress_ptr->flags) ||
+                !write_string(out, progress_ptr->phase) || !write_string(out, progress_ptr->message) ||
+                !write_frame(state->channel_fd, HOST_PROGRESS_MAGIC, out.str())) {
+                return -1;
+            }
+            return host_is_cancelled(user_data_ptr);
+        }
+#endif
         if (!state->progress_path.empty()) {
             std::ofstream out(state->progress_path, std::ios::binary | std::ios::app);
             if (!out || !write_pod(out, HOST_PROGRESS_MAGIC) || !write_pod(out, progress_ptr->processed_bytes) ||
@@ -200,14 +368,49 @@ namespace {
         return host_is_cancelled(user_data_ptr);
     }
 
+    // Streamed replacement chunks go to the client as output frames when served, or are appended to the output file
+    auto host_write(const omega_byte_t *bytes, int64_t length, void *user_data_ptr) -> int {
+        auto *state = static_cast<callback_state_t *>(user_data_ptr);
+        if (!state || length < 0 || (!bytes && length > 0) || state->output_length > INT64_MAX - length) { return -1; }
+        if (length == 0) { return 0; }
+#ifndef _WIN32
+        if (state->channel_fd >= 0) {
+            const auto magic = HOST_OUTPUT_MAGIC;
+            for (int64_t written = 0; written < length;) {
+                const auto frame_length = std::min(length - written, HOST_OUTPUT_FRAME_BYTES);
+                if (!write_fd_all(state->channel_fd, &magic, sizeof(magic)) ||
+                    !write_fd_all(state->channel_fd, &frame_length, sizeof(frame_length)) ||
+                    !write_fd_all(state->channel_fd, bytes + written, static_cast<size_t>(frame_length))) {
+                    return -1;
+                }
+                written += frame_length;
+            }
+            state->output_length += length;
+            return 0;
+        }
+#endif
+        if (!state->output.is_open()) {
+            state->output.open(state->output_path, std::ios::binary | std::ios::trunc);
+            if (!state->output) { return -1; }
+        }
+        if (!state->output.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(length))) {
+            return -1;
+        }
+        state->output_length += length;
+        return 0;
+    }
+
     struct apply_request_t {
         int64_t session_offset{};
         int64_t session_length{};
+        int64_t range_offset{};
         int64_t preferred_chunk_size{};
         std::string options_json;
         std::vector<omega_byte_t> input;
+        const omega_byte_t *mapped_input{};
         std::string progress_path;
         std::string cancel_path;
+        std::string output_path;
     };
 
     auto load_plugin(const char *plugin_path, dynamic_library_t &library, omega_transform_plugin_get_info_fn &get_info,
@@ -234,9 +437,10 @@ namespace {
 
         return write_pod(out, info.abi_version) && write_pod(out, static_cast<int32_t>(info.operation)) &&
                write_pod(out, info.flags) && write_pod(out, static_cast<int32_t>(info.support)) &&
-               write_string(out, info.id) && write_string(out, info.name) && write_string(out, info.description) &&
-               write_string(out, info.help) && write_string(out, info.example) &&
-               write_string(out, info.default_args) && write_string(out, info.args_schema);
+               write_pod(out, info.chunk_alignment) && write_string(out, info.id) && write_string(out, info.name) &&
+               write_string(out, info.description) && write_string(out, info.help) &&
+               write_string(out, info.example) && write_string(out, info.default_args) &&
+               write_string(out, info.args_schema);
     }
 
     auto read_apply_request(const char *request_path, apply_request_t &request) -> bool {
@@ -244,17 +448,18 @@ namespace {
         uint32_t magic = 0;
         if (!in || !read_pod(in, magic) || magic != HOST_REQUEST_MAGIC) { return false; }
         return read_pod(in, request.session_offset) && read_pod(in, request.session_length) &&
-               read_pod(in, request.preferred_chunk_size) && request.session_offset >= 0 &&
-               request.session_length >= 0 && request.preferred_chunk_size >= 0 &&
+               read_pod(in, request.range_offset) && read_pod(in, request.preferred_chunk_size) &&
+               request.session_offset >= 0 && request.session_length >= 0 && request.range_offset >= 0 &&
+               request.preferred_chunk_size >= 0 &&
                read_string(in, request.options_json) && read_bytes(in, request.input) &&
                static_cast<int64_t>(request.input.size()) == request.session_length &&
-               read_string(in, request.progress_path) && read_string(in, request.cancel_path);
+               read_string(in, request.progress_path) && read_string(in, request.cancel_path) &&
+               read_string(in, request.output_path);
     }
 
-    auto write_apply_response(const char *response_path, int32_t status,
-                              const omega_transform_plugin_response_t &response) -> bool {
-        std::ofstream out(response_path, std::ios::binary | std::ios::trunc);
-        if (!out || !write_pod(out, HOST_RESPONSE_MAGIC) || !write_pod(out, status)) { return false; }
+    auto write_apply_response_body(std::ostream &out, int32_t status,
+                                   const omega_transform_plugin_response_t &response) -> bool {
+        if (!write_pod(out, status)) { return false; }
         if (status != 0) { return true; }
         return write_pod(out, response.flags) &&
                write_bytes(out, response.replacement_bytes, response.replacement_length) &&
@@ -263,6 +468,56 @@ namespace {
                write_optional_string(out, response.result_mime_type);
     }
 
+    auto write_apply_response(const char *response_path, int32_t status,
+                              const omega_transform_plugin_response_t &response) -> bool {
+        std::ofstream out(response_path, std::ios::binary | std::ios::trunc);
+        return out && write_pod(out, HOST_RESPONSE_MAGIC) && write_apply_response_body(out, status, response);
+    }
+
+    auto apply_request(omega_transform_plugin_apply_fn apply, const apply_request_t &host_request,
+                       callback_state_t &callbacks, allocation_state_t &allocation_state,
+                       omega_transform_plugin_response_t &response) -> int32_t {
+        request_input_t input{host_request.mapped_input, host_request.session_length, host_request.session_length};
+        if (!input.bytes) {
+            input.bytes = host_request.input.empty() ? nullptr : host_request.input.data();
+            input.length = static_cast<int64_t>(host_request.input.size());
+        }
+        omega_transform_plugin_request_t request{};
+        request.input_bytes = input.bytes;
+        request.input_length = input.length;
+        request.session_offset = host_request.session_offset;
+        request.session_length = host_request.session_length;
+        request.options_json = host_request.options_json.empty() ? nullptr : host_request.options_json.c_str();
+        request.alloc = host_alloc;
+        request.allocator_user_data_ptr = &allocation_state;
+        request.read = host_read;
+        request.reader_user_data_ptr = &input;
+        request.preferred_chunk_size = host_request.preferred_chunk_size;
+        request.progress = callbacks.report_progress ? host_progress : nullptr;
+        request.progress_user_data_ptr = &callbacks;
+        request.is_cancelled = callbacks.check_cancel ? host_is_cancelled : nullptr;
+        request.cancel_user_data_ptr = &callbacks;
+        request.write = callbacks.stream_output ? host_write : nullptr;
+        request.writer_user_data_ptr = &callbacks;
+        request.range_offset = host_request.range_offset;
+
+        auto status = apply(&request, &response) == 0 ? 0 : -1;
+        release_allocations(allocation_state, response);
+
+        // A streamed replacement must account for exactly the chunks written, and nothing may be written otherwise
+        const auto streamed = (response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_STREAMED_REPLACEMENT) != 0U;
+        if (streamed ? response.replacement_bytes || response.replacement_length != callbacks.output_length
+                     : callbacks.output_length != 0) {
+            status = -1;
+        }
+        if (callbacks.output.is_open()) {
+            callbacks.output.close();
+            if (callbacks.output.fail()) { status = -1; }
+        }
+        if (status == 0 && streamed) { response.replacement_length = 0; }
+        return status;
+    }
+
     auto run_apply(const char *plugin_path, const char *request_path, const char *response_path) -> bool {
         dynamic_library_t library(plugin_path);
         omega_transform_plugin_get_info_fn get_info = nullptr;
@@ -278,42 +533,218 @@ namespace {
             return write_apply_response(response_path, -1, empty);
         }
 
+        callback_state_t callbacks{std::move(host_request.progress_path), std::move(host_request.cancel_path),
+                                   std::move(host_request.output_path)};
+        callbacks.report_progress = !callbacks.progress_path.empty();
+        callbacks.check_cancel = !callbacks.cancel_path.empty();
+        callbacks.stream_output = !callbacks.output_path.empty();
         allocation_state_t allocation_state;
-        request_input_t input{std::move(host_request.input), host_request.session_length};
-        callback_state_t callbacks{std::move(host_request.progress_path), std::move(host_request.cancel_path)};
-        omega_transform_plugin_request_t request{};
-        request.input_bytes = input.bytes.empty() ? nullptr : input.bytes.data();
-        request.input_length = static_cast<int64_t>(input.bytes.size());
-        request.session_offset = host_request.session_offset;
-        request.session_length = host_request.session_length;
-        request.options_json = host_request.options_json.empty() ? nullptr : host_request.options_json.c_str();
-        request.alloc = host_alloc;
-        request.allocator_user_data_ptr = &allocation_state;
-        request.read = host_read;
-        request.reader_user_data_ptr = &input;
-        request.preferred_chunk_size = host_request.preferred_chunk_size;
-        request.progress = callbacks.progress_path.empty() ? nullptr : host_progress;
-        request.progress_user_data_ptr = &callbacks;
-        request.is_cancelled = callbacks.cancel_path.empty() ? nullptr : host_is_cancelled;
-        request.cancel_user_data_ptr = &callbacks;
-
         omega_transform_plugin_response_t response{};
-        const int32_t status = apply(&request, &response) == 0 ? 0 : -1;
-        release_allocations(allocation_state, response);
+        const auto status = apply_request(apply, host_request, callbacks, allocation_state, response);
         const auto wrote_response = write_apply_response(response_path, status, response);
-        clear_response(response);
+        clear_response(allocation_state, response);
         return wrote_response;
     }
+
+#ifndef _WIN32
+    template<typename T>
+    auto read_fd_pod(int fd, T &value) -> bool {
+        return read_fd_exact(fd, &value, sizeof(T));
+    }
+
+    auto read_fd_string(int fd, std::string &value) -> bool {
+        int64_t length = 0;
+        if (!read_fd_pod(fd, length) || length < 0) { return false; }
+        value.assign(static_cast<size_t>(length), '\0');
+        return length == 0 || read_fd_exact(fd, value.data(), value.size());
+    }
+
+    auto read_fd_bytes(int fd, std::vector<omega_byte_t> &bytes) -> bool {
+        int64_t length = 0;
+        if (!read_fd_pod(fd, length) || length < 0) { return false; }
+        bytes.assign(static_cast<size_t>(length), omega_byte_t{});
+        return length == 0 || read_fd_exact(fd, bytes.data(), bytes.size());
+    }
+
+    // Descriptors travel as ancillary data on a single marker byte that follows the frame they belong to
+    auto read_fd_descriptor(int fd, int &descriptor) -> bool {
+        char marker = 0;
+        iovec iov{&marker, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t count = 0;
+        do { count = recvmsg(fd, &message, 0); } while (count < 0 && errno == EINTR);
+        const auto *header = CMSG_FIRSTHDR(&message);
+        if (count != 1 || !header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            return false;
+        }
+        std::memcpy(&descriptor, CMSG_DATA(header), sizeof(int));
+        return true;
+    }
+
+    auto write_fd_descriptor(int fd, int descriptor) -> bool {
+        char marker = 0;
+        iovec iov{&marker, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        auto *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &descriptor, sizeof(int));
+        ssize_t count = 0;
+        do { count = sendmsg(fd, &message, 0); } while (count < 0 && errno == EINTR);
+        return count == 1;
+    }
+
+    class mapped_input_t {
+    public:
+        mapped_input_t() = default;
+        mapped_input_t(const mapped_input_t &) = delete;
+        auto operator=(const mapped_input_t &) -> mapped_input_t & = delete;
+        ~mapped_input_t() { reset(); }
+
+        auto map(int descriptor, int64_t length) -> const omega_byte_t * {
+            reset();
+            void *data = length > 0 ? mmap(nullptr, static_cast<size_t>(length), PROT_READ, MAP_SHARED, descriptor, 0)
+                                    : MAP_FAILED;
+            close(descriptor);
+            if (data == MAP_FAILED) { return nullptr; }
+            data_ = data;
+            size_ = static_cast<size_t>(length);
+            return static_cast<const omega_byte_t *>(data_);
+        }
+
+        void reset() {
+            if (data_) { munmap(data_, size_); }
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+    private:
+        void *data_{};
+        size_t size_{};
+    };
+
+    // Reads the next request from the client, skipping cancel frames that arrived after their request completed
+    auto read_served_request(int fd, apply_request_t &request, uint8_t &request_flags, mapped_input_t &mapped_input)
+            -> bool {
+        uint32_t magic = 0;
+        int64_t length = 0;
+        do {
+            if (!read_fd_pod(fd, magic) || !read_fd_pod(fd, length)) { return false; }
+        } while (magic == HOST_CANCEL_MAGIC && length == 0);
+        if (magic != HOST_REQUEST_MAGIC || length < 0) { return false; }
+
+        request = {};
+        request_flags = 0;
+        mapped_input.reset();
+        if (!read_fd_pod(fd, request.session_offset) || !read_fd_pod(fd, request.session_length) ||
+            !read_fd_pod(fd, request.range_offset) || !read_fd_pod(fd, request.preferred_chunk_size) ||
+            !read_fd_pod(fd, request_flags) || request.session_offset < 0 || request.session_length < 0 ||
+            request.range_offset < 0 || request.preferred_chunk_size < 0 || !read_fd_string(fd, request.options_json)) {
+            return false;
+        }
+        const auto header_length =
+                static_cast<int64_t>(6 * sizeof(int64_t) + sizeof(uint8_t) + request.options_json.size());
+        if ((request_flags & HOST_REQUEST_SHARED_INPUT) == 0U) {
+            return read_fd_bytes(fd, request.input) &&
+                   static_cast<int64_t>(request.input.size()) == request.session_length &&
+                   length == header_length + request.session_length;
+        }
+
+        int64_t input_length = 0;
+        int descriptor = -1;
+        if (!read_fd_pod(fd, input_length) || input_length != request.session_length || length != header_length ||
+            !read_fd_descriptor(fd, descriptor)) {
+            return false;
+        }
+        request.mapped_input = mapped_input.map(descriptor, input_length);
+        return request.mapped_input != nullptr;
+    }
+
+    // Replacements in shared memory are handed back by descriptor instead of being copied through the channel
+    auto write_served_response(int fd, int32_t status, allocation_state_t &allocation_state,
+                               const omega_transform_plugin_response_t &response) -> bool {
+        auto *shared = status == 0 ? find_shared_allocation(allocation_state, response.replacement_bytes) : nullptr;
+        std::ostringstream body;
+        if (!shared || response.replacement_length <= 0 ||
+            static_cast<uint64_t>(response.replacement_length) > shared->size) {
+            return write_apply_response_body(body, status, response) &&
+                   write_frame(fd, HOST_RESPONSE_MAGIC, body.str());
+        }
+        seal_shared_allocation(*shared);
+        return write_pod(body, status) && write_pod(body, response.flags) &&
+               write_pod(body, response.replacement_length) &&
+               write_bytes(body, response.result_bytes, response.result_length) &&
+               write_optional_string(body, response.result_label) &&
+               write_optional_string(body, response.result_mime_type) &&
+               write_frame(fd, HOST_SHARED_RESPONSE_MAGIC, body.str()) && write_fd_descriptor(fd, shared->fd);
+    }
+
+    // Loads the plugin once and applies requests read from standard input until the client closes the channel.  The
+    // channel is moved off the standard descriptors first so plugin output cannot corrupt the protocol.
+    auto run_serve(const char *plugin_path) -> int {
+        const auto channel_fd = dup(STDIN_FILENO);
+        const auto null_fd = open("/dev/null", O_RDONLY);
+        if (channel_fd < 0 || null_fd < 0 || dup2(null_fd, STDIN_FILENO) < 0 ||
+            dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+            return 1;
+        }
+        close(null_fd);
+
+        dynamic_library_t library(plugin_path);
+        omega_transform_plugin_get_info_fn get_info = nullptr;
+        omega_transform_plugin_apply_fn apply = nullptr;
+        const int32_t ready_status = load_plugin(plugin_path, library, get_info, apply) ? 0 : -1;
+        std::ostringstream ready;
+        if (!write_pod(ready, ready_status) || !write_frame(channel_fd, HOST_READY_MAGIC, ready.str())) { return 1; }
+        if (ready_status != 0) { return 1; }
+
+        apply_request_t host_request;
+        uint8_t request_flags = 0;
+        mapped_input_t mapped_input;
+        while (read_served_request(channel_fd, host_request, request_flags, mapped_input)) {
+            callback_state_t callbacks{};
+            callbacks.channel_fd = channel_fd;
+            callbacks.report_progress = (request_flags & HOST_REQUEST_WANTS_PROGRESS) != 0U;
+            callbacks.check_cancel = (request_flags & HOST_REQUEST_WANTS_CANCEL) != 0U;
+            callbacks.stream_output = (request_flags & HOST_REQUEST_WANTS_OUTPUT) != 0U;
+
+            allocation_state_t allocation_state;
+            allocation_state.allow_shared = true;
+            omega_transform_plugin_response_t response{};
+            const auto status = apply_request(apply, host_request, callbacks, allocation_state, response);
+            mapped_input.reset();
+            const auto wrote_response = write_served_response(channel_fd, status, allocation_state, response);
+            clear_response(allocation_state, response);
+            if (!wrote_response) { return 1; }
+        }
+        return 0;
+    }
+#endif
 }// namespace
 
 int main(int argc, char **argv) {
-    if (argc != 4 && argc != 5) {
+    if (argc != 3 && argc != 4 && argc != 5) {
         std::cerr << "usage: omega-transform-plugin-host --get-info <plugin> <response>\n"
-                  << "       omega-transform-plugin-host --apply <plugin> <request> <response>\n";
+                  << "       omega-transform-plugin-host --apply <plugin> <request> <response>\n"
+                  << "       omega-transform-plugin-host --serve <plugin>\n";
         return 2;
     }
 
     const std::string command = argv[1] ? argv[1] : "";
+#ifndef _WIN32
+    if (command == "--serve" && argc == 3) { return run_serve(argv[2]); }
+#endif
     if (command == "--get-info" && argc == 4) { return write_info_response(argv[2], argv[3]) ? 0 : 1; }
     if (command == "--apply" && argc == 5) { return run_apply(argv[2], argv[3], argv[4]) ? 0 : 1; }
     return 2;
@@ -53,6 +53,7 @@ import type { ReplaceSessionCheckpointedResponse } from './omega_edit'
 import type { ReplaceSessionCheckpointedRequest } from './omega_edit'
 import type { ReplaceSessionResponse } from './omega_edit'
 import type { ReplaceSessionRequest } from './omega_edit'
+import type { SearchSessionStreamResponse } from './omega_edit'
 import type { SearchSessionResponse } from './omega_edit'
 import type { SearchSessionRequest } from './omega_edit'
 import type { GetSegmentResponse } from './omega_edit'
@@ -1465,6 +1466,7 @@ export interface IEditorServiceClient {
   /**
    * Search for a byte pattern in a session.  Supports case-insensitive and
    * reverse search, with optional offset/length bounds and a match limit.
+   * Setting patterns finds all of them in a single forward pass.
    *
    * @generated from protobuf rpc: SearchSession
    */
@@ -1500,6 +1502,23 @@ export interface IEditorServiceClient {
       value?: SearchSessionResponse
     ) => void
   ): grpc.ClientUnaryCall
+  /**
+   * Stream the matches of a single byte pattern in batches as they are found.
+   * Matches are those of the session content when the search started, even if
+   * the session is edited meanwhile, since the session is only locked while a
+   * batch is found.  Not capped by the search match resource limit.
+   *
+   * @generated from protobuf rpc: SearchSessionStream
+   */
+  searchSessionStream(
+    input: SearchSessionRequest,
+    metadata?: grpc.Metadata,
+    options?: grpc.CallOptions
+  ): grpc.ClientReadableStream<SearchSessionStreamResponse>
+  searchSessionStream(
+    input: SearchSessionRequest,
+    options?: grpc.CallOptions
+  ): grpc.ClientReadableStream<SearchSessionStreamResponse>
   /**
    * Replace non-overlapping matches in a session range by applying a native
    * transactional edit script. Returns the number of matches selected and the
@@ -3531,6 +3550,7 @@ export class EditorServiceClient
   /**
    * Search for a byte pattern in a session.  Supports case-insensitive and
    * reverse search, with optional offset/length bounds and a match limit.
+   * Setting patterns finds all of them in a single forward pass.
    *
    * @generated from protobuf rpc: SearchSession
    */
@@ -3567,6 +3587,34 @@ export class EditorServiceClient
       callback as any
     )
   }
+  /**
+   * Stream the matches of a single byte pattern in batches as they are found.
+   * Matches are those of the session content when the search started, even if
+   * the session is edited meanwhile, since the session is only locked while a
+   * batch is found.  Not capped by the search match resource limit.
+   *
+   * @generated from protobuf rpc: SearchSessionStream
+   */
+  searchSessionStream(
+    input: SearchSessionRequest,
+    metadata?: grpc.Metadata | grpc.CallOptions,
+    options?: grpc.CallOptions
+  ): grpc.ClientReadableStream<SearchSessionStreamResponse> {
+    const method = EditorService.methods[36]
+    return this.makeServerStreamRequest<
+      SearchSessionRequest,
+      SearchSessionStreamResponse
+    >(
+      `/${EditorService.typeName}/${method.name}`,
+      (value: SearchSessionRequest): Buffer =>
+        Buffer.from(method.I.toBinary(value, this._binaryOptions)),
+      (value: Buffer): SearchSessionStreamResponse =>
+        method.O.fromBinary(value, this._binaryOptions),
+      input,
+      metadata as any,
+      options
+    )
+  }
   /**
    * Replace non-overlapping matches in a session range by applying a native
    * transactional edit script. Returns the number of matches selected and the
@@ -3594,7 +3642,7 @@ export class EditorServiceClient
       value?: ReplaceSessionResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[36]
+    const method = EditorService.methods[37]
     return this.makeUnaryRequest<ReplaceSessionRequest, ReplaceSessionResponse>(
       `/${EditorService.typeName}/${method.name}`,
       (value: ReplaceSessionRequest): Buffer =>
@@ -3634,7 +3682,7 @@ export class EditorServiceClient
       value?: ReplaceSessionCheckpointedResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[37]
+    const method = EditorService.methods[38]
     return this.makeUnaryRequest<
       ReplaceSessionCheckpointedRequest,
       ReplaceSessionCheckpointedResponse
@@ -3675,7 +3723,7 @@ export class EditorServiceClient
       value?: CreateCheckpointResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[38]
+    const method = EditorService.methods[39]
     return this.makeUnaryRequest<
       CreateCheckpointRequest,
       CreateCheckpointResponse
@@ -3717,7 +3765,7 @@ export class EditorServiceClient
       value?: DestroyLastCheckpointResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[39]
+    const method = EditorService.methods[40]
     return this.makeUnaryRequest<
       DestroyLastCheckpointRequest,
       DestroyLastCheckpointResponse
@@ -3758,7 +3806,7 @@ export class EditorServiceClient
       value?: CheckoutCheckpointResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[40]
+    const method = EditorService.methods[41]
     return this.makeUnaryRequest<
       CheckoutCheckpointRequest,
       CheckoutCheckpointResponse
@@ -3799,7 +3847,7 @@ export class EditorServiceClient
       value?: DiscardCheckpointFutureResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[41]
+    const method = EditorService.methods[42]
     return this.makeUnaryRequest<
       DiscardCheckpointFutureRequest,
       DiscardCheckpointFutureResponse
@@ -3841,7 +3889,7 @@ export class EditorServiceClient
       value?: RestoreLastCheckpointResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[42]
+    const method = EditorService.methods[43]
     return this.makeUnaryRequest<
       RestoreLastCheckpointRequest,
       RestoreLastCheckpointResponse
@@ -3882,7 +3930,7 @@ export class EditorServiceClient
       value?: ListTransformPluginsResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[43]
+    const method = EditorService.methods[44]
     return this.makeUnaryRequest<
       ListTransformPluginsRequest,
       ListTransformPluginsResponse
@@ -3924,7 +3972,7 @@ export class EditorServiceClient
       value?: ApplyTransformPluginResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[44]
+    const method = EditorService.methods[45]
     return this.makeUnaryRequest<
       ApplyTransformPluginRequest,
       ApplyTransformPluginResponse
@@ -3966,7 +4014,7 @@ export class EditorServiceClient
       value?: GetByteFrequencyProfileResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[45]
+    const method = EditorService.methods[46]
     return this.makeUnaryRequest<
       GetByteFrequencyProfileRequest,
       GetByteFrequencyProfileResponse
@@ -4008,7 +4056,7 @@ export class EditorServiceClient
       value?: GetCharacterCountsResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[46]
+    const method = EditorService.methods[47]
     return this.makeUnaryRequest<
       GetCharacterCountsRequest,
       GetCharacterCountsResponse
@@ -4053,7 +4101,7 @@ export class EditorServiceClient
       value?: ServerControlResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[47]
+    const method = EditorService.methods[48]
     return this.makeUnaryRequest<ServerControlRequest, ServerControlResponse>(
       `/${EditorService.typeName}/${method.name}`,
       (value: ServerControlRequest): Buffer =>
@@ -4086,7 +4134,7 @@ export class EditorServiceClient
       value?: GetHeartbeatResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[48]
+    const method = EditorService.methods[49]
     return this.makeUnaryRequest<GetHeartbeatRequest, GetHeartbeatResponse>(
       `/${EditorService.typeName}/${method.name}`,
       (value: GetHeartbeatRequest): Buffer =>
@@ -4115,7 +4163,7 @@ export class EditorServiceClient
     metadata?: grpc.Metadata | grpc.CallOptions,
     options?: grpc.CallOptions
   ): grpc.ClientReadableStream<SubscribeToSessionEventsResponse> {
-    const method = EditorService.methods[49]
+    const method = EditorService.methods[50]
     return this.makeServerStreamRequest<
       SubscribeToSessionEventsRequest,
       SubscribeToSessionEventsResponse
@@ -4141,7 +4189,7 @@ export class EditorServiceClient
     metadata?: grpc.Metadata | grpc.CallOptions,
     options?: grpc.CallOptions
   ): grpc.ClientReadableStream<SubscribeToViewportEventsResponse> {
-    const method = EditorService.methods[50]
+    const method = EditorService.methods[51]
     return this.makeServerStreamRequest<
       SubscribeToViewportEventsRequest,
       SubscribeToViewportEventsResponse
@@ -4181,7 +4229,7 @@ export class EditorServiceClient
       value?: UnsubscribeToSessionEventsResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[51]
+    const method = EditorService.methods[52]
     return this.makeUnaryRequest<
       UnsubscribeToSessionEventsRequest,
       UnsubscribeToSessionEventsResponse
@@ -4222,7 +4270,7 @@ export class EditorServiceClient
       value?: UnsubscribeToViewportEventsResponse
     ) => void
   ): grpc.ClientUnaryCall {
-    const method = EditorService.methods[52]
+    const method = EditorService.methods[53]
     return this.makeUnaryRequest<
       UnsubscribeToViewportEventsRequest,
       UnsubscribeToViewportEventsResponse
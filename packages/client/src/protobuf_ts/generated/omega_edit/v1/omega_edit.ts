@@ -199,6 +199,13 @@ export interface CreateSessionRequest {
    * @generated from protobuf field: optional bytes initial_data = 4
    */
   initialData?: Uint8Array
+  /**
+   * Read file_path directly and copy its snapshot in the background, rather than copying it before the session is
+   * created.  Opening large files is then instant on filesystems that can't clone files.
+   *
+   * @generated from protobuf field: optional bool lazy_snapshot = 5
+   */
+  lazySnapshot?: boolean
 }
 /**
  * Response after a session is successfully created.
@@ -253,6 +260,13 @@ export interface SaveSessionRequest {
    * @generated from protobuf field: optional omega_edit.v1.SessionContentFingerprint expected_original_fingerprint = 6
    */
   expectedOriginalFingerprint?: SessionContentFingerprint
+  /**
+   * Write only the changed byte ranges into the original file, through a journal that rolls back an interrupted save,
+   * when the session keeps the original length.  Other saves replace the whole file as usual.
+   *
+   * @generated from protobuf field: optional bool in_place = 7
+   */
+  inPlace?: boolean
 }
 /**
  * Response after a save operation.
@@ -1810,6 +1824,10 @@ export interface SearchSessionRequest {
    * @generated from protobuf field: optional int64 limit = 7
    */
   limit?: number // Maximum number of matches to return (0 = unlimited).
+  /**
+   * @generated from protobuf field: repeated bytes patterns = 8
+   */
+  patterns: Uint8Array[] // Patterns to find in one forward pass instead of pattern.
 }
 /**
  * Search results.
@@ -1845,6 +1863,21 @@ export interface SearchSessionResponse {
    * @generated from protobuf field: repeated int64 match_offset = 7
    */
   matchOffset: number[] // Byte offsets of each match.
+  /**
+   * @generated from protobuf field: repeated int32 match_pattern = 8
+   */
+  matchPattern: number[] // Index in patterns of each match (multi-pattern searches only).
+}
+/**
+ * A batch of streamed search results.
+ *
+ * @generated from protobuf message omega_edit.v1.SearchSessionStreamResponse
+ */
+export interface SearchSessionStreamResponse {
+  /**
+   * @generated from protobuf field: repeated int64 match_offset = 1
+   */
+  matchOffset: number[] // Byte offsets of the matches found since the previous batch.
 }
 /**
  * Request to replace non-overlapping matches in a session range transactionally.
@@ -3882,6 +3915,13 @@ class CreateSessionRequest$Type extends MessageType<CreateSessionRequest> {
         opt: true,
         T: 12 /*ScalarType.BYTES*/,
       },
+      {
+        no: 5,
+        name: 'lazy_snapshot',
+        kind: 'scalar',
+        opt: true,
+        T: 8 /*ScalarType.BOOL*/,
+      },
     ])
   }
   create(value?: PartialMessage<CreateSessionRequest>): CreateSessionRequest {
@@ -3913,6 +3953,9 @@ class CreateSessionRequest$Type extends MessageType<CreateSessionRequest> {
         case /* optional bytes initial_data */ 4:
           message.initialData = reader.bytes()
           break
+        case /* optional bool lazy_snapshot */ 5:
+          message.lazySnapshot = reader.bool()
+          break
         default:
           let u = options.readUnknownField
           if (u === 'throw')
@@ -3951,6 +3994,9 @@ class CreateSessionRequest$Type extends MessageType<CreateSessionRequest> {
     /* optional bytes initial_data = 4; */
     if (message.initialData !== undefined)
       writer.tag(4, WireType.LengthDelimited).bytes(message.initialData)
+    /* optional bool lazy_snapshot = 5; */
+    if (message.lazySnapshot !== undefined)
+      writer.tag(5, WireType.Varint).bool(message.lazySnapshot)
     let u = options.writeUnknownFields
     if (u !== false)
       (u == true ? UnknownFieldHandler.onWrite : u)(
@@ -4092,6 +4138,13 @@ class SaveSessionRequest$Type extends MessageType<SaveSessionRequest> {
         kind: 'message',
         T: () => SessionContentFingerprint,
       },
+      {
+        no: 7,
+        name: 'in_place',
+        kind: 'scalar',
+        opt: true,
+        T: 8 /*ScalarType.BOOL*/,
+      },
     ])
   }
   create(value?: PartialMessage<SaveSessionRequest>): SaveSessionRequest {
@@ -4138,6 +4191,9 @@ class SaveSessionRequest$Type extends MessageType<SaveSessionRequest> {
               message.expectedOriginalFingerprint
             )
           break
+        case /* optional bool in_place */ 7:
+          message.inPlace = reader.bool()
+          break
         default:
           let u = options.readUnknownField
           if (u === 'throw')
@@ -4184,6 +4240,9 @@ class SaveSessionRequest$Type extends MessageType<SaveSessionRequest> {
         writer.tag(6, WireType.LengthDelimited).fork(),
         options
       ).join()
+    /* optional bool in_place = 7; */
+    if (message.inPlace !== undefined)
+      writer.tag(7, WireType.Varint).bool(message.inPlace)
     let u = options.writeUnknownFields
     if (u !== false)
       (u == true ? UnknownFieldHandler.onWrite : u)(
@@ -12139,12 +12198,20 @@ class SearchSessionRequest$Type extends MessageType<SearchSessionRequest> {
         T: 3 /*ScalarType.INT64*/,
         L: 2 /*LongType.NUMBER*/,
       },
+      {
+        no: 8,
+        name: 'patterns',
+        kind: 'scalar',
+        repeat: 2 /*RepeatType.UNPACKED*/,
+        T: 12 /*ScalarType.BYTES*/,
+      },
     ])
   }
   create(value?: PartialMessage<SearchSessionRequest>): SearchSessionRequest {
     const message = globalThis.Object.create(this.messagePrototype!)
     message.sessionId = ''
     message.pattern = new Uint8Array(0)
+    message.patterns = []
     if (value !== undefined)
       reflectionMergePartial<SearchSessionRequest>(this, message, value)
     return message
@@ -12181,6 +12248,9 @@ class SearchSessionRequest$Type extends MessageType<SearchSessionRequest> {
         case /* optional int64 limit */ 7:
           message.limit = reader.int64().toNumber()
           break
+        case /* repeated bytes patterns */ 8:
+          message.patterns.push(reader.bytes())
+          break
         default:
           let u = options.readUnknownField
           if (u === 'throw')
@@ -12226,6 +12296,9 @@ class SearchSessionRequest$Type extends MessageType<SearchSessionRequest> {
     /* optional int64 limit = 7; */
     if (message.limit !== undefined)
       writer.tag(7, WireType.Varint).int64(message.limit)
+    /* repeated bytes patterns = 8; */
+    for (let i = 0; i < message.patterns.length; i++)
+      writer.tag(8, WireType.LengthDelimited).bytes(message.patterns[i])
     let u = options.writeUnknownFields
     if (u !== false)
       (u == true ? UnknownFieldHandler.onWrite : u)(
@@ -12279,6 +12352,13 @@ class SearchSessionResponse$Type extends MessageType<SearchSessionResponse> {
         T: 3 /*ScalarType.INT64*/,
         L: 2 /*LongType.NUMBER*/,
       },
+      {
+        no: 8,
+        name: 'match_pattern',
+        kind: 'scalar',
+        repeat: 1 /*RepeatType.PACKED*/,
+        T: 5 /*ScalarType.INT32*/,
+      },
     ])
   }
   create(value?: PartialMessage<SearchSessionResponse>): SearchSessionResponse {
@@ -12290,6 +12370,7 @@ class SearchSessionResponse$Type extends MessageType<SearchSessionResponse> {
     message.offset = 0
     message.length = 0
     message.matchOffset = []
+    message.matchPattern = []
     if (value !== undefined)
       reflectionMergePartial<SearchSessionResponse>(this, message, value)
     return message
@@ -12329,6 +12410,12 @@ class SearchSessionResponse$Type extends MessageType<SearchSessionResponse> {
               message.matchOffset.push(reader.int64().toNumber())
           else message.matchOffset.push(reader.int64().toNumber())
           break
+        case /* repeated int32 match_pattern */ 8:
+          if (wireType === WireType.LengthDelimited)
+            for (let e = reader.int32() + reader.pos; reader.pos < e; )
+              message.matchPattern.push(reader.int32())
+          else message.matchPattern.push(reader.int32())
+          break
         default:
           let u = options.readUnknownField
           if (u === 'throw')
@@ -12378,6 +12465,13 @@ class SearchSessionResponse$Type extends MessageType<SearchSessionResponse> {
         writer.int64(message.matchOffset[i])
       writer.join()
     }
+    /* repeated int32 match_pattern = 8; */
+    if (message.matchPattern.length) {
+      writer.tag(8, WireType.LengthDelimited).fork()
+      for (let i = 0; i < message.matchPattern.length; i++)
+        writer.int32(message.matchPattern[i])
+      writer.join()
+    }
     let u = options.writeUnknownFields
     if (u !== false)
       (u == true ? UnknownFieldHandler.onWrite : u)(
@@ -12393,6 +12487,92 @@ class SearchSessionResponse$Type extends MessageType<SearchSessionResponse> {
  */
 export const SearchSessionResponse = new SearchSessionResponse$Type()
 // @generated message type with reflection information, may provide speed optimized methods
+class SearchSessionStreamResponse$Type extends MessageType<SearchSessionStreamResponse> {
+  constructor() {
+    super('omega_edit.v1.SearchSessionStreamResponse', [
+      {
+        no: 1,
+        name: 'match_offset',
+        kind: 'scalar',
+        repeat: 1 /*RepeatType.PACKED*/,
+        T: 3 /*ScalarType.INT64*/,
+        L: 2 /*LongType.NUMBER*/,
+      },
+    ])
+  }
+  create(
+    value?: PartialMessage<SearchSessionStreamResponse>
+  ): SearchSessionStreamResponse {
+    const message = globalThis.Object.create(this.messagePrototype!)
+    message.matchOffset = []
+    if (value !== undefined)
+      reflectionMergePartial<SearchSessionStreamResponse>(this, message, value)
+    return message
+  }
+  internalBinaryRead(
+    reader: IBinaryReader,
+    length: number,
+    options: BinaryReadOptions,
+    target?: SearchSessionStreamResponse
+  ): SearchSessionStreamResponse {
+    let message = target ?? this.create(),
+      end = reader.pos + length
+    while (reader.pos < end) {
+      let [fieldNo, wireType] = reader.tag()
+      switch (fieldNo) {
+        case /* repeated int64 match_offset */ 1:
+          if (wireType === WireType.LengthDelimited)
+            for (let e = reader.int32() + reader.pos; reader.pos < e; )
+              message.matchOffset.push(reader.int64().toNumber())
+          else message.matchOffset.push(reader.int64().toNumber())
+          break
+        default:
+          let u = options.readUnknownField
+          if (u === 'throw')
+            throw new globalThis.Error(
+              `Unknown field ${fieldNo} (wire type ${wireType}) for ${this.typeName}`
+            )
+          let d = reader.skip(wireType)
+          if (u !== false)
+            (u === true ? UnknownFieldHandler.onRead : u)(
+              this.typeName,
+              message,
+              fieldNo,
+              wireType,
+              d
+            )
+      }
+    }
+    return message
+  }
+  internalBinaryWrite(
+    message: SearchSessionStreamResponse,
+    writer: IBinaryWriter,
+    options: BinaryWriteOptions
+  ): IBinaryWriter {
+    /* repeated int64 match_offset = 1; */
+    if (message.matchOffset.length) {
+      writer.tag(1, WireType.LengthDelimited).fork()
+      for (let i = 0; i < message.matchOffset.length; i++)
+        writer.int64(message.matchOffset[i])
+      writer.join()
+    }
+    let u = options.writeUnknownFields
+    if (u !== false)
+      (u == true ? UnknownFieldHandler.onWrite : u)(
+        this.typeName,
+        message,
+        writer
+      )
+    return writer
+  }
+}
+/**
+ * @generated MessageType for protobuf message omega_edit.v1.SearchSessionStreamResponse
+ */
+export const SearchSessionStreamResponse =
+  new SearchSessionStreamResponse$Type()
+// @generated message type with reflection information, may provide speed optimized methods
 class ReplaceSessionRequest$Type extends MessageType<ReplaceSessionRequest> {
   constructor() {
     super('omega_edit.v1.ReplaceSessionRequest', [
@@ -16410,6 +16590,13 @@ export const EditorService = new ServiceType('omega_edit.v1.EditorService', [
     I: SearchSessionRequest,
     O: SearchSessionResponse,
   },
+  {
+    name: 'SearchSessionStream',
+    serverStreaming: true,
+    options: {},
+    I: SearchSessionRequest,
+    O: SearchSessionStreamResponse,
+  },
   {
     name: 'ReplaceSession',
     options: {},
@@ -34,4 +34,5 @@ export type {
   CreateSessionResponse,
   GetSegmentResponse,
   SearchSessionResponse,
+  SearchSessionStreamResponse,
 } from './generated/omega_edit/v1/omega_edit'
@@ -73,7 +73,8 @@ export async function createSession(
   filePath: string = '',
   sessionIdDesired: string = '',
   checkpointDirectory: string = '',
-  initialData?: Uint8Array
+  initialData?: Uint8Array,
+  lazySnapshot: boolean = false
 ): Promise<CreateSessionResponse> {
   const log = getLogger()
   const request: CreateSessionRequest = {}
@@ -84,6 +85,7 @@ export async function createSession(
     request.checkpointDirectory = checkpointDirectory
   }
   if (initialData !== undefined) request.initialData = initialData
+  if (lazySnapshot) request.lazySnapshot = true
 
   debugLog(log, () => ({ fn: 'protobufTs.createSession', rqst: request }))
   const client = await getClient()
@@ -402,7 +404,8 @@ export async function saveSession(
   offset: number = 0,
   length: number = 0,
   expectedOriginalFingerprint?: SessionContentFingerprint,
-  options: CancellableCallOptions = {}
+  options: CancellableCallOptions = {},
+  inPlace: boolean = false
 ): Promise<SaveSessionResponse> {
   const log = getLogger()
   const request: SaveSessionRequest = {
@@ -415,6 +418,7 @@ export async function saveSession(
   if (expectedOriginalFingerprint) {
     request.expectedOriginalFingerprint = expectedOriginalFingerprint
   }
+  if (inPlace) request.inPlace = true
 
   debugLog(log, () => ({ fn: 'protobufTs.saveSession', rqst: request }))
   if (options.signal?.aborted) {
@@ -1292,6 +1296,7 @@ export async function searchSession(
     sessionId: sessionId,
     pattern: typeof pattern === 'string' ? Buffer.from(pattern) : pattern,
     offset: offset,
+    patterns: [],
   }
 
   if (caseFolding !== SearchCaseFolding.UNSPECIFIED)
@@ -218,10 +218,17 @@ export const PROFILE_DOS_EOL = 256
 export async function createSession(
   file_path: string = '',
   session_id_desired: string = '',
-  checkpoint_directory: string = ''
+  checkpoint_directory: string = '',
+  lazy_snapshot: boolean = false
 ): Promise<CreateSessionResponse> {
   return wrapCreateSessionResponse(
-    await rawCreateSession(file_path, session_id_desired, checkpoint_directory)
+    await rawCreateSession(
+      file_path,
+      session_id_desired,
+      checkpoint_directory,
+      undefined,
+      lazy_snapshot
+    )
   )
 }
 
@@ -413,7 +420,8 @@ export async function saveSession(
   offset: number = 0,
   length: number = 0,
   expected_original_fingerprint?: SessionContentFingerprint,
-  options: CancellableCallOptions = {}
+  options: CancellableCallOptions = {},
+  in_place: boolean = false
 ): Promise<SaveSessionResponse> {
   return await enqueueSessionMutation(session_id, async () => {
     if (options.signal?.aborted) {
@@ -427,7 +435,8 @@ export async function saveSession(
         requireSafeIntegerInput('saveSession offset', offset),
         requireSafeIntegerInput('saveSession length', length),
         expected_original_fingerprint,
-        options
+        options,
+        in_place
       )
     )
   })
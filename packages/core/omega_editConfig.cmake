@@ -34,6 +34,7 @@ if (omega_edit_comp_static AND omega_edit_comp_shared)
     return()
 endif ()
 
+find_dependency(Threads)
 find_dependency(zstd CONFIG QUIET)
 
 # The core library may have been built with FetchContent (target
@@ -243,9 +243,11 @@ static int omega_bitmask_apply_replace(const omega_transform_plugin_request_t *r
             omega_transform_plugin_sdk_copy_bytes(request_ptr, request_ptr->input_bytes, request_ptr->input_length);
     if (!bytes) { return -1; }
 
+    /* The mask repeats from the start of the caller's range, which may precede this request's bytes */
+    const size_t phase = (size_t) (request_ptr->range_offset % (int64_t) mask_ptr->length);
     for (int64_t i = 0; i < request_ptr->input_length; ++i) {
         if ((i & 0xFFF) == 0 && omega_transform_plugin_sdk_is_cancelled(request_ptr)) { return -1; }
-        const omega_byte_t mask = mask_ptr->bytes[(size_t) i % mask_ptr->length];
+        const omega_byte_t mask = mask_ptr->bytes[(phase + (size_t) i) % mask_ptr->length];
         bytes[i] = omega_bitmask_apply_byte(request_ptr->input_bytes[i], mask, mask_ptr->operation);
     }
     response_ptr->replacement_bytes = bytes;
@@ -20,7 +20,8 @@ OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_get_info(omega_transfor
     info_ptr->name = "Bitwise";
     info_ptr->description = "Apply AND, OR, or XOR to every byte in the selected range.";
     info_ptr->operation = OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE;
-    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE;
+    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE |
+                      OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL;
     info_ptr->help = "Choose a logical operator and provide either a single byte or a repeating byte mask. "
                      "The default is XOR with 0xFF.";
     info_ptr->example = "{\"operator\":\"xor\",\"mask\":[\"0x42\",\"0x24\"]}";
@@ -109,7 +109,8 @@ OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_get_info(omega_transfor
     info_ptr->name = "Case Change";
     info_ptr->description = "Convert ASCII alphabetic bytes to upper or lower case.";
     info_ptr->operation = OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE;
-    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE;
+    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE |
+                      OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL;
     info_ptr->help =
             "Choose upper or lower case. Only ASCII alphabetic bytes are changed; all other bytes are preserved.";
     info_ptr->example = "{\"case\":\"lower\"}";
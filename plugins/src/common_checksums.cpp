@@ -20,6 +20,19 @@
 #include <cstring>
 #include <string>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define OMEGA_CHECKSUMS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define OMEGA_CHECKSUMS_TARGET_SSE42
+#define OMEGA_CHECKSUMS_TARGET_PCLMUL
+#else
+#define OMEGA_CHECKSUMS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define OMEGA_CHECKSUMS_TARGET_PCLMUL __attribute__((target("sse4.1,pclmul")))
+#endif
+#endif
+
 namespace {
 
     constexpr const char *CHECKSUM_ARGS_SCHEMA = R"json({
@@ -93,9 +106,11 @@ namespace {
   "additionalProperties": false
 })json";
 
-    uint64_t mask_for_width(int width) { return width == 64 ? UINT64_MAX : ((UINT64_C(1) << width) - UINT64_C(1)); }
+    constexpr uint64_t mask_for_width(int width) {
+        return width == 64 ? UINT64_MAX : ((UINT64_C(1) << width) - UINT64_C(1));
+    }
 
-    uint64_t reflect_bits(uint64_t value, int width) {
+    constexpr uint64_t reflect_bits(uint64_t value, int width) {
         uint64_t reflected = 0;
         for (int i = 0; i < width; ++i) {
             if (value & (UINT64_C(1) << i)) { reflected |= UINT64_C(1) << (width - 1 - i); }
@@ -103,6 +118,56 @@ namespace {
         return reflected;
     }
 
+    // Slicing-by-8 tables: table 0 is the classic byte-at-a-time table, and table k runs a byte through k more zero
+    // bytes, so eight input bytes fold into the register with eight independent lookups. Reflected models keep the
+    // register in the low bits, the others keep it left-aligned in 32 bits so every width shares one kernel.
+    using crc_tables_t = std::array<std::array<uint32_t, 256>, 8>;
+
+    constexpr crc_tables_t make_crc_tables(int width, uint64_t polynomial, bool reflected) {
+        crc_tables_t tables{};
+        const auto reflected_polynomial = static_cast<uint32_t>(reflect_bits(polynomial, width));
+        const auto aligned_polynomial = static_cast<uint32_t>(polynomial << (32 - width));
+        for (uint32_t byte = 0; byte < 256; ++byte) {
+            uint32_t entry = reflected ? byte : byte << 24U;
+            for (int bit = 0; bit < 8; ++bit) {
+                if (reflected) {
+                    entry = (entry & 1U) ? ((entry >> 1U) ^ reflected_polynomial) : (entry >> 1U);
+                } else {
+                    entry = (entry & 0x80000000U) ? ((entry << 1U) ^ aligned_polynomial) : (entry << 1U);
+                }
+            }
+            tables[0][byte] = entry;
+        }
+        for (size_t slice = 1; slice < tables.size(); ++slice) {
+            for (uint32_t byte = 0; byte < 256; ++byte) {
+                const auto previous = tables[slice - 1][byte];
+                tables[slice][byte] = reflected ? (previous >> 8U) ^ tables[0][previous & 0xFFU]
+                                                : (previous << 8U) ^ tables[0][previous >> 24U];
+            }
+        }
+        return tables;
+    }
+
+    constexpr crc_tables_t CRC32_TABLES = make_crc_tables(32, 0x04C11DB7U, true);
+    constexpr crc_tables_t CRC32C_TABLES = make_crc_tables(32, 0x1EDC6F41U, true);
+    constexpr crc_tables_t CRC32_MSB_TABLES = make_crc_tables(32, 0x04C11DB7U, false);
+    constexpr crc_tables_t CRC16_8005_TABLES = make_crc_tables(16, 0x8005U, true);
+    constexpr crc_tables_t CRC16_1021_TABLES = make_crc_tables(16, 0x1021U, false);
+    constexpr crc_tables_t CRC16_1021_REFLECTED_TABLES = make_crc_tables(16, 0x1021U, true);
+    constexpr crc_tables_t CRC8_07_TABLES = make_crc_tables(8, 0x07U, false);
+
+    // Constants for folding a reflected CRC-32 with carry-less multiplication ("Fast CRC Computation for Generic
+    // Polynomials Using PCLMULQDQ Instruction", Intel, 2009): k1/k2 fold 64-byte blocks, k3/k4 fold 16-byte blocks, k5
+    // folds 64 bits to 32, and the reflected polynomial and mu finish with a Barrett reduction
+    struct crc_fold_constants_t {
+        uint64_t k1, k2, k3, k4, k5, polynomial, mu;
+    };
+
+    constexpr crc_fold_constants_t CRC32_FOLD_CONSTANTS = {0x154442BD4U, 0x1C6E41596U, 0x1751997D0U, 0x0CCAA009EU,
+                                                           0x163CD6124U, 0x1DB710641U, 0x1F7011641U};
+    constexpr crc_fold_constants_t CRC32C_FOLD_CONSTANTS = {0x0740EEF02U, 0x09E4ADDF8U, 0x0F20C0DFEU, 0x14CD00BD6U,
+                                                            0x0DD45AAB8U, 0x105EC76F1U, 0x0DEA713F1U};
+
     struct crc_model_t {
         int width;
         uint64_t polynomial;
@@ -110,9 +175,22 @@ namespace {
         uint64_t xor_out;
         bool refin;
         bool refout;
+        const crc_tables_t *tables;                ///< Slicing-by-8 tables, or nullptr to process one bit at a time
+        const crc_fold_constants_t *fold_constants;///< Folding constants of reflected CRC-32 models, or nullptr
+        bool is_castagnoli;                        ///< CRC-32C, which SSE4.2 computes with its crc32 instruction
     };
 
-    uint64_t crc_update(uint64_t state, const crc_model_t &model, const omega_byte_t *bytes, int64_t length) {
+    uint32_t read32be(const omega_byte_t *bytes) {
+        return (static_cast<uint32_t>(bytes[0]) << 24U) | (static_cast<uint32_t>(bytes[1]) << 16U) |
+               (static_cast<uint32_t>(bytes[2]) << 8U) | static_cast<uint32_t>(bytes[3]);
+    }
+
+    uint32_t read32le(const omega_byte_t *bytes) {
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8U) |
+               (static_cast<uint32_t>(bytes[2]) << 16U) | (static_cast<uint32_t>(bytes[3]) << 24U);
+    }
+
+    uint64_t crc_update_bitwise(uint64_t state, const crc_model_t &model, const omega_byte_t *bytes, int64_t length) {
         const uint64_t mask = mask_for_width(model.width);
         if (model.refin) {
             const uint64_t reflected_polynomial = reflect_bits(model.polynomial, model.width);
@@ -137,6 +215,129 @@ namespace {
         return state;
     }
 
+    uint32_t crc_update_sliced(uint32_t state, const crc_model_t &model, const omega_byte_t *bytes, int64_t length) {
+        const auto &t = *model.tables;
+        if (model.refin) {
+            for (; length >= 8; bytes += 8, length -= 8) {
+                const auto low = read32le(bytes) ^ state;
+                const auto high = read32le(bytes + 4);
+                state = t[7][low & 0xFFU] ^ t[6][(low >> 8U) & 0xFFU] ^ t[5][(low >> 16U) & 0xFFU] ^ t[4][low >> 24U] ^
+                        t[3][high & 0xFFU] ^ t[2][(high >> 8U) & 0xFFU] ^ t[1][(high >> 16U) & 0xFFU] ^
+                        t[0][high >> 24U];
+            }
+            for (; length > 0; ++bytes, --length) { state = (state >> 8U) ^ t[0][(state ^ *bytes) & 0xFFU]; }
+            return state;
+        }
+
+        const auto shift = 32 - model.width;
+        state <<= shift;
+        for (; length >= 8; bytes += 8, length -= 8) {
+            const auto high = read32be(bytes) ^ state;
+            const auto low = read32be(bytes + 4);
+            state = t[7][high >> 24U] ^ t[6][(high >> 16U) & 0xFFU] ^ t[5][(high >> 8U) & 0xFFU] ^ t[4][high & 0xFFU] ^
+                    t[3][low >> 24U] ^ t[2][(low >> 16U) & 0xFFU] ^ t[1][(low >> 8U) & 0xFFU] ^ t[0][low & 0xFFU];
+        }
+        for (; length > 0; ++bytes, --length) { state = (state << 8U) ^ t[0][(state >> 24U) ^ *bytes]; }
+        return state >> shift;
+    }
+
+#ifdef OMEGA_CHECKSUMS_X86
+    OMEGA_CHECKSUMS_TARGET_SSE42 uint32_t crc32c_update_sse42(uint32_t state, const omega_byte_t *bytes,
+                                                              int64_t length) {
+        uint64_t state64 = state;
+        for (; length >= 8; bytes += 8, length -= 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, sizeof(word));
+            state64 = _mm_crc32_u64(state64, word);
+        }
+        state = static_cast<uint32_t>(state64);
+        for (; length > 0; ++bytes, --length) { state = _mm_crc32_u8(state, *bytes); }
+        return state;
+    }
+
+    OMEGA_CHECKSUMS_TARGET_PCLMUL inline __m128i load128(const omega_byte_t *bytes) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+    }
+
+    // Multiplies both halves of the value by the matching constant, which moves it forward to line up with the next
+    OMEGA_CHECKSUMS_TARGET_PCLMUL inline __m128i fold128(__m128i value, __m128i constants, __m128i next) {
+        const auto high = _mm_clmulepi64_si128(value, constants, 0x11);
+        const auto low = _mm_clmulepi64_si128(value, constants, 0x00);
+        return _mm_xor_si128(_mm_xor_si128(high, low), next);
+    }
+
+    // Folds at least 64 bytes, a multiple of 16, into a reflected CRC-32 register, four 16-byte lanes at a time
+    OMEGA_CHECKSUMS_TARGET_PCLMUL uint32_t crc32_fold_pclmul(uint32_t state, const crc_fold_constants_t &constants,
+                                                             const omega_byte_t *bytes, int64_t length) {
+        auto x1 = _mm_xor_si128(load128(bytes), _mm_cvtsi32_si128(static_cast<int>(state)));
+        auto x2 = load128(bytes + 16);
+        auto x3 = load128(bytes + 32);
+        auto x4 = load128(bytes + 48);
+        bytes += 64;
+        length -= 64;
+
+        auto k = _mm_set_epi64x(static_cast<long long>(constants.k2), static_cast<long long>(constants.k1));
+        for (; length >= 64; bytes += 64, length -= 64) {
+            x1 = fold128(x1, k, load128(bytes));
+            x2 = fold128(x2, k, load128(bytes + 16));
+            x3 = fold128(x3, k, load128(bytes + 32));
+            x4 = fold128(x4, k, load128(bytes + 48));
+        }
+
+        k = _mm_set_epi64x(static_cast<long long>(constants.k4), static_cast<long long>(constants.k3));
+        x1 = fold128(fold128(fold128(x1, k, x2), k, x3), k, x4);
+        for (; length >= 16; bytes += 16, length -= 16) { x1 = fold128(x1, k, load128(bytes)); }
+
+        // 128 bits to 64, then 64 to 32, then a Barrett reduction to the 32-bit remainder
+        const auto mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k, 0x10));
+        k = _mm_set_epi64x(0, static_cast<long long>(constants.k5));
+        x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), _mm_srli_si128(x1, 4));
+        k = _mm_set_epi64x(static_cast<long long>(constants.mu), static_cast<long long>(constants.polynomial));
+        auto quotient = _mm_and_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10), mask32);
+        x1 = _mm_xor_si128(x1, _mm_clmulepi64_si128(quotient, k, 0x00));
+        return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+    }
+
+    struct crc_cpu_features_t {
+        bool sse42;
+        bool pclmul;
+    };
+
+    crc_cpu_features_t detect_crc_cpu_features() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        // SSE4.1 (for the final extract) comes with every CPU that has SSE4.2
+        return {(info[2] & (1 << 20)) != 0, (info[2] & (1 << 1)) != 0 && (info[2] & (1 << 20)) != 0};
+#else
+        return {__builtin_cpu_supports("sse4.2") != 0,
+                __builtin_cpu_supports("pclmul") != 0 && __builtin_cpu_supports("sse4.1") != 0};
+#endif
+    }
+
+    const crc_cpu_features_t &crc_cpu_features() {
+        static const auto features = detect_crc_cpu_features();
+        return features;
+    }
+#endif
+
+    uint64_t crc_update(uint64_t state, const crc_model_t &model, const omega_byte_t *bytes, int64_t length) {
+        if (!model.tables) { return crc_update_bitwise(state, model, bytes, length); }
+        auto state32 = static_cast<uint32_t>(state);
+#ifdef OMEGA_CHECKSUMS_X86
+        const auto &features = crc_cpu_features();
+        if (model.fold_constants && features.pclmul && length >= 64) {
+            const auto folded_length = length & ~INT64_C(15);
+            state32 = crc32_fold_pclmul(state32, *model.fold_constants, bytes, folded_length);
+            bytes += folded_length;
+            length -= folded_length;
+        }
+        if (model.is_castagnoli && features.sse42) { return crc32c_update_sse42(state32, bytes, length); }
+#endif
+        return crc_update_sliced(state32, model, bytes, length);
+    }
+
     uint64_t crc_finalize(uint64_t state, const crc_model_t &model) {
         if (model.refin != model.refout) { state = reflect_bits(state, model.width); }
         return (state ^ model.xor_out) & mask_for_width(model.width);
@@ -144,52 +345,54 @@ namespace {
 
     bool crc_model_for(const std::string &algorithm, crc_model_t &model, int &hex_width) {
         if (algorithm == "crc32") {
-            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, true, true};
+            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, true, true, &CRC32_TABLES, &CRC32_FOLD_CONSTANTS,
+                     false};
             hex_width = 8;
             return true;
         }
         if (algorithm == "crc32c") {
-            model = {32, 0x1EDC6F41U, 0xFFFFFFFFU, 0xFFFFFFFFU, true, true};
+            model = {32, 0x1EDC6F41U, 0xFFFFFFFFU, 0xFFFFFFFFU, true, true, &CRC32C_TABLES, &CRC32C_FOLD_CONSTANTS,
+                     true};
             hex_width = 8;
             return true;
         }
         if (algorithm == "crc32-mpeg2") {
-            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0x00000000U, false, false};
+            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0x00000000U, false, false, &CRC32_MSB_TABLES, nullptr, false};
             hex_width = 8;
             return true;
         }
         if (algorithm == "crc32-bzip2") {
-            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, false, false};
+            model = {32, 0x04C11DB7U, 0xFFFFFFFFU, 0xFFFFFFFFU, false, false, &CRC32_MSB_TABLES, nullptr, false};
             hex_width = 8;
             return true;
         }
         if (algorithm == "crc16-ibm" || algorithm == "crc16-arc") {
-            model = {16, 0x8005U, 0x0000U, 0x0000U, true, true};
+            model = {16, 0x8005U, 0x0000U, 0x0000U, true, true, &CRC16_8005_TABLES, nullptr, false};
             hex_width = 4;
             return true;
         }
         if (algorithm == "crc16-modbus") {
-            model = {16, 0x8005U, 0xFFFFU, 0x0000U, true, true};
+            model = {16, 0x8005U, 0xFFFFU, 0x0000U, true, true, &CRC16_8005_TABLES, nullptr, false};
             hex_width = 4;
             return true;
         }
         if (algorithm == "crc16-ccitt-false") {
-            model = {16, 0x1021U, 0xFFFFU, 0x0000U, false, false};
+            model = {16, 0x1021U, 0xFFFFU, 0x0000U, false, false, &CRC16_1021_TABLES, nullptr, false};
             hex_width = 4;
             return true;
         }
         if (algorithm == "crc16-xmodem") {
-            model = {16, 0x1021U, 0x0000U, 0x0000U, false, false};
+            model = {16, 0x1021U, 0x0000U, 0x0000U, false, false, &CRC16_1021_TABLES, nullptr, false};
             hex_width = 4;
             return true;
         }
         if (algorithm == "crc16-kermit") {
-            model = {16, 0x1021U, 0x0000U, 0x0000U, true, true};
+            model = {16, 0x1021U, 0x0000U, 0x0000U, true, true, &CRC16_1021_REFLECTED_TABLES, nullptr, false};
             hex_width = 4;
             return true;
         }
         if (algorithm == "crc8") {
-            model = {8, 0x07U, 0x00U, 0x00U, false, false};
+            model = {8, 0x07U, 0x00U, 0x00U, false, false, &CRC8_07_TABLES, nullptr, false};
             hex_width = 2;
             return true;
         }
@@ -200,11 +403,6 @@ namespace {
 
     uint64_t rotl64(uint64_t value, int count) { return (value << count) | (value >> (64 - count)); }
 
-    uint32_t read32le(const omega_byte_t *bytes) {
-        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8U) |
-               (static_cast<uint32_t>(bytes[2]) << 16U) | (static_cast<uint32_t>(bytes[3]) << 24U);
-    }
-
     uint64_t read64le(const omega_byte_t *bytes) {
         return static_cast<uint64_t>(read32le(bytes)) | (static_cast<uint64_t>(read32le(bytes + 4)) << 32U);
     }
@@ -30,7 +30,10 @@ extern "C" OMEGA_TRANSFORM_PLUGIN_EXPORT int omega_transform_plugin_get_info(ome
     info_ptr->name = "Endian Swap";
     info_ptr->description = "Reverse byte order in complete fixed-width 2, 4, or 8 byte fields.";
     info_ptr->operation = OMEGA_TRANSFORM_PLUGIN_OPERATION_REPLACE;
-    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE;
+    info_ptr->flags = OMEGA_TRANSFORM_PLUGIN_FLAG_ONE_FOR_ONE | OMEGA_TRANSFORM_PLUGIN_FLAG_BINARY_SAFE |
+                      OMEGA_TRANSFORM_PLUGIN_FLAG_CHUNK_PARALLEL;
+    // Shards split at multiples of every supported field width, so no field straddles two of them
+    info_ptr->chunk_alignment = 8;
     info_ptr->help =
             "Choose a field width of 2, 4, or 8 bytes. Trailing bytes that do not fill a complete field are left "
             "unchanged.";
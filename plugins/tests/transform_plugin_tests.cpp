@@ -19,6 +19,7 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
@@ -89,6 +90,10 @@ namespace {
         }
         return session_ptr;
     }
+
+    std::string plugin_path(const std::string &plugin_name) {
+        return (PLUGIN_DIR / ("omega_transform_" + plugin_name + PLUGIN_SUFFIX)).string();
+    }
 }// namespace
 
 TEST_CASE("Packaged Transform Plugins", "[TransformPlugin]") {
@@ -955,6 +960,36 @@ TEST_CASE("Packaged Transform Plugins", "[TransformPlugin]") {
     require_checksum_result("xxhash64", "0x8CB841DB40E6AE83");
     omega_edit_destroy_session(checksum_session_ptr);
 
+    // Long, unaligned ranges run the table and carry-less multiplication kernels, and their tails, across chunks
+    const auto long_checksum_session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(long_checksum_session_ptr);
+    std::vector<omega_byte_t> long_checksum_input(100000);
+    for (size_t i = 0; i < long_checksum_input.size(); ++i) {
+        long_checksum_input[i] = static_cast<omega_byte_t>(((i * 31 + 7) & 0xFFU) ^ ((i >> 8U) & 0xFFU));
+    }
+    REQUIRE(0 < omega_edit_insert_bytes(long_checksum_session_ptr, 0, long_checksum_input.data(),
+                                        static_cast<int64_t>(long_checksum_input.size())));
+    const auto require_long_checksum_result = [&](const char *algorithm, const char *expected) {
+        const std::string options = std::string("{\"algorithm\":\"") + algorithm + "\"}";
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry_ptr, "omega.example.common_checksums",
+                                                                      long_checksum_session_ptr, 3, 99990,
+                                                                      options.c_str(), &response));
+        REQUIRE(expected == std::string(reinterpret_cast<const char *>(response.result_bytes),
+                                        static_cast<size_t>(response.result_length)));
+        omega_transform_plugin_response_clear(&response);
+    };
+    require_long_checksum_result("crc32", "0xAA2282E9");
+    require_long_checksum_result("crc32c", "0x61F65EAC");
+    require_long_checksum_result("crc32-mpeg2", "0xB9EE9CDF");
+    require_long_checksum_result("crc32-bzip2", "0x46116320");
+    require_long_checksum_result("crc16-ibm", "0xA189");
+    require_long_checksum_result("crc16-modbus", "0x4F0B");
+    require_long_checksum_result("crc16-ccitt-false", "0x257C");
+    require_long_checksum_result("crc16-xmodem", "0xDED2");
+    require_long_checksum_result("crc16-kermit", "0x5E7C");
+    require_long_checksum_result("crc8", "0x44");
+    omega_edit_destroy_session(long_checksum_session_ptr);
+
     const auto text_codec_session_ptr = omega_edit_create_session(nullptr, nullptr, nullptr, NO_EVENTS, nullptr);
     REQUIRE(text_codec_session_ptr);
     REQUIRE(0 < omega_edit_insert_string(text_codec_session_ptr, 0, "hello"));
@@ -1424,3 +1459,154 @@ TEST_CASE("Large Transform Replacement Uses File-Backed Checkpoint", "[Transform
     omega_edit_destroy_session(session_ptr);
     omega_transform_plugin_registry_destroy(registry_ptr);
 }
+
+TEST_CASE("Trusted Streaming Plugins Read Sessions In Process", "[TransformPlugin]") {
+    REQUIRE(std::filesystem::is_directory(PLUGIN_DIR));
+
+    const auto registry_ptr = omega_transform_plugin_registry_create();
+    REQUIRE(registry_ptr);
+    REQUIRE(0 < omega_transform_plugin_registry_register_directory(registry_ptr, PLUGIN_DIR.string().c_str()));
+
+    // Edits spread the range over several model segments, so reads cross segment boundaries
+    std::vector<omega_byte_t> input(6 * 1024 * 1024 + 11);
+    for (size_t i = 0; i < input.size(); ++i) { input[i] = static_cast<omega_byte_t>((i * 151U) ^ (i >> 11U)); }
+    const auto session_ptr = omega_edit_create_session_from_bytes(input.data(), static_cast<int64_t>(input.size()),
+                                                                  nullptr, nullptr, NO_EVENTS, nullptr);
+    REQUIRE(session_ptr);
+    REQUIRE(0 < omega_edit_insert_cstring(session_ptr, 1024 * 1024 + 3, "trusted"));
+    REQUIRE(0 < omega_edit_delete(session_ptr, 4 * 1024 * 1024, 4097));
+
+    const auto checksum = [&](const char *algorithm) {
+        const auto options = std::string("{\"algorithm\":\"") + algorithm + "\"}";
+        omega_transform_plugin_response_t response{};
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session(registry_ptr, "omega.example.common_checksums",
+                                                                      session_ptr, 0, 0, options.c_str(), &response));
+        const auto result = response_text(response);
+        omega_transform_plugin_response_clear(&response);
+        return result;
+    };
+    const auto checksums_path = plugin_path("common_checksums");
+    const auto isolated_crc32 = checksum("crc32");
+    const auto isolated_xxhash64 = checksum("xxhash64");
+    REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(registry_ptr, checksums_path.c_str(), 1));
+    REQUIRE(isolated_crc32 == checksum("crc32"));
+    REQUIRE(isolated_xxhash64 == checksum("xxhash64"));
+
+    // Reader inspections hand the caller's reader straight to trusted plugins
+    byte_reader_state_t reader{input.data(), static_cast<int64_t>(input.size())};
+    omega_transform_plugin_response_t trusted_response{};
+    REQUIRE(0 == omega_transform_plugin_registry_inspect_reader(
+                         registry_ptr, "omega.example.common_checksums", 0, reader.length, "{\"algorithm\":\"crc32\"}",
+                         nullptr, byte_reader_callback, &reader, 64 * 1024, nullptr, nullptr, &trusted_response));
+    REQUIRE(0 < reader.calls);
+    REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(registry_ptr, checksums_path.c_str(), 0));
+    omega_transform_plugin_response_t isolated_response{};
+    REQUIRE(0 == omega_transform_plugin_registry_inspect_reader(
+                         registry_ptr, "omega.example.common_checksums", 0, reader.length, "{\"algorithm\":\"crc32\"}",
+                         nullptr, byte_reader_callback, &reader, 64 * 1024, nullptr, nullptr, &isolated_response));
+    REQUIRE(response_text(isolated_response) == response_text(trusted_response));
+
+    omega_transform_plugin_response_clear(&trusted_response);
+    omega_transform_plugin_response_clear(&isolated_response);
+    omega_edit_destroy_session(session_ptr);
+    omega_transform_plugin_registry_destroy(registry_ptr);
+}
+
+TEST_CASE("Chunk-Parallel Plugins Apply Shards Concurrently", "[TransformPlugin]") {
+    REQUIRE(std::filesystem::is_directory(PLUGIN_DIR));
+
+    const auto registry_ptr = omega_transform_plugin_registry_create();
+    REQUIRE(registry_ptr);
+    REQUIRE(0 < omega_transform_plugin_registry_register_directory(registry_ptr, PLUGIN_DIR.string().c_str()));
+    REQUIRE(0 != omega_transform_plugin_registry_set_parallel_thread_count(registry_ptr, -1));
+    REQUIRE(0 == omega_transform_plugin_registry_set_parallel_thread_count(registry_ptr, 4));
+
+    // The range splits into four shards whose lengths are neither multiples of the mask length nor of the field width
+    const int64_t range_offset = 5;
+    const auto range_length = 4 * OMEGA_TRANSFORM_PLUGIN_PARALLEL_CHUNK_LENGTH + 13;
+    std::vector<omega_byte_t> input(static_cast<size_t>(range_offset + range_length + 7));
+    for (size_t i = 0; i < input.size(); ++i) { input[i] = static_cast<omega_byte_t>((i * 131U) ^ (i >> 9U)); }
+
+    const auto session_bytes = [](omega_session_t *session_ptr) {
+        std::vector<omega_byte_t> bytes(static_cast<size_t>(omega_session_get_computed_file_size(session_ptr)));
+        auto *segment = omega_segment_create(1024 * 1024);
+        REQUIRE(segment);
+        for (int64_t offset = 0; offset < static_cast<int64_t>(bytes.size());) {
+            REQUIRE(0 == omega_session_get_segment(session_ptr, segment, offset));
+            REQUIRE(0 < omega_segment_get_length(segment));
+            std::memcpy(bytes.data() + offset, omega_segment_get_data(segment),
+                        static_cast<size_t>(omega_segment_get_length(segment)));
+            offset += omega_segment_get_length(segment);
+        }
+        omega_segment_destroy(segment);
+        return bytes;
+    };
+
+    const omega_byte_t mask[] = {0x42, 0x24, 0x99};
+    auto xor_expected = input;
+    auto swap_expected = input;
+    auto upper_expected = input;
+    for (int64_t i = 0; i < range_length; ++i) {
+        auto &byte = xor_expected[static_cast<size_t>(range_offset + i)];
+        byte = static_cast<omega_byte_t>(byte ^ mask[i % 3]);
+        auto &upper = upper_expected[static_cast<size_t>(range_offset + i)];
+        if (upper >= 'a' && upper <= 'z') { upper = static_cast<omega_byte_t>(upper - ('a' - 'A')); }
+    }
+    for (int64_t i = 0; i + 8 <= range_length; i += 8) {
+        const auto field = swap_expected.begin() + range_offset + i;
+        std::reverse(field, field + 8);
+    }
+
+    for (const auto trusted : {0, 1}) {
+        for (const auto *plugin_name : {"bitwise", "endian_swap", "case_change"}) {
+            REQUIRE(0 == omega_transform_plugin_registry_set_plugin_trusted(registry_ptr,
+                                                                           plugin_path(plugin_name).c_str(), trusted));
+        }
+
+        const auto apply = [&](const char *plugin_id, const char *options_json,
+                               const std::vector<omega_byte_t> &expected) {
+            const auto session_ptr = create_session_from_vector(input);
+            const auto changes = omega_session_get_num_changes(session_ptr);
+            omega_transform_plugin_response_t response{};
+            int64_t change_serial = 0;
+            REQUIRE(0 == omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_serial(
+                                 registry_ptr, plugin_id, session_ptr, range_offset, range_length, options_json,
+                                 nullptr, nullptr, nullptr, nullptr, &response, &change_serial));
+            REQUIRE(0 < change_serial);
+            REQUIRE(changes + 1 == omega_session_get_num_changes(session_ptr));
+            REQUIRE(range_length == response.replacement_length);
+            REQUIRE(nullptr == response.replacement_bytes);
+            REQUIRE(expected == session_bytes(session_ptr));
+            omega_transform_plugin_response_clear(&response);
+            omega_edit_destroy_session(session_ptr);
+        };
+        apply("omega.example.bitwise", "{\"operator\":\"xor\",\"mask\":[\"0x42\",\"0x24\",\"0x99\"]}", xor_expected);
+        apply("omega.example.endian_swap", "{\"width\":8}", swap_expected);
+        apply("omega.example.case_change", "{\"case\":\"upper\"}", upper_expected);
+
+        // Shards that are all unchanged leave the session alone
+        const auto session_ptr = create_session_from_vector(upper_expected);
+        const auto changes = omega_session_get_num_changes(session_ptr);
+        omega_transform_plugin_response_t response{};
+        int64_t change_serial = -1;
+        REQUIRE(0 == omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_serial(
+                             registry_ptr, "omega.example.case_change", session_ptr, range_offset, range_length,
+                             "{\"case\":\"upper\"}", nullptr, nullptr, nullptr, nullptr, &response, &change_serial));
+        REQUIRE(0 == change_serial);
+        REQUIRE(0 != (response.flags & OMEGA_TRANSFORM_PLUGIN_RESPONSE_NO_CONTENT_CHANGE));
+        REQUIRE(changes == omega_session_get_num_changes(session_ptr));
+
+        // Cancelling fails the whole apply without changing the session.  In process, the plugin polls often enough
+        // for the cancellation to arrive while the shards are being applied rather than while they are read.
+        cancellation_state_t cancellation{0, trusted ? 100 : 10};
+        REQUIRE(0 != omega_transform_plugin_registry_apply_to_session_with_progress_cancel_and_serial(
+                             registry_ptr, "omega.example.bitwise", session_ptr, range_offset, range_length, nullptr,
+                             nullptr, nullptr, cancel_after_callback, &cancellation, &response, &change_serial));
+        REQUIRE(cancellation.cancel_after < cancellation.calls);
+        REQUIRE(changes == omega_session_get_num_changes(session_ptr));
+        REQUIRE(upper_expected == session_bytes(session_ptr));
+        omega_transform_plugin_response_clear(&response);
+        omega_edit_destroy_session(session_ptr);
+    }
+    omega_transform_plugin_registry_destroy(registry_ptr);
+}
@@ -16,10 +16,12 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -36,6 +38,7 @@ namespace {
         std::vector<std::string> plugin_dirs;
         std::vector<std::string> plugin_paths;
         bool allow_experimental = false;
+        bool trusted = false;
         bool list = false;
         std::string run_id;
         std::optional<std::vector<omega_byte_t>> input;
@@ -44,6 +47,9 @@ namespace {
         std::string options_json;
         std::optional<std::vector<omega_byte_t>> expect_output;
         std::optional<std::string> expect_result;
+        int64_t benchmark_bytes = 0;
+        int64_t benchmark_iterations = 5;
+        int64_t threads = 0;
     };
 
     void print_usage(const char *argv0) {
@@ -52,7 +58,10 @@ namespace {
                 << "  " << argv0 << " [--plugin-dir DIR] --list\n"
                 << "  " << argv0 << " --plugin PATH --run ID --input TEXT [--expect-output TEXT]\n"
                 << "  " << argv0 << " --plugin-dir DIR --run ID --input-hex HEX [--offset N] [--length N]\n"
-                << "       [--allow-experimental] [--options JSON] [--expect-output-hex HEX] [--expect-result TEXT]\n";
+                << "       [--allow-experimental] [--trusted] [--threads N] [--options JSON]\n"
+                << "       [--expect-output-hex HEX] [--expect-result TEXT]\n"
+                << "  " << argv0 << " --plugin-dir DIR --run ID --benchmark-bytes N [--benchmark-iterations N]\n"
+                << "       [--options JSON] [--trusted] [--threads N]\n";
     }
 
     auto executable_path_from_argv0(const char *argv0) -> std::filesystem::path {
@@ -199,6 +208,8 @@ namespace {
                 options.plugin_paths.emplace_back(value);
             } else if (arg == "--list") {
                 options.list = true;
+            } else if (arg == "--trusted") {
+                options.trusted = true;
             } else if (arg == "--allow-experimental") {
                 options.allow_experimental = true;
             } else if (arg == "--run") {
@@ -245,6 +256,22 @@ namespace {
                 const auto value = require_value("--expect-result");
                 if (!value) { return false; }
                 options.expect_result = value;
+            } else if (arg == "--benchmark-bytes") {
+                const auto value = require_value("--benchmark-bytes");
+                if (!value || !parse_i64(value, options.benchmark_bytes) || options.benchmark_bytes <= 0) {
+                    return false;
+                }
+            } else if (arg == "--benchmark-iterations") {
+                const auto value = require_value("--benchmark-iterations");
+                if (!value || !parse_i64(value, options.benchmark_iterations) || options.benchmark_iterations <= 0) {
+                    return false;
+                }
+            } else if (arg == "--threads") {
+                const auto value = require_value("--threads");
+                if (!value || !parse_i64(value, options.threads) || options.threads < 0 ||
+                    options.threads > std::numeric_limits<int>::max()) {
+                    return false;
+                }
             } else if (arg == "--help" || arg == "-h") {
                 return false;
             } else {
@@ -284,6 +311,24 @@ namespace {
         return true;
     }
 
+    // Trust is granted by library path, so --trusted trusts every library the plugins were registered from
+    auto trust_plugins(omega_transform_plugin_registry_t *registry_ptr, const options_t &options) -> bool {
+        auto paths = options.plugin_paths;
+        std::error_code error;
+        for (const auto &dir : options.plugin_dirs) {
+            for (const auto &entry : std::filesystem::directory_iterator(dir, error)) {
+                if (entry.is_regular_file(error)) { paths.push_back(entry.path().string()); }
+            }
+        }
+        for (const auto &path : paths) {
+            if (0 != omega_transform_plugin_registry_set_plugin_trusted(registry_ptr, path.c_str(), 1)) {
+                std::cerr << "failed to trust plugin: " << path << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
     auto list_plugins(const omega_transform_plugin_registry_t *registry_ptr) -> int {
         const auto count = omega_transform_plugin_registry_get_count(registry_ptr);
         std::cout << "plugins=" << count << "\n";
@@ -296,6 +341,60 @@ namespace {
         return 0;
     }
 
+    // Times the plugin over generated bytes, undoing any edit it makes so every iteration sees the same input
+    auto run_benchmark(omega_transform_plugin_registry_t *registry_ptr, const options_t &options) -> int {
+        if (options.run_id.empty()) {
+            std::cerr << "--run is required with --benchmark-bytes\n";
+            return 2;
+        }
+        std::vector<omega_byte_t> input(static_cast<size_t>(options.benchmark_bytes));
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (auto &byte : input) {
+            state ^= state << 13U;
+            state ^= state >> 7U;
+            state ^= state << 17U;
+            byte = static_cast<omega_byte_t>(state);
+        }
+        auto *session_ptr = omega_edit_create_session_from_bytes(input.data(), static_cast<int64_t>(input.size()),
+                                                                 nullptr, nullptr, NO_EVENTS, nullptr);
+        if (!session_ptr) {
+            std::cerr << "failed to create session\n";
+            return 1;
+        }
+        input.clear();
+        input.shrink_to_fit();
+
+        const auto options_json = options.options_json.empty() ? nullptr : options.options_json.c_str();
+        std::chrono::duration<double> elapsed{};
+        for (int64_t iteration = 0; iteration < options.benchmark_iterations; ++iteration) {
+            omega_transform_plugin_response_t response{};
+            const auto begin = std::chrono::steady_clock::now();
+            const auto rc = omega_transform_plugin_registry_apply_to_session(
+                    registry_ptr, options.run_id.c_str(), session_ptr, 0, 0, options_json, &response);
+            elapsed += std::chrono::steady_clock::now() - begin;
+            omega_transform_plugin_response_clear(&response);
+            if (rc != 0) {
+                omega_edit_destroy_session(session_ptr);
+                std::cerr << "plugin apply failed\n";
+                return 1;
+            }
+            if (omega_session_get_num_changes(session_ptr) > 0 && omega_edit_undo_last_change(session_ptr) >= 0) {
+                omega_edit_destroy_session(session_ptr);
+                std::cerr << "failed to undo the plugin edit\n";
+                return 1;
+            }
+        }
+        omega_edit_destroy_session(session_ptr);
+
+        const auto total_bytes =
+                static_cast<double>(options.benchmark_bytes) * static_cast<double>(options.benchmark_iterations);
+        std::cout << "benchmark_bytes=" << options.benchmark_bytes << "\n"
+                  << "benchmark_iterations=" << options.benchmark_iterations << "\n"
+                  << "benchmark_seconds=" << elapsed.count() << "\n"
+                  << "benchmark_mib_per_s=" << total_bytes / (1024.0 * 1024.0) / elapsed.count() << "\n";
+        return 0;
+    }
+
     auto run_plugin(omega_transform_plugin_registry_t *registry_ptr, const options_t &options) -> int {
         if (options.run_id.empty()) {
             std::cerr << "--run is required unless --list is used\n";
@@ -407,8 +506,21 @@ int main(int argc, char **argv) {
         omega_transform_plugin_registry_destroy(registry_ptr);
         return 1;
     }
+    if (options.trusted && !trust_plugins(registry_ptr, options)) {
+        omega_transform_plugin_registry_destroy(registry_ptr);
+        return 1;
+    }
+
+    const auto thread_count = static_cast<int>(options.threads);
+    if (omega_transform_plugin_registry_set_parallel_thread_count(registry_ptr, thread_count) != 0) {
+        omega_transform_plugin_registry_destroy(registry_ptr);
+        std::cerr << "failed to set parallel thread count\n";
+        return 1;
+    }
 
-    const auto rc = options.list ? list_plugins(registry_ptr) : run_plugin(registry_ptr, options);
+    const auto rc = options.list                  ? list_plugins(registry_ptr)
+                    : options.benchmark_bytes > 0 ? run_benchmark(registry_ptr, options)
+                                                  : run_plugin(registry_ptr, options);
     omega_transform_plugin_registry_destroy(registry_ptr);
     return rc;
 }
@@ -26,6 +26,7 @@
 #include <atomic>
 #include <cctype>
 #include <chrono>
+#include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -91,6 +92,9 @@ namespace omega_edit {
         static constexpr size_t DIGEST_PLUGIN_ID_LIMIT = 4096;
         static constexpr size_t DIGEST_ALGORITHM_LIMIT = 128;
         static constexpr size_t DIGEST_VALUE_LIMIT = 4096;
+        static constexpr int SEARCH_STREAM_BATCH_MATCHES = 4096;
+        static constexpr auto SEARCH_STREAM_BATCH_INTERVAL = std::chrono::milliseconds(100);
+        static constexpr int64_t SEARCH_STREAM_SCAN_LENGTH = 4 * 1024 * 1024;
 
         static bool digest_plugin_id_is_safe(const std::string &plugin_id) {
             return !plugin_id.empty() && plugin_id.size() <= DIGEST_PLUGIN_ID_LIMIT &&
@@ -1203,6 +1207,45 @@ namespace omega_edit {
             return grpc::Status::OK;
         }
 
+        /**
+         * Bounds the automaton a multi-pattern search builds before it's allocated.  Each pattern byte adds at most one
+         * state, and the transition table has a column for each distinct byte plus one for all other bytes, so this
+         * bounds the table from above whatever the case folding.
+         */
+        static grpc::Status validate_multi_pattern_limits(const ::omega_edit::v1::SearchSessionRequest *request) {
+            if (request->patterns_size() > OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT) {
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                    "multi-pattern search exceeds the limit of " +
+                                            std::to_string(OMEGA_SEARCH_MULTI_PATTERN_COUNT_LIMIT) + " patterns");
+            }
+            int64_t total_length = 0;
+            std::array<bool, UCHAR_MAX + 1> is_used{};
+            int64_t class_count = 1;
+            for (const auto &pattern : request->patterns()) {
+                total_length += static_cast<int64_t>(pattern.size());
+                if (total_length > OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT) {
+                    return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                        "multi-pattern search exceeds the limit of " +
+                                                std::to_string(OMEGA_SEARCH_MULTI_PATTERN_TOTAL_LENGTH_LIMIT) +
+                                                " pattern bytes");
+                }
+                for (const auto byte : pattern) {
+                    auto &used = is_used[static_cast<unsigned char>(byte)];
+                    if (!used) {
+                        used = true;
+                        ++class_count;
+                    }
+                }
+            }
+            if ((total_length + 1) * class_count > OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT) {
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                    "multi-pattern search exceeds the limit of " +
+                                            std::to_string(OMEGA_SEARCH_MULTI_PATTERN_TABLE_LIMIT) +
+                                            " automaton transitions");
+            }
+            return grpc::Status::OK;
+        }
+
         static grpc::Status validate_replace_payload_sizes(const std::string &pattern, const std::string &replacement,
                                                            int64_t max_change_bytes,
                                                            const std::string &operation_name) {
@@ -1650,7 +1693,8 @@ namespace omega_edit {
             const std::string *initial_data_ptr = has_initial_data ? &initial_data : nullptr;
             try {
                 session_id = session_manager_.create_session(file_path, desired_id, checkpoint_dir, initial_data_ptr,
-                                                             file_size, checkpoint_dir_out, &create_error);
+                                                             request->lazy_snapshot(), file_size, checkpoint_dir_out,
+                                                             &create_error);
             } catch (const std::exception &e) {
                 return grpc::Status(grpc::StatusCode::INTERNAL, std::string("Failed to create session: ") + e.what());
             }
@@ -1733,6 +1777,10 @@ namespace omega_edit {
                 save_options.overwrite_guard_user_data = &guard_context;
                 save_options_ptr = &save_options;
             }
+            if (request->in_place()) {
+                save_options.in_place = OMEGA_EDIT_TRUE;
+                save_options_ptr = &save_options;
+            }
 
             int result;
             if (offset != 0 || length != 0) {
@@ -3015,7 +3063,7 @@ namespace omega_edit {
 
         // ---------- Search ----------
 
-        grpc::Status EditorServiceImpl::SearchSession(grpc::ServerContext * /*context*/,
+        grpc::Status EditorServiceImpl::SearchSession(grpc::ServerContext *context,
                                                       const ::omega_edit::v1::SearchSessionRequest *request,
                                                       ::omega_edit::v1::SearchSessionResponse *response) {
             bool is_reverse = request->has_is_reverse() ? request->is_reverse() : false;
@@ -3037,10 +3085,20 @@ namespace omega_edit {
                 return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search range is invalid");
             }
 
+            const bool is_multi_pattern = request->patterns_size() > 0;
+            if (is_multi_pattern && (is_reverse || !request->pattern().empty())) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                    "multi-pattern search is forward only and takes patterns instead of pattern");
+            }
+            if (is_multi_pattern) {
+                if (auto status = validate_multi_pattern_limits(request); !status.ok()) { return status; }
+            }
+
             bool resource_limit_applies = false;
             const auto bounded_limit =
                     effective_search_limit(limit, resource_limits_.max_search_matches, resource_limit_applies);
             std::vector<int64_t> match_offsets;
+            std::vector<int32_t> match_patterns;
 
             {
                 auto locked_session = session_manager_.lock_session(request->session_id());
@@ -3061,7 +3119,81 @@ namespace omega_edit {
                 if (length > 0 && effective_length > session_size - offset) {
                     return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search range is invalid");
                 }
-                if (static_cast<int64_t>(request->pattern().size()) <= effective_length) {
+                if (is_multi_pattern) {
+                    std::vector<const omega_byte_t *> patterns;
+                    std::vector<int64_t> pattern_lengths;
+                    patterns.reserve(static_cast<size_t>(request->patterns_size()));
+                    pattern_lengths.reserve(static_cast<size_t>(request->patterns_size()));
+                    for (const auto &pattern : request->patterns()) {
+                        patterns.push_back(reinterpret_cast<const omega_byte_t *>(pattern.data()));
+                        pattern_lengths.push_back(static_cast<int64_t>(pattern.size()));
+                    }
+                    auto *ctx = omega_search_create_multi_context(session, patterns.data(), pattern_lengths.data(),
+                                                                  static_cast<int64_t>(patterns.size()), offset, length,
+                                                                  case_folding);
+                    if (!ctx) {
+                        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search context could not be created");
+                    }
+
+                    // All patterns are found in one pass, so the match limit counts matches of any pattern
+                    int64_t num_matches = 0;
+                    auto search_result = 0;
+                    while ((bounded_limit <= 0 || num_matches < bounded_limit) &&
+                           (search_result = omega_search_next_multi_match(ctx)) > 0) {
+                        match_offsets.push_back(omega_search_multi_context_get_match_offset(ctx));
+                        match_patterns.push_back(
+                                static_cast<int32_t>(omega_search_multi_context_get_match_pattern_id(ctx)));
+                        ++num_matches;
+                    }
+                    if (search_result >= 0 && resource_limit_applies && num_matches >= bounded_limit) {
+                        search_result = omega_search_next_multi_match(ctx);
+                        if (search_result > 0) {
+                            omega_search_destroy_multi_context(ctx);
+                            return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                                "search matches exceed configured search match limit of " +
+                                                        std::to_string(resource_limits_.max_search_matches));
+                        }
+                    }
+                    omega_search_destroy_multi_context(ctx);
+                    if (search_result < 0) {
+                        return grpc::Status(grpc::StatusCode::INTERNAL, "search failed while reading session content");
+                    }
+                } else if (!is_reverse && static_cast<int64_t>(request->pattern().size()) <= effective_length) {
+                    const auto pattern_length = static_cast<int64_t>(request->pattern().size());
+                    if (pattern_length == 0 || OMEGA_SEARCH_PATTERN_LENGTH_LIMIT <= pattern_length) {
+                        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search context could not be created");
+                    }
+
+                    // Forward searches are split into chunks scanned across all cores.  One match past the resource
+                    // limit is requested so that exceeding it can be told apart from reaching it exactly.
+                    struct find_all_state_t {
+                        grpc::ServerContext *context;
+                        std::vector<int64_t> *match_offsets;
+                    } state{context, &match_offsets};
+                    const auto num_matches = omega_search_find_all(
+                            session, reinterpret_cast<const omega_byte_t *>(request->pattern().data()),
+                            pattern_length, offset, length, case_folding,
+                            resource_limit_applies ? bounded_limit + 1 : bounded_limit, 0,
+                            [](const int64_t *chunk_offsets, int64_t chunk_count, void *user_data_ptr) -> int {
+                                auto &find_all_state = *static_cast<find_all_state_t *>(user_data_ptr);
+                                if (find_all_state.context && find_all_state.context->IsCancelled()) { return 1; }
+                                find_all_state.match_offsets->insert(find_all_state.match_offsets->end(),
+                                                                     chunk_offsets, chunk_offsets + chunk_count);
+                                return 0;
+                            },
+                            &state);
+                    if (num_matches < 0) {
+                        return grpc::Status(grpc::StatusCode::INTERNAL, "search failed while reading session content");
+                    }
+                    if (context && context->IsCancelled()) {
+                        return grpc::Status(grpc::StatusCode::CANCELLED, "search cancelled");
+                    }
+                    if (resource_limit_applies && num_matches > bounded_limit) {
+                        return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                            "search matches exceed configured search match limit of " +
+                                                    std::to_string(resource_limits_.max_search_matches));
+                    }
+                } else if (static_cast<int64_t>(request->pattern().size()) <= effective_length) {
                     auto *ctx = omega_search_create_context_bytes(
                             session, reinterpret_cast<const omega_byte_t *>(request->pattern().data()),
                             static_cast<int64_t>(request->pattern().size()), offset, length, case_folding,
@@ -3107,10 +3239,113 @@ namespace omega_edit {
             response->set_offset(offset);
             response->set_length(length);
             for (const auto match_offset : match_offsets) { response->add_match_offset(match_offset); }
+            for (const auto match_pattern : match_patterns) { response->add_match_pattern(match_pattern); }
 
             return grpc::Status::OK;
         }
 
+        grpc::Status EditorServiceImpl::SearchSessionStream(
+                grpc::ServerContext *context, const ::omega_edit::v1::SearchSessionRequest *request,
+                grpc::ServerWriter<::omega_edit::v1::SearchSessionStreamResponse> *writer) {
+            const bool is_reverse = request->has_is_reverse() ? request->is_reverse() : false;
+            omega_search_case_folding_t case_folding = OMEGA_SEARCH_CASE_FOLDING_NONE;
+            if (!to_core_search_case_folding(request->has_case_folding()
+                                                     ? request->case_folding()
+                                                     : ::omega_edit::v1::SEARCH_CASE_FOLDING_UNSPECIFIED,
+                                             case_folding)) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search case folding is unsupported");
+            }
+            const int64_t offset = request->has_offset() ? request->offset() : 0;
+            const int64_t length = request->has_length() ? request->length() : 0;
+            const int64_t limit = request->has_limit() ? request->limit() : 0;// 0 = no limit
+            if (offset < 0 || length < 0 || limit < 0) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                    "search offset, length, and limit must be non-negative");
+            }
+            if (length > 0 && offset > (std::numeric_limits<int64_t>::max)() - length) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search range is invalid");
+            }
+            if (request->patterns_size() > 0) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "streaming search takes a single pattern");
+            }
+            const auto pattern_length = static_cast<int64_t>(request->pattern().size());
+            if (pattern_length == 0 || OMEGA_SEARCH_PATTERN_LENGTH_LIMIT <= pattern_length) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search context could not be created");
+            }
+
+            auto locked_session = session_manager_.lock_session(request->session_id());
+            if (!locked_session) {
+                return grpc::Status(grpc::StatusCode::NOT_FOUND, "session not found: " + request->session_id());
+            }
+            const auto session_size = omega_session_get_computed_file_size(locked_session.session());
+            if (session_size < 0) {
+                return grpc::Status(grpc::StatusCode::INTERNAL,
+                                    "failed to compute session size for session: " + request->session_id());
+            }
+            if (offset > session_size) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search context could not be created");
+            }
+            const auto effective_length = length > 0 ? length : session_size - offset;
+            if (length > 0 && effective_length > session_size - offset) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search range is invalid");
+            }
+            if (pattern_length > effective_length) { return grpc::Status::OK; }
+
+            // The search context pins the content as it is now, so the session lock can be released between batches
+            auto *ctx = omega_search_create_context_bytes(
+                    locked_session.session(), reinterpret_cast<const omega_byte_t *>(request->pattern().data()),
+                    pattern_length, offset, length, case_folding, is_reverse ? 1 : 0);
+            if (!ctx) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "search context could not be created");
+            }
+            if (omega_search_context_pin_content(ctx) != 0) {
+                omega_search_destroy_context(ctx);
+                return grpc::Status(grpc::StatusCode::INTERNAL, "failed to pin session content for search");
+            }
+            // Destroying the session while the lock is released also destroys the context
+            const auto destroy_context = [&]() {
+                if (!locked_session.lock.owns_lock()) { locked_session.lock.lock(); }
+                if (locked_session.session()) { omega_search_destroy_context(ctx); }
+            };
+
+            int64_t num_matches = 0;
+            for (;;) {
+                if (!locked_session.lock.owns_lock()) {
+                    locked_session.lock.lock();
+                    if (!locked_session) {
+                        return grpc::Status(grpc::StatusCode::ABORTED,
+                                            "session destroyed during search: " + request->session_id());
+                    }
+                }
+                // Each batch ends when it's full, or after the batch interval.  The search scans a bounded number of
+                // offsets per step, so the interval is checked (and the lock released) even while nothing matches.
+                ::omega_edit::v1::SearchSessionStreamResponse batch;
+                const auto batch_deadline = std::chrono::steady_clock::now() + SEARCH_STREAM_BATCH_INTERVAL;
+                auto search_result = 0;
+                while ((limit <= 0 || num_matches < limit) && batch.match_offset_size() < SEARCH_STREAM_BATCH_MATCHES &&
+                       (search_result = omega_search_next_match_bounded(ctx, 1, SEARCH_STREAM_SCAN_LENGTH)) > 0) {
+                    if (search_result == 1) {
+                        batch.add_match_offset(omega_search_context_get_match_offset(ctx));
+                        ++num_matches;
+                    }
+                    if (batch_deadline <= std::chrono::steady_clock::now()) { break; }
+                }
+                if (search_result < 0) {
+                    destroy_context();
+                    return grpc::Status(grpc::StatusCode::INTERNAL, "search failed while reading session content");
+                }
+                const bool is_complete = search_result == 0 || (limit > 0 && num_matches >= limit);
+                if (is_complete) { destroy_context(); }
+                locked_session.lock.unlock();
+
+                if (context->IsCancelled() || (batch.match_offset_size() > 0 && !writer->Write(batch))) {
+                    if (!is_complete) { destroy_context(); }
+                    return grpc::Status(grpc::StatusCode::CANCELLED, "search cancelled");
+                }
+                if (is_complete) { return grpc::Status::OK; }
+            }
+        }
+
         grpc::Status EditorServiceImpl::ReplaceSession(grpc::ServerContext * /*context*/,
                                                        const ::omega_edit::v1::ReplaceSessionRequest *request,
                                                        ::omega_edit::v1::ReplaceSessionResponse *response) {
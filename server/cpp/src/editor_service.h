@@ -194,6 +194,10 @@ namespace omega_edit {
                                        const ::omega_edit::v1::SearchSessionRequest *request,
                                        ::omega_edit::v1::SearchSessionResponse *response) override;
 
+            grpc::Status
+            SearchSessionStream(grpc::ServerContext *context, const ::omega_edit::v1::SearchSessionRequest *request,
+                                grpc::ServerWriter<::omega_edit::v1::SearchSessionStreamResponse> *writer) override;
+
             grpc::Status ReplaceSession(grpc::ServerContext *context,
                                         const ::omega_edit::v1::ReplaceSessionRequest *request,
                                         ::omega_edit::v1::ReplaceSessionResponse *response) override;
@@ -505,8 +505,9 @@ namespace omega_edit {
         // ── Session lifecycle ────────────────────────────────────────────────────────
         std::string SessionManager::create_session(const std::string &file_path, const std::string &desired_id,
                                                    const std::string &checkpoint_directory,
-                                                   const std::string *initial_data, int64_t &file_size_out,
-                                                   std::string &checkpoint_dir_out, SessionCreateError *error_out) {
+                                                   const std::string *initial_data, bool lazy_snapshot,
+                                                   int64_t &file_size_out, std::string &checkpoint_dir_out,
+                                                   SessionCreateError *error_out) {
             if (error_out) { *error_out = SessionCreateError::SUCCESS; }
 
             if (!file_path.empty() && !is_valid_external_path(file_path)) {
@@ -647,7 +648,12 @@ namespace omega_edit {
                         static_cast<int64_t>(initial_data->size()), session_event_callback, info.get(), 0, chkpt_dir);
             } else {
                 const char *path = canonical_file_path.empty() ? nullptr : canonical_file_path.c_str();
-                session = omega_edit_create_session(path, session_event_callback, info.get(), 0, chkpt_dir);
+                omega_edit_session_options_t options{};
+                options.cbk = session_event_callback;
+                options.user_data_ptr = info.get();
+                options.checkpoint_directory = chkpt_dir;
+                options.lazy_snapshot = lazy_snapshot ? OMEGA_EDIT_TRUE : OMEGA_EDIT_FALSE;
+                session = omega_edit_create_session_with_options(path, &options);
             }
 
             if (!session) {
@@ -286,7 +286,7 @@ namespace omega_edit {
             // Session lifecycle
             std::string create_session(const std::string &file_path, const std::string &desired_id,
                                        const std::string &checkpoint_directory, const std::string *initial_data,
-                                       int64_t &file_size_out, std::string &checkpoint_dir_out,
+                                       bool lazy_snapshot, int64_t &file_size_out, std::string &checkpoint_dir_out,
                                        SessionCreateError *error_out = nullptr);
             bool destroy_session(const std::string &session_id);
             bool detach_session(const std::string &session_id);